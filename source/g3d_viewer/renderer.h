@@ -142,6 +142,9 @@ namespace Shared {
 			Texture2D *newTexture2D(ResourceScope rs) {
 				return getNewTexture2D();
 			}
+			void initTexture(ResourceScope rs, Texture *texture) {
+				textureManager->initTexture(texture);
+			}
 
 			void initTextureManager();
 			void initModelManager();
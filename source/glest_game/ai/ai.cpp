@@ -989,20 +989,91 @@ namespace
 			}
 		}
 
+		// Radius of the first window findPosForBuilding probes
+		static const int
+			firstBuildAreaRadius = 4;
+		static const char
+			buildCellUnknown = 0;
+		static const char
+			buildCellFree = 1;
+		static const char
+			buildCellBlocked = 2;
+
+		// Fills buildAreaTable with every footprint tried for radii below
+		// radius, reusing the cells probed for a smaller radius
+		void
+			Ai::markBuildArea(const Vec2i & searchPos, int radius,
+				int footprintSize) {
+			int
+				searchSize = 2 * maxBuildRadius + footprintSize;
+			int
+				searchOriginX = searchPos.x - maxBuildRadius - minBuildSpacing;
+			int
+				searchOriginY = searchPos.y - maxBuildRadius - minBuildSpacing;
+			int
+				size = 2 * radius + footprintSize;
+			buildAreaTable.init(searchPos.x - radius - minBuildSpacing,
+				searchPos.y - radius - minBuildSpacing, size, size);
+
+			const Map *
+				map = aiInterface->getMap();
+			for (int j = buildAreaTable.getOriginY();
+				j < buildAreaTable.getOriginY() + buildAreaTable.getH(); ++j) {
+				for (int i = buildAreaTable.getOriginX();
+					i < buildAreaTable.getOriginX() + buildAreaTable.getW(); ++i) {
+					char &
+						cell = buildAreaCells[(j - searchOriginY) * searchSize +
+						(i - searchOriginX)];
+					if (cell == buildCellUnknown) {
+						cell = (map->isFreeCell(Vec2i(i, j), fLand) == true ?
+							buildCellFree : buildCellBlocked);
+					}
+					if (cell == buildCellBlocked) {
+						buildAreaTable.mark(i, j);
+					}
+				}
+			}
+			buildAreaTable.build();
+		}
+
 		bool
 			Ai::findPosForBuilding(const UnitType * building,
 				const Vec2i & searchPos, Vec2i & outPos) {
 
+			// Blocked cells of the footprints the search tries are counted
+			// into buildAreaTable, each footprint is then checked in constant
+			// time. Most buildings fit close to searchPos, so the table starts
+			// small and doubles as the search widens; a cell is only ever
+			// probed once
+			int
+				footprintSize = building->getAiBuildSize() + minBuildSpacing * 2;
+			int
+				searchSize = 2 * maxBuildRadius + footprintSize;
+			buildAreaCells.assign(searchSize * searchSize, buildCellUnknown);
+			int
+				tableRadius = 0;
+
+			// Each radius tries the square from searchPos - currRadius to
+			// searchPos + currRadius - 1, all of it but its border already
+			// failed, so only the border is tried, in the same order
 			for (int currRadius = 0; currRadius < maxBuildRadius; ++currRadius) {
+				if (currRadius >= tableRadius) {
+					tableRadius = std::min(std::max(tableRadius * 2,
+						firstBuildAreaRadius), maxBuildRadius);
+					markBuildArea(searchPos, tableRadius, footprintSize);
+				}
 				for (int i = searchPos.x - currRadius; i < searchPos.x + currRadius;
 					++i) {
+					bool
+						borderColumn = (i == searchPos.x - currRadius ||
+							i == searchPos.x + currRadius - 1);
+					int
+						step = (borderColumn ? 1 : 2 * currRadius - 1);
 					for (int j = searchPos.y - currRadius;
-						j < searchPos.y + currRadius; ++j) {
+						j < searchPos.y + currRadius; j += step) {
 						outPos = Vec2i(i, j);
-						if (aiInterface->
-							isFreeCells(outPos - Vec2i(minBuildSpacing),
-								building->getAiBuildSize() +
-								minBuildSpacing * 2, fLand)) {
+						if (buildAreaTable.isClear(outPos.x - minBuildSpacing,
+							outPos.y - minBuildSpacing, footprintSize)) {
 							int
 								aiBuildSizeDiff =
 								building->getAiBuildSize() - building->getSize();
@@ -19,6 +19,7 @@
 #   include "commander.h"
 #   include "command.h"
 #   include "randomgen.h"
+#   include "summed_area_table.h"
 #   include "leak_dumper.h"
 
 using
@@ -29,6 +30,8 @@ using
 std::list;
 using
 Shared::Util::RandomGen;
+using
+Shared::Util::SummedAreaTable;
 
 namespace
 	Glest {
@@ -280,7 +283,17 @@ namespace
 				factionSwitchTeamRequestCount;
 			int
 				minWarriors;
+			// Blocked land cells around the last building search
+			SummedAreaTable
+				buildAreaTable;
+			// Which cells of the whole search window were probed yet, and
+			// how they turned out
+			vector < char >
+				buildAreaCells;
 
+			void
+				markBuildArea(const Vec2i & searchPos, int radius,
+					int footprintSize);
 			bool
 				getAdjacentUnits(std::map < float, std::map < int,
 					const Unit * > >&signalAdjacentUnits,
@@ -116,6 +116,7 @@ namespace Glest {
 		const char *Config::colorPicking = "color";
 		const char *Config::selectBufPicking = "selectbuf";
 		const char *Config::frustumPicking = "frustum";
+		const char *Config::rayPicking = "ray";
 
 		map < string, string > Config::customRuntimeProperties;
 
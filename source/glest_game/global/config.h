@@ -82,6 +82,7 @@ namespace Glest {
 			static const char *colorPicking;
 			static const char *selectBufPicking;
 			static const char *frustumPicking;
+			static const char *rayPicking;
 
 		protected:
 
@@ -49,6 +49,8 @@ namespace Glest {
 			particleSystemStartDelay = 0;
 			texture = NULL;
 			model = NULL;
+			assetRenderer = NULL;
+			textureLuminance = false;
 			minmaxEnabled = false;
 			minHp = 0;
 			maxHp = 0;
@@ -98,10 +100,19 @@ namespace Glest {
 			children.clear();
 		}
 
+		// Guards the lazily loaded assets of every particle system type
+		static Mutex lazyAssetsMutex;
+
 		void ParticleSystemType::copyAll(const ParticleSystemType &src) {
+			MutexSafeWrapper safeMutex(&lazyAssetsMutex, string(__FILE__) + "_" + intToStr(__LINE__));
 			this->type = src.type;
 			this->texture = src.texture;
 			this->model = src.model;
+			this->assetRenderer = src.assetRenderer;
+			this->texturePath = src.texturePath;
+			this->textureLuminance = src.textureLuminance;
+			this->modelPath = src.modelPath;
+			safeMutex.ReleaseLock();
 			this->modelCycle = src.modelCycle;
 			this->primitive = src.primitive;
 			this->offset = src.offset;
@@ -140,11 +151,24 @@ namespace Glest {
 			RendererInterface *renderer, std::map<string, vector<pair<string, string> > > &loadedFileList,
 			string parentLoader, string techtreePath) {
 
+			// Textures and models wait for the first particle system made
+			// from this type
+			bool lazyAssets = (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false &&
+				Config::getInstance().getBool("LazyLoadUnitAssets", "false") == true);
+			assetRenderer = (lazyAssets == true ? renderer : NULL);
+
 			//texture
 			const XmlNode *textureNode = particleSystemNode->getChild("texture");
 			bool textureEnabled = textureNode->getAttribute("value")->getBoolValue();
 
-			if (textureEnabled) {
+			if (textureEnabled && lazyAssets == true) {
+				string currentPath = dir;
+				endPathWithSlash(currentPath);
+				texturePath = textureNode->getAttribute("path")->getRestrictedValue(currentPath);
+				textureLuminance = textureNode->getAttribute("luminance")->getBoolValue();
+				texture = NULL;
+				loadedFileList[texturePath].push_back(make_pair(parentLoader, textureNode->getAttribute("path")->getRestrictedValue()));
+			} else if (textureEnabled) {
 				texture = renderer->newTexture2D(rsGame);
 				if (texture) {
 					if (textureNode->getAttribute("luminance")->getBoolValue()) {
@@ -173,7 +197,12 @@ namespace Glest {
 					endPathWithSlash(currentPath);
 
 					string path = modelNode->getAttribute("path")->getRestrictedValue(currentPath);
-					model = renderer->newModel(rsGame, path, false, &loadedFileList, &parentLoader);
+					if (lazyAssets == true) {
+						modelPath = path;
+						model = NULL;
+					} else {
+						model = renderer->newModel(rsGame, path, false, &loadedFileList, &parentLoader);
+					}
 					loadedFileList[path].push_back(make_pair(parentLoader, modelNode->getAttribute("path")->getRestrictedValue()));
 
 					if (modelNode->hasChild("cycles")) {
@@ -297,7 +326,77 @@ namespace Glest {
 			}
 		}
 
+		void ParticleSystemType::loadAssets() {
+			for (Children::iterator it = children.begin(); it != children.end(); ++it) {
+				(*it)->loadAssets();
+			}
+			if (Thread::isCurrentThreadMainThread() == false) {
+				return;
+			}
+			MutexSafeWrapper safeMutex(&lazyAssetsMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (assetRenderer == NULL) {
+				return;
+			}
+			// Only the main thread gets here, so nothing else writes these
+			// while the lock is released for loading
+			RendererInterface *renderer = assetRenderer;
+			string loadTexturePath = texturePath;
+			string loadModelPath = modelPath;
+			safeMutex.ReleaseLock(true);
+
+			Texture2D *loadedTexture = NULL;
+			if (loadTexturePath != "") {
+				loadedTexture = renderer->newTexture2D(rsGame);
+				if (loadedTexture) {
+					if (textureLuminance == true) {
+						loadedTexture->setFormat(Texture::fAlpha);
+						loadedTexture->getPixmap()->init(1);
+					} else {
+						loadedTexture->getPixmap()->init(4);
+					}
+					loadedTexture->load(loadTexturePath);
+					renderer->initTexture(rsGame, loadedTexture);
+				}
+			}
+			Model *loadedModel = NULL;
+			if (loadModelPath != "") {
+				loadedModel = renderer->newModel(rsGame, loadModelPath);
+			}
+
+			safeMutex.Lock();
+			if (loadTexturePath != "") {
+				texture = loadedTexture;
+				texturePath = "";
+			}
+			if (loadModelPath != "") {
+				model = loadedModel;
+				modelPath = "";
+			}
+			assetRenderer = NULL;
+		}
+
+		Texture2D *ParticleSystemType::getLoadedTexture() const {
+			MutexSafeWrapper safeMutex(&lazyAssetsMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return texture;
+		}
+
+		Model *ParticleSystemType::getLoadedModel() const {
+			MutexSafeWrapper safeMutex(&lazyAssetsMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return model;
+		}
+
+		bool ParticleSystemType::hasTexture() const {
+			MutexSafeWrapper safeMutex(&lazyAssetsMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return(texture != NULL || texturePath != "");
+		}
+
+		bool ParticleSystemType::hasModel() const {
+			MutexSafeWrapper safeMutex(&lazyAssetsMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return(model != NULL || modelPath != "");
+		}
+
 		void ParticleSystemType::setValues(AttackParticleSystem *ats) {
+			loadAssets();
 			// add instances of all children; some settings will cascade to all children
 			for (Children::iterator i = children.begin(); i != children.end(); ++i) {
 				UnitParticleSystem *child = new UnitParticleSystem();
@@ -307,7 +406,7 @@ namespace Glest {
 				ats->addChild(child);
 				child->setState(ParticleSystem::sPlay);
 			}
-			ats->setTexture(texture);
+			ats->setTexture(getLoadedTexture());
 			ats->setPrimitive(AttackParticleSystem::strToPrimitive(primitive));
 			ats->setOffset(offset);
 			ats->setColor(color);
@@ -321,7 +420,7 @@ namespace Glest {
 			ats->setEmissionRate(emissionRate);
 			ats->setMaxParticleEnergy(energyMax);
 			ats->setVarParticleEnergy(energyVar);
-			ats->setModel(model);
+			ats->setModel(getLoadedModel());
 			ats->setModelCycle(modelCycle);
 			ats->setTeamcolorNoEnergy(teamcolorNoEnergy);
 			ats->setTeamcolorEnergy(teamcolorEnergy);
@@ -85,7 +85,17 @@ namespace Glest {
 			int maxHp;
 			bool minmaxIsPercent;
 
+			// Left for loadAssets() when the type was loaded lazily. The
+			// main thread fills in texture and model while other threads
+			// make particle systems, so these are only used under a mutex
+			RendererInterface *assetRenderer;
+			string texturePath;
+			bool textureLuminance;
+			string modelPath;
+
 			void copyAll(const ParticleSystemType &src);
+			Texture2D *getLoadedTexture() const;
+			Model *getLoadedModel() const;
 		public:
 
 			ParticleSystemType();
@@ -98,12 +108,12 @@ namespace Glest {
 				RendererInterface *renderer, std::map<string, vector<pair<string, string> > > &loadedFileList,
 				string parentLoader, string techtreePath);
 			void setValues(AttackParticleSystem *ats);
-			bool hasTexture() const {
-				return(texture != NULL);
-			}
-			bool hasModel() const {
-				return(model != NULL);
-			}
+			// Loads the texture and model of a lazily loaded type and its
+			// children. Needs the GL context, so it does nothing off the
+			// main thread
+			void loadAssets();
+			bool hasTexture() const;
+			bool hasModel() const;
 
 			bool getMinmaxEnabled() const {
 				return minmaxEnabled;
@@ -26,6 +26,9 @@
 #include "factory_repository.h"
 #include <cstdlib>
 #include "cache_manager.h"
+#include "async_texture_loader.h"
+#include "interpolation.h"
+#include "pick_bvh.h"
 #include "network_manager.h"
 #include <algorithm>
 #include <iterator>
@@ -102,7 +105,7 @@ namespace Glest {
 
 		// ==================== constructor and destructor ====================
 
-		Renderer::Renderer() : BaseRenderer(), saveScreenShotThreadAccessor(new Mutex(CODE_AT_LINE)) {
+		Renderer::Renderer() : BaseRenderer(), saveScreenShotThreadAccessor(new Mutex(CODE_AT_LINE)), assetPrefetchAccessor(new Mutex(CODE_AT_LINE)) {
 			//this->masterserverMode = masterserverMode;
 			//printf("this->masterserverMode = %d\n",this->masterserverMode);
 			//assert(0==1);
@@ -119,7 +122,12 @@ namespace Glest {
 			photoMode = false;
 			focusArrows = false;
 			pointCount = 0;
+			renderQueueItemCount = 0;
+			renderQueueBatchCount = 0;
+			renderQueueStateChangeCount = 0;
 			maxLights = 0;
+			asyncTextureUploadMillis = 4;
+			assetPrefetchMillis = 4;
 			waterAnim = 0;
 
 			this->allowRenderUnitTitles = false;
@@ -143,6 +151,7 @@ namespace Glest {
 			lastRenderFps = MIN_FPS_NORMAL_RENDERING;
 			shadowsOffDueToMinRender = false;
 			shadowMapHandle = 0;
+			fowTexUploadedHandle = 0;
 			shadowMapHandleValid = false;
 
 			//list3d=0;
@@ -283,6 +292,9 @@ namespace Glest {
 
 				delete saveScreenShotThreadAccessor;
 				saveScreenShotThreadAccessor = NULL;
+
+				delete assetPrefetchAccessor;
+				assetPrefetchAccessor = NULL;
 			} catch (const exception &e) {
 				char szBuf[8096] = "";
 				snprintf(szBuf, 8096, "In [%s::%s Line: %d]\nError [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, e.what());
@@ -398,6 +410,10 @@ namespace Glest {
 
 			init2dList();
 
+			AsyncTextureLoader::start(config.getInt("AsyncTextureLoadThreads", "2"));
+			ParticleSystem::setParticleStorePoolSize(config.getInt("ParticleStorePoolSize", "32"));
+			ParticleManager::startWorkers(config.getInt("ParticleUpdateThreads", "2"));
+
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 
 			glHint(GL_FOG_HINT, GL_FASTEST);
@@ -428,6 +444,8 @@ namespace Glest {
 			mapSurfaceData.clear();
 			this->game = game;
 			worldToScreenPosCache.clear();
+			resourceStatusTexts.clear();
+			fowTexUploadedHandle = 0;
 
 			//vars
 			shadowMapFrame = 0;
@@ -501,6 +519,10 @@ namespace Glest {
 			textureManager[rsGame]->init();
 			fontManager[rsGame]->init();
 
+			// Whatever lazy loading brings in during the game is decoded in
+			// the background
+			textureManager[rsGame]->setLoadAsync(Config::getInstance().getBool("LazyLoadUnitAssets", "false"));
+
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 
 			init3dList();
@@ -593,6 +615,9 @@ namespace Glest {
 
 			pointCount = 0;
 			triangleCount = 0;
+			renderQueueItemCount = 0;
+			renderQueueBatchCount = 0;
+			renderQueueStateChangeCount = 0;
 			assertGl();
 		}
 
@@ -639,6 +664,9 @@ namespace Glest {
 
 			mapSurfaceData.clear();
 
+			AsyncTextureLoader::stop();
+			ParticleManager::stopWorkers();
+
 			//delete resources
 			if (modelManager[rsGlobal]) {
 				modelManager[rsGlobal]->end();
@@ -652,6 +680,7 @@ namespace Glest {
 			if (particleManager[rsGlobal]) {
 				particleManager[rsGlobal]->end();
 			}
+			ParticleSystem::clearParticleStorePools();
 
 			//delete 2d list
 			//if(list2dValid == true) {
@@ -690,6 +719,8 @@ namespace Glest {
 			//}
 
 			worldToScreenPosCache.clear();
+			resourceStatusTexts.clear();
+			fowTexUploadedHandle = 0;
 			ReleaseSurfaceVBOs();
 			mapSurfaceData.clear();
 		}
@@ -699,6 +730,15 @@ namespace Glest {
 			this->gameCamera = NULL;
 			Config &config = Config::getInstance();
 
+			// The unit types go away with the game
+			{
+				MutexSafeWrapper safeMutex(assetPrefetchAccessor, string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+				assetPrefetchQueue.clear();
+			}
+			if (textureManager[rsGame] != NULL) {
+				textureManager[rsGame]->setLoadAsync(false);
+			}
+
 			try {
 				quadCache = VisibleQuadContainerCache();
 				quadCache.clearFrustumData();
@@ -725,6 +765,7 @@ namespace Glest {
 				if (particleManager[rsGame] != NULL) {
 					particleManager[rsGame]->end();
 				}
+				ParticleSystem::clearParticleStorePools();
 			}
 
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
@@ -744,6 +785,8 @@ namespace Glest {
 			//}
 
 			worldToScreenPosCache.clear();
+			resourceStatusTexts.clear();
+			fowTexUploadedHandle = 0;
 			ReleaseSurfaceVBOs();
 			mapSurfaceData.clear();
 		}
@@ -952,6 +995,14 @@ namespace Glest {
 			//glFlush();
 
 			GraphicsInterface::getInstance().getCurrentContext()->swapBuffers();
+
+			// Hand over textures decoded in the background, a few per frame
+			if (AsyncTextureLoader::isRunning() == true) {
+				AsyncTextureLoader::processUploads(asyncTextureUploadMillis);
+			}
+			processAssetPrefetches(assetPrefetchMillis);
+			// Interpolated frames not used from here on get recycled
+			InterpolationData::advanceFrame();
 		}
 
 		// ==================== lighting ====================
@@ -2203,6 +2254,10 @@ namespace Glest {
 				str += gamePerfStats + "\n";
 			}
 
+			snprintf(szBuf, 200, "Draw items: %d batches: %d state changes: %d",
+				renderQueueItemCount, renderQueueBatchCount, renderQueueStateChangeCount);
+			str += string(szBuf) + string("\n");
+
 			if (renderText3DEnabled == true) {
 				renderTextShadow3D(
 					str, CoreData::getInstance().getDisplayFontSmall3D(),
@@ -2493,7 +2548,28 @@ namespace Glest {
 			}
 
 			const Resource *r = factionForResourceView->getResource(rt, localFactionResourcesOnly);
-			string str = intToStr(r->getAmount());
+			int storeAmount = (rt->getClass() != rcStatic ? factionForResourceView->getStoreAmount(rt, localFactionResourcesOnly) : 0);
+			ResourceStatusText &statusText = resourceStatusTexts[ResourceStatusKey(std::make_pair(factionForResourceView, rt), localFactionResourcesOnly)];
+			if (statusText.text.empty() == true || statusText.amount != r->getAmount() ||
+				statusText.storeAmount != storeAmount || statusText.balance != r->getBalance()) {
+				statusText.amount = r->getAmount();
+				statusText.storeAmount = storeAmount;
+				statusText.balance = r->getBalance();
+
+				string str = intToStr(r->getAmount());
+				if (rt->getClass() != rcStatic) {
+					str += "/" + intToStr(storeAmount);
+				}
+				if (rt->getClass() == rcConsumable) {
+					str += "(";
+					if (r->getBalance() > 0) {
+						str += "+";
+					}
+					str += intToStr(r->getBalance()) + ")";
+				}
+				statusText.text = str;
+			}
+			const string &str = statusText.text;
 
 			glEnable(GL_TEXTURE_2D);
 
@@ -2530,17 +2606,6 @@ namespace Glest {
 
 			renderQuad(resourceCol * 100 + 200, resourceYStart - (resourceRowHeigth * resourceRow), 16, 16, rt->getImage());
 
-			if (rt->getClass() != rcStatic) {
-				str += "/" + intToStr(factionForResourceView->getStoreAmount(rt, localFactionResourcesOnly));
-			}
-			if (rt->getClass() == rcConsumable) {
-				str += "(";
-				if (r->getBalance() > 0) {
-					str += "+";
-				}
-				str += intToStr(r->getBalance()) + ")";
-			}
-
 			glDisable(GL_TEXTURE_2D);
 
 			if (renderText3DEnabled == true) {
@@ -2700,7 +2765,7 @@ namespace Glest {
 					for (int i = 0; i < useWidth; ++i) {
 						temp += DEFAULT_CHAR_FOR_WIDTH_CALC;
 					}
-					float lineWidth = (font->getTextHandler()->Advance(temp.c_str()) * ::Shared::Graphics::Font::scaleFontValue);
+					float lineWidth = (font->getMetrics()->getLayoutCache()->getLayout(temp, true).advance * ::Shared::Graphics::Font::scaleFontValue);
 					useWidth = (int) lineWidth;
 
 					maxEditWidth = useWidth;
@@ -2767,7 +2832,7 @@ namespace Glest {
 					throw megaglest_runtime_error(szBuf);
 				}
 
-				float lineWidth = (font->getTextHandler()->Advance(text.c_str()) * ::Shared::Graphics::Font::scaleFontValue);
+				float lineWidth = (font->getMetrics()->getLayoutCache()->getLayout(text, true).advance * ::Shared::Graphics::Font::scaleFontValue);
 				if (lineWidth < w) {
 					pos.x += ((w / 2.f) - (lineWidth / 2.f));
 				}
@@ -2782,7 +2847,7 @@ namespace Glest {
 
 				//const Metrics &metrics= Metrics::getInstance();
 				//float lineHeight = (font->getTextHandler()->LineHeight(text.c_str()) * Font::scaleFontValue);
-				float lineHeight = (font->getTextHandler()->LineHeight(text.c_str()) * ::Shared::Graphics::Font::scaleFontValue);
+				float lineHeight = (font->getMetrics()->getLayoutCache()->getLineHeight() * ::Shared::Graphics::Font::scaleFontValue);
 				//lineHeight=metrics.toVirtualY(lineHeight);
 				//lineHeight= lineHeight / (2.f + 0.2f * FontMetrics::DEFAULT_Y_OFFSET_FACTOR);
 				//pos.y += (h / 2.f) - (lineHeight / 2.f);
@@ -2841,7 +2906,7 @@ namespace Glest {
 					for (int i = 0; i < useWidth; ++i) {
 						temp += DEFAULT_CHAR_FOR_WIDTH_CALC;
 					}
-					float lineWidth = (font->getTextHandler()->Advance(temp.c_str()) * ::Shared::Graphics::Font::scaleFontValue);
+					float lineWidth = (font->getMetrics()->getLayoutCache()->getLayout(temp, true).advance * ::Shared::Graphics::Font::scaleFontValue);
 					useWidth = (int) lineWidth;
 
 					maxEditWidth = useWidth;
@@ -2917,7 +2982,7 @@ namespace Glest {
 					for (int i = 0; i < useWidth; ++i) {
 						temp += DEFAULT_CHAR_FOR_WIDTH_CALC;
 					}
-					float lineWidth = (font->getTextHandler()->Advance(temp.c_str()) * ::Shared::Graphics::Font::scaleFontValue);
+					float lineWidth = (font->getMetrics()->getLayoutCache()->getLayout(temp, true).advance * ::Shared::Graphics::Font::scaleFontValue);
 					useWidth = (int) lineWidth;
 
 					maxEditWidth = useWidth;
@@ -4355,10 +4420,25 @@ namespace Glest {
 					glEnable(GL_TEXTURE_2D);
 					glBindTexture(GL_TEXTURE_2D, static_cast<const Texture2DGl*>(fowTex)->getHandle());
 
-					glTexSubImage2D(
-						GL_TEXTURE_2D, 0, 0, 0,
-						fowTex->getPixmapConst()->getW(), fowTex->getPixmapConst()->getH(),
-						GL_ALPHA, GL_UNSIGNED_BYTE, fowTex->getPixmapConst()->getPixels());
+					// Only rows the fog of war changed are sent, all of
+					// them when the texture was (re)created without pixels
+					const Pixmap2D *fowTexPixmap = fowTex->getPixmapConst();
+					GLuint fowTexHandle = static_cast<const Texture2DGl*>(fowTex)->getHandle();
+					int firstRow = 0;
+					int rowCount = 0;
+					bool rowsChanged = world->getMinimap()->takeFowTexChangedRows(firstRow, rowCount);
+					if (fowTexHandle != fowTexUploadedHandle) {
+						firstRow = 0;
+						rowCount = fowTexPixmap->getH();
+						rowsChanged = true;
+						fowTexUploadedHandle = fowTexHandle;
+					}
+					if (rowsChanged == true) {
+						glTexSubImage2D(
+							GL_TEXTURE_2D, 0, 0, firstRow,
+							fowTexPixmap->getW(), rowCount,
+							GL_ALPHA, GL_UNSIGNED_BYTE, fowTexPixmap->getPixels() + firstRow * fowTexPixmap->getW());
+					}
 
 					if (shadowsOffDueToMinRender == false) {
 						//shadow texture
@@ -4766,16 +4846,40 @@ namespace Glest {
 
 			VisibleQuadContainerCache &qCache = getQuadCache();
 
-			//	for(int visibleIndex = 0;
-			//			visibleIndex < qCache.visibleObjectList.size(); ++visibleIndex) {
-			// render from last to first object so animated objects which are on bottom of screen are
-			// rendered first which looks better for limited number of animated tileset objects
+			// Which objects get animated is still decided from last to first
+			// object, so the animated ones are those at the bottom of the
+			// screen when their number is limited
+			vector<float> objectAnimProgress(qCache.visibleObjectList.size());
+			renderQueue.clear();
 			for (int visibleIndex = (int) qCache.visibleObjectList.size() - 1;
 				visibleIndex >= 0; --visibleIndex) {
 				Object *o = qCache.visibleObjectList[visibleIndex];
 
+				if (tilesetObjectsToAnimate == -1) {
+					objectAnimProgress[visibleIndex] = o->getAnimProgress();
+				} else if (tilesetObjectsToAnimate > 0 && o->isAnimated()) {
+					tilesetObjectsToAnimate--;
+					objectAnimProgress[visibleIndex] = o->getAnimProgress();
+				} else {
+					objectAnimProgress[visibleIndex] = 0;
+				}
+
+				RenderQueueItem item;
+				item.model = o->getModelPtr();
+				item.index = visibleIndex;
+				renderQueue.add(item);
+			}
+			renderQueue.sort();
+			renderQueueItemCount += renderQueue.getItemCount();
+			renderQueueBatchCount += renderQueue.getBatchCount();
+			renderQueueStateChangeCount += renderQueue.getStateChangeCount();
+
+			float lastFowFactor = -1;
+			for (int itemIndex = 0; itemIndex < renderQueue.getItemCount(); ++itemIndex) {
+				int visibleIndex = renderQueue.getItem(itemIndex).index;
+				Object *o = qCache.visibleObjectList[visibleIndex];
+
 				Model *objModel = o->getModelPtr();
-				//objModel->updateInterpolationData(o->getAnimProgress(), true);
 				const Vec3f v = o->getConstPos();
 
 				if (modelRenderStarted == false) {
@@ -4800,13 +4904,17 @@ namespace Glest {
 
 					modelRenderer->begin(true, true, false, false);
 				}
-				//ambient and diffuse color is taken from cell color
+				//ambient and diffuse color is taken from cell color, neighbours
+				//often share it
 
 				float fowFactor = fowTexPixmap->getPixelf(o->getMapPos().x / Map::cellScale, o->getMapPos().y / Map::cellScale);
-				Vec4f color = Vec4f(Vec3f(fowFactor), 1.f);
-				glColor4fv(color.ptr());
-				glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, (color * ambFactor).ptr());
-				glFogfv(GL_FOG_COLOR, (baseFogColor * fowFactor).ptr());
+				if (fowFactor != lastFowFactor) {
+					Vec4f color = Vec4f(Vec3f(fowFactor), 1.f);
+					glColor4fv(color.ptr());
+					glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, (color * ambFactor).ptr());
+					glFogfv(GL_FOG_COLOR, (baseFogColor * fowFactor).ptr());
+					lastFowFactor = fowFactor;
+				}
 
 				glMatrixMode(GL_MODELVIEW);
 				glPushMatrix();
@@ -4818,21 +4926,7 @@ namespace Glest {
 				//			setupLightingForRotatedModel();
 				//		}
 
-				//objModel->updateInterpolationData(0.f, true);
-				//if(this->gameCamera->getPos().dist(o->getPos()) <= SKIP_INTERPOLATION_DISTANCE) {
-
-
-				if (tilesetObjectsToAnimate == -1) {
-					objModel->updateInterpolationData(o->getAnimProgress(), true);
-				} else if (tilesetObjectsToAnimate > 0 && o->isAnimated()) {
-					tilesetObjectsToAnimate--;
-					objModel->updateInterpolationData(o->getAnimProgress(), true);
-				} else {
-					objModel->updateInterpolationData(0, true);
-				}
-
-				//		objModel->updateInterpolationData(o->getAnimProgress(), true);
-						//}
+				objModel->updateInterpolationData(objectAnimProgress[visibleIndex], true);
 				modelRenderer->render(objModel);
 
 				triangleCount += objModel->getTriangleCount();
@@ -5020,9 +5114,10 @@ namespace Glest {
 					Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
 					Vec3f currVec = unit->getCurrVectorFlat();
 					Vec4f color = unit->getFaction()->getTexture()->getPixmapConst()->getPixel4f(0, 0);
-					glColor4f(color.x, color.y, color.z, color.w * 0.7f);
-					renderSelectionCircle(currVec, unit->getType()->getSize(), 0.8f, 0.05f);
+					color.w *= 0.7f;
+					renderSelectionCircle(currVec, unit->getType()->getSize(), 0.8f, color, 0.05f);
 				}
+				effectBatch.flush();
 				glPopAttrib();
 			}
 		}
@@ -5065,12 +5160,11 @@ namespace Glest {
 							thickness = specialInfo.thickness;
 						}
 
-						glColor4f(color.x, color.y, color.z, color.w);
-
 						Vec3f currVec = unit->getCurrVectorFlat();
-						renderSelectionCircle(currVec, unit->getType()->getSize(), radius, thickness);
+						renderSelectionCircle(currVec, unit->getType()->getSize(), radius, color, thickness);
 					}
 				}
+				effectBatch.flush();
 				glPopAttrib();
 			}
 		}
@@ -5097,6 +5191,7 @@ namespace Glest {
 							unit->getFaction()->getTexture()->getPixmapConst()->getPixel4f(0, 0), texture);
 					}
 				}
+				effectBatch.flush();
 				glDisable(GL_COLOR_MATERIAL);
 				glPopAttrib();
 			}
@@ -5175,7 +5270,9 @@ namespace Glest {
 
 			VisibleQuadContainerCache &qCache = getQuadCache();
 			if (qCache.visibleQuadUnitList.empty() == false) {
-				bool modelRenderStarted = false;
+				// Fading units are blended, they go last and farthest first
+				vector<float> unitAlpha(qCache.visibleQuadUnitList.size());
+				renderQueue.clear();
 				for (int visibleUnitIndex = 0;
 					visibleUnitIndex < (int) qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
 					Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
@@ -5183,6 +5280,38 @@ namespace Glest {
 					if ((airUnits == false && unit->getType()->getField() == fAir) || (airUnits == true && unit->getType()->getField() != fAir)) {
 						continue;
 					}
+
+					//dead alpha
+					const SkillType *st = unit->getCurrSkill();
+					float alpha = 1.0f;
+					if (st->getClass() == scDie) {
+						if (static_cast<const DieSkillType*>(st)->getFade())
+							alpha = 1.0f - unit->getAnimProgressAsFloat();
+						else
+							alpha = 1.0f - 0.625f * unit->getAnimProgressAsFloat();
+					}
+					unitAlpha[visibleUnitIndex] = alpha;
+
+					RenderQueueItem item;
+					item.model = unit->getCurrentModelPtr();
+					item.teamTexture = unit->getFaction()->getTexture();
+					item.blended = (alpha < 1.0f);
+					if (item.blended == true) {
+						item.depth = unit->getCurrVectorFlat().dist(gameCamera->getPos());
+					}
+					item.index = visibleUnitIndex;
+					renderQueue.add(item);
+				}
+				renderQueue.sort();
+				renderQueueItemCount += renderQueue.getItemCount();
+				renderQueueBatchCount += renderQueue.getBatchCount();
+				renderQueueStateChangeCount += renderQueue.getStateChangeCount();
+
+				bool modelRenderStarted = false;
+				for (int itemIndex = 0; itemIndex < renderQueue.getItemCount(); ++itemIndex) {
+					int visibleUnitIndex = renderQueue.getItem(itemIndex).index;
+					Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
+
 					meshCallback.setTeamTexture(unit->getFaction()->getTexture());
 
 					if (modelRenderStarted == false) {
@@ -5203,6 +5332,8 @@ namespace Glest {
 							}
 						}
 						glActiveTexture(baseTexUnit);
+						// we cut off a tiny bit here to avoid problems with fully transparent texture parts cutting units in background rendered later.
+						glAlphaFunc(GL_GREATER, 0.02f);
 
 						modelRenderer->begin(true, true, true, false, &meshCallback);
 					}
@@ -5225,21 +5356,12 @@ namespace Glest {
 					}
 					glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
 
-					//dead alpha
-					const SkillType *st = unit->getCurrSkill();
-					float alpha = 1.0f;
-					if (st->getClass() == scDie) {
-						if (static_cast<const DieSkillType*>(st)->getFade())
-							alpha = 1.0f - unit->getAnimProgressAsFloat();
-						else
-							alpha = 1.0f - 0.625f * unit->getAnimProgressAsFloat();
-					}
-					glEnable(GL_COLOR_MATERIAL);
-					// we cut off a tiny bit here to avoid problems with fully transparent texture parts cutting units in background rendered later.
-					glAlphaFunc(GL_GREATER, 0.02f);
+					float alpha = unitAlpha[visibleUnitIndex];
 
 					//render
-					Model *model = unit->getCurrentModelPtr();
+					// Picked once when queued, getCurrentModelPtr may cycle
+					// random animations on every call
+					Model *model = renderQueue.getItem(itemIndex).model;
 					//printf("Rendering model [%d - %s]\n[%s]\nCamera [%s]\nDistance: %f\n",unit->getId(),unit->getType()->getName().c_str(),unit->getCurrVector().getString().c_str(),this->gameCamera->getPos().getString().c_str(),this->gameCamera->getPos().dist(unit->getCurrVector()));
 
 					//if(this->gameCamera->getPos().dist(unit->getCurrVector()) <= SKIP_INTERPOLATION_DISTANCE) {
@@ -5330,21 +5452,17 @@ namespace Glest {
 			float halfSize = size;
 			//halfSize=halfSize;
 			float heigthoffset = 0.5 + heigth % 25 * 0.004;
-			glPushMatrix();
-			glBindTexture(GL_TEXTURE_2D, static_cast<const Texture2DGl*>(texture)->getHandle());
-			glColor4f(color.x, color.y, color.z, color.w);
-			glBegin(GL_TRIANGLE_STRIP);
-			glTexCoord2i(0, 1);
-			glVertex3f(v.x - halfSize, v.y + heigthoffset, v.z + halfSize);
-			glTexCoord2i(0, 0);
-			glVertex3f(v.x - halfSize, v.y + heigthoffset, v.z - halfSize);
-			glTexCoord2i(1, 1);
-
-			glVertex3f(v.x + halfSize, v.y + heigthoffset, v.z + halfSize);
-			glTexCoord2i(1, 0);
-			glVertex3f(v.x + halfSize, v.y + heigthoffset, v.z - halfSize);
-			glEnd();
-			glPopMatrix();
+			// The former triangle strip as a quad, drawn by the caller
+			effectBatch.begin(GL_QUADS, static_cast<const Texture2DGl*>(texture)->getHandle());
+			effectBatch.color(color);
+			effectBatch.texCoord(0, 1);
+			effectBatch.vertex(Vec3f(v.x - halfSize, v.y + heigthoffset, v.z + halfSize));
+			effectBatch.texCoord(0, 0);
+			effectBatch.vertex(Vec3f(v.x - halfSize, v.y + heigthoffset, v.z - halfSize));
+			effectBatch.texCoord(1, 0);
+			effectBatch.vertex(Vec3f(v.x + halfSize, v.y + heigthoffset, v.z - halfSize));
+			effectBatch.texCoord(1, 1);
+			effectBatch.vertex(Vec3f(v.x + halfSize, v.y + heigthoffset, v.z + halfSize));
 
 		}
 
@@ -5393,13 +5511,13 @@ namespace Glest {
 								}
 
 								float color = frameCycle * 0.4f / 40;
-								glColor4f(color, color, 0.4f, 0.4f);
-								renderSelectionCircle(currVec, mType->getSize(), frameCycle*0.85f / 40, 0.2f);
+								renderSelectionCircle(currVec, mType->getSize(), frameCycle*0.85f / 40, Vec4f(color, color, 0.4f, 0.4f), 0.2f);
 							}
 						}
 					}
 				}
 				if (initialized) {
+					effectBatch.flush();
 					glPopAttrib();
 				}
 			}
@@ -5457,21 +5575,22 @@ namespace Glest {
 						hpRatio = 1.0f;
 					}
 
+					Vec4f circleColor;
 					if (world->getThisFactionIndex() == unit->getFactionIndex()) {
 						if (showDebugUI == true &&
 							((showDebugUILevel & debugui_unit_titles) == debugui_unit_titles) &&
 							unit->getCommandSize() > 0 &&
 							dynamic_cast<const BuildCommandType *>(unit->getCurrCommand()->getCommandType()) != NULL) {
-							glColor4f(hpRatio, hpRatio, hpRatio, 0.3f);
+							circleColor = Vec4f(hpRatio, hpRatio, hpRatio, 0.3f);
 						} else {
-							glColor4f(0, hpRatio, 0, 0.3f);
+							circleColor = Vec4f(0, hpRatio, 0, 0.3f);
 						}
 					} else if (world->getThisTeamIndex() == unit->getTeam()) {
-						glColor4f(hpRatio, hpRatio, 0, 0.3f);
+						circleColor = Vec4f(hpRatio, hpRatio, 0, 0.3f);
 					} else {
-						glColor4f(hpRatio, 0, 0, 0.3f);
+						circleColor = Vec4f(hpRatio, 0, 0, 0.3f);
 					}
-					renderSelectionCircle(currVec, unit->getType()->getSize(), selectionCircleRadius, selectionCircleThickness);
+					renderSelectionCircle(currVec, unit->getType()->getSize(), selectionCircleRadius, circleColor, selectionCircleThickness);
 
 					if (showDebugUI == true &&
 						(showDebugUILevel & debugui_unit_titles) == debugui_unit_titles) {
@@ -5489,15 +5608,15 @@ namespace Glest {
 								}
 								Vec3f currVec2 = unit->getVectorFlat(lastPosValue, curPosValue);
 								currVec2.y += 0.3f;
-								renderSelectionCircle(currVec2, 1, selectionCircleRadius);
+								renderSelectionCircle(currVec2, 1, selectionCircleRadius, circleColor);
 							}
 						}
 					}
 
 					//magic circle
 					if (!healthbarsVisible && world->getThisFactionIndex() == unit->getFactionIndex() && unit->getType()->getMaxEp() > 0) {
-						glColor4f(unit->getEpRatio() / 2.f, unit->getEpRatio(), unit->getEpRatio(), 0.5f);
-						renderSelectionCircle(currVec, unit->getType()->getSize(), magicCircleRadius);
+						renderSelectionCircle(currVec, unit->getType()->getSize(), magicCircleRadius,
+							Vec4f(unit->getEpRatio() / 2.f, unit->getEpRatio(), unit->getEpRatio(), 0.5f));
 					}
 
 					// Render Attack-boost circles
@@ -5506,8 +5625,7 @@ namespace Glest {
 						const UnitAttackBoostEffectOriginator &effect = unit->getAttackBoostOriginatorEffect();
 
 						if (effect.skillType->isAttackBoostEnabled() == true) {
-							glColor4f(MAGENTA.x, MAGENTA.y, MAGENTA.z, MAGENTA.w);
-							renderSelectionCircle(currVec, 1, effect.skillType->getAttackBoost()->radius, .25f / effect.skillType->getAttackBoost()->radius);
+							renderSelectionCircle(currVec, 1, effect.skillType->getAttackBoost()->radius, MAGENTA, .25f / effect.skillType->getAttackBoost()->radius);
 
 							for (unsigned int i = 0; i < effect.currentAttackBoostUnits.size(); ++i) {
 								// Remove attack boost upgrades from unit
@@ -5517,7 +5635,7 @@ namespace Glest {
 									Vec3f currVecBoost = affectedUnit->getCurrVectorFlat();
 									currVecBoost.y += 0.3f;
 
-									renderSelectionCircle(currVecBoost, affectedUnit->getType()->getSize(), 1.f);
+									renderSelectionCircle(currVecBoost, affectedUnit->getType()->getSize(), 1.f, MAGENTA);
 								}
 							}
 						}
@@ -5538,8 +5656,7 @@ namespace Glest {
 				Resource *r = selectedResourceObject->getResource();
 				int defaultValue = r->getType()->getDefResPerPatch();
 				float colorValue = static_cast<float>(r->getAmount()) / static_cast<float>(defaultValue);
-				glColor4f(0.1f, 0.1f, colorValue, 0.4f);
-				renderSelectionCircle(selectedResourceObject->getPos(), 2, selectionCircleRadius);
+				renderSelectionCircle(selectedResourceObject->getPos(), 2, selectionCircleRadius, Vec4f(0.1f, 0.1f, colorValue, 0.4f));
 			}
 			//target arrow
 			if (selection->getCount() == 1) {
@@ -5589,15 +5706,14 @@ namespace Glest {
 
 				if (unit->isHighlighted()) {
 					float highlight = unit->getHightlight();
+					Vec4f highlightColor(1.f, 0.f, 0.f, highlight);
 					if (game->getWorld()->getThisFactionIndex() == unit->getFactionIndex()) {
-						glColor4f(0.f, 1.f, 0.f, highlight);
-					} else {
-						glColor4f(1.f, 0.f, 0.f, highlight);
+						highlightColor = Vec4f(0.f, 1.f, 0.f, highlight);
 					}
 
 					Vec3f v = unit->getCurrVectorFlat();
 					v.y += 0.3f;
-					renderSelectionCircle(v, unit->getType()->getSize(), 0.5f + 0.4f*highlight);
+					renderSelectionCircle(v, unit->getType()->getSize(), 0.5f + 0.4f*highlight, highlightColor);
 				}
 			}
 			// old inefficient way to render highlights
@@ -5625,13 +5741,13 @@ namespace Glest {
 				const Object* object = game->getGui()->getHighlightedResourceObject();
 				if (object->isHighlighted()) {
 					float highlight = object->getHightlight();
-					glColor4f(0.1f, 0.1f, 1.0f, highlight);
 					Vec3f v = object->getPos();
 					v.y += 0.3f;
-					renderSelectionCircle(v, 2, 0.4f + 0.4f*highlight);
+					renderSelectionCircle(v, 2, 0.4f + 0.4f*highlight, Vec4f(0.1f, 0.1f, 1.0f, highlight));
 				}
 			}
 
+			effectBatch.flush();
 			glPopAttrib();
 		}
 
@@ -5660,6 +5776,12 @@ namespace Glest {
 
 			VisibleQuadContainerCache &qCache = getQuadCache();
 			if (qCache.visibleQuadUnitList.empty() == false) {
+				// The bars face the camera, the same for every unit
+				float modelview[16];
+				glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+				Vec3f rightVector = Vec3f(modelview[0], modelview[4], modelview[8]);
+				Vec3f upVector = Vec3f(modelview[1], modelview[5], modelview[9]);
+
 				for (int visibleUnitIndex = 0;
 					visibleUnitIndex < (int) qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
 					Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
@@ -5709,9 +5831,15 @@ namespace Glest {
 						} else {
 							currVec.y += healthbarheight;
 						}
-						renderHealthBar(currVec, unit, healthbarthickness, healthbarLineBorder, healthbarTexture, healthbarBackgroundTexture);
+						renderHealthBar(currVec, unit, healthbarthickness, healthbarLineBorder, rightVector, upVector, healthbarTexture, healthbarBackgroundTexture);
 					}
 				}
+
+				// Layered as each bar used to be drawn
+				healthBarBackgroundBatch.flush();
+				effectBatch.flush();
+				healthBarLineBatch.flush();
+				healthBarBorderBatch.flush();
 			}
 			glPopAttrib();
 		}
@@ -5942,6 +6070,16 @@ namespace Glest {
 			glActiveTexture(baseTexUnit);
 			glBindTexture(GL_TEXTURE_2D, static_cast<const Texture2DGl*>(minimap->getTexture())->getHandle());
 
+			// Cells whose resources ran out
+			int firstRow = 0;
+			int rowCount = 0;
+			if (minimap->takeTextureChangedRows(firstRow, rowCount) == true) {
+				glTexSubImage2D(
+					GL_TEXTURE_2D, 0, 0, firstRow,
+					pixmap->getW(), rowCount,
+					GL_RGBA, GL_UNSIGNED_BYTE, pixmap->getPixels() + firstRow * pixmap->getW() * pixmap->getComponents());
+			}
+
 			glColor4f(0.5f, 0.5f, 0.5f, 0.2f);
 
 			glBegin(GL_TRIANGLE_STRIP);
@@ -6905,6 +7043,8 @@ namespace Glest {
 			/// Frustum approach --> Currently not accurate enough
 			else if (selectionType == Config::frustumPicking) {
 				selectUsingFrustumSelection(units, obj, withObjectSelection, posDown, posUp);
+			} else if (selectionType == Config::rayPicking) {
+				selectUsingRayPicking(units, obj, withObjectSelection, posDown, posUp);
 			} else {
 				selectUsingSelectionBuffer(units, obj, withObjectSelection, posDown, posUp);
 			}
@@ -7111,7 +7251,9 @@ namespace Glest {
 			//render units to find which ones should be selected
 			//printf("In [%s::%s] Line: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-			vector<Unit *> rendererUnits = renderUnitsFast(false, true);
+			// A few pixels of slack for the sampling in getPickedList
+			Rect2i pickRect(x - 4, y - 4, x + w + 4, y + h + 4);
+			vector<Unit *> rendererUnits = renderUnitsFast(false, true, &pickRect);
 			//printf("In [%s::%s] Line: %d rendererUnits = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,rendererUnits.size());
 
 
@@ -7185,6 +7327,172 @@ namespace Glest {
 			glPopMatrix();
 		}
 
+		// Rotates a camera space vector into the world the way
+		// loadGameCameraMatrix rotates the world into the camera
+		static Vec3f cameraToWorld(const Vec3f &v, const GameCamera *gameCamera) {
+			float vAng = degToRad(gameCamera->getVAng());
+			float hAng = degToRad(-gameCamera->getHAng());
+			Vec3f pitched(v.x,
+				v.y * std::cos(vAng) - v.z * std::sin(vAng),
+				v.y * std::sin(vAng) + v.z * std::cos(vAng));
+			return Vec3f(pitched.x * std::cos(hAng) + pitched.z * std::sin(hAng),
+				pitched.y,
+				-pitched.x * std::sin(hAng) + pitched.z * std::cos(hAng));
+		}
+
+		// World space direction of the ray through a point in virtual
+		// screen coordinates, the same projection gluPerspective sets up
+		static Vec3f getPickRayDirection(float x, float y, const GameCamera *gameCamera,
+			float fov, const Metrics &metrics) {
+			float tanHalfFov = std::tan(degToRad(fov) / 2.f);
+			Vec3f dir((2.f * x / metrics.getVirtualW() - 1.f) * tanHalfFov * metrics.getAspectRatio(),
+				(2.f * y / metrics.getVirtualH() - 1.f) * tanHalfFov,
+				-1.f);
+			return cameraToWorld(dir, gameCamera);
+		}
+
+		// Plane through the eye and two ray directions, facing inside
+		static Vec4f getPickSidePlane(const Vec3f &eye, const Vec3f &dirA, const Vec3f &dirB, const Vec3f &inside) {
+			Vec3f normal = dirA.cross(dirB);
+			if (normal.dot(inside) < 0) {
+				normal = -normal;
+			}
+			return Vec4f(normal.x, normal.y, normal.z, -normal.dot(eye));
+		}
+
+		// World box of a model drawn at pos rotated about the y axis,
+		// without a model (headless) the type's cell size is used
+		static PickBox getPickBox(const Model *model, float size, float height,
+			const Vec3f &pos, float rotation, int id) {
+			Vec3f boundsMin(-size / 2.f, 0.f, -size / 2.f);
+			Vec3f boundsMax(size / 2.f, height, size / 2.f);
+			if (model != NULL && model->getMeshCount() > 0) {
+				model->getBounds(boundsMin, boundsMax);
+			}
+
+			float angle = degToRad(rotation);
+			float cosAngle = std::cos(angle);
+			float sinAngle = std::sin(angle);
+			PickBox box;
+			box.id = id;
+			for (int corner = 0; corner < 8; ++corner) {
+				Vec3f v((corner & 1) ? boundsMax.x : boundsMin.x,
+					(corner & 2) ? boundsMax.y : boundsMin.y,
+					(corner & 4) ? boundsMax.z : boundsMin.z);
+				Vec3f world(pos.x + v.x * cosAngle + v.z * sinAngle,
+					pos.y + v.y,
+					pos.z - v.x * sinAngle + v.z * cosAngle);
+				if (corner == 0) {
+					box.boxMin = world;
+					box.boxMax = world;
+				} else {
+					box.add(world);
+				}
+			}
+			return box;
+		}
+
+		// Picks against the bounds of the models instead of rendering
+		// them, no GL calls so it also works without a window
+		void Renderer::selectUsingRayPicking(Selection::UnitContainer &units,
+			const Object *&obj, const bool withObjectSelection,
+			const Vec2i &posDown, const Vec2i &posUp) {
+			assert(game != NULL);
+			const GameCamera *gameCamera = game->getGameCamera();
+			if (gameCamera == NULL) {
+				return;
+			}
+			const Metrics &metrics = Metrics::getInstance();
+			const bool headless = GlobalStaticFlags::getIsNonGraphicalModeEnabled();
+
+			Vec3f eye(gameCamera->getPos().x + gameCamera->getShakeOffset().x,
+				gameCamera->getPos().y,
+				gameCamera->getPos().z + gameCamera->getShakeOffset().y);
+
+			float x1 = (float) min(posDown.x, posUp.x);
+			float y1 = (float) min(posDown.y, posUp.y);
+			float x2 = (float) max(posDown.x, posUp.x);
+			float y2 = (float) max(posDown.y, posUp.y);
+			// A click picks what is under the cursor, like a 2x2
+			// rectangle does for color picking
+			bool click = (x2 - x1 < 2 && y2 - y1 < 2);
+
+			Vec3f rayDir = getPickRayDirection((x1 + x2) / 2.f, (y1 + y2) / 2.f, gameCamera, perspFov, metrics);
+			Vec4f planes[6];
+			if (click == false) {
+				Vec3f forward = cameraToWorld(Vec3f(0.f, 0.f, -1.f), gameCamera);
+				Vec3f bottomLeft = getPickRayDirection(x1, y1, gameCamera, perspFov, metrics);
+				Vec3f bottomRight = getPickRayDirection(x2, y1, gameCamera, perspFov, metrics);
+				Vec3f topRight = getPickRayDirection(x2, y2, gameCamera, perspFov, metrics);
+				Vec3f topLeft = getPickRayDirection(x1, y2, gameCamera, perspFov, metrics);
+				planes[0] = getPickSidePlane(eye, bottomLeft, topLeft, rayDir);
+				planes[1] = getPickSidePlane(eye, bottomRight, topRight, rayDir);
+				planes[2] = getPickSidePlane(eye, bottomLeft, bottomRight, rayDir);
+				planes[3] = getPickSidePlane(eye, topLeft, topRight, rayDir);
+				planes[4] = Vec4f(forward.x, forward.y, forward.z, -forward.dot(eye) - perspNearPlane);
+				planes[5] = Vec4f(-forward.x, -forward.y, -forward.z, forward.dot(eye) + perspFarPlane);
+			}
+
+			VisibleQuadContainerCache &qCache = getQuadCache();
+			vector<PickBox> boxes;
+			boxes.reserve(qCache.visibleQuadUnitList.size());
+			for (int visibleUnitIndex = 0;
+				visibleUnitIndex < (int) qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
+				Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
+				if (unit != NULL && unit->isAlive()) {
+					const UnitType *unitType = unit->getType();
+					boxes.push_back(getPickBox(headless ? NULL : unit->getCurrentModelPtr(),
+						(float) unitType->getSize(), (float) unitType->getHeight(),
+						unit->getCurrVectorFlat(), unit->getRotation(), visibleUnitIndex));
+				}
+			}
+
+			PickBvh bvh;
+			bvh.build(boxes);
+			if (click == true) {
+				int index = bvh.findNearest(eye, rayDir);
+				if (index >= 0) {
+					units.push_back(qCache.visibleQuadUnitList[index]);
+				}
+			} else {
+				vector<int> indexes;
+				bvh.findInside(planes, 6, indexes);
+				// Keep the order the units are listed in
+				std::sort(indexes.begin(), indexes.end());
+				units.reserve(indexes.size());
+				for (unsigned int i = 0; i < indexes.size(); ++i) {
+					units.push_back(qCache.visibleQuadUnitList[indexes[i]]);
+				}
+			}
+
+			if (withObjectSelection == true && units.empty() == true) {
+				boxes.clear();
+				for (int visibleIndex = 0;
+					visibleIndex < (int) qCache.visibleObjectList.size(); ++visibleIndex) {
+					Object *object = qCache.visibleObjectList[visibleIndex];
+					if (object != NULL && object->getResource() != NULL) {
+						boxes.push_back(getPickBox(headless ? NULL : object->getModelPtr(), 1.f, 1.f,
+							object->getConstPos(), object->getRotation(), visibleIndex));
+					}
+				}
+
+				bvh.build(boxes);
+				int index = -1;
+				if (click == true) {
+					index = bvh.findNearest(eye, rayDir);
+				} else {
+					vector<int> indexes;
+					bvh.findInside(planes, 6, indexes);
+					if (indexes.empty() == false) {
+						index = *std::min_element(indexes.begin(), indexes.end());
+					}
+				}
+				if (index >= 0) {
+					obj = qCache.visibleObjectList[index];
+				}
+			}
+		}
+
 		// ==================== shadows ====================
 
 		void Renderer::renderShadowsToTexture(const int renderFps) {
@@ -7480,6 +7788,11 @@ namespace Glest {
 
 			//cache most used config params
 			maxLights = config.getInt("MaxLights");
+			asyncTextureUploadMillis = config.getInt("AsyncTextureUploadMillisPerFrame", "4");
+			assetPrefetchMillis = config.getInt("AssetPrefetchMillisPerFrame", "4");
+			InterpolationData::setCacheSteps(config.getInt("AnimationInterpolationSteps", "64"));
+			InterpolationData::setCacheSize(config.getInt("AnimationInterpolationCacheSize", "8"));
+			InterpolationData::setFrameSlots(config.getInt("AnimationInterpolationFrameSlots", "64"));
 			photoMode = config.getBool("PhotoMode");
 			focusArrows = config.getBool("FocusArrows");
 			textures3D = config.getBool("Textures3D");
@@ -7614,8 +7927,50 @@ namespace Glest {
 
 		// ==================== fast render ====================
 
+		// Projects a unit's bounds to the screen, true when they can not
+		// reach into the given screen rectangle. Models stick out of the
+		// cells they stand on so the bounds are kept generous.
+		static bool isUnitOutsideScreenRect(const Unit *unit, const Rect2i &screenRect,
+			const GLdouble *modelviewMatrix, const GLdouble *projectionMatrix, const GLint *viewport) {
+			const UnitType *unitType = unit->getType();
+			float radius = unitType->getSize() * 0.75f + 1.f;
+			Vec3f pos = unit->getCurrVectorFlat();
+
+			GLdouble minX = 0;
+			GLdouble minY = 0;
+			GLdouble maxX = 0;
+			GLdouble maxY = 0;
+			for (int corner = 0; corner < 8; ++corner) {
+				GLdouble cornerX = pos.x + ((corner & 1) ? radius : -radius);
+				GLdouble cornerY = pos.y + ((corner & 2) ? unitType->getHeight() + 1.f : -1.f);
+				GLdouble cornerZ = pos.z + ((corner & 4) ? radius : -radius);
+				GLdouble screenX;
+				GLdouble screenY;
+				GLdouble screenZ;
+				if (gluProject(cornerX, cornerY, cornerZ, modelviewMatrix, projectionMatrix, viewport,
+					&screenX, &screenY, &screenZ) == GL_FALSE || screenZ < 0 || screenZ > 1) {
+					// Behind the camera, can not tell
+					return false;
+				}
+				if (corner == 0 || screenX < minX) {
+					minX = screenX;
+				}
+				if (corner == 0 || screenY < minY) {
+					minY = screenY;
+				}
+				if (corner == 0 || screenX > maxX) {
+					maxX = screenX;
+				}
+				if (corner == 0 || screenY > maxY) {
+					maxY = screenY;
+				}
+			}
+			return (maxX < screenRect.p[0].x || minX > screenRect.p[1].x ||
+				maxY < screenRect.p[0].y || minY > screenRect.p[1].y);
+		}
+
 		//render units for selection purposes
-		vector<Unit *> Renderer::renderUnitsFast(bool renderingShadows, bool colorPickingSelection) {
+		vector<Unit *> Renderer::renderUnitsFast(bool renderingShadows, bool colorPickingSelection, const Rect2i *pickRect) {
 			vector<Unit *> unitsList;
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 				return unitsList;
@@ -7631,6 +7986,16 @@ namespace Glest {
 					unitsList.reserve(qCache.visibleQuadUnitList.size());
 				}
 
+				// Only units that can cover the pick rectangle are drawn
+				GLdouble modelviewMatrix[16];
+				GLdouble projectionMatrix[16];
+				GLint viewport[4];
+				if (pickRect != NULL) {
+					glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
+					glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+					glGetIntegerv(GL_VIEWPORT, viewport);
+				}
+
 				bool modelRenderStarted = false;
 				bool renderOnlyBuildings = true;
 				for (int k = 0; k < 2; k++) {
@@ -7662,6 +8027,11 @@ namespace Glest {
 							continue;
 						}
 
+						if (pickRect != NULL && isUnitOutsideScreenRect(unit, *pickRect,
+							modelviewMatrix, projectionMatrix, viewport) == true) {
+							continue;
+						}
+
 						if (modelRenderStarted == false) {
 							modelRenderStarted = true;
 
@@ -8337,7 +8707,10 @@ namespace Glest {
 		}
 
 		// ==================== private aux drawing ====================
-		void Renderer::renderHealthBar(Vec3f v, Unit *unit, float height, bool lineBorder, const Texture2D *texture, const Texture2D *backgroundTexture) {
+		// Adds the bars of one unit to the health bar batches, the caller
+		// flushes them. rightVector and upVector face the camera.
+		void Renderer::renderHealthBar(Vec3f v, Unit *unit, float height, bool lineBorder, const Vec3f &rightVector, const Vec3f &upVector,
+			const Texture2D *texture, const Texture2D *backgroundTexture) {
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 				return;
 			}
@@ -8357,24 +8730,14 @@ namespace Glest {
 			int size = unit->getType()->getSize();
 
 
-			Vec3f rightVector;
-			Vec3f upVector;
 			Vec3f rightVectorTexture;
 			Vec3f upVectorTexture;
 			v.y += 1;
-			float modelview[16];
 			float width = (float) size / 6 + 0.25f;
 			float red;
 			float green;
 			float brightness = 0.8f;
 
-			glMatrixMode(GL_MODELVIEW);
-			glPushMatrix();
-
-			// get the current modelview state
-			glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
-			rightVector = Vec3f(modelview[0], modelview[4], modelview[8]);
-			upVector = Vec3f(modelview[1], modelview[5], modelview[9]);
 			rightVectorTexture = rightVector * 2;
 			upVectorTexture = upVector * 4;
 
@@ -8394,45 +8757,40 @@ namespace Glest {
 
 			if (backgroundTexture != NULL) {
 				//backgroundTexture
-				glEnable(GL_TEXTURE_2D);
-				glBindTexture(GL_TEXTURE_2D, static_cast<const Texture2DGl*>(backgroundTexture)->getHandle());
-				glColor4f(1.f, 1.f, 1.f, 1.f);
+				healthBarBackgroundBatch.begin(GL_QUADS, static_cast<const Texture2DGl*>(backgroundTexture)->getHandle());
+				healthBarBackgroundBatch.color(1.f, 1.f, 1.f, 1.f);
 				//glColor4f(red+0.1f,green+0.1f,0.1f,0.5f);
-				glBegin(GL_QUADS);
-				glTexCoord2i(0, 1);
-				glVertex3fv((v - (rightVectorTexture*width - upVectorTexture * height*yOffset)).ptr());
-				glTexCoord2i(0, 0);
-				glVertex3fv((v - (rightVectorTexture*width + upVectorTexture * height*yOffset)).ptr());
-				glTexCoord2i(1, 0);
-				glVertex3fv((v + (rightVectorTexture*width - upVectorTexture * height*yOffset)).ptr());
-				glTexCoord2i(1, 1);
-				glVertex3fv((v + (rightVectorTexture*width + upVectorTexture * height*yOffset)).ptr());
-				glEnd();
-				glDisable(GL_TEXTURE_2D);
+				healthBarBackgroundBatch.texCoord(0, 1);
+				healthBarBackgroundBatch.vertex(v - (rightVectorTexture*width - upVectorTexture * height*yOffset));
+				healthBarBackgroundBatch.texCoord(0, 0);
+				healthBarBackgroundBatch.vertex(v - (rightVectorTexture*width + upVectorTexture * height*yOffset));
+				healthBarBackgroundBatch.texCoord(1, 0);
+				healthBarBackgroundBatch.vertex(v + (rightVectorTexture*width - upVectorTexture * height*yOffset));
+				healthBarBackgroundBatch.texCoord(1, 1);
+				healthBarBackgroundBatch.vertex(v + (rightVectorTexture*width + upVectorTexture * height*yOffset));
 			}
 
 			//healthbar
-			glColor4f(red*brightness, green*brightness, 0.0f, 0.4f);
 			//hpbar
 			barCount++;
-			internalRenderHp(numberOfBars, barCount, hp, v, width, height, rightVector, upVector);
+			internalRenderHp(numberOfBars, barCount, hp, v, width, height, rightVector, upVector,
+				Vec4f(red*brightness, green*brightness, 0.0f, 0.4f));
 
 
 			if (ep > -1.0f) {
 				//epbar
 				barCount++;
 				//glColor4f(brightness,0,brightness,0.5f);
-				glColor4f(.15f*brightness, 0.3f*brightness, 0.8f*brightness, 0.7f);
-				internalRenderHp(numberOfBars, barCount, ep, v, width, height, rightVector, upVector);
+				internalRenderHp(numberOfBars, barCount, ep, v, width, height, rightVector, upVector,
+					Vec4f(.15f*brightness, 0.3f*brightness, 0.8f*brightness, 0.7f));
 			}
 			if (productionPercent != -1) {
 				barCount++;
-				glColor4f(brightness, 0, brightness, 0.6f);
 				//glColor4f(0.0f*brightness,0.4f*brightness,0.2f*brightness,0.8f);
-				internalRenderHp(numberOfBars, barCount, (float) productionPercent / 100, v, width, height, rightVector, upVector);
+				internalRenderHp(numberOfBars, barCount, (float) productionPercent / 100, v, width, height, rightVector, upVector,
+					Vec4f(brightness, 0, brightness, 0.6f));
 			}
 
-
 			//	glBegin(GL_QUADS);
 			//		if(ep < -2.0f) {
 			//			//hpbar
@@ -8457,40 +8815,39 @@ namespace Glest {
 			//	glEnd();
 
 			if (lineBorder) {
-				//border
-				glColor4f(red*brightness, green*brightness, 0.1f*brightness, 0.5f);
-				glBegin(GL_LINE_LOOP);
-				glVertex3fv((v - (rightVector*width - upVector * height*yOffset)).ptr());
-				glVertex3fv((v - (rightVector*width + upVector * height*yOffset)).ptr());
-				glVertex3fv((v + (rightVector*width - upVector * height*yOffset)).ptr());
-				glVertex3fv((v + (rightVector*width + upVector * height*yOffset)).ptr());
-				glEnd();
+				//border, the former line loop
+				Vec3f corners[4] = {
+					v - (rightVector*width - upVector * height*yOffset),
+					v - (rightVector*width + upVector * height*yOffset),
+					v + (rightVector*width - upVector * height*yOffset),
+					v + (rightVector*width + upVector * height*yOffset)
+				};
+				healthBarLineBatch.begin(GL_LINES);
+				healthBarLineBatch.color(red*brightness, green*brightness, 0.1f*brightness, 0.5f);
+				for (int i = 0; i < 4; ++i) {
+					healthBarLineBatch.vertex(corners[i]);
+					healthBarLineBatch.vertex(corners[(i + 1) % 4]);
+				}
 			}
 
 			if (texture != NULL) {
 				//BorderTexture
-				glEnable(GL_TEXTURE_2D);
-				glBindTexture(GL_TEXTURE_2D, static_cast<const Texture2DGl*>(texture)->getHandle());
-				glColor4f(1.f, 1.f, 1.f, 1.f);
+				healthBarBorderBatch.begin(GL_QUADS, static_cast<const Texture2DGl*>(texture)->getHandle());
+				healthBarBorderBatch.color(1.f, 1.f, 1.f, 1.f);
 				//glColor4f(red+0.1f,green+0.1f,0.1f,0.5f);
-				glBegin(GL_QUADS);
-				glTexCoord2i(0, 1);
-				glVertex3fv((v - (rightVectorTexture*width - upVectorTexture * height*yOffset)).ptr());
-				glTexCoord2i(0, 0);
-				glVertex3fv((v - (rightVectorTexture*width + upVectorTexture * height*yOffset)).ptr());
-				glTexCoord2i(1, 0);
-				glVertex3fv((v + (rightVectorTexture*width - upVectorTexture * height*yOffset)).ptr());
-				glTexCoord2i(1, 1);
-				glVertex3fv((v + (rightVectorTexture*width + upVectorTexture * height*yOffset)).ptr());
-				glEnd();
-				glDisable(GL_TEXTURE_2D);
+				healthBarBorderBatch.texCoord(0, 1);
+				healthBarBorderBatch.vertex(v - (rightVectorTexture*width - upVectorTexture * height*yOffset));
+				healthBarBorderBatch.texCoord(0, 0);
+				healthBarBorderBatch.vertex(v - (rightVectorTexture*width + upVectorTexture * height*yOffset));
+				healthBarBorderBatch.texCoord(1, 0);
+				healthBarBorderBatch.vertex(v + (rightVectorTexture*width - upVectorTexture * height*yOffset));
+				healthBarBorderBatch.texCoord(1, 1);
+				healthBarBorderBatch.vertex(v + (rightVectorTexture*width + upVectorTexture * height*yOffset));
 			}
-
-			glPopMatrix();
 		}
 
 		void Renderer::internalRenderHp(int numberOfBars, int barNumber, float hp,
-			Vec3f posVector, float width, float singleHPheight, Vec3f rightVector, Vec3f upVector) {
+			Vec3f posVector, float width, float singleHPheight, Vec3f rightVector, Vec3f upVector, const Vec4f &color) {
 
 			float yOffset = (float) numberOfBars*singleHPheight / 2;
 			float offsetTop = yOffset - singleHPheight * (barNumber - 1);
@@ -8498,32 +8855,46 @@ namespace Glest {
 			offsetBottom = offsetBottom * -1;
 			hp = hp * 2 - 1;
 
-			glBegin(GL_QUADS);
-			glVertex3fv((posVector - (rightVector*width - upVector * offsetTop)).ptr());
-			glVertex3fv((posVector - (rightVector*width + upVector * offsetBottom)).ptr());
-			glVertex3fv((posVector + (rightVector*hp*width - upVector * offsetBottom)).ptr());
-			glVertex3fv((posVector + (rightVector*hp*width + upVector * offsetTop)).ptr());
-			glEnd();
+			effectBatch.begin(GL_QUADS);
+			effectBatch.color(color);
+			effectBatch.vertex(posVector - (rightVector*width - upVector * offsetTop));
+			effectBatch.vertex(posVector - (rightVector*width + upVector * offsetBottom));
+			effectBatch.vertex(posVector + (rightVector*hp*width - upVector * offsetBottom));
+			effectBatch.vertex(posVector + (rightVector*hp*width + upVector * offsetTop));
 		}
 
-		void Renderer::renderSelectionCircle(Vec3f v, int size, float radius, float thickness) {
+		// The ring gluCylinder used to draw, rotated to lie on the ground.
+		// Added to effectBatch, the caller flushes it.
+		void Renderer::renderSelectionCircle(Vec3f v, int size, float radius, const Vec4f &color, float thickness) {
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 				return;
 			}
 
-			GLUquadricObj *disc;
-
-			glMatrixMode(GL_MODELVIEW);
-			glPushMatrix();
-
-			glTranslatef(v.x, v.y, v.z);
-			glRotatef(90.f, 1.f, 0.f, 0.f);
-			disc = gluNewQuadric();
-			gluQuadricDrawStyle(disc, GLU_FILL);
-			gluCylinder(disc, radius*(size - thickness), radius*size, thickness, 30, 1);
-			gluDeleteQuadric(disc);
+			const int slices = 30;
+			static float sinCache[slices + 1];
+			static float cosCache[slices + 1];
+			static bool cacheReady = false;
+			if (cacheReady == false) {
+				for (int i = 0; i < slices; ++i) {
+					float angle = 2.0f * pi * i / slices;
+					sinCache[i] = std::sin(angle);
+					cosCache[i] = std::cos(angle);
+				}
+				sinCache[slices] = sinCache[0];
+				cosCache[slices] = cosCache[0];
+				cacheReady = true;
+			}
 
-			glPopMatrix();
+			float innerRadius = radius * (size - thickness);
+			float outerRadius = radius * size;
+			effectBatch.begin(GL_QUADS);
+			effectBatch.color(color);
+			for (int i = 0; i < slices; ++i) {
+				effectBatch.vertex(Vec3f(v.x + innerRadius * sinCache[i], v.y, v.z + innerRadius * cosCache[i]));
+				effectBatch.vertex(Vec3f(v.x + outerRadius * sinCache[i], v.y - thickness, v.z + outerRadius * cosCache[i]));
+				effectBatch.vertex(Vec3f(v.x + outerRadius * sinCache[i + 1], v.y - thickness, v.z + outerRadius * cosCache[i + 1]));
+				effectBatch.vertex(Vec3f(v.x + innerRadius * sinCache[i + 1], v.y, v.z + innerRadius * cosCache[i + 1]));
+			}
 			//	glBegin (GL_QUAD_STRIP);
 			//	for (float k = 0; k <= 180; k=k+1) {
 			//		float j=degToRad(k);
@@ -8564,8 +8935,11 @@ namespace Glest {
 			Vec3f pos1Left = pos1 + normal * (width + 0.05f);
 			Vec3f pos1Right = pos1 - normal * (width + 0.05f);
 
-			//arrow body
-			glBegin(GL_TRIANGLE_STRIP);
+			//arrow body, the triangles of the former strip
+			effectBatch.begin(GL_TRIANGLES);
+			Vec3f lastA;
+			Vec3f lastB;
+			Vec4f lastColor;
 			for (int i = 0; i <= tesselation; ++i) {
 				float t = static_cast<float>(i) / tesselation;
 				Vec3f a = pos1Left.lerp(t, pos2Left);
@@ -8573,20 +8947,27 @@ namespace Glest {
 				Vec4f c = color;
 				c.w *= t * 0.25f * alphaFactor;
 
-				glColor4fv(c.ptr());
-
-				glVertex3fv(a.ptr());
-				glVertex3fv(b.ptr());
-
+				if (i > 0) {
+					effectBatch.color(lastColor);
+					effectBatch.vertex(lastA);
+					effectBatch.vertex(lastB);
+					effectBatch.color(c);
+					effectBatch.vertex(a);
+					effectBatch.color(lastColor);
+					effectBatch.vertex(lastB);
+					effectBatch.color(c);
+					effectBatch.vertex(a);
+					effectBatch.vertex(b);
+				}
+				lastA = a;
+				lastB = b;
+				lastColor = c;
 			}
 
-			glEnd();
 			//arrow end
-			glBegin(GL_TRIANGLES);
-			glVertex3fv((pos2Left + normal * (arrowEndSize - 0.1f)).ptr());
-			glVertex3fv((pos2Right - normal * (arrowEndSize - 0.1f)).ptr());
-			glVertex3fv((pos2 + dir * (arrowEndSize - 0.1f)).ptr());
-			glEnd();
+			effectBatch.vertex(pos2Left + normal * (arrowEndSize - 0.1f));
+			effectBatch.vertex(pos2Right - normal * (arrowEndSize - 0.1f));
+			effectBatch.vertex(pos2 + dir * (arrowEndSize - 0.1f));
 		}
 
 		void Renderer::renderProgressBar3D(int size, int x, int y, Font3D *font, int customWidth,
@@ -8960,6 +9341,11 @@ namespace Glest {
 			}
 		}
 
+		// Row by row, like PosQuadIterator
+		static bool isBeforeInQuadWalk(const Vec2i &a, const Vec2i &b) {
+			return (a.y < b.y || (a.y == b.y && a.x < b.x));
+		}
+
 		VisibleQuadContainerCache & Renderer::getQuadCache(bool updateOnDirtyFrame,
 			bool forceNew) {
 			//forceNew = true;
@@ -8986,8 +9372,18 @@ namespace Glest {
 						for (int j = 0; j < faction->getUnitCount(); ++j) {
 							Unit *unit = faction->getUnit(j);
 
+							// Units off the visible quad fail both checks below,
+							// spare them the frustum math
 							bool unitCheckedForRender = false;
-							if (VisibleQuadContainerCache::enableFrustumCalcs == true) {
+							if (visibleQuad.isInside(unit->getPos()) == false) {
+								unit->setVisible(false);
+								if (world->toRenderUnit(unit) == true) {
+									quadCache.visibleUnitList.push_back(unit);
+								}
+								unitCheckedForRender = true;
+							}
+							if (unitCheckedForRender == false &&
+								VisibleQuadContainerCache::enableFrustumCalcs == true) {
 								//bool insideQuad 	= PointInFrustum(quadCache.frustumData, unit->getCurrVector().x, unit->getCurrVector().y, unit->getCurrVector().z );
 								bool insideQuad = CubeInFrustum(quadCache.frustumData, unit->getCurrMidHeightVector().x, unit->getCurrMidHeightVector().y, unit->getCurrMidHeightVector().z, unit->getType()->getRenderSize());
 								bool renderInMap = world->toRenderUnit(unit);
@@ -9073,13 +9469,21 @@ namespace Glest {
 						}
 						quadCache.clearNonVolatileCacheData();
 
-						//int loops1=0;
+						// Only the cells holding an object in the buckets under the
+						// quad, taken in the order the quad iterator walks it
 						PosQuadIterator pqi(map, visibleQuad, Map::cellScale);
-						while (pqi.next()) {
-							const Vec2i &pos = pqi.getPos();
-							if (map->isInside(pos)) {
+						const Rect2i quadRect = visibleQuad.computeBoundingRect();
+						vector<Vec2i> objectCells;
+						map->getObjectBuckets().find(Rect2i(Map::toSurfCoords(quadRect.p[0]),
+							Map::toSurfCoords(quadRect.p[1])), objectCells);
+						std::sort(objectCells.begin(), objectCells.end(), isBeforeInQuadWalk);
+
+						//int loops1=0;
+						for (unsigned int objectIndex = 0; objectIndex < objectCells.size(); ++objectIndex) {
+							const Vec2i &mapPos = objectCells[objectIndex];
+							const Vec2i pos(mapPos.x * Map::cellScale, mapPos.y * Map::cellScale);
+							if (pqi.covers(pos) && map->isInside(pos)) {
 								//loops1++;
-								const Vec2i &mapPos = Map::toSurfCoords(pos);
 
 								//quadCache.visibleCellList.push_back(mapPos);
 
@@ -9670,7 +10074,44 @@ namespace Glest {
 			return result;
 		}
 
-		Texture2D * Renderer::preloadTexture(string logoFilename) {
+		void Renderer::loadTextureAsync(ResourceScope rs, Texture2D *texture, const string &path) {
+			AsyncTextureLoader::load(texture, path, textureManager[rs]->getTextureFilter(), textureManager[rs]->getMaxAnisotropy());
+		}
+
+		void Renderer::queueAssetPrefetch(const UnitType *unitType) {
+			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+				return;
+			}
+			MutexSafeWrapper safeMutex(assetPrefetchAccessor, string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+			assetPrefetchQueue.push_back(unitType);
+		}
+
+		// Loads queued unit types until maxMillis have passed, returns how
+		// many were loaded. Their textures then go to AsyncTextureLoader.
+		int Renderer::processAssetPrefetches(int maxMillis) {
+			int loadCount = 0;
+			Chrono chrono(true);
+			for (;;) {
+				MutexSafeWrapper safeMutex(assetPrefetchAccessor, string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__));
+				if (assetPrefetchQueue.empty() == true) {
+					break;
+				}
+				const UnitType *unitType = assetPrefetchQueue.front();
+				assetPrefetchQueue.pop_front();
+				safeMutex.ReleaseLock();
+
+				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] prefetching assets of [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, unitType->getName(false).c_str());
+				unitType->loadAssets();
+				loadCount++;
+
+				if (chrono.getMillis() >= maxMillis) {
+					break;
+				}
+			}
+			return loadCount;
+		}
+
+		Texture2D * Renderer::preloadTexture(string logoFilename, bool loadAsync) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] logoFilename [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, logoFilename.c_str());
 
 			Texture2D *result = NULL;
@@ -9691,7 +10132,11 @@ namespace Glest {
 					result = renderer.newTexture2D(rsGlobal);
 					if (result) {
 						result->setMipmap(true);
-						result->load(logoFilename);
+						if (loadAsync == true) {
+							renderer.loadTextureAsync(rsGlobal, result, logoFilename);
+						} else {
+							result->load(logoFilename);
+						}
 						//renderer.initTexture(rsGlobal,result);
 					}
 
@@ -9704,10 +10149,10 @@ namespace Glest {
 			return result;
 		}
 
-		Texture2D * Renderer::findTexture(string logoFilename) {
+		Texture2D * Renderer::findTexture(string logoFilename, bool loadAsync) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] logoFilename [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, logoFilename.c_str());
 
-			Texture2D *result = preloadTexture(logoFilename);
+			Texture2D *result = preloadTexture(logoFilename, loadAsync);
 			if (result != NULL && result->getInited() == false) {
 				Renderer &renderer = Renderer::getInstance();
 				renderer.initTexture(rsGlobal, result);
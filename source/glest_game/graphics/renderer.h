@@ -39,6 +39,8 @@
 #include "base_renderer.h"
 #include "simple_threads.h"
 #include "video_player.h"
+#include "render_queue.h"
+#include "geometry_batch_gl.h"
 
 #ifdef DEBUG_RENDERING_ENABLED
 #	define IF_DEBUG_EDITION(x) x
@@ -247,6 +249,7 @@ namespace Glest {
 			bool textures3D;
 			Shadows shadows;
 			int maxConsoleLines;
+			int asyncTextureUploadMillis;
 
 			//game
 			const Game *game;
@@ -257,6 +260,17 @@ namespace Glest {
 			//misc
 			int triangleCount;
 			int pointCount;
+			// Units and objects are drawn in state order, counted per frame
+			RenderQueue renderQueue;
+			int renderQueueItemCount;
+			int renderQueueBatchCount;
+			int renderQueueStateChangeCount;
+			// Selection circles, arrows and health bars of a pass, drawn
+			// together when the pass ends
+			Gl::GeometryBatchGl effectBatch;
+			Gl::GeometryBatchGl healthBarBackgroundBatch;
+			Gl::GeometryBatchGl healthBarLineBatch;
+			Gl::GeometryBatchGl healthBarBorderBatch;
 			Quad2i visibleQuad;
 			Quad2i visibleQuadFromCamera;
 			Vec4f nearestLightPos;
@@ -315,8 +329,28 @@ namespace Glest {
 			Mutex *saveScreenShotThreadAccessor;
 			std::list<std::pair<string, Pixmap2D *> > saveScreenQueue;
 
+			// Unit types whose lazily loaded assets are loaded between frames
+			Mutex *assetPrefetchAccessor;
+			std::list<const UnitType *> assetPrefetchQueue;
+			int assetPrefetchMillis;
+
 			std::map<Vec3f, Vec3f> worldToScreenPosCache;
 
+			// Resource counter text, formatted again only when one of
+			// its values changes
+			class ResourceStatusText {
+			public:
+				int amount;
+				int storeAmount;
+				int balance;
+				string text;
+			};
+			typedef std::pair<std::pair<const Faction *, const ResourceType *>, bool> ResourceStatusKey;
+			std::map<ResourceStatusKey, ResourceStatusText> resourceStatusTexts;
+
+			// Fog of war texture all rows were last uploaded to
+			GLuint fowTexUploadedHandle;
+
 			//bool masterserverMode;
 
 			std::map<uint32, VisibleQuadContainerVBOCache > mapSurfaceVBOCache;
@@ -573,6 +607,7 @@ namespace Glest {
 			void selectUsingColorPicking(Selection::UnitContainer &units, const Object *&obj, const bool withObjectSelection, const Vec2i &posDown, const Vec2i &posUp);
 			void selectUsingSelectionBuffer(Selection::UnitContainer &units, const Object *&obj, const bool withObjectSelection, const Vec2i &posDown, const Vec2i &posUp);
 			void selectUsingFrustumSelection(Selection::UnitContainer &units, const Object *&obj, const bool withObjectSelection, const Vec2i &posDown, const Vec2i &posUp);
+			void selectUsingRayPicking(Selection::UnitContainer &units, const Object *&obj, const bool withObjectSelection, const Vec2i &posDown, const Vec2i &posUp);
 
 
 			//gl wrap
@@ -668,8 +703,14 @@ namespace Glest {
 
 			void renderProgressBar(int size, int x, int y, Font2D *font, int customWidth = -1, string prefixLabel = "", bool centeredText = true);
 
-			static Texture2D * findTexture(string logoFilename);
-			static Texture2D * preloadTexture(string logoFilename);
+			// loadAsync decodes the image in the background, the texture shows a
+			// placeholder until then so only use it when the size is not needed
+			static Texture2D * findTexture(string logoFilename, bool loadAsync = false);
+			static Texture2D * preloadTexture(string logoFilename, bool loadAsync = false);
+			void loadTextureAsync(ResourceScope rs, Texture2D *texture, const string &path);
+			// Any thread may queue, the main thread loads them after swapBuffers
+			void queueAssetPrefetch(const UnitType *unitType);
+			int processAssetPrefetches(int maxMillis);
 			inline int getCachedSurfaceDataSize() const {
 				return (int) mapSurfaceData.size();
 			}
@@ -706,7 +747,7 @@ namespace Glest {
 
 			//selection render
 			vector<Object *> renderObjectsFast(bool renderingShadows = false, bool resourceOnly = false, bool colorPickingSelection = false);
-			vector<Unit *> renderUnitsFast(bool renderingShadows = false, bool colorPickingSelection = false);
+			vector<Unit *> renderUnitsFast(bool renderingShadows = false, bool colorPickingSelection = false, const Rect2i *pickRect = NULL);
 
 			//gl requirements
 			void checkGlCaps();
@@ -721,10 +762,11 @@ namespace Glest {
 			void enableProjectiveTexturing();
 
 			//private aux drawing
-			void renderSelectionCircle(Vec3f v, int size, float radius, float thickness = 0.2f);
+			void renderSelectionCircle(Vec3f v, int size, float radius, const Vec4f &color, float thickness = 0.2f);
 			bool isHealthBarVisible(const Unit *unit, int healthbarMode);
-			void renderHealthBar(Vec3f v, Unit *unit, float height, bool lineBorder, const Texture2D *texture = NULL, const Texture2D *backgroundTexture = NULL);
-			void internalRenderHp(int numberOfBars, int barNumber, float hp, Vec3f posVector, float width, float singleHPheight, Vec3f rightVector, Vec3f upVector);
+			void renderHealthBar(Vec3f v, Unit *unit, float height, bool lineBorder, const Vec3f &rightVector, const Vec3f &upVector,
+				const Texture2D *texture = NULL, const Texture2D *backgroundTexture = NULL);
+			void internalRenderHp(int numberOfBars, int barNumber, float hp, Vec3f posVector, float width, float singleHPheight, Vec3f rightVector, Vec3f upVector, const Vec4f &color);
 			void renderTeamColorEffect(Vec3f &v, int heigth, int size, Vec4f color, const Texture2D *texture);
 			void renderArrow(const Vec3f &pos1, const Vec3f &pos2, const Vec4f &color, float width);
 			//void renderTile(const Vec2i &pos);
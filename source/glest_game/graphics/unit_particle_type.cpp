@@ -207,6 +207,7 @@ namespace Glest {
 		}
 
 		const void UnitParticleSystemType::setValues(UnitParticleSystem *ups) {
+			loadAssets();
 			// whilst we extend ParticleSystemType we don't use ParticleSystemType::setValues()
 			// add instances of all children; some settings will cascade to all children
 			for (Children::iterator i = children.begin(); i != children.end(); ++i) {
@@ -217,9 +218,9 @@ namespace Glest {
 				ups->addChild(child);
 			}
 			// set values
-			ups->setModel(model);
+			ups->setModel(getLoadedModel());
 			ups->setModelCycle(modelCycle);
-			ups->setTexture(texture);
+			ups->setTexture(getLoadedTexture());
 			ups->setPrimitive(UnitParticleSystem::strToPrimitive(primitive));
 			ups->setOffset(offset);
 			ups->setShape(shape);
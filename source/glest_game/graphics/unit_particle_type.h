@@ -100,7 +100,7 @@ namespace Glest {
 
 			const void setValues(UnitParticleSystem *uts);
 			bool hasTexture() const {
-				return(texture != NULL);
+				return(getLoadedTexture() != NULL);
 			}
 			virtual void saveGame(XmlNode *rootNode);
 			virtual void loadGame(const XmlNode *rootNode);
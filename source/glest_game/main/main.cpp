@@ -51,6 +51,7 @@
 #include "font_gl.h"
 #include "FileReader.h"
 #include "cache_manager.h"
+#include "data_archive.h"
 #include <iterator>
 #include "core_data.h"
 #include "font_text.h"
@@ -76,6 +77,11 @@
 
 #ifndef WIN32
 #   include <poll.h>
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <sys/types.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
 
 #   define stricmp strcasecmp
 #   define strnicmp strncasecmp
@@ -379,6 +385,8 @@ namespace
 				list3d = FileReader < Pixmap3D >::getFileReadersMap();
 			deleteMapValues(list3d.begin(), list3d.end());
 
+			VirtualFileSystem::unmountAll();
+
 #if defined(WANT_XERCES)
 
 			XmlIo::getInstance().cleanup();
@@ -4853,9 +4861,14 @@ namespace
 						compress_item = paramPartTokens[1];
 					bool
 						includeMainData = false;
-					if (paramPartTokens.size() >= 3
-						&& paramPartTokens[2] == "include_main") {
-						includeMainData = true;
+					bool
+						packedArchive = false;
+					for (unsigned int i = 2; i < paramPartTokens.size(); ++i) {
+						if (paramPartTokens[i] == "include_main") {
+							includeMainData = true;
+						} else if (paramPartTokens[i] == "packed") {
+							packedArchive = true;
+						}
 					}
 
 					Config & config = Config::getInstance();
@@ -4916,7 +4929,9 @@ namespace
 									}
 
 									string
-										downloadArchive = techtreePath + fileArchiveExtension;
+										downloadArchive = techtreePath +
+										(packedArchive ==
+											true ? DataArchive::fileExtension : fileArchiveExtension);
 
 									if (fileExists(downloadArchive) == true) {
 										bool
@@ -4926,21 +4941,32 @@ namespace
 												downloadArchive.c_str());
 										}
 									}
-									string
-										compressCmd =
-										getFullFileArchiveCompressCommand
-										(fileArchiveCompressCommand,
-											fileArchiveCompressCommandParameters,
-											downloadArchive, techtreePath);
-
-									printf("Running compression command: %s\n",
-										compressCmd.c_str());
-
-									if (executeShellCommand
-									(compressCmd,
-										fileArchiveCompressCommandSuccessResult) == false) {
-										printf("Error could not create new file: [%s]\n",
+									if (packedArchive == true) {
+										printf("Packing data archive: %s\n",
 											downloadArchive.c_str());
+
+										if (DataArchive::create(techtreePath, downloadArchive,
+											true) == false) {
+											printf("Error could not create new file: [%s]\n",
+												downloadArchive.c_str());
+										}
+									} else {
+										string
+											compressCmd =
+											getFullFileArchiveCompressCommand
+											(fileArchiveCompressCommand,
+												fileArchiveCompressCommandParameters,
+												downloadArchive, techtreePath);
+
+										printf("Running compression command: %s\n",
+											compressCmd.c_str());
+
+										if (executeShellCommand
+										(compressCmd,
+											fileArchiveCompressCommandSuccessResult) == false) {
+											printf("Error could not create new file: [%s]\n",
+												downloadArchive.c_str());
+										}
 									}
 
 									if (fileExists(downloadArchive) == true) {
@@ -4992,7 +5018,9 @@ namespace
 									}
 
 									string
-										downloadArchive = tilesetDataPath + fileArchiveExtension;
+										downloadArchive = tilesetDataPath +
+										(packedArchive ==
+											true ? DataArchive::fileExtension : fileArchiveExtension);
 
 									if (fileExists(downloadArchive) == true) {
 										bool
@@ -5002,21 +5030,32 @@ namespace
 												downloadArchive.c_str());
 										}
 									}
-									string
-										compressCmd =
-										getFullFileArchiveCompressCommand
-										(fileArchiveCompressCommand,
-											fileArchiveCompressCommandParameters,
-											downloadArchive, tilesetDataPath);
-
-									printf("Running compression command: %s\n",
-										compressCmd.c_str());
-
-									if (executeShellCommand
-									(compressCmd,
-										fileArchiveCompressCommandSuccessResult) == false) {
-										printf("Error could not create new file: [%s]\n",
+									if (packedArchive == true) {
+										printf("Packing data archive: %s\n",
 											downloadArchive.c_str());
+
+										if (DataArchive::create(tilesetDataPath, downloadArchive,
+											true) == false) {
+											printf("Error could not create new file: [%s]\n",
+												downloadArchive.c_str());
+										}
+									} else {
+										string
+											compressCmd =
+											getFullFileArchiveCompressCommand
+											(fileArchiveCompressCommand,
+												fileArchiveCompressCommandParameters,
+												downloadArchive, tilesetDataPath);
+
+										printf("Running compression command: %s\n",
+											compressCmd.c_str());
+
+										if (executeShellCommand
+										(compressCmd,
+											fileArchiveCompressCommandSuccessResult) == false) {
+											printf("Error could not create new file: [%s]\n",
+												downloadArchive.c_str());
+										}
 									}
 
 									if (fileExists(downloadArchive) == true) {
@@ -5695,6 +5734,209 @@ namespace
 			return return_value;
 		}
 
+#ifndef WIN32
+		static volatile sig_atomic_t
+			headlessMatchesQuitRequested = 0;
+
+		static void
+			handleHeadlessMatchesSignal(int signum) {
+			headlessMatchesQuitRequested = 1;
+		}
+
+		// signal() restarts interrupted calls, which would leave the
+		// launcher blocked in waitpid and never pass the signal on
+		static void
+			setHeadlessMatchesSignalHandler(int signum) {
+			struct sigaction action;
+			memset(&action, 0, sizeof(action));
+			action.sa_handler = handleHeadlessMatchesSignal;
+			sigemptyset(&action.sa_mask);
+			action.sa_flags = 0;
+			sigaction(signum, &action, NULL);
+		}
+
+		static pid_t
+			startHeadlessMatch(const string & executable,
+				const vector < string > &matchArgs) {
+			pid_t
+				pid = fork();
+			if (pid == 0) {
+				// Only one process may own the console, the servers read nothing from it
+				int
+					nullInput = open("/dev/null", O_RDONLY);
+				if (nullInput >= 0) {
+					dup2(nullInput, STDIN_FILENO);
+					close(nullInput);
+				}
+
+				vector < char *>childArgv;
+				for (unsigned int i = 0; i < matchArgs.size(); ++i) {
+					childArgv.push_back(const_cast <char *>(matchArgs[i].c_str()));
+				}
+				childArgv.push_back(NULL);
+
+				execv(executable.c_str(), &childArgv[0]);
+				_exit(127);
+			}
+			return pid;
+		}
+#endif
+
+		// Only a process launcher: the servers do not share tech tree,
+		// faction, unit or tileset data, each one loads its own copy
+		int
+			handleHeadlessMatchesCommand(int argc, char **argv) {
+#ifdef WIN32
+			printf("\n%s is not supported on this platform.\n\n",
+				GAME_ARGS[GAME_ARG_MASTERSERVER_MATCHES]);
+			return 1;
+#else
+			int
+				foundParamIndIndex = -1;
+			hasCommandArgument(argc, argv,
+				string(GAME_ARGS[GAME_ARG_MASTERSERVER_MATCHES]) +
+				string("="), &foundParamIndIndex);
+			if (foundParamIndIndex < 0) {
+				hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_MASTERSERVER_MATCHES]),
+					&foundParamIndIndex);
+			}
+			string
+				paramValue = argv[foundParamIndIndex];
+			vector < string > paramPartTokens;
+			Tokenize(paramValue, paramPartTokens, "=");
+			if (paramPartTokens.size() < 2 || IsNumeric(paramPartTokens[1].c_str(), false) == false) {
+				printf("\nInvalid match count specified on commandline [%s]\n\n",
+					argv[foundParamIndIndex]);
+				return 1;
+			}
+			const int
+				maxMatches = 64;
+			int
+				matchCount = strToInt(paramPartTokens[1]);
+			if (matchCount < 1 || matchCount > maxMatches) {
+				printf("\nMatch count must be between 1 and %d [%s]\n\n",
+					maxMatches, argv[foundParamIndIndex]);
+				return 1;
+			}
+
+			// Each server needs its game port plus 9 FTP ports, the status port
+			// sits just below the game port (same layout as start_zetaglest_gameserver)
+			const int
+				portsPerMatch = 11;
+			int
+				internalPort = GameConstants::serverPort;
+			int
+				externalPort = GameConstants::serverPort;
+			int
+				statusPort = GameConstants::serverPort - 1;
+			bool
+				hasHeadlessMode = false;
+			vector < string > sharedArgs;
+			sharedArgs.push_back(PlatformExceptionHandler::application_binary);
+			for (int idx = 1; idx < argc; ++idx) {
+				string
+					arg = argv[idx];
+				if (hasCommandArgument(1, &argv[idx],
+					GAME_ARGS[GAME_ARG_MASTERSERVER_MATCHES], NULL, 0) == true) {
+					continue;
+				} else if (hasCommandArgument(1, &argv[idx],
+					GAME_ARGS[GAME_ARG_USE_PORTS], NULL, 0) == true) {
+					vector < string > portTokens;
+					Tokenize(arg, portTokens, "=");
+					vector < string > ports;
+					if (portTokens.size() >= 2) {
+						Tokenize(portTokens[1], ports, ",");
+					}
+					if (ports.size() < 2) {
+						printf("\nInvalid ports specified on commandline [%s]\n\n",
+							arg.c_str());
+						return 1;
+					}
+					internalPort = strToInt(ports[0]);
+					externalPort = strToInt(ports[1]);
+					statusPort = (ports.size() >= 3 ? strToInt(ports[2]) : internalPort - 1);
+					continue;
+				} else if (hasCommandArgument(1, &argv[idx],
+					GAME_ARGS[GAME_ARG_MASTERSERVER_MODE], NULL, 0) == true) {
+					hasHeadlessMode = true;
+				}
+				sharedArgs.push_back(arg);
+			}
+			if (hasHeadlessMode == false) {
+				sharedArgs.push_back(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE]);
+			}
+
+			vector < vector < string > > matchArgs;
+			for (int i = 0; i < matchCount; ++i) {
+				int
+					offset = i * portsPerMatch;
+				vector < string > args = sharedArgs;
+				args.push_back(string(GAME_ARGS[GAME_ARG_USE_PORTS]) + "=" +
+					intToStr(internalPort + offset) + "," +
+					intToStr(externalPort + offset) + "," +
+					intToStr(statusPort + offset));
+				matchArgs.push_back(args);
+			}
+
+			setHeadlessMatchesSignalHandler(SIGINT);
+			setHeadlessMatchesSignalHandler(SIGTERM);
+			setHeadlessMatchesSignalHandler(SIGHUP);
+
+			vector < pid_t > matchPids(matchCount, -1);
+			for (int i = 0; i < matchCount; ++i) {
+				matchPids[i] = startHeadlessMatch(sharedArgs[0], matchArgs[i]);
+				printf("Started headless server #%d pid: %d ports: %d,%d,%d\n",
+					i, (int) matchPids[i], internalPort + i * portsPerMatch,
+					externalPort + i * portsPerMatch, statusPort + i * portsPerMatch);
+			}
+
+			while (headlessMatchesQuitRequested == 0) {
+				int
+					status = 0;
+				pid_t
+					pid = waitpid(-1, &status, 0);
+				if (pid < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					break;
+				}
+
+				for (int i = 0; i < matchCount; ++i) {
+					if (matchPids[i] != pid) {
+						continue;
+					}
+					printf("Headless server #%d pid: %d quit with status: %d\n",
+						i, (int) pid,
+						(WIFEXITED(status) ? WEXITSTATUS(status) : -1));
+					matchPids[i] = -1;
+
+					// Don't spin when a server dies right away (bad data path, port in use...)
+					sleep(WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 1000 : 5000);
+					if (headlessMatchesQuitRequested == 0) {
+						matchPids[i] = startHeadlessMatch(sharedArgs[0], matchArgs[i]);
+						printf("Restarted headless server #%d pid: %d\n", i,
+							(int) matchPids[i]);
+					}
+					break;
+				}
+			}
+
+			for (int i = 0; i < matchCount; ++i) {
+				if (matchPids[i] > 0) {
+					kill(matchPids[i], SIGTERM);
+				}
+			}
+			for (int i = 0; i < matchCount; ++i) {
+				if (matchPids[i] > 0) {
+					waitpid(matchPids[i], NULL, 0);
+				}
+			}
+			return 0;
+#endif
+		}
+
 		int
 			glestMain(int argc, char **argv) {
 #ifdef SL_LEAK_DUMP
@@ -5766,6 +6008,12 @@ namespace
 				return 2;
 			}
 
+			if (hasCommandArgument
+			(argc, argv,
+				string(GAME_ARGS[GAME_ARG_MASTERSERVER_MATCHES])) == true) {
+				return handleHeadlessMatchesCommand(argc, argv);
+			}
+
 			if (hasCommandArgument
 			(argc, argv,
 				string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true) {
@@ -77,9 +77,8 @@ namespace
 				waterTexture = renderer.newTexture2D(rsMenu);
 				if (waterTexture) {
 					waterTexture->getPixmap()->init(4);
-					waterTexture->
-						getPixmap()->
-						load(getGameCustomCoreDataPath
+					renderer.loadTextureAsync(rsMenu, waterTexture,
+						getGameCustomCoreDataPath
 						(data_path, "data/core/menu/textures/water.tga"));
 				}
 			}
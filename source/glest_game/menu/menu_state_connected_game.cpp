@@ -125,6 +125,9 @@ namespace Glest {
 			getMissingTechtreeFromFTPServer = "";
 			getMissingTechtreeFromFTPServerLastPrompted = 0;
 			getMissingTechtreeFromFTPServerInProgress = false;
+			getMismatchedTechtreeFromFTPServer = "";
+			getMismatchedTechtreeFromFTPServerLastPrompted = 0;
+			getMismatchedTechtreeFromFTPServerInProgress = false;
 
 			getInProgressSavedGameFromFTPServer = "";
 			getInProgressSavedGameFromFTPServerInProgress = false;
@@ -792,6 +795,8 @@ namespace Glest {
 					fileArchiveExtractCommandParameters,
 					fileArchiveExtractCommandSuccessResult,
 					tempFilePath);
+				ftpClientThread->setMaxConcurrentTransfers(config.getInt("FTPClientMaxConcurrentTransfers", "2"));
+				ftpClientThread->setMaxTransferRetries(config.getInt("FTPClientMaxTransferRetries", "3"));
 				ftpClientThread->start();
 			}
 			// Start http meta data thread
@@ -1891,6 +1896,28 @@ namespace Glest {
 									safeMutexFTPProgress.ReleaseLock();
 								}
 							}
+						} else if (ftpMissingDataType == ftpmsg_MismatchedTechtree) {
+							// Only the files that differ from the host, into the folder the techtree is loaded from
+							Config & config = Config::getInstance();
+							string techPath =
+								TechTree::findPath(getMismatchedTechtreeFromFTPServer,
+									config.getPathListForType(ptTechs, ""));
+							if (ftpClientThread != NULL && techPath != "") {
+								getMismatchedTechtreeFromFTPServerInProgress = true;
+
+								ftpClientThread->addTechtreeFilesToRequests
+								(getMismatchedTechtreeFromFTPServer, techPath,
+									clientInterface->getNetworkGameDataSynchCheckTechFilesToFetch(),
+									clientInterface->getNetworkGameDataSynchCheckTechFilesToRemove());
+								MutexSafeWrapper
+									safeMutexFTPProgress(ftpClientThread->getProgressMutex(),
+										string(__FILE__) + "_" +
+										intToStr(__LINE__));
+								fileFTPProgressList[getMismatchedTechtreeFromFTPServer] =
+									pair < int,
+									string >(0, "");
+								safeMutexFTPProgress.ReleaseLock();
+							}
 						}
 					}
 				}
@@ -1931,6 +1958,9 @@ namespace Glest {
 					getMissingMapFromFTPServerLastPrompted = 0;
 					getMissingTilesetFromFTPServerLastPrompted = 0;
 					getMissingTechtreeFromFTPServerLastPrompted = 0;
+					getMismatchedTechtreeFromFTPServerInProgress = false;
+					getMismatchedTechtreeFromFTPServer = "";
+					getMismatchedTechtreeFromFTPServerLastPrompted = 0;
 
 					ClientInterface *
 						clientInterface = networkManager.getClientInterface();
@@ -2036,6 +2066,8 @@ namespace Glest {
 						fileArchiveExtractCommandParameters,
 						fileArchiveExtractCommandSuccessResult,
 						tempFilePath);
+					ftpClientThread->setMaxConcurrentTransfers(config.getInt("FTPClientMaxConcurrentTransfers", "2"));
+					ftpClientThread->setMaxTransferRetries(config.getInt("FTPClientMaxTransferRetries", "3"));
 					ftpClientThread->start();
 
 					Lang & lang = Lang::getInstance();
@@ -4967,6 +4999,39 @@ namespace Glest {
 									}
 								}
 							}
+
+							// Offer to fetch just the differing files from the host
+							vector < string > filesToFetch =
+								clientInterface->getNetworkGameDataSynchCheckTechFilesToFetch();
+							string techName = clientInterface->getGameSettings()->getTech();
+							if (ftpClientThread != NULL && filesToFetch.empty() == false &&
+								getMismatchedTechtreeFromFTPServerInProgress == false &&
+								getMissingTechtreeFromFTPServerInProgress == false &&
+								ftpMessageBox.getEnabled() == false &&
+								(getMismatchedTechtreeFromFTPServer != techName ||
+									difftime(time(NULL),
+										getMismatchedTechtreeFromFTPServerLastPrompted) >
+									REPROMPT_DOWNLOAD_SECONDS)) {
+								getMismatchedTechtreeFromFTPServerLastPrompted = time(NULL);
+								getMismatchedTechtreeFromFTPServer = techName;
+								Lang & lang = Lang::getInstance();
+
+								char
+									szBuf[8096] = "";
+								if (lang.hasString("DownloadMismatchedTechtreeFilesQuestion") == true) {
+									snprintf(szBuf, 8096,
+										lang.getString("DownloadMismatchedTechtreeFilesQuestion").c_str(),
+										(int) filesToFetch.size(), techName.c_str());
+								} else {
+									snprintf(szBuf, 8096,
+										"Download the %d files of techtree %s that differ from the host?",
+										(int) filesToFetch.size(), techName.c_str());
+								}
+								ftpMessageBox.init(lang.getString("Yes"),
+									lang.getString("NoDownload"));
+								ftpMissingDataType = ftpmsg_MismatchedTechtree;
+								showFTPMessageBox(szBuf, lang.getString("Question"), false);
+							}
 						}
 
 						if (SystemFlags::getSystemSettingType
@@ -6174,7 +6239,7 @@ namespace Glest {
 							extractFileFromDirectoryPath
 							(__FILE__).c_str(), __FUNCTION__,
 							__LINE__, filepath.c_str());
-					factionTexture = Renderer::findTexture(filepath);
+					factionTexture = Renderer::findTexture(filepath, true);
 					if (SystemFlags::
 						getSystemSettingType(SystemFlags::debugSystem).enabled)
 						SystemFlags::OutputDebug(SystemFlags::debugSystem,
@@ -6836,6 +6901,7 @@ namespace Glest {
 				}
 			} else if (type == ftp_cct_Techtree) {
 				getMissingTechtreeFromFTPServerInProgress = false;
+				getMismatchedTechtreeFromFTPServerInProgress = false;
 				if (SystemFlags::VERBOSE_MODE_ENABLED)
 					printf("Got FTP Callback for [%s] result = %d [%s]\n",
 						itemName.c_str(), result.first, result.second.c_str());
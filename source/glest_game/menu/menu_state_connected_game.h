@@ -58,7 +58,8 @@ namespace Glest {
 			ftpmsg_MissingNone,
 			ftpmsg_MissingMap,
 			ftpmsg_MissingTileset,
-			ftpmsg_MissingTechtree
+			ftpmsg_MissingTechtree,
+			ftpmsg_MismatchedTechtree
 		};
 
 		// ===============================
@@ -211,6 +212,10 @@ namespace Glest {
 			bool getMissingTechtreeFromFTPServerInProgress;
 			time_t getMissingTechtreeFromFTPServerLastPrompted;
 
+			string getMismatchedTechtreeFromFTPServer;
+			bool getMismatchedTechtreeFromFTPServerInProgress;
+			time_t getMismatchedTechtreeFromFTPServerLastPrompted;
+
 			string getInProgressSavedGameFromFTPServer;
 			bool getInProgressSavedGameFromFTPServerInProgress;
 			bool readyToJoinInProgressGame;
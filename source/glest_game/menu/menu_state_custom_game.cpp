@@ -5650,7 +5650,7 @@ namespace Glest {
 							c_str(), __FUNCTION__, __LINE__,
 							filepath.c_str());
 
-					factionTexture = Renderer::findTexture(filepath);
+					factionTexture = Renderer::findTexture(filepath, true);
 
 					if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).
 						enabled)
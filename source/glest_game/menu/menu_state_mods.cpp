@@ -420,6 +420,8 @@ namespace Glest {
 				fileArchiveExtractCommandParameters,
 				fileArchiveExtractCommandSuccessResult,
 				tempFilePath);
+			ftpClientThread->setMaxConcurrentTransfers(config.getInt("FTPClientMaxConcurrentTransfers", "2"));
+			ftpClientThread->setMaxTransferRetries(config.getInt("FTPClientMaxTransferRetries", "3"));
 			ftpClientThread->start();
 
 
@@ -2833,7 +2835,7 @@ namespace Glest {
 
 							if (tempImage != "" && fileExists(tempImage) == true) {
 								cleanupPreviewTexture();
-								modPreviewImage = Renderer::findTexture(tempImage);
+								modPreviewImage = Renderer::findTexture(tempImage, true);
 							}
 						}
 						if (modPreviewImage != NULL) {
@@ -293,6 +293,7 @@ namespace
 				listBoxSelectionType.pushBackItem("SelectBuffer (nvidia)");
 				listBoxSelectionType.pushBackItem("ColorPicking (default)");
 				listBoxSelectionType.pushBackItem("FrustumPicking (bad)");
+				listBoxSelectionType.pushBackItem("RayPicking (cpu)");
 
 				const string
 					selectionType =
@@ -301,6 +302,8 @@ namespace
 					listBoxSelectionType.setSelectedItemIndex(1);
 				else if (selectionType == Config::frustumPicking)
 					listBoxSelectionType.setSelectedItemIndex(2);
+				else if (selectionType == Config::rayPicking)
+					listBoxSelectionType.setSelectedItemIndex(3);
 				else
 					listBoxSelectionType.setSelectedItemIndex(0);
 				currentLine -= lineOffset;
@@ -1031,6 +1034,8 @@ namespace
 				config.setString("SelectionType", Config::colorPicking);
 			} else if (selectionTypeindex == 2) {
 				config.setString("SelectionType", Config::frustumPicking);
+			} else if (selectionTypeindex == 3) {
+				config.setString("SelectionType", Config::rayPicking);
 			}
 
 			int
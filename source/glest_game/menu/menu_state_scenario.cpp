@@ -565,7 +565,7 @@ namespace Glest {
 
 					if (scenarioLogo != "") {
 						cleanupPreviewTexture();
-						scenarioLogoTexture = Renderer::findTexture(scenarioLogo);
+						scenarioLogoTexture = Renderer::findTexture(scenarioLogo, true);
 					} else {
 						cleanupPreviewTexture();
 						scenarioLogoTexture = NULL;
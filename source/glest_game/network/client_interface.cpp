@@ -196,6 +196,7 @@ namespace Glest {
 
 			networkCommandListThreadAccessor = new Mutex(CODE_AT_LINE);
 			networkCommandListThread = NULL;
+			networkLinkSimulator = NULL;
 			cachedPendingCommandsIndex = 0;
 			cachedLastPendingFrameCount = 0;
 			timeClientWaitedForLastMessage = 0;
@@ -392,6 +393,47 @@ namespace Glest {
 			return resumeInGameJoin;
 		}
 
+		int ClientInterface::startNetworkLinkSimulator(const Ip &ip, int port) {
+			stopNetworkLinkSimulator();
+
+			Config &config = Config::getInstance();
+			NetworkLinkConditions conditions;
+			conditions.latencyMilliseconds = config.getInt("SimulateNetworkLatencyMilliseconds", "0");
+			conditions.jitterMilliseconds = config.getInt("SimulateNetworkJitterMilliseconds", "0");
+			conditions.bandwidthBytesPerSecond = config.getInt("SimulateNetworkBandwidthBytesPerSecond", "0");
+			conditions.dropPercent = config.getInt("SimulateNetworkDropPercent", "0");
+			conditions.retransmitMilliseconds = config.getInt("SimulateNetworkRetransmitMilliseconds", intToStr(conditions.retransmitMilliseconds).c_str());
+			conditions.reorderPercent = config.getInt("SimulateNetworkReorderPercent", "0");
+			conditions.reorderMilliseconds = config.getInt("SimulateNetworkReorderMilliseconds", intToStr(conditions.reorderMilliseconds).c_str());
+			conditions.randomSeed = config.getInt("SimulateNetworkRandomSeed", intToStr(conditions.randomSeed).c_str());
+
+			if (conditions.hasImpairment() == false) {
+				return port;
+			}
+
+			try {
+				networkLinkSimulator = new NetworkLinkSimulator(conditions, ip.getString(), port);
+				networkLinkSimulator->start();
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", __FILE__, __FUNCTION__, __LINE__, ex.what());
+				delete networkLinkSimulator;
+				networkLinkSimulator = NULL;
+				return port;
+			}
+
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("Simulating network link [%s] via local port %d\n", conditions.toString().c_str(), networkLinkSimulator->getListenPort());
+			return networkLinkSimulator->getListenPort();
+		}
+
+		void ClientInterface::stopNetworkLinkSimulator() {
+			if (networkLinkSimulator != NULL) {
+				if (networkLinkSimulator->shutdownAndWait() == true) {
+					delete networkLinkSimulator;
+				}
+				networkLinkSimulator = NULL;
+			}
+		}
+
 		void ClientInterface::connect(const Ip &ip, int port) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] START\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__);
 
@@ -406,9 +448,16 @@ namespace Glest {
 
 			safeMutex.ReleaseLock();
 
+			// Route through a local relay when link impairment is configured
+			int connectPort = startNetworkLinkSimulator(ip, port);
+
 			clientSocket = new ClientSocket();
 			clientSocket->setBlock(false);
-			clientSocket->connect(ip, port);
+			if (connectPort != port) {
+				clientSocket->connect(Ip("127.0.0.1"), connectPort);
+			} else {
+				clientSocket->connect(ip, port);
+			}
 			connectedTime = time(NULL);
 			//clientSocket->setBlock(true);
 
@@ -712,6 +761,7 @@ namespace Glest {
 						networkGameDataSynchCheckOkTile = false;
 						networkGameDataSynchCheckOkTech = false;
 						this->setNetworkGameDataSynchCheckTechMismatchReport("");
+						this->setNetworkGameDataSynchCheckTechFileDiff(vector<string>(), vector<string>());
 						this->setReceivedDataSynchCheck(false);
 
 						uint32 tilesetCRC = 0;
@@ -754,9 +804,44 @@ namespace Glest {
 
 								if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 
-								string report = networkMessageSynchNetworkGameData.getTechCRCFileMismatchReport(vctFileList);
+								vector<string> rootFolders = NetworkMessageSynchNetworkGameData::getTechRootFolders(config.getPathListForType(ptTechs, scenarioDir), networkMessageSynchNetworkGameData.getTech());
+								string report = networkMessageSynchNetworkGameData.getTechCRCFileMismatchReport(vctFileList, rootFolders);
 								this->setNetworkGameDataSynchCheckTechMismatchReport(report);
 
+								// Only worth fetching file by file when the host sent its whole list
+								MerkleManifestDiff manifestDiff;
+								if (networkMessageSynchNetworkGameData.getTechCRCFileDiff(vctFileList, rootFolders, manifestDiff) == true) {
+									vector<string> filesToFetch = manifestDiff.changed;
+									filesToFetch.insert(filesToFetch.end(), manifestDiff.missingLocally.begin(), manifestDiff.missingLocally.end());
+
+									// The techtree can be spread over several data paths. Fetched
+									// files go to the first one holding it, so copies of them in the
+									// others are removed like the files the host doesn't have
+									vector<string> filesToRemove;
+									int fetchRoot = -1;
+									for (unsigned int rootIdx = 0; rootIdx < rootFolders.size(); ++rootIdx) {
+										if (fetchRoot < 0 && isdir(rootFolders[rootIdx].c_str()) == true) {
+											fetchRoot = rootIdx;
+										}
+										for (unsigned int fileIdx = 0; fileIdx < manifestDiff.missingRemotely.size(); ++fileIdx) {
+											string localFile = rootFolders[rootIdx] + manifestDiff.missingRemotely[fileIdx];
+											if (fileExists(localFile) == true) {
+												filesToRemove.push_back(localFile);
+											}
+										}
+										for (unsigned int fileIdx = 0; fetchRoot >= 0 && fetchRoot != (int) rootIdx && fileIdx < filesToFetch.size(); ++fileIdx) {
+											string localFile = rootFolders[rootIdx] + filesToFetch[fileIdx];
+											if (fileExists(localFile) == true) {
+												filesToRemove.push_back(localFile);
+											}
+										}
+									}
+									this->setNetworkGameDataSynchCheckTechFileDiff(filesToFetch, filesToRemove);
+								}
+
+								// The host compares against its own folders, send paths relative to the techtree
+								MerkleManifest::getRelativeFileList(vctFileList, rootFolders);
+
 							}
 							if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] techCRC info, local = %d, remote = %d, networkMessageSynchNetworkGameData.getTech() = [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, techCRC, networkMessageSynchNetworkGameData.getTechCRC(), networkMessageSynchNetworkGameData.getTech().c_str());
 
@@ -2056,6 +2141,8 @@ namespace Glest {
 
 			safeMutex.ReleaseLock();
 
+			stopNetworkLinkSimulator();
+
 			connectedTime = 0;
 			gotIntro = false;
 
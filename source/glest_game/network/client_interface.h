@@ -31,10 +31,13 @@
 #include <vector>
 #include "network_interface.h"
 #include "socket.h"
+#include "network_link_simulator.h"
 #include "leak_dumper.h"
 
 using Shared::Platform::Ip;
 using Shared::Platform::ClientSocket;
+using Shared::Platform::NetworkLinkConditions;
+using Shared::Platform::NetworkLinkSimulator;
 using std::vector;
 
 namespace Glest {
@@ -99,6 +102,7 @@ namespace Glest {
 			string serverPlatform;
 
 			ClientInterfaceThread *networkCommandListThread;
+			NetworkLinkSimulator *networkLinkSimulator;
 
 			Mutex *networkCommandListThreadAccessor;
 			std::map<int, Commands> cachedPendingCommands;	//commands ready to be given
@@ -241,6 +245,8 @@ namespace Glest {
 
 			void updateFrame(int *checkFrame);
 			void shutdownNetworkCommandListThread(MutexSafeWrapper &safeMutexWrapper);
+			int startNetworkLinkSimulator(const Ip &ip, int port);
+			void stopNetworkLinkSimulator();
 			bool getNetworkCommand(int frameCount, int currentCachedPendingCommandsIndex);
 
 			void close(bool lockMutex);
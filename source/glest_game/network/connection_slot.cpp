@@ -1147,7 +1147,8 @@ namespace Glest {
 															vctFileList = getFolderTreeContentsCheckSumListRecursively(config.getPathListForType(ptTechs, scenarioDir), "/" + serverInterface->getGameSettings()->getTech() + "/*", ".xml", &vctFileList);
 														}
 
-														string report = networkMessageSynchNetworkGameDataStatus.getTechCRCFileMismatchReport(serverInterface->getGameSettings()->getTech(), vctFileList);
+														string report = networkMessageSynchNetworkGameDataStatus.getTechCRCFileMismatchReport(serverInterface->getGameSettings()->getTech(), vctFileList,
+															NetworkMessageSynchNetworkGameData::getTechRootFolders(config.getPathListForType(ptTechs, scenarioDir), serverInterface->getGameSettings()->getTech()));
 														this->setNetworkGameDataSynchCheckTechMismatchReport(report);
 													}
 													if (networkGameDataSynchCheckOkMap == false) {
@@ -1160,7 +1161,8 @@ namespace Glest {
 													if (networkGameDataSynchCheckOkTech == false) {
 														vctFileList = getFolderTreeContentsCheckSumListRecursively(config.getPathListForType(ptTechs, scenarioDir), "/" + serverInterface->getGameSettings()->getTech() + "/*", ".xml", NULL);
 
-														string report = networkMessageSynchNetworkGameDataStatus.getTechCRCFileMismatchReport(serverInterface->getGameSettings()->getTech(), vctFileList);
+														string report = networkMessageSynchNetworkGameDataStatus.getTechCRCFileMismatchReport(serverInterface->getGameSettings()->getTech(), vctFileList,
+															NetworkMessageSynchNetworkGameData::getTechRootFolders(config.getPathListForType(ptTechs, scenarioDir), serverInterface->getGameSettings()->getTech()));
 														this->setNetworkGameDataSynchCheckTechMismatchReport(report);
 													}
 												}
@@ -212,6 +212,10 @@ namespace Glest {
 			bool networkGameDataSynchCheckOkTile;
 			bool networkGameDataSynchCheckOkTech;
 			string networkGameDataSynchCheckTechMismatchReport;
+			// Techtree files that differ from the other side, relative to the
+			// techtree folder
+			vector<string> networkGameDataSynchCheckTechFilesToFetch;
+			vector<string> networkGameDataSynchCheckTechFilesToRemove;
 			bool receivedDataSynchCheck;
 
 			NetworkMessagePing lastPingInfo;
@@ -357,6 +361,17 @@ namespace Glest {
 				networkGameDataSynchCheckTechMismatchReport = value;
 			}
 
+			vector<string> getNetworkGameDataSynchCheckTechFilesToFetch() const {
+				return networkGameDataSynchCheckTechFilesToFetch;
+			}
+			vector<string> getNetworkGameDataSynchCheckTechFilesToRemove() const {
+				return networkGameDataSynchCheckTechFilesToRemove;
+			}
+			void setNetworkGameDataSynchCheckTechFileDiff(const vector<string> &filesToFetch, const vector<string> &filesToRemove) {
+				networkGameDataSynchCheckTechFilesToFetch = filesToFetch;
+				networkGameDataSynchCheckTechFilesToRemove = filesToRemove;
+			}
+
 			bool getReceivedDataSynchCheck() const {
 				return receivedDataSynchCheck;
 			}
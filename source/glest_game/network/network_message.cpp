@@ -26,6 +26,7 @@
 #include "util.h"
 #include "game_settings.h"
 #include "checksum.h"
+#include "merkle_manifest.h"
 #include "platform_util.h"
 #include "config.h"
 #include "network_protocol.h"
@@ -2247,6 +2248,7 @@ namespace Glest {
 
 			vector<std::pair<string, uint32> > vctFileList;
 			vctFileList = getFolderTreeContentsCheckSumListRecursively(config.getPathListForType(ptTechs, scenarioDir), string("/") + gameSettings->getTech() + string("/*"), ".xml", &vctFileList);
+			MerkleManifest::getRelativeFileList(vctFileList, getTechRootFolders(config.getPathListForType(ptTechs, scenarioDir), gameSettings->getTech()));
 			data.header.techCRCFileCount = min((int) vctFileList.size(), (int) maxFileCRCCount);
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] vctFileList.size() = %d, maxFileCRCCount = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, vctFileList.size(), maxFileCRCCount);
@@ -2266,56 +2268,80 @@ namespace Glest {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] data.mapCRC = %d, [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, data.header.mapCRC, gameSettings->getMap().c_str());
 		}
 
-		string NetworkMessageSynchNetworkGameData::getTechCRCFileMismatchReport(vector<std::pair<string, uint32> > &vctFileList) {
-			string result = "Techtree: [" + data.header.tech.getString() + "] Filecount local: " + intToStr(vctFileList.size()) + " remote: " + intToStr(data.header.techCRCFileCount) + "\n";
+		// Local paths are full paths, the remote ones came over the network
+		// and are relative to the techtree folder already
+		static void getTechCRCFileListDiff(const vector<std::pair<string, uint32> > &vctFileList, const vector<string> &rootFolders,
+			const vector<std::pair<string, uint32> > &vctRemoteFileList, MerkleManifestDiff &result) {
+			MerkleManifest localManifest;
+			localManifest.build(vctFileList, rootFolders);
+			MerkleManifest remoteManifest;
+			remoteManifest.build(vctRemoteFileList, vector<string>());
+			localManifest.diff(remoteManifest, result);
+		}
+
+		static string getTechCRCFileListMismatchReport(const string &techtree, const vector<std::pair<string, uint32> > &vctFileList, const vector<string> &rootFolders,
+			const vector<std::pair<string, uint32> > &vctRemoteFileList) {
+			string result = "Techtree: [" + techtree + "] Filecount local: " + intToStr(vctFileList.size()) + " remote: " + intToStr(vctRemoteFileList.size()) + "\n";
 			if (vctFileList.size() <= 0) {
 				result = result + "Local player has no files.\n";
-			} else if (data.header.techCRCFileCount <= 0) {
+			} else if (vctRemoteFileList.size() <= 0) {
 				result = result + "Remote player has no files.\n";
 			} else {
-				for (int idx = 0; idx < (int) vctFileList.size(); ++idx) {
-					std::pair<string, uint32> &fileInfo = vctFileList[idx];
-					bool fileFound = false;
-					uint32 remoteCRC = 0;
-					for (int j = 0; j < (int) data.header.techCRCFileCount; ++j) {
-						string networkFile = data.detail.techCRCFileList[j].getString();
-						uint32 &networkFileCRC = data.detail.techCRCFileCRCList[j];
-						if (fileInfo.first == networkFile) {
-							fileFound = true;
-							remoteCRC = networkFileCRC;
-							break;
-						}
-					}
+				MerkleManifestDiff manifestDiff;
+				getTechCRCFileListDiff(vctFileList, rootFolders, vctRemoteFileList, manifestDiff);
 
-					if (fileFound == false) {
-						result = result + "local file [" + fileInfo.first + "] missing remotely.\n";
-					} else if (fileInfo.second != remoteCRC) {
-						result = result + "local file [" + fileInfo.first + "] CRC mismatch.\n";
-					}
+				for (unsigned int idx = 0; idx < manifestDiff.missingRemotely.size(); ++idx) {
+					result = result + "local file [" + manifestDiff.missingRemotely[idx] + "] missing remotely.\n";
 				}
+				for (unsigned int idx = 0; idx < manifestDiff.changed.size(); ++idx) {
+					result = result + "file [" + manifestDiff.changed[idx] + "] CRC mismatch.\n";
+				}
+				for (unsigned int idx = 0; idx < manifestDiff.missingLocally.size(); ++idx) {
+					result = result + "remote file [" + manifestDiff.missingLocally[idx] + "] missing locally.\n";
+				}
+			}
+			return result;
+		}
 
-				for (int i = 0; i < (int) data.header.techCRCFileCount; ++i) {
-					string networkFile = data.detail.techCRCFileList[i].getString();
-					uint32 &networkFileCRC = data.detail.techCRCFileCRCList[i];
-					bool fileFound = false;
-					uint32 localCRC = 0;
-					for (int idx = 0; idx < (int) vctFileList.size(); ++idx) {
-						std::pair<string, uint32> &fileInfo = vctFileList[idx];
-						if (networkFile == fileInfo.first) {
-							fileFound = true;
-							localCRC = fileInfo.second;
-							break;
-						}
-					}
+		vector<string> NetworkMessageSynchNetworkGameData::getTechRootFolders(const vector<string> &techPaths, const string &techtree) {
+			vector<string> result;
+			for (unsigned int idx = 0; idx < techPaths.size(); ++idx) {
+				string techPath = techPaths[idx];
+				endPathWithSlash(techPath);
+				result.push_back(techPath + techtree + "/");
+			}
+			return result;
+		}
 
-					if (fileFound == false) {
-						result = result + "remote file [" + networkFile + "] missing locally.\n";
-					} else if (networkFileCRC != localCRC) {
-						result = result + "remote file [" + networkFile + "] CRC mismatch.\n";
-					}
+		// Older hosts send the full paths of their own files, which name the
+		// techtree folder itself (".../techs/megapack/factions/...")
+		static bool isRelativeTechFileName(const string &techtree, const string &fileName) {
+			return fileName != "" && fileName[0] != '/' && fileName[0] != '.' &&
+				fileName.find(':') == string::npos && fileName.find('\\') == string::npos &&
+				StartsWith(fileName, techtree + "/") == false &&
+				fileName.find("/" + techtree + "/") == string::npos;
+		}
+
+		bool NetworkMessageSynchNetworkGameData::getTechCRCFileDiff(const vector<std::pair<string, uint32> > &vctFileList, const vector<string> &rootFolders, MerkleManifestDiff &result) const {
+			vector<std::pair<string, uint32> > vctRemoteFileList;
+			bool relativePaths = true;
+			for (int i = 0; i < (int) data.header.techCRCFileCount; ++i) {
+				vctRemoteFileList.push_back(make_pair(data.detail.techCRCFileList[i].getString(), data.detail.techCRCFileCRCList[i]));
+				if (isRelativeTechFileName(data.header.tech.getString(), vctRemoteFileList.back().first) == false) {
+					relativePaths = false;
 				}
 			}
-			return result;
+			getTechCRCFileListDiff(vctFileList, rootFolders, vctRemoteFileList, result);
+			return (relativePaths == true &&
+				vctFileList.size() < (size_t) maxFileCRCCount && data.header.techCRCFileCount < (uint32) maxFileCRCCount);
+		}
+
+		string NetworkMessageSynchNetworkGameData::getTechCRCFileMismatchReport(const vector<std::pair<string, uint32> > &vctFileList, const vector<string> &rootFolders) const {
+			vector<std::pair<string, uint32> > vctRemoteFileList;
+			for (int i = 0; i < (int) data.header.techCRCFileCount; ++i) {
+				vctRemoteFileList.push_back(make_pair(data.detail.techCRCFileList[i].getString(), data.detail.techCRCFileCRCList[i]));
+			}
+			return getTechCRCFileListMismatchReport(data.header.tech.getString(), vctFileList, rootFolders, vctRemoteFileList);
 		}
 
 		const char * NetworkMessageSynchNetworkGameData::getPackedMessageFormatHeader() const {
@@ -2568,57 +2594,12 @@ namespace Glest {
 			}
 		}
 
-		string NetworkMessageSynchNetworkGameDataStatus::getTechCRCFileMismatchReport(string techtree, vector<std::pair<string, uint32> > &vctFileList) {
-			string result = "Techtree: [" + techtree + "] Filecount local: " + intToStr(vctFileList.size()) + " remote: " + intToStr(data.header.techCRCFileCount) + "\n";
-			if (vctFileList.size() <= 0) {
-				result = result + "Local player has no files.\n";
-			} else if (data.header.techCRCFileCount <= 0) {
-				result = result + "Remote player has no files.\n";
-			} else {
-				for (int idx = 0; idx < (int) vctFileList.size(); ++idx) {
-					std::pair<string, uint32> &fileInfo = vctFileList[idx];
-					bool fileFound = false;
-					uint32 remoteCRC = 0;
-					for (int j = 0; j < (int) data.header.techCRCFileCount; ++j) {
-						string networkFile = data.detail.techCRCFileList[j].getString();
-						uint32 &networkFileCRC = data.detail.techCRCFileCRCList[j];
-						if (fileInfo.first == networkFile) {
-							fileFound = true;
-							remoteCRC = networkFileCRC;
-							break;
-						}
-					}
-
-					if (fileFound == false) {
-						result = result + "local file [" + fileInfo.first + "] missing remotely.\n";
-					} else if (fileInfo.second != remoteCRC) {
-						result = result + "local file [" + fileInfo.first + "] CRC mismatch.\n";
-					}
-				}
-
-				for (int i = 0; i < (int) data.header.techCRCFileCount; ++i) {
-					string networkFile = data.detail.techCRCFileList[i].getString();
-					uint32 &networkFileCRC = data.detail.techCRCFileCRCList[i];
-					bool fileFound = false;
-					uint32 localCRC = 0;
-					for (int idx = 0; idx < (int) vctFileList.size(); ++idx) {
-						std::pair<string, uint32> &fileInfo = vctFileList[idx];
-
-						if (networkFile == fileInfo.first) {
-							fileFound = true;
-							localCRC = fileInfo.second;
-							break;
-						}
-					}
-
-					if (fileFound == false) {
-						result = result + "remote file [" + networkFile + "] missing locally.\n";
-					} else if (networkFileCRC != localCRC) {
-						result = result + "remote file [" + networkFile + "] CRC mismatch.\n";
-					}
-				}
+		string NetworkMessageSynchNetworkGameDataStatus::getTechCRCFileMismatchReport(string techtree, const vector<std::pair<string, uint32> > &vctFileList, const vector<string> &rootFolders) const {
+			vector<std::pair<string, uint32> > vctRemoteFileList;
+			for (int i = 0; i < (int) data.header.techCRCFileCount; ++i) {
+				vctRemoteFileList.push_back(make_pair(data.detail.techCRCFileList[i].getString(), data.detail.techCRCFileCRCList[i]));
 			}
-			return result;
+			return getTechCRCFileListMismatchReport(techtree, vctFileList, rootFolders, vctRemoteFileList);
 		}
 
 		bool NetworkMessageSynchNetworkGameDataStatus::receive(Socket* socket) {
@@ -29,9 +29,11 @@
 #include "byte_order.h"
 #include <map>
 #include "common_scoped_ptr.h"
+#include "merkle_manifest.h"
 #include "leak_dumper.h"
 
 using Shared::Platform::Socket;
+using Shared::Util::MerkleManifestDiff;
 using Shared::Platform::int8;
 using Shared::Platform::uint8;
 using Shared::Platform::int16;
@@ -801,7 +803,15 @@ namespace Glest {
 				return data.detail.techCRCFileCRCList;
 			}
 
-			string getTechCRCFileMismatchReport(vector<std::pair<string, uint32> > &vctFileList);
+			// The file list holds paths relative to the techtree folder, which
+			// makes this message the whole techtree manifest
+			static vector<string> getTechRootFolders(const vector<string> &techPaths, const string &techtree);
+
+			// Returns false when either list was cut at maxFileCRCCount, the
+			// diff then misses files, or the host is too old to send paths
+			// relative to the techtree folder
+			bool getTechCRCFileDiff(const vector<std::pair<string, uint32> > &vctFileList, const vector<string> &rootFolders, MerkleManifestDiff &result) const;
+			string getTechCRCFileMismatchReport(const vector<std::pair<string, uint32> > &vctFileList, const vector<string> &rootFolders) const;
 		};
 #pragma pack(pop)
 
@@ -901,7 +911,7 @@ namespace Glest {
 				return data.detail.techCRCFileCRCList;
 			}
 
-			string getTechCRCFileMismatchReport(string techtree, vector<std::pair<string, uint32> > &vctFileList);
+			string getTechCRCFileMismatchReport(string techtree, const vector<std::pair<string, uint32> > &vctFileList, const vector<string> &rootFolders) const;
 
 		};
 #pragma pack(pop)
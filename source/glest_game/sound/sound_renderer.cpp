@@ -14,6 +14,7 @@
 #include "config.h"
 #include "sound_interface.h"
 #include "factory_repository.h"
+#include "sound_buffer_cache.h"
 #include "util.h"
 #include "leak_dumper.h"
 
@@ -70,6 +71,9 @@ namespace Glest {
 			}
 			safeMutex.ReleaseLock();
 
+			StrSound::setPrefetchSize(config.getInt("SoundStreamPrefetchSize", intToStr(StrSound::getPrefetchSize()).c_str()));
+			SoundBufferCache::start(config.getInt("SoundDecodeThreads", "2"));
+
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
 			return wasInitOk();
@@ -110,6 +114,7 @@ namespace Glest {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
 			cleanup();
+			SoundBufferCache::stop();
 
 			delete mutex;
 			mutex = NULL;
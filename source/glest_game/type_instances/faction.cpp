@@ -1122,6 +1122,13 @@ namespace Glest {
 				}
 			}
 
+			// Only resources stand in the way now, so it will probably be
+			// built soon: have its lazily loaded assets ready by then
+			const UnitType *requiredUnitType = dynamic_cast <const UnitType *>(rt);
+			if (requiredUnitType != NULL) {
+				requiredUnitType->prefetchAssets();
+			}
+
 			//required resources
 			for (int i = 0; i < rt->getCostCount(); i++) {
 				const ResourceType *resource = rt->getCost(i)->getType();
@@ -5196,6 +5196,10 @@ namespace Glest {
 			if (ups->getMeshName() != "") {
 				string meshName = ups->getMeshName();
 				Model *model = getCurrentModelPtr();
+				// A lazily loaded model the main thread has not loaded yet
+				if (model == NULL) {
+					return;
+				}
 
 				// as it can happen that anim progress is a bit out of range we correct it to get something valid for the particle positions.
 				float currentAnimProgress = getAnimProgressAsFloat();
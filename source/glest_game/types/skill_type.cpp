@@ -27,6 +27,7 @@
 
 using namespace Shared::Util;
 using namespace Shared::Graphics;
+using namespace Shared::Platform;
 
 namespace Glest {
 	namespace Game {
@@ -534,6 +535,12 @@ namespace Glest {
 					randomCycleCountNode->getAttribute("value")->getIntValue();
 			}
 
+			// Models wait for their first use in lazy mode, a headless
+			// server never loads them at all
+			bool lazyAssets = (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false &&
+				Config::getInstance().getBool("LazyLoadUnitAssets", "false") == true);
+			lazyAnimations = lazyAssets;
+
 			if (sn->hasChild("animation") == true) {
 				//string path= sn->getChild("animation")->getAttribute("path")->getRestrictedValue(currentPath);
 				vector < XmlNode * >animationList = sn->getChildList("animation");
@@ -542,10 +549,13 @@ namespace Glest {
 						animationList[i]->getAttribute("path")->
 						getRestrictedValue(currentPath);
 					if (fileExists(path) == true) {
-						Model *animation =
-							Renderer::getInstance().newModel(rsGame, path, false,
-								&loadedFileList,
-								&parentLoader);
+						Model *animation = NULL;
+						if (lazyAssets == false) {
+							animation =
+								Renderer::getInstance().newModel(rsGame, path, false,
+									&loadedFileList,
+									&parentLoader);
+						}
 						loadedFileList[path].
 							push_back(make_pair
 							(parentLoader,
@@ -553,6 +563,7 @@ namespace Glest {
 								getRestrictedValue()));
 
 						animations.push_back(animation);
+						animationPaths.push_back(path);
 						//printf("**FOUND ANIMATION [%s]\n",path.c_str());
 
 						AnimationAttributes animationAttributeList;
@@ -593,6 +604,11 @@ namespace Glest {
 							particleNode->getChild("particle-file", i);
 						string path =
 							particleFileNode->getAttribute("path")->getRestrictedValue();
+						if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+							// Only ever drawn, so a headless server skips them
+							loadedFileList[currentPath + path].push_back(make_pair(parentLoader, path));
+							continue;
+						}
 						UnitParticleSystemType *unitParticleSystemType =
 							new UnitParticleSystemType();
 						unitParticleSystemType->load(particleFileNode, dir,
@@ -870,7 +886,52 @@ namespace Glest {
 			}
 
 			//printf("!!RETURN ANIMATION [%d / %d]\n",modelIndex,animations.size()-1);
-			return animations[modelIndex];
+			if (lazyAnimations == false) {
+				return animations[modelIndex];
+			}
+			return loadAnimation(modelIndex);
+		}
+
+		// Guards the animation slots of lazily loaded skills, unit models are
+		// read by faction threads while the main thread fills them in
+		static Mutex lazyAnimationMutex;
+
+		// The model manager is not thread safe, so other threads get NULL
+		// until the main thread has loaded the model
+		Model *SkillType::loadAnimation(int index) const {
+			MutexSafeWrapper safeMutex(&lazyAnimationMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (animations[index] != NULL || index >= (int) animationPaths.size() ||
+				Thread::isCurrentThreadMainThread() == false) {
+				return animations[index];
+			}
+			safeMutex.ReleaseLock(true);
+
+			Model *animation =
+				Renderer::getInstance().newModel(rsGame, animationPaths[index]);
+
+			safeMutex.Lock();
+			animations[index] = animation;
+			return animation;
+		}
+
+		void SkillType::loadAssets() const {
+			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+				return;
+			}
+			for (int i = 0; i < (int) animations.size(); ++i) {
+				loadAnimation(i);
+			}
+			for (UnitParticleSystemTypes::const_iterator it =
+				unitParticleSystemTypes.begin();
+				it != unitParticleSystemTypes.end(); ++it) {
+				(*it)->loadAssets();
+			}
+			if (attackBoost.unitParticleSystemTypeForSourceUnit != NULL) {
+				attackBoost.unitParticleSystemTypeForSourceUnit->loadAssets();
+			}
+			if (attackBoost.unitParticleSystemTypeForAffectedUnit != NULL) {
+				attackBoost.unitParticleSystemTypeForAffectedUnit->loadAssets();
+			}
 		}
 
 		string SkillType::skillClassToStr(SkillClass skillClass) {
@@ -1299,6 +1360,19 @@ namespace Glest {
 			}
 		}
 
+		void AttackSkillType::loadAssets() const {
+			SkillType::loadAssets();
+			for (ProjectileTypes::const_iterator it = projectileTypes.begin();
+				it != projectileTypes.end(); ++it) {
+				if ((*it)->getProjectileParticleSystemType() != NULL) {
+					(*it)->getProjectileParticleSystemType()->loadAssets();
+				}
+			}
+			if (splashParticleSystemType != NULL) {
+				splashParticleSystemType->loadAssets();
+			}
+		}
+
 		string AttackSkillType::toString(bool translatedValue) const {
 			if (translatedValue == false) {
 				return "Attack";
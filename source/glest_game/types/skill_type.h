@@ -196,7 +196,11 @@ namespace Glest {
 
 
 			int animationRandomCycleMaxcount;
-			vector < Model * >animations;
+			// NULL until first used when the skill was loaded lazily, the
+			// slots are then only filled on the main thread
+			mutable vector < Model * >animations;
+			bool lazyAnimations;
+			vector < string > animationPaths;
 			vector < AnimationAttributes > animationAttributes;
 
 			SkillSoundList skillSoundList;
@@ -217,6 +221,7 @@ namespace Glest {
 				const string & dir, string currentPath,
 				std::map < string, vector < pair < string,
 				string > > >&loadedFileList, const TechTree * tt);
+			Model *loadAnimation(int index) const;
 
 		public:
 			UnitParticleSystemTypes unitParticleSystemTypes;
@@ -264,6 +269,8 @@ namespace Glest {
 			Model *getAnimation(float animProgress = 0, const Unit * unit =
 				NULL, int *lastAnimationIndex =
 				NULL, int *animationRandomCycleCount = NULL) const;
+			// Loads whatever lazy loading left for first use, main thread only
+			virtual void loadAssets() const;
 
 			float getShakeStartTime() const {
 				return shakeStartTime;
@@ -400,6 +407,7 @@ namespace Glest {
 				vector < pair < string, string > > >&loadedFileList,
 				string parentLoader);
 			virtual string toString(bool translatedValue) const;
+			virtual void loadAssets() const;
 
 			//get
 			inline int getAttackStrength() const {
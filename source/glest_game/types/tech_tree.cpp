@@ -17,7 +17,9 @@
 #include "resource.h"
 #include "faction_type.h"
 #include "logger.h"
+#include "config.h"
 #include "xml_parser.h"
+#include "data_archive.h"
 #include "platform_util.h"
 #include "game_util.h"
 #include "window.h"
@@ -26,6 +28,7 @@
 
 using namespace Shared::Util;
 using namespace Shared::Xml;
+using namespace Shared::PlatformCommon;
 
 namespace Glest {
 	namespace Game {
@@ -167,6 +170,26 @@ namespace Glest {
 			return result;
 		}
 
+		// Closes the xml tree cache when loading ends, it is only written
+		// once the whole tech tree loaded without errors
+		class XmlTreeCacheGuard {
+		public:
+			bool save;
+
+			XmlTreeCacheGuard() : save(false) {
+			}
+			~XmlTreeCacheGuard() {
+				XmlTreeCache::close(save);
+			}
+		};
+
+		static void addPreloadPath(vector < string > &pathList,
+			const string & path) {
+			if (XmlTreeCache::hasFile(path) == false) {
+				pathList.push_back(path);
+			}
+		}
+
 		Checksum TechTree::loadTech(const string & techName,
 			set < string > &factions,
 			Checksum * checksum, std::map < string,
@@ -236,6 +259,12 @@ namespace Glest {
 			treePath = currentPath;
 			name = lastDir(currentPath);
 
+			// Files packed with --create-data-archives=techtrees=packed are
+			// read from the archive instead of one by one
+			if (Config::getInstance().getBool("PackedDataArchives", "true") == true) {
+				VirtualFileSystem::mountFolderArchive(currentPath);
+			}
+
 			Lang & lang = Lang::getInstance();
 			lang.loadTechTreeStrings(name, true);
 			languageUsedForCache = lang.getLanguage();
@@ -399,6 +428,14 @@ namespace Glest {
 			sleep(0);
 			//SDL_PumpEvents();
 
+			// Files already in the binary cache skip reading and parsing the
+			// XML, the rest are parsed on worker threads while the factions
+			// below are loaded one after the other. The types themselves are
+			// built from the XmlNode trees either way
+			XmlTreeCacheGuard xmlTreeCacheGuard;
+			openXmlTreeCache();
+			preloadFactionXmlFiles(factions);
+
 			//load factions
 			try {
 				factionTypes.resize(factions.size());
@@ -432,7 +469,9 @@ namespace Glest {
 					Window::handleEvent();
 					SDL_PumpEvents();
 				}
+				XmlTreePreloader::stop();
 			} catch (megaglest_runtime_error & ex) {
+				XmlTreePreloader::stop();
 				SystemFlags::OutputDebug(SystemFlags::debugError,
 					"In [%s::%s Line: %d] Error [%s]\n",
 					extractFileFromDirectoryPath(__FILE__).
@@ -443,6 +482,7 @@ namespace Glest {
 					ex.what(), !ex.wantStackTrace()
 					|| isValidationModeEnabled);
 			} catch (const exception & e) {
+				XmlTreePreloader::stop();
 				SystemFlags::OutputDebug(SystemFlags::debugError,
 					"In [%s::%s Line: %d] Error [%s]\n",
 					extractFileFromDirectoryPath(__FILE__).
@@ -456,6 +496,7 @@ namespace Glest {
 			if (techtreeChecksum != NULL) {
 				*techtreeChecksum = checksumValue;
 			}
+			xmlTreeCacheGuard.save = true;
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).
 				enabled)
@@ -465,6 +506,72 @@ namespace Glest {
 					c_str(), __FUNCTION__, __LINE__);
 		}
 
+		void TechTree::openXmlTreeCache() {
+			if (Config::getInstance().getBool("TechTreeXmlCache", "true") == false ||
+				getCRCCacheFilePath() == "") {
+				return;
+			}
+
+			// The cache is thrown away as soon as any xml file in the tree changes
+			uint32 crc =
+				getFolderTreeContentsCheckSumRecursively(treePath + "*", ".xml",
+					NULL);
+			if (crc == 0) {
+				return;
+			}
+
+			std::map < string, string > mapExtraTagReplacementValues;
+			mapExtraTagReplacementValues["$COMMONDATAPATH"] =
+				treePath + "/commondata/";
+			XmlTreeCache::open(getCRCCacheFilePath() + "TECHTREE_XML_CACHE_" +
+				name, crc, treePath,
+				Properties::
+				getTagReplacementValues(&mapExtraTagReplacementValues));
+		}
+
+		void TechTree::preloadFactionXmlFiles(const set < string > &factions) {
+			int defaultThreadCount = std::max(SDL_GetCPUCount() - 1, 0);
+			int threadCount =
+				Config::getInstance().getInt("TechTreeLoadThreads",
+					intToStr(defaultThreadCount).c_str());
+			if (threadCount <= 0) {
+				return;
+			}
+
+			// Queued in the same order FactionType::load asks for them so the
+			// workers stay ahead of the loader
+			vector < string > pathList;
+			for (set < string >::const_iterator it = factions.begin();
+				it != factions.end(); ++it) {
+				string factionPath = treePath + "factions/" + *it;
+				endPathWithSlash(factionPath);
+
+				vector < string > unitNames;
+				findDirs(factionPath + "units/", unitNames, false, false);
+				for (unsigned int i = 0; i < unitNames.size(); ++i) {
+					addPreloadPath(pathList, factionPath + "units/" + unitNames[i] +
+						"/" + unitNames[i] + ".xml");
+				}
+
+				vector < string > upgradeNames;
+				findDirs(factionPath + "upgrades/", upgradeNames, false, false);
+				for (unsigned int i = 0; i < upgradeNames.size(); ++i) {
+					addPreloadPath(pathList, factionPath + "upgrades/" +
+						upgradeNames[i] + "/" + upgradeNames[i] + ".xml");
+				}
+
+				addPreloadPath(pathList, factionPath + *it + ".xml");
+			}
+
+			std::map < string, string > mapExtraTagReplacementValues;
+			mapExtraTagReplacementValues["$COMMONDATAPATH"] =
+				treePath + "/commondata/";
+			XmlTreePreloader::start(pathList,
+				Properties::
+				getTagReplacementValues(&mapExtraTagReplacementValues),
+				threadCount);
+		}
+
 		TechTree::~TechTree() {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).
 				enabled)
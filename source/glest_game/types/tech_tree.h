@@ -60,6 +60,9 @@ namespace Glest {
 				string > >translatedTechFactionNames;
 			bool isValidationModeEnabled;
 
+			void openXmlTreeCache();
+			void preloadFactionXmlFiles(const set < string > &factions);
+
 		public:
 			Checksum loadTech(const string & techName,
 				set < string > &factions, Checksum * checksum,
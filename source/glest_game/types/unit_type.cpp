@@ -93,6 +93,7 @@ namespace Glest {
 		UnitType::UnitType() :ProducibleType() {
 
 			countInVictoryConditions = ucvcNotSet;
+			assetsPending = false;
 			meetingPointImage = NULL;
 			lightColor = Vec3f(0.f);
 			light = false;
@@ -545,6 +546,11 @@ namespace Glest {
 							string path =
 								particleFileNode->getAttribute("path")->
 								getRestrictedValue();
+							if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+								// Only ever drawn, so a headless server skips them
+								loadedFileList[currentPath + path].push_back(make_pair(sourceXMLFile, path));
+								continue;
+							}
 							UnitParticleSystemType *unitParticleSystemType =
 								new UnitParticleSystemType();
 
@@ -1111,6 +1117,9 @@ namespace Glest {
 				computeFirstStOfClass();
 				computeFirstCtOfClass();
 
+				assetsPending = (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false &&
+					Config::getInstance().getBool("LazyLoadUnitAssets", "false") == true);
+
 				if (getFirstStOfClass(scStop) == NULL) {
 					throw
 						megaglest_runtime_error
@@ -1480,6 +1489,36 @@ namespace Glest {
 			return false;
 		}
 
+		// Must run on the main thread, textures and models need the GL context
+		void UnitType::loadAssets() const {
+			for (int i = 0; i < (int) skillTypes.size(); ++i) {
+				if (skillTypes[i] != NULL) {
+					skillTypes[i]->loadAssets();
+				}
+			}
+			for (DamageParticleSystemTypes::const_iterator it =
+				damageParticleSystemTypes.begin();
+				it != damageParticleSystemTypes.end(); ++it) {
+				(*it)->loadAssets();
+			}
+		}
+
+		// Guards assetsPending, faction threads check requirements in parallel
+		static Mutex assetsPendingMutex;
+
+		// Called whenever the type could be produced, so only the first call
+		// after a lazy load queues anything
+		void UnitType::prefetchAssets() const {
+			MutexSafeWrapper safeMutex(&assetsPendingMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (assetsPending == false) {
+				return;
+			}
+			assetsPending = false;
+			safeMutex.ReleaseLock();
+
+			Renderer::getInstance().queueAssetPrefetch(this);
+		}
+
 		// ==================== PRIVATE ====================
 
 		void UnitType::computeFirstStOfClass() {
@@ -264,6 +264,9 @@ namespace Glest {
 
 			UnitCountsInVictoryConditions countInVictoryConditions;
 
+			// Lazily loaded models and particles not queued for loading yet
+			mutable bool assetsPending;
+
 			static auto_ptr < CommandType > ctHarvestEmergencyReturnCommandType;
 
 		public:
@@ -507,6 +510,10 @@ namespace Glest {
 				rotatedBuildPos = value;
 			}
 
+			//lazily loaded assets
+			void loadAssets() const;
+			void prefetchAssets() const;
+
 			//other
 			virtual string getReqDesc(bool translatedValue) const;
 
@@ -337,6 +337,50 @@ namespace Glest {
 		//		}
 			}
 		}
+		// =====================================================
+		// 	class ObjectBuckets
+		// =====================================================
+
+		const int ObjectBuckets::bucketSize = 8;
+
+		ObjectBuckets::ObjectBuckets() {
+			w = 0;
+			h = 0;
+		}
+
+		void ObjectBuckets::init(const Map *map) {
+			w = (map->getSurfaceW() + bucketSize - 1) / bucketSize;
+			h = (map->getSurfaceH() + bucketSize - 1) / bucketSize;
+			buckets.clear();
+			buckets.resize(w * h);
+			for (int j = 0; j < map->getSurfaceH(); ++j) {
+				for (int i = 0; i < map->getSurfaceW(); ++i) {
+					if (map->getSurfaceCell(i, j)->getObject() != NULL) {
+						buckets[(j / bucketSize) * w + (i / bucketSize)].push_back(Vec2i(i, j));
+					}
+				}
+			}
+		}
+
+		void ObjectBuckets::clear() {
+			w = 0;
+			h = 0;
+			buckets.clear();
+		}
+
+		void ObjectBuckets::find(const Rect2i &surfaceRect, vector<Vec2i> &result) const {
+			int bucketX0 = (surfaceRect.p[0].x > 0 ? surfaceRect.p[0].x / bucketSize : 0);
+			int bucketY0 = (surfaceRect.p[0].y > 0 ? surfaceRect.p[0].y / bucketSize : 0);
+			int bucketX1 = (surfaceRect.p[1].x < w * bucketSize ? surfaceRect.p[1].x / bucketSize : w - 1);
+			int bucketY1 = (surfaceRect.p[1].y < h * bucketSize ? surfaceRect.p[1].y / bucketSize : h - 1);
+			for (int bucketY = bucketY0; bucketY <= bucketY1; ++bucketY) {
+				for (int bucketX = bucketX0; bucketX <= bucketX1; ++bucketX) {
+					const vector<Vec2i> &bucket = buckets[bucketY * w + bucketX];
+					result.insert(result.end(), bucket.begin(), bucket.end());
+				}
+			}
+		}
+
 		// =====================================================
 		// 	class Map
 		// =====================================================
@@ -385,6 +429,7 @@ namespace Glest {
 					getSurfaceCell(i, j)->end();
 				}
 			}
+			objectBuckets.clear();
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 		}
 
@@ -581,6 +626,9 @@ namespace Glest {
 			computeInterpolatedHeights();
 			computeNearSubmerged();
 			computeCellColors();
+			// Objects are only placed by load and smoothing, the ones
+			// harvested later are skipped by whoever reads the buckets
+			objectBuckets.init(this);
 		}
 
 
@@ -2038,6 +2086,28 @@ namespace Glest {
 			return true;
 		}
 
+		// True for the positions next() stops at. Its first row starts one
+		// step past (p[0].x - 1) rounded toward zero, the other rows at
+		// p[0].x rounded toward zero.
+		bool PosQuadIterator::covers(const Vec2i &testPos) const {
+			if (testPos.x % step != 0 || testPos.y % step != 0) {
+				return false;
+			}
+			int firstRowY = (boundingRect.p[0].y / step) * step;
+			if (testPos.y < firstRowY || testPos.y > boundingRect.p[1].y ||
+				testPos.x > boundingRect.p[1].x) {
+				return false;
+			}
+			int rowStartX = (boundingRect.p[0].x / step) * step;
+			if (testPos.y == firstRowY) {
+				rowStartX = ((boundingRect.p[0].x - 1) / step) * step + step;
+			}
+			if (testPos.x < rowStartX) {
+				return false;
+			}
+			return quad.isInside(testPos);
+		}
+
 		//void PosQuadIterator::skipX() {
 		//	pos.x+= step;
 		//}
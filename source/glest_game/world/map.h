@@ -59,6 +59,7 @@ namespace Glest {
 		class TechTree;
 		class GameSettings;
 		class World;
+		class Map;
 
 		// =====================================================
 		// 	class Cell
@@ -271,6 +272,35 @@ namespace Glest {
 		};
 
 
+		// =====================================================
+		// 	class ObjectBuckets
+		//
+		///	Surface cells holding a tileset object, grouped into
+		///	square blocks so the ones under a screen area can be
+		///	listed without walking every cell of it
+		// =====================================================
+
+		class ObjectBuckets {
+		public:
+			static const int bucketSize;	//number of surface cells per side of a bucket
+
+		private:
+			int w;
+			int h;
+			vector<vector<Vec2i> > buckets;
+
+		public:
+			ObjectBuckets();
+
+			void init(const Map *map);
+			void clear();
+
+			// Surface positions in every bucket touching the (inclusive)
+			// surface rect, row-major within a bucket. Callers still check
+			// the exact position and that the object was not removed since.
+			void find(const Rect2i &surfaceRect, vector<Vec2i> &result) const;
+		};
+
 		// =====================================================
 		// 	class Map
 		//
@@ -311,6 +341,7 @@ namespace Glest {
 			Checksum checksumValue;
 			float maxMapHeight;
 			string mapFile;
+			ObjectBuckets objectBuckets;
 
 		private:
 			Map(Map&);
@@ -371,6 +402,9 @@ namespace Glest {
 			inline SurfaceCell *getSurfaceCell(const Vec2i &sPos) const {
 				return getSurfaceCell(sPos.x, sPos.y);
 			}
+			inline const ObjectBuckets &getObjectBuckets() const {
+				return objectBuckets;
+			}
 
 			inline int getW() const {
 				return w;
@@ -759,6 +793,7 @@ namespace Glest {
 		public:
 			PosQuadIterator(const Map *map, const Quad2i &quad, int step = 1);
 			bool next();
+			bool covers(const Vec2i &testPos) const;
 			//void skipX();
 			const Vec2i &getPos();
 		};
@@ -26,6 +26,95 @@ using namespace Shared::Graphics;
 namespace Glest {
 	namespace Game {
 
+		// Fog of war alphas are worked on as the bytes the pixmaps hold,
+		// a row at a time in loops simple enough for the compiler to
+		// vectorize. Each returns true when row1 still differs from row0.
+
+		static bool keepBrightestRow(const uint8 *row0, uint8 *row1, int w) {
+			uint8 difference = 0;
+			for (int x = 0; x < w; ++x) {
+				uint8 p0 = row0[x];
+				uint8 p1 = row1[x];
+				uint8 value = (p0 > p1 ? p0 : p1);
+				row1[x] = value;
+				difference |= value ^ p0;
+			}
+			return difference != 0;
+		}
+
+		static bool fadeToExploredRow(const uint8 *row0, uint8 *row1, int w, uint8 explored) {
+			uint8 difference = 0;
+			for (int x = 0; x < w; ++x) {
+				uint8 p0 = row0[x];
+				uint8 p1 = row1[x];
+				uint8 faded = (p1 > explored ? explored : p1);
+				uint8 value = (p0 > p1 ? p0 : faded);
+				row1[x] = value;
+				difference |= value ^ p0;
+			}
+			return difference != 0;
+		}
+
+		static bool fillRow(const uint8 *row0, uint8 *row1, int w, uint8 value) {
+			uint8 difference = 0;
+			for (int x = 0; x < w; ++x) {
+				row1[x] = value;
+				difference |= value ^ row0[x];
+			}
+			return difference != 0;
+		}
+
+		// Moves texRow a fraction t256 / 256 of the way from row0 to
+		// row1, texels already at row1 are left alone. Returns true when
+		// texRow changed, reachedRow1 tells if nothing is left to blend.
+		static bool blendRow(const uint8 *row0, const uint8 *row1, uint8 *texRow, int w, int t256, bool &reachedRow1) {
+			uint8 changed = 0;
+			uint8 difference = 0;
+			for (int x = 0; x < w; ++x) {
+				int p0 = row0[x];
+				int p1 = row1[x];
+				uint8 current = texRow[x];
+				uint8 blended = static_cast<uint8>((p0 * 256 + (p1 - p0) * t256) >> 8);
+				uint8 value = (p1 != current ? blended : current);
+				texRow[x] = value;
+				changed |= value ^ current;
+				difference |= value ^ static_cast<uint8>(p1);
+			}
+			reachedRow1 = (difference == 0);
+			return changed != 0;
+		}
+
+		// =====================================================
+		// 	class Minimap::ChangedRows
+		// =====================================================
+
+		void Minimap::ChangedRows::add(int row) {
+			if (first < 0 || row < first) {
+				first = row;
+			}
+			if (row > last) {
+				last = row;
+			}
+		}
+
+		void Minimap::ChangedRows::addAll(int rowCount) {
+			if (rowCount > 0) {
+				first = 0;
+				last = max(last, rowCount - 1);
+			}
+		}
+
+		bool Minimap::ChangedRows::take(int &firstRow, int &rowCount) {
+			if (first < 0) {
+				return false;
+			}
+			firstRow = first;
+			rowCount = last - first + 1;
+			first = -1;
+			last = -1;
+			return true;
+		}
+
 		// =====================================================
 		// 	class Minimap
 		// =====================================================
@@ -101,6 +190,7 @@ namespace Glest {
 				fowTex->getPixmap()->init(potW, potH, 1);
 				fowTex->getPixmap()->setPixels(&f, 1);
 			}
+			setAllFowRowsChanged();
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
@@ -109,6 +199,8 @@ namespace Glest {
 			if (tex) {
 				tex->getPixmap()->init(scaledW, scaledH, 4);
 				tex->setMipmap(false);
+				// Changed cells are uploaded on their own
+				tex->setForceCompressionDisabled(true);
 			}
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
@@ -141,6 +233,9 @@ namespace Glest {
 
 				if (fowPixmap1->getPixelf(sPos.x, sPos.y) < alpha) {
 					fowPixmap1->setPixel(sPos.x, sPos.y, alpha);
+					if (sPos.y < (int) fowRowsBlending.size()) {
+						fowRowsBlending[sPos.y] = true;
+					}
 				}
 
 				if (fowPixmap1Copy != NULL && isIncrementalUpdate == true) {
@@ -166,6 +261,7 @@ namespace Glest {
 			if (fowPixmap1Copy != NULL && fowPixmap1Copy_default != NULL) {
 				fowPixmap1Copy->copy(fowPixmap1Copy_default);
 			}
+			setAllFowRowsChanged();
 		}
 
 		void Minimap::setFogOfWar(bool value) {
@@ -188,6 +284,14 @@ namespace Glest {
 			if (fowPixmap1 != NULL && fowPixmap1Copy != NULL) {
 				fowPixmap1->copy(fowPixmap1Copy);
 			}
+			setAllFowRowsChanged();
+		}
+
+		void Minimap::setAllFowRowsChanged() {
+			if (fowTex != NULL) {
+				fowRowsBlending.assign(fowTex->getPixmapConst()->getH(), true);
+				fowTexChangedRows.addAll(fowTex->getPixmapConst()->getH());
+			}
 		}
 
 		void Minimap::resetFowTex() {
@@ -199,40 +303,24 @@ namespace Glest {
 				// Could turn off ONLY fog of war by setting below to false
 				bool overridefogOfWarValue = fogOfWar;
 
-				for (int indexPixelWidth = 0;
-					indexPixelWidth < fowTex->getPixmap()->getW();
-					++indexPixelWidth) {
-					for (int indexPixelHeight = 0;
-						indexPixelHeight < fowTex->getPixmap()->getH();
-						++indexPixelHeight) {
-						if ((fogOfWar == false && overridefogOfWarValue == false)) {
-							//(gameSettings->getFlagTypes1() & ft1_show_map_resources) != ft1_show_map_resources) {
-							//printf("Line: %d\n",__LINE__);
-
-							float p0 = fowPixmap0->getPixelf(indexPixelWidth, indexPixelHeight);
-							float p1 = fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
-							if (p0 > p1) {
-								fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p0);
-							} else {
-								fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p1);
-							}
-						} else if ((fogOfWar && overridefogOfWarValue) ||
-							(gameSettings->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources) {
-							//printf("Line: %d\n",__LINE__);
-
-							float p0 = fowPixmap0->getPixelf(indexPixelWidth, indexPixelHeight);
-							float p1 = fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
-
-							if (p1 > exploredAlpha) {
-								fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, exploredAlpha);
-							}
-							if (p0 > p1) {
-								fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p0);
-							}
-						} else {
-							//printf("Line: %d\n",__LINE__);
-							fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, 1.f);
-						}
+				int w = fowTex->getPixmap()->getW();
+				int h = fowTex->getPixmap()->getH();
+				const uint8 explored = static_cast<uint8>(exploredAlpha * 255.f);
+				for (int y = 0; y < h; ++y) {
+					const uint8 *row0 = fowPixmap0->getPixels() + y * w;
+					uint8 *row1 = fowPixmap1->getPixels() + y * w;
+					bool rowChanged = false;
+					if ((fogOfWar == false && overridefogOfWarValue == false)) {
+						//(gameSettings->getFlagTypes1() & ft1_show_map_resources) != ft1_show_map_resources) {
+						rowChanged = keepBrightestRow(row0, row1, w);
+					} else if ((fogOfWar && overridefogOfWarValue) ||
+						(gameSettings->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources) {
+						rowChanged = fadeToExploredRow(row0, row1, w, explored);
+					} else {
+						rowChanged = fillRow(row0, row1, w, 255);
+					}
+					if (rowChanged == true) {
+						fowRowsBlending[y] = true;
 					}
 				}
 			}
@@ -240,59 +328,88 @@ namespace Glest {
 
 		void Minimap::updateFowTex(float t) {
 			if (fowTex && fowPixmap0 && fowPixmap1) {
-				for (int indexPixelWidth = 0;
-					indexPixelWidth < fowPixmap0->getW();
-					++indexPixelWidth) {
-					for (int indexPixelHeight = 0;
-						indexPixelHeight < fowPixmap0->getH();
-						++indexPixelHeight) {
-						float p1 = fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
-						float p2 = fowTex->getPixmap()->getPixelf(indexPixelWidth, indexPixelHeight);
-						if (p1 != p2) {
-							float p0 = fowPixmap0->getPixelf(indexPixelWidth, indexPixelHeight);
-							fowTex->getPixmap()->setPixel(indexPixelWidth, indexPixelHeight, p0 + (t*(p1 - p0)));
-						}
+				Pixmap2D *texPixmap = fowTex->getPixmap();
+				int w = texPixmap->getW();
+				int h = texPixmap->getH();
+				int t256 = static_cast<int>(clamp(t, 0.f, 1.f) * 256.f);
+				for (int y = 0; y < h; ++y) {
+					if (fowRowsBlending[y] == false) {
+						continue;
+					}
+					bool reachedRow1 = false;
+					if (blendRow(fowPixmap0->getPixels() + y * w, fowPixmap1->getPixels() + y * w,
+						texPixmap->getPixels() + y * w, w, t256, reachedRow1) == true) {
+						fowTexChangedRows.add(y);
+					}
+					if (reachedRow1 == true) {
+						fowRowsBlending[y] = false;
 					}
 				}
 			}
 		}
 
-		// ==================== PRIVATE ====================
+		void Minimap::updateSurfaceCell(const World *world, const Vec2i &sPos) {
+			if (tex == NULL) {
+				return;
+			}
+			// The texture no longer matches the surface when it was
+			// resized for the graphics card
+			Pixmap2D *pixmap = tex->getPixmap();
+			const Map *map = world->getMap();
+			if (pixmap->getW() != map->getSurfaceW() || pixmap->getH() != map->getSurfaceH() ||
+				sPos.x < 0 || sPos.y < 0 || sPos.x >= pixmap->getW() || sPos.y >= pixmap->getH()) {
+				return;
+			}
+			pixmap->setPixel(sPos.x, sPos.y, computeCellColor(world, sPos.x, sPos.y));
+			texChangedRows.add(sPos.y);
+		}
 
-		void Minimap::computeTexture(const World *world) {
+		bool Minimap::takeFowTexChangedRows(int &firstRow, int &rowCount) const {
+			return fowTexChangedRows.take(firstRow, rowCount);
+		}
 
-			Vec4f color;
-			const Map *map = world->getMap();
+		bool Minimap::takeTextureChangedRows(int &firstRow, int &rowCount) const {
+			return texChangedRows.take(firstRow, rowCount);
+		}
+
+		// ==================== PRIVATE ====================
 
+		void Minimap::computeTexture(const World *world) {
 			if (tex) {
 				tex->getPixmap()->setPixels(Vec4f(1.f, 1.f, 1.f, 0.1f).ptr(), tex->getPixmap()->getComponents());
 
 				for (int j = 0; j < tex->getPixmap()->getH(); ++j) {
 					for (int i = 0; i < tex->getPixmap()->getW(); ++i) {
-						SurfaceCell *sc = map->getSurfaceCell(i, j);
-
-						if (sc->getObject() == NULL || sc->getObject()->getType() == NULL) {
-							const Pixmap2D *p = world->getTileset()->getSurfPixmap(sc->getSurfaceType(), 0);
-							color = p->getPixel4f(p->getW() / 2, p->getH() / 2);
-							color = color * static_cast<float>(sc->getVertex().y / 6.f);
-
-							if (sc->getVertex().y <= world->getMap()->getWaterLevel()) {
-								color += Vec4f(0.5f, 0.5f, 1.0f, 1.0f);
-							}
-
-							if (color.x > 1.f) color.x = 1.f;
-							if (color.y > 1.f) color.y = 1.f;
-							if (color.z > 1.f) color.z = 1.f;
-							if (color.w > 1.f) color.w = 1.f;
-						} else {
-							color = sc->getObject()->getType()->getColor();
-						}
-						tex->getPixmap()->setPixel(i, j, color);
+						tex->getPixmap()->setPixel(i, j, computeCellColor(world, i, j));
 					}
 				}
 			}
 		}
 
+		Vec4f Minimap::computeCellColor(const World *world, int i, int j) const {
+			Vec4f color;
+			const Map *map = world->getMap();
+			SurfaceCell *sc = map->getSurfaceCell(i, j);
+
+			if (sc->getObject() == NULL || sc->getObject()->getType() == NULL) {
+				const Pixmap2D *p = world->getTileset()->getSurfPixmap(sc->getSurfaceType(), 0);
+				color = p->getPixel4f(p->getW() / 2, p->getH() / 2);
+				color = color * static_cast<float>(sc->getVertex().y / 6.f);
+
+				if (sc->getVertex().y <= world->getMap()->getWaterLevel()) {
+					color += Vec4f(0.5f, 0.5f, 1.0f, 1.0f);
+				}
+
+				if (color.x > 1.f) color.x = 1.f;
+				if (color.y > 1.f) color.y = 1.f;
+				if (color.z > 1.f) color.z = 1.f;
+				if (color.w > 1.f) color.w = 1.f;
+			} else {
+				color = sc->getObject()->getType()->getColor();
+			}
+			return color;
+		}
+
 		void Minimap::saveGame(XmlNode *rootNode) {
 			std::map<string, string> mapTagReplacements;
 			XmlNode *minimapNode = rootNode->addChild("Minimap");
@@ -320,6 +437,7 @@ namespace Glest {
 					fowPixmap1->getPixels()[pixelIndex] = fowPixmap1Node->getAttribute("pixel")->getIntValue();
 				}
 			}
+			setAllFowRowsChanged();
 		}
 
 	}
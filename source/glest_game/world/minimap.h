@@ -31,6 +31,8 @@ namespace Glest {
 		using Shared::Graphics::Pixmap2D;
 		using Shared::Graphics::Texture2D;
 		using Shared::Xml::XmlNode;
+		using Shared::Platform::uint8;
+		using std::vector;
 
 		class World;
 		class GameSettings;
@@ -48,6 +50,23 @@ namespace Glest {
 		// =====================================================
 
 		class Minimap {
+		private:
+			// Range of texture rows changed since the renderer last
+			// uploaded them
+			class ChangedRows {
+			public:
+				int first;
+				int last;
+
+				ChangedRows() {
+					first = -1;
+					last = -1;
+				}
+				void add(int row);
+				void addAll(int rowCount);
+				bool take(int &firstRow, int &rowCount);
+			};
+
 		private:
 			Pixmap2D * fowPixmap0;
 			Pixmap2D *fowPixmap1;
@@ -61,6 +80,12 @@ namespace Glest {
 			bool fogOfWar;
 			const GameSettings *gameSettings;
 
+			// Rows where fowTex has not reached fowPixmap1 yet, the
+			// others need no blending until the fog of war changes
+			vector<uint8> fowRowsBlending;
+			mutable ChangedRows fowTexChangedRows;
+			mutable ChangedRows texChangedRows;
+
 		private:
 			static const float exploredAlpha;
 
@@ -87,11 +112,20 @@ namespace Glest {
 			void copyFowTexAlphaSurface();
 			void restoreFowTexAlphaSurface();
 
+			// Color of a surface cell whose object changed
+			void updateSurfaceCell(const World *world, const Vec2i &sPos);
+
+			// Rows changed since the last call, false when there are none
+			bool takeFowTexChangedRows(int &firstRow, int &rowCount) const;
+			bool takeTextureChangedRows(int &firstRow, int &rowCount) const;
+
 			void saveGame(XmlNode *rootNode);
 			void loadGame(const XmlNode *rootNode);
 
 		private:
 			void computeTexture(const World *world);
+			Vec4f computeCellColor(const World *world, int i, int j) const;
+			void setAllFowRowsChanged();
 		};
 
 	}
@@ -22,6 +22,8 @@
 #include "properties.h"
 #include "lang.h"
 #include "platform_util.h"
+#include "data_archive.h"
+#include "config.h"
 
 using namespace Shared::Util;
 using namespace Shared::Xml;
@@ -158,6 +160,10 @@ namespace Glest {
 			string path = currentPath + name + ".xml";
 			string sourceXMLFile = path;
 
+			if (Config::getInstance().getBool("PackedDataArchives", "true") == true) {
+				VirtualFileSystem::mountFolderArchive(currentPath);
+			}
+
 			checksum->addFile(path);
 			tilesetChecksum->addFile(path);
 			checksumValue.addFile(path);
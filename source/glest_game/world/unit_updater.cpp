@@ -1807,6 +1807,7 @@ namespace Glest {
 											//const ResourceType *rt = r->getType();
 											sc->deleteResource();
 											world->removeResourceTargetFromCache(unitTargetPos);
+											world->getMiniMapObject()->updateSurfaceCell(world, Map::toSurfCoords(unitTargetPos));
 
 											switch (this->game->getGameSettings()->getPathFinderType()) {
 												case pfBasic:
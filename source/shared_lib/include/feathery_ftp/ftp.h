@@ -70,6 +70,7 @@ typedef struct {
 	ip_t     passiveIp;					///< IP of the FTP Server from the clients perspective related to Passive connection
 	port_t   passivePort; 				///< Port of the FTP Server from the clients perspective related to Passive connection
 	transmission_S activeTrans;			///< infos about a currently active file/directory-transmission
+	uint32_t restartOffset;				///< byte offset set via REST command, used by the next RETR
 
 }ftpSession_S;
 
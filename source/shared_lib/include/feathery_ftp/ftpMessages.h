@@ -64,6 +64,8 @@ extern const char ftpMsg037[];
 extern const char ftpMsg038[];
 extern const char ftpMsg039[];
 extern const char ftpMsg040[];
+extern const char ftpMsg041[];
+extern const char ftpMsg042[];
 
 
 #endif /* FTPMESSAGES_H_ */
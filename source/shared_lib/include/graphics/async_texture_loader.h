@@ -0,0 +1,75 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// async_texture_loader.h: decodes texture images on worker threads and
+// hands them to the main thread for upload
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_GRAPHICS_ASYNCTEXTURELOADER_H_
+#define _SHARED_GRAPHICS_ASYNCTEXTURELOADER_H_
+
+#include <string>
+#include "texture.h"
+#include "leak_dumper.h"
+
+using std::string;
+
+namespace Shared {
+	namespace Graphics {
+
+		// =====================================================
+		//	class AsyncTextureLoader
+		//
+		//	Worker threads decode image files into pixmaps, the
+		//	main thread uploads them with processUploads(). Until
+		//	then the texture holds a 1x1 grey placeholder so it
+		//	can be initialized and rendered like any other.
+		// =====================================================
+
+		class AsyncTextureLoader {
+		public:
+			// Decoded images waiting for upload, workers pause once this many are ready
+			static const int maxQueuedUploads;
+
+			static void start(int threadCount);
+			static void stop();
+			static bool isRunning();
+
+			// The texture must belong to a TextureManager, which cancels the
+			// request if the texture ends first. Loads right away when no
+			// workers are running.
+			static void load(Texture2D *texture, const string &path, Texture::Filter filter, int maxAnisotropy);
+			static void cancel(const Texture *texture);
+			static bool isPending(const Texture *texture);
+			static int getPendingCount();
+
+			// Main thread only: uploads decoded textures until maxMillis
+			// have passed (at least one), returns how many were uploaded
+			static int processUploads(int maxMillis);
+
+			// Worker side: decodes the next queued image, false when idle
+			static bool processNextDecode();
+		};
+
+	}
+}//end namespace
+
+#endif
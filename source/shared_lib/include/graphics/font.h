@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 #include "font_text.h"
+#include "text_layout_cache.h"
 #include "leak_dumper.h"
 
 using std::string;
@@ -36,6 +37,7 @@ namespace Shared {
 
 			//float yOffsetFactor;
 			Text *textHandler;
+			mutable TextLayoutCache layoutCache;
 
 		public:
 			//static float DEFAULT_Y_OFFSET_FACTOR;
@@ -48,6 +50,9 @@ namespace Shared {
 
 			void setTextHandler(Text *textHandler);
 			Text * getTextHandler();
+			TextLayoutCache * getLayoutCache() {
+				return &layoutCache;
+			}
 
 			void setWidth(int i, float width) {
 				this->widths[i] = width;
@@ -129,6 +134,8 @@ namespace Shared {
 			void setSize(int size);
 
 			static void bidi_cvt(string &str_);
+			static void shapeText2D(string &text, bool hasTextHandler);
+			static void shapeText3D(string &text, bool hasTextHandler);
 
 			static void resetToDefaults();
 		};
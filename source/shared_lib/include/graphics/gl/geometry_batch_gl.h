@@ -0,0 +1,113 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// geometry_batch_gl.h: small effect geometry gathered in client side
+// arrays and drawn with one call per texture and primitive type
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_GRAPHICS_GL_GEOMETRYBATCHGL_H_
+#define _SHARED_GRAPHICS_GL_GEOMETRYBATCHGL_H_
+
+#include <vector>
+#include "vec.h"
+#include "opengl.h"
+#include "leak_dumper.h"
+
+using std::vector;
+
+namespace Shared {
+	namespace Graphics {
+		namespace Gl {
+
+			// =====================================================
+			//	class GeometryBatchGl
+			//
+			//	Replaces glBegin/glEnd blocks drawn many times a
+			//	frame. Vertices are appended to growable arrays and
+			//	consecutive ones with the same primitive type and
+			//	texture become one draw, so draw order is kept.
+			//	Only primitives that can be joined are accepted:
+			//	GL_POINTS, GL_LINES, GL_TRIANGLES and GL_QUADS.
+			// =====================================================
+
+			class GeometryBatchGl {
+			private:
+				class Vertex {
+				public:
+					Vec2f texCoord;
+					Vec4f color;
+					Vec3f pos;
+				};
+
+				class Draw {
+				public:
+					GLenum primitive;
+					GLuint textureHandle;
+					int first;
+					int count;
+				};
+
+				vector<Vertex> vertices;
+				vector<Draw> draws;
+
+				Vec4f currentColor;
+				Vec2f currentTexCoord;
+
+			public:
+				GeometryBatchGl();
+
+				// Following vertices belong to this primitive type and
+				// texture, 0 draws them untextured
+				void begin(GLenum primitive, GLuint textureHandle = 0);
+
+				void color(const Vec4f &color) {
+					currentColor = color;
+				}
+				void color(float r, float g, float b, float a) {
+					currentColor = Vec4f(r, g, b, a);
+				}
+				void texCoord(float s, float t) {
+					currentTexCoord = Vec2f(s, t);
+				}
+				void vertex(const Vec3f &pos);
+
+				bool isEmpty() const {
+					return vertices.empty();
+				}
+				int getVertexCount() const {
+					return (int) vertices.size();
+				}
+				int getDrawCount() const {
+					return (int) draws.size();
+				}
+
+				// Draws everything gathered and empties the batch, the
+				// current color and texture state are kept. The arrays
+				// stay allocated for the next pass.
+				void flush();
+				void clear();
+			};
+
+		}
+	}
+}//end namespace
+
+#endif
@@ -27,15 +27,34 @@ namespace Shared {
 			private:
 				const Texture *teamTexture;
 
+				// What the last execute set up, consecutive meshes needing
+				// the same texture environment skip setting it again
+				bool applied;
+				const Texture *appliedTeamTexture;
+				bool appliedTeamColors;
+				uint8 appliedFactionOpacity;
+				float appliedAlpha;
+
 			public:
 				MeshCallback() {
 					teamTexture = NULL;
+					reset();
 				}
 
 				void setTeamTexture(const Texture *teamTexture) {
 					this->teamTexture = teamTexture;
 				}
 
+				// Forget the texture environment, when something else may
+				// have changed it
+				void reset() {
+					applied = false;
+					appliedTeamTexture = NULL;
+					appliedTeamColors = false;
+					appliedFactionOpacity = 0;
+					appliedAlpha = 1.0f;
+				}
+
 				void execute(const Mesh *mesh, float alpha);
 
 				static bool noTeamColors;
@@ -51,6 +70,9 @@ namespace Shared {
 				bool duplicateTexCoords;
 				int secondaryTexCoordUnit;
 				GLuint lastTexture;
+				// -1 until set since begin
+				int lastTwoSided;
+				int lastGlow;
 
 			public:
 				ModelRendererGl();
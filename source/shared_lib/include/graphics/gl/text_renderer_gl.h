@@ -55,7 +55,7 @@ namespace Shared {
 				bool rendering;
 				int currentFTGLErrorCount;
 
-				void internalRender(const string &text, float  x, float y, bool centered, Vec4f *color);
+				void internalRender(const TextLayout &layout, float  x, float y, bool centered, Vec4f *color);
 				void specialFTGLErrorCheckWorkaround(string text);
 
 			public:
@@ -22,6 +22,7 @@ namespace Shared {
 
 		class GraphicsFactory;
 		class Context;
+		class Texture;
 		class Texture2D;
 		class Model;
 
@@ -36,6 +37,7 @@ namespace Shared {
 		class RendererInterface {
 		public:
 			virtual Texture2D *newTexture2D(ResourceScope rs) = 0;
+			virtual void initTexture(ResourceScope rs, Texture *texture) = 0;
 			virtual Model *newModel(ResourceScope rs, const string &path, bool deletePixMapAfterLoad = false, std::map<string, vector<pair<string, string> > > *loadedFileList = NULL, string *sourceLoader = NULL) = 0;
 
 			virtual ~RendererInterface() {
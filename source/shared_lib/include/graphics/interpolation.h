@@ -15,27 +15,55 @@
 #include "vec.h"
 #include "model.h"
 #include <map>
+#include <vector>
 #include "leak_dumper.h"
 
+using std::vector;
+
 namespace Shared {
 	namespace Graphics {
 
 		// =====================================================
 		//	class InterpolationData
+		//
+		//	Interpolated frames are cached per mesh, keyed by the
+		//	two key frames and the blend factor rounded to
+		//	1 / cacheSteps, so units of one type playing the same
+		//	animation share the work. Entries not used in the last
+		//	frame are dropped.
 		// =====================================================
 
 		class InterpolationData {
 		private:
+			class CacheEntry {
+			public:
+				uint32 prevFrame;
+				uint32 nextFrame;
+				float localT;
+				uint32 lastUsedFrame;
+				Vec3f *data;
+			};
+			typedef vector<CacheEntry> CacheEntries;
+
 			const Mesh *mesh;
 
-			Vec3f *vertices;
-			Vec3f *normals;
+			const Vec3f *vertices;
+			const Vec3f *normals;
+			CacheEntries vertexCache;
+			CacheEntries normalCache;
 
 			int raw_frame_ofs;
 
 			static bool enableInterpolation;
+			static int cacheSteps;
+			static int cacheSize;
+			static int frameSlots;
+			static uint32 currentFrame;
+			static uint32 cacheHits;
+			static uint32 cacheMisses;
 
-			void update(const Vec3f* src, Vec3f* &dest, float t, bool cycle);
+			void update(const Vec3f* src, CacheEntries &cache, const Vec3f* &dest, float t, bool cycle);
+			void clearCache(CacheEntries &cache);
 
 		public:
 			InterpolationData(const Mesh *mesh);
@@ -44,6 +72,38 @@ namespace Shared {
 			static void setEnableInterpolation(bool enabled) {
 				enableInterpolation = enabled;
 			}
+			// 0 only shares exactly equal blend factors
+			static void setCacheSteps(int steps) {
+				cacheSteps = steps;
+			}
+			// Interpolated frames kept per mesh for vertices and for normals
+			static void setCacheSize(int size) {
+				cacheSize = size;
+			}
+			// Frames interpolated in the current frame are kept for the
+			// later render passes (shadows, selection) up to this many
+			// per mesh, even past the cache size
+			static void setFrameSlots(int slots) {
+				frameSlots = slots;
+			}
+			// Call once per rendered frame
+			static void advanceFrame() {
+				currentFrame++;
+			}
+			static uint32 getCacheHits() {
+				return cacheHits;
+			}
+			static uint32 getCacheMisses() {
+				return cacheMisses;
+			}
+			static void resetCacheStats() {
+				cacheHits = 0;
+				cacheMisses = 0;
+			}
+
+			// dest[i] = prev[i] + (next[i] - prev[i]) * t, vectorized where
+			// the compiler targets SSE2 or AVX
+			static void lerp(const Vec3f *prev, const Vec3f *next, Vec3f *dest, uint32 count, float t);
 
 			const Vec3f *getVertices() const {
 				return !vertices || !enableInterpolation ? mesh->getVertices() + raw_frame_ofs : vertices;
@@ -51,6 +111,9 @@ namespace Shared {
 			const Vec3f *getNormals() const {
 				return !normals || !enableInterpolation ? mesh->getNormals() + raw_frame_ofs : normals;
 			}
+			int getCachedFrameCount() const {
+				return (int) (vertexCache.size() + normalCache.size());
+			}
 
 			void update(float t, bool cycle);
 			void updateVertices(float t, bool cycle);
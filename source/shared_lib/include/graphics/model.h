@@ -22,11 +22,13 @@
 #include <memory>
 #include "common_scoped_ptr.h"
 #include "byte_order.h"
+#include "memory_mapped_file.h"
 #include "leak_dumper.h"
 
 using std::string;
 using std::map;
 using std::pair;
+using Shared::PlatformCommon::MemoryMappedFile;
 
 namespace Shared {
 	namespace Graphics {
@@ -62,6 +64,14 @@ namespace Shared {
 			Vec3f *normals;
 			Vec2f *texCoords;
 			uint32 *indices;
+			// vertices / normals point into the model's file mapping
+			bool verticesMapped;
+			bool normalsMapped;
+
+			// Extent of all frames, kept when the vertices move to a VBO
+			mutable bool boundsBuilt;
+			mutable Vec3f boundsMin;
+			mutable Vec3f boundsMax;
 
 			//material data
 			Vec3f diffuseColor;
@@ -113,6 +123,7 @@ namespace Shared {
 				return indexCount;
 			}
 			uint32 getTriangleCount() const;
+			void getBounds(Vec3f &boundsMin, Vec3f &boundsMax) const;
 
 			uint32	getVBOVertices() const {
 				return m_nVBOVertices;
@@ -145,6 +156,9 @@ namespace Shared {
 			const uint32 *getIndices() const {
 				return indices;
 			}
+			bool hasMappedFrameData() const {
+				return verticesMapped || normalsMapped;
+			}
 
 			void setVertices(Vec3f *data, uint32 count);
 			void setNormals(Vec3f *data, uint32 count);
@@ -208,10 +222,10 @@ namespace Shared {
 
 			//load
 			void loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
-				bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList = NULL, string sourceLoader = "", string modelFile = "");
+				bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList = NULL, string sourceLoader = "", string modelFile = "", MemoryMappedFile *mappedFile = NULL);
 			void loadV3(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
-				bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList = NULL, string sourceLoader = "", string modelFile = "");
-			void load(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager, bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList = NULL, string sourceLoader = "", string modelFile = "");
+				bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList = NULL, string sourceLoader = "", string modelFile = "", MemoryMappedFile *mappedFile = NULL);
+			void load(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager, bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList = NULL, string sourceLoader = "", string modelFile = "", MemoryMappedFile *mappedFile = NULL);
 			void save(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
 				string convertTextureToFormat, std::map<string, int> &textureDeleteList,
 				bool keepsmallest, string modelFile);
@@ -223,6 +237,7 @@ namespace Shared {
 
 		private:
 			string findAlternateTexture(vector<string> conversionList, string textureFile);
+			void readFrameData(FILE *f, MemoryMappedFile *mappedFile);
 			//void computeTangents();
 
 		};
@@ -241,6 +256,8 @@ namespace Shared {
 			uint8 fileVersion;
 			uint32 meshCount;
 			Mesh *meshes;
+			// Kept while any mesh points into it
+			MemoryMappedFile *mappedFile;
 
 			float lastTData;
 			bool lastCycleData;
@@ -282,6 +299,7 @@ namespace Shared {
 
 			uint32 getTriangleCount() const;
 			uint32 getVertexCount() const;
+			void getBounds(Vec3f &boundsMin, Vec3f &boundsMax) const;
 
 			//io
 			void save(const string &path, string convertTextureToFormat, bool keepsmallest);
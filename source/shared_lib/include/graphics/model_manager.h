@@ -14,6 +14,7 @@
 
 #include "model.h"
 #include <vector>
+#include <map>
 #include "leak_dumper.h"
 
 using namespace std;
@@ -25,6 +26,10 @@ namespace Shared {
 
 		// =====================================================
 		//	class ModelManager
+		//
+		//	Models are shared by path: asking for a model that is
+		//	already loaded returns the same instance and it is only
+		//	deleted once every newModel call has its endModel.
 		// =====================================================
 
 		class ModelManager {
@@ -34,6 +39,13 @@ namespace Shared {
 		protected:
 			ModelContainer models;
 			TextureManager *textureManager;
+			std::map<string, Model *> modelsByPath;
+			std::map<Model *, int> modelRefCounts;
+			// What the last newModel call returned, for endLastModel
+			Model *lastModel;
+
+			static string getModelKey(const string &path, bool deletePixMapAfterLoad);
+			void forgetModel(Model *model);
 
 		public:
 			ModelManager();
@@ -49,6 +61,7 @@ namespace Shared {
 			void setTextureManager(TextureManager *textureManager) {
 				this->textureManager = textureManager;
 			}
+			int getRefCount(const Model *model) const;
 		};
 
 	}
@@ -13,6 +13,8 @@
 #define _SHARED_GRAPHICS_PARTICLE_H_
 
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include <cassert>
 #include "vec.h"
 #include "pixmap.h"
@@ -23,6 +25,7 @@
 #include "interpolation.h"
 
 using std::list;
+using std::vector;
 using Shared::Util::RandomGen;
 using Shared::Xml::XmlNode;
 
@@ -90,6 +93,62 @@ namespace Shared {
 			void loadGame(const XmlNode *rootNode);
 		};
 
+		// =====================================================
+		//	class ParticleStore
+		//
+		//	Particles kept as one array per component so the
+		//	update kernels of the particle systems run down plain
+		//	float arrays the compiler can vectorize. Particle is
+		//	only used to build or inspect a single particle.
+		// =====================================================
+
+		class ParticleStore {
+		public:
+			vector<float> posX, posY, posZ;
+			vector<float> lastPosX, lastPosY, lastPosZ;
+			vector<float> speedX, speedY, speedZ;
+			vector<float> speedUpRelative;
+			vector<float> speedUpConstantX, speedUpConstantY, speedUpConstantZ;
+			vector<float> accelX, accelY, accelZ;
+			vector<float> colorR, colorG, colorB, colorA;
+			vector<float> size;
+			vector<int> energy;
+			// Scratch space for the update kernels
+			vector<float> energyRatio;
+
+		public:
+			void resize(int count);
+			void clear();
+			void swap(ParticleStore &store);
+			int getCount() const {
+				return (int) energy.size();
+			}
+			int getCapacity() const {
+				return (int) energy.capacity();
+			}
+
+			void set(int i, const Particle &p);
+			Particle get(int i) const;
+			// Overwrites particle to with particle from
+			void move(int from, int to);
+
+			Vec3f getPos(int i) const {
+				return Vec3f(posX[i], posY[i], posZ[i]);
+			}
+			Vec3f getLastPos(int i) const {
+				return Vec3f(lastPosX[i], lastPosY[i], lastPosZ[i]);
+			}
+			Vec4f getColor(int i) const {
+				return Vec4f(colorR[i], colorG[i], colorB[i], colorA[i]);
+			}
+			float getSize(int i) const {
+				return size[i];
+			}
+			int getEnergy(int i) const {
+				return energy[i];
+			}
+		};
+
 		// =====================================================
 		//	class ParticleObserver
 		// =====================================================
@@ -154,11 +213,28 @@ namespace Shared {
 				pst_SnowParticleSystem,
 				pst_ProjectileParticleSystem,
 				pst_SplashParticleSystem,
+
+				pst_Count
 			};
 
+		private:
+			friend class ParticleManager;
+
+			// Set by ParticleManager while it runs update() on its systems
+			// so the particle steps can run on its workers afterwards
+			static bool deferParticleSteps;
+
+			bool pendingParticleStep;
+			int pendingEmissions;
+			State pendingStepState;
+
+			void acquireParticleStore(int particleCount);
+			void releaseParticleStore();
+
 		protected:
 
-			std::vector<Particle> particles;
+			ParticleSystemType systemType;
+			ParticleStore particles;
 			RandomGen random;
 
 			BlendMode blendMode;
@@ -195,12 +271,21 @@ namespace Shared {
 
 		public:
 			//conmstructor and destructor
-			ParticleSystem(int particleCount);
+			ParticleSystem(int particleCount, ParticleSystemType systemType);
 			virtual ~ParticleSystem();
-			virtual ParticleSystemType getParticleSystemType() const = 0;
+			ParticleSystemType getParticleSystemType() const {
+				return systemType;
+			}
 
 			//public
 			virtual void update();
+			// Moves, retires and emits the particles of the last update(),
+			// only touches this system so steps of different systems can
+			// run side by side
+			void stepParticles();
+			bool hasPendingParticleStep() const {
+				return pendingParticleStep;
+			}
 			virtual void render(ParticleRenderer *pr, ModelRenderer *mr);
 
 			//get
@@ -216,11 +301,11 @@ namespace Shared {
 			Vec3f getPos() const {
 				return pos;
 			}
-			Particle *getParticle(int i) {
-				return &particles[i];
+			const ParticleStore &getParticles() const {
+				return particles;
 			}
-			const Particle *getParticle(int i) const {
-				return &particles[i];
+			Particle getParticle(int i) const {
+				return particles.get(i);
 			}
 			int getAliveParticleCount() const {
 				return aliveParticleCount;
@@ -296,15 +381,25 @@ namespace Shared {
 
 			virtual Checksum getCRC();
 
+			// Projectile, splash and unit systems come and go all game
+			// long, their particle arrays are kept for the next one of
+			// the same type. Up to poolSize stores are kept per type.
+			static void setParticleStorePoolSize(int poolSize);
+			static int getPooledParticleStoreCount(ParticleSystemType type);
+			static void clearParticleStorePools();
+
 		protected:
 			//protected
-			Particle *createParticle();
-			void killParticle(Particle *p);
+			int createParticle();
+			// Keeps the alive particles at the front of the store
+			template<typename DeathTest> void compactParticles(const DeathTest &deathTest);
 
 			//virtual protected
+			virtual int emitParticle(int particleIndex);
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
-			virtual bool deathTest(Particle *p);
+			// Update kernels work on the particles in [first, last)
+			virtual void updateParticles(int first, int last);
+			virtual void removeDeadParticles();
 		};
 
 		// =====================================================
@@ -319,13 +414,9 @@ namespace Shared {
 		public:
 			FireParticleSystem(int particleCount = 2000);
 
-			virtual ParticleSystemType getParticleSystemType() const {
-				return pst_FireParticleSystem;
-			}
-
 			//virtual
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
+			virtual void updateParticles(int first, int last);
 
 			//set params
 			void setRadius(float radius);
@@ -402,7 +493,7 @@ namespace Shared {
 			Vec3f direction;
 			float tween;
 
-			GameParticleSystem(int particleCount);
+			GameParticleSystem(int particleCount, ParticleSystemType systemType);
 			void positionChildren();
 			void setTween(float relative, float absolute);
 		};
@@ -460,10 +551,6 @@ namespace Shared {
 			UnitParticleSystem(int particleCount = 2000);
 			~UnitParticleSystem();
 
-			virtual ParticleSystemType getParticleSystemType() const {
-				return pst_UnitParticleSystem;
-			}
-
 			ParticleSystemTypeInterface * getParticleType() const {
 				return particleSystemType;
 			}
@@ -473,7 +560,7 @@ namespace Shared {
 
 			//virtual
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
+			virtual void updateParticles(int first, int last);
 			virtual void update();
 			virtual bool getVisible() const;
 			virtual void fade();
@@ -593,14 +680,10 @@ namespace Shared {
 		public:
 			RainParticleSystem(int particleCount = 4000);
 
-			virtual ParticleSystemType getParticleSystemType() const {
-				return pst_RainParticleSystem;
-			}
-
 			virtual void render(ParticleRenderer *pr, ModelRenderer *mr);
 
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual bool deathTest(Particle *p);
+			virtual void removeDeadParticles();
 
 			void setRadius(float radius);
 			void setWind(float windAngle, float windSpeed);
@@ -622,12 +705,8 @@ namespace Shared {
 		public:
 			SnowParticleSystem(int particleCount = 4000);
 
-			virtual ParticleSystemType getParticleSystemType() const {
-				return pst_SnowParticleSystem;
-			}
-
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual bool deathTest(Particle *p);
+			virtual void removeDeadParticles();
 
 			void setRadius(float radius);
 			void setWind(float windAngle, float windSpeed);
@@ -649,11 +728,7 @@ namespace Shared {
 			float sizeNoEnergy;
 			float gravity;
 		public:
-			AttackParticleSystem(int particleCount);
-
-			virtual ParticleSystemType getParticleSystemType() const {
-				return pst_ProjectileParticleSystem;
-			}
+			AttackParticleSystem(int particleCount, ParticleSystemType systemType);
 
 			void setSizeNoEnergy(float sizeNoEnergy) {
 				this->sizeNoEnergy = sizeNoEnergy;
@@ -713,15 +788,12 @@ namespace Shared {
 			ProjectileParticleSystem(int particleCount = 1000);
 			virtual ~ProjectileParticleSystem();
 
-			virtual ParticleSystemType getParticleSystemType() const {
-				return pst_SplashParticleSystem;
-			}
-
 			void link(SplashParticleSystem *particleSystem);
 
 			virtual void update();
+			virtual int emitParticle(int particleIndex);
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
+			virtual void updateParticles(int first, int last);
 
 			void setTrajectory(Trajectory trajectory) {
 				this->trajectory = trajectory;
@@ -773,7 +845,7 @@ namespace Shared {
 
 			virtual void update();
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
+			virtual void updateParticles(int first, int last);
 
 			virtual void initParticleSystem();
 
@@ -808,6 +880,16 @@ namespace Shared {
 		class ParticleManager {
 		private:
 			vector<ParticleSystem *> particleSystems;
+			// Where each managed system sits in particleSystems. Removing a
+			// system leaves a NULL slot behind until the next update()
+			// compacts the list, so indices stay put while it runs.
+			std::unordered_map<const ParticleSystem *, int> particleSystemSlots;
+			int removedParticleSystemCount;
+			vector<int> updatedSlots;
+
+			void removeParticleSystem(int slot);
+			void compactParticleSystems();
+			void stepParticleSystems();
 
 		public:
 			ParticleManager();
@@ -823,6 +905,17 @@ namespace Shared {
 			bool validateParticleSystemStillExists(ParticleSystem * particleSystem) const;
 			void removeParticleSystemsForParticleOwner(ParticleOwner * particleOwner);
 			bool hasActiveParticleSystem(ParticleSystem::ParticleSystemType type) const;
+
+			// Workers shared by all managers that step the particles of
+			// different systems in parallel once update() has run the
+			// system logic in order. Without workers everything runs in
+			// update() on the calling thread.
+			static void startWorkers(int threadCount);
+			static void stopWorkers();
+			static int getWorkerCount();
+
+			// Worker side: steps the next queued system, false when idle
+			static bool processNextStep();
 		};
 
 	}
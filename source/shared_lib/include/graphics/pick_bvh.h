@@ -0,0 +1,107 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// pick_bvh.h: bounding volume hierarchy of axis aligned boxes, finds
+// what a picking ray hits first or what lies inside a selection frustum
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_GRAPHICS_PICKBVH_H_
+#define _SHARED_GRAPHICS_PICKBVH_H_
+
+#include <vector>
+#include "vec.h"
+#include "leak_dumper.h"
+
+using std::vector;
+
+namespace Shared {
+	namespace Graphics {
+
+		// =====================================================
+		//	class PickBox
+		// =====================================================
+
+		class PickBox {
+		public:
+			PickBox();
+			PickBox(const Vec3f &boxMin, const Vec3f &boxMax, int id);
+
+			Vec3f boxMin;
+			Vec3f boxMax;
+			int id;
+
+			void add(const Vec3f &point);
+		};
+
+		// =====================================================
+		//	class PickBvh
+		//
+		//	Selection without drawing: boxes are split at the
+		//	median of their longest axis until few are left per
+		//	leaf, queries skip every subtree whose box is missed.
+		//	Planes are (a,b,c,d) with a*x+b*y+c*z+d >= 0 inside.
+		// =====================================================
+
+		class PickBvh {
+		public:
+			static const int maxLeafBoxes = 4;
+
+		private:
+			class Node {
+			public:
+				Vec3f boxMin;
+				Vec3f boxMax;
+				// Leaves have no children and a range of boxes
+				int left;
+				int right;
+				int first;
+				int count;
+			};
+
+			vector<PickBox> boxes;
+			vector<Node> nodes;
+
+			int buildNode(int first, int count);
+
+		public:
+			void build(const vector<PickBox> &boxes);
+			void clear();
+
+			// Id of the box the ray enters first, -1 when none is hit
+			int findNearest(const Vec3f &origin, const Vec3f &direction, float *distance = NULL) const;
+			// Ids of the boxes not fully outside any of the planes
+			void findInside(const Vec4f *planes, int planeCount, vector<int> &ids) const;
+
+			int getBoxCount() const {
+				return (int) boxes.size();
+			}
+			int getNodeCount() const {
+				return (int) nodes.size();
+			}
+
+			static bool intersectRay(const Vec3f &boxMin, const Vec3f &boxMax,
+				const Vec3f &origin, const Vec3f &direction, float &distance);
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -317,6 +317,8 @@ namespace Shared {
 			void copy(const Pixmap2D *sourcePixmap);
 			void subCopy(int x, int y, const Pixmap2D *sourcePixmap);
 			void copyImagePart(int x, int y, const Pixmap2D *sourcePixmap);
+			// Takes over the pixels of sourcePixmap without copying, leaving it empty
+			void transferFrom(Pixmap2D *sourcePixmap);
 			string getPath() const {
 				return path;
 			}
@@ -0,0 +1,123 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// render_queue.h: draw items of a render pass sorted by the state
+// they need
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_GRAPHICS_RENDERQUEUE_H_
+#define _SHARED_GRAPHICS_RENDERQUEUE_H_
+
+#include <map>
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::vector;
+
+namespace Shared {
+	namespace Graphics {
+
+		using Platform::uint64;
+
+		class Model;
+		class Texture;
+
+		// =====================================================
+		//	class RenderQueueItem
+		// =====================================================
+
+		class RenderQueueItem {
+		public:
+			// Not const, the renderer still updates its interpolation
+			Model *model;
+			const Texture *teamTexture;
+			// Blended items are drawn after the others, farthest first
+			bool blended;
+			// Distance to the camera, only used for blended items
+			float depth;
+			// The caller's own reference to what it draws
+			int index;
+
+			RenderQueueItem() : model(NULL), teamTexture(NULL), blended(false), depth(0), index(0) {
+			}
+		};
+
+		// =====================================================
+		//	class RenderQueue
+		//
+		//	Collects the draw items of one pass and sorts them so
+		//	items sharing a team texture and a model are drawn one
+		//	after the other: first the opaque ones grouped by team
+		//	texture then model, then the blended ones back to
+		//	front. The keys are radix sorted, items with the same
+		//	state keep the order they were added in.
+		// =====================================================
+
+		class RenderQueue {
+		private:
+			vector<RenderQueueItem> items;
+			vector<uint64> keys;
+			vector<int> order;
+			vector<uint64> sortKeys;
+			vector<int> sortOrder;
+			// Small per pass numbers for the models and team textures,
+			// in the order they were first seen
+			std::map<const void *, int> modelSlots;
+			std::map<const void *, int> teamTextureSlots;
+
+			int batchCount;
+			int stateChangeCount;
+
+			static int getSlot(std::map<const void *, int> &slots, const void *ptr, int maxSlot);
+			void radixSort();
+			void countStateChanges();
+
+		public:
+			RenderQueue();
+
+			void clear();
+			void add(const RenderQueueItem &item);
+			void sort();
+
+			int getItemCount() const {
+				return (int) items.size();
+			}
+			// The i-th item to draw once sorted
+			const RenderQueueItem &getItem(int i) const {
+				return items[order[i]];
+			}
+
+			// Runs of items needing the same state, and how many times
+			// the blend class, team texture or model changes between
+			// consecutive items, as of the last sort
+			int getBatchCount() const {
+				return batchCount;
+			}
+			int getStateChangeCount() const {
+				return stateChangeCount;
+			}
+		};
+
+	}
+}//end namespace
+
+#endif
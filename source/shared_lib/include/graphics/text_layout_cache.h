@@ -0,0 +1,126 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// text_layout_cache.h: shaped text, glyph runs and metrics of strings
+// rendered again and again with the same font
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_GRAPHICS_TEXTLAYOUTCACHE_H_
+#define _SHARED_GRAPHICS_TEXTLAYOUTCACHE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include "font_text.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+
+namespace Shared {
+	namespace Graphics {
+
+		// Turns text into the order its glyphs are drawn in (bidi, right
+		// to left languages), hasTextHandler is false for legacy fonts
+		typedef void(*TextShaper)(string &text, bool hasTextHandler);
+
+		// =====================================================
+		//	class TextLayout
+		// =====================================================
+
+		class TextLayout {
+		public:
+			TextLayout();
+
+			bool shaped;
+			string shapedText;
+			// Shaped text split into glyph runs, tabs and newlines are
+			// runs of their own. Empty when the text has neither.
+			vector<string> runs;
+
+			// Measured on first use, negative until then
+			float advance;
+			float width;
+		};
+
+		// =====================================================
+		//	class TextLayoutCache
+		//
+		//	Console lines, labels and unit titles are the same
+		//	strings frame after frame, so shaping and measuring
+		//	them is done once per font face size and string.
+		//	When full the cache starts over.
+		// =====================================================
+
+		class TextLayoutCache {
+		public:
+			static const int defaultMaxLayouts = 512;
+
+			// Bumped when language settings change the shaping
+			static int shapingGeneration;
+
+		private:
+			typedef std::pair<int, string> LayoutKey;
+
+			Text *textHandler;
+			TextShaper shaper;
+			int maxLayouts;
+			int generation;
+
+			std::map<LayoutKey, TextLayout> layouts;
+			std::map<int, float> lineHeights;
+
+			int hitCount;
+			int missCount;
+
+			TextLayout &findLayout(const string &text);
+			int getFaceSize();
+
+		public:
+			TextLayoutCache(Text *textHandler = NULL, TextShaper shaper = NULL, int maxLayouts = defaultMaxLayouts);
+
+			void setTextHandler(Text *textHandler);
+			void setShaper(TextShaper shaper);
+
+			// The reference is good until the next call to the cache
+			const TextLayout &getLayout(const string &text, bool measureAdvance = false);
+
+			// Advance of the longest line of the unshaped text
+			float getTextWidth(const string &text);
+			float getLineHeight();
+
+			void clear();
+
+			int getLayoutCount() const {
+				return (int) layouts.size();
+			}
+			int getHitCount() const {
+				return hitCount;
+			}
+			int getMissCount() const {
+				return missCount;
+			}
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -175,6 +175,8 @@ namespace Shared {
 
 		public:
 			void load(const string &path);
+			// 1x1 grey stand-in for path while the image is still loading
+			void initPlaceholder(const string &path);
 
 			Pixmap2D *getPixmap() {
 				return &pixmap;
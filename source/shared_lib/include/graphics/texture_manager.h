@@ -34,6 +34,7 @@ namespace Shared {
 
 			Texture::Filter textureFilter;
 			int maxAnisotropy;
+			bool loadAsync;
 
 		public:
 			TextureManager();
@@ -43,6 +44,13 @@ namespace Shared {
 
 			void setFilter(Texture::Filter textureFilter);
 			void setMaxAnisotropy(int maxAnisotropy);
+			// Model textures loaded from now on are decoded by AsyncTextureLoader
+			void setLoadAsync(bool loadAsync) {
+				this->loadAsync = loadAsync;
+			}
+			bool getLoadAsync() const {
+				return loadAsync;
+			}
 			void initTexture(Texture *texture);
 			void endTexture(Texture *texture, bool mustExistInList = false);
 			void endLastTexture(bool mustExistInList = false);
@@ -78,6 +78,9 @@ namespace Shared {
 
 			static bool shutdownAndWait(BaseThread *ppThread);
 			virtual bool shutdownAndWait();
+			// Unlike shutdownAndWait() this does not give up after a few seconds,
+			// for threads that work on memory owned by the caller
+			void shutdownAndJoin();
 			virtual bool canShutdown(bool deleteSelfIfShutdownDelayed = false);
 
 			virtual bool getDeleteSelfOnExecutionDone();
@@ -0,0 +1,175 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// data_archive.h: packed game data archives and the file system
+// layer that reads from them
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_PLATFORMCOMMON_DATAARCHIVE_H_
+#define _SHARED_PLATFORMCOMMON_DATAARCHIVE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdio.h>
+#include "data_types.h"
+#include "memory_mapped_file.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+using Shared::Platform::uint32;
+using Shared::Platform::uint64;
+using Shared::Platform::int64;
+
+namespace Shared {
+	namespace Util {
+		class Checksum;
+	}
+
+	namespace PlatformCommon {
+
+		// =====================================================
+		//	class DataArchiveEntry
+		// =====================================================
+
+		class DataArchiveEntry {
+		public:
+			enum Flags {
+				fCompressed = 1
+			};
+
+			// Relative to the archived folder, always using '/'
+			string path;
+			// Same value Checksum::getFileSum gives the original file
+			uint32 crc;
+			uint32 flags;
+			uint64 offset;
+			uint64 size;
+			uint64 storedSize;
+			// Modification time of the original file when it was packed
+			int64 modified;
+
+			DataArchiveEntry() : crc(0), flags(0), offset(0), size(0), storedSize(0), modified(0) {
+			}
+			bool isCompressed() const {
+				return (flags & fCompressed) != 0;
+			}
+		};
+
+		// =====================================================
+		//	class DataArchive
+		//
+		//	One game data folder packed into a single file: a
+		//	header, the file blobs (each starting on a 4K boundary,
+		//	stored as is or deflated) and an index sorted by path.
+		//	The archive is mapped into memory, so stored files are
+		//	read straight from the page cache.
+		// =====================================================
+
+		class DataArchive {
+		private:
+			MemoryMappedFile mappedFile;
+			vector<DataArchiveEntry> entries;
+
+		private:
+			DataArchive(const DataArchive &);
+			void operator =(const DataArchive &);
+
+		public:
+			static const uint32 version;
+			static const string fileExtension;
+			static const uint64 blobAlignment;
+
+			DataArchive();
+			~DataArchive();
+
+			// Packs every file below folder, compressing the ones that
+			// shrink when compress is set. Returns false on any error
+			static bool create(const string &folder, const string &archiveFile, bool compress);
+
+			bool open(const string &archiveFile);
+			void close();
+
+			bool isOpen() const {
+				return mappedFile.isOpen();
+			}
+			const string &getPath() const {
+				return mappedFile.getPath();
+			}
+			const vector<DataArchiveEntry> &getEntries() const {
+				return entries;
+			}
+
+			const DataArchiveEntry *findEntry(const string &relativePath) const;
+			// The bytes of a stored (not compressed) entry inside the mapping
+			const char *getMappedData(const DataArchiveEntry &entry) const;
+			bool readFile(const DataArchiveEntry &entry, vector<char> &data) const;
+
+			// What getFolderTreeContentsCheckSumRecursively returns for the
+			// folder the archive was made from, without touching the disk
+			uint32 getContentCheckSum(const string &filterFileExt) const;
+			// Adds the archived files below folder to a folder walk in progress
+			void addToChecksum(const string &folder, const string &filterFileExt, Shared::Util::Checksum &checksum) const;
+			// False once a file in folder was added, removed or changed
+			// after the archive was packed from it
+			bool matchesFolder(const string &folder) const;
+		};
+
+		// =====================================================
+		//	class VirtualFileSystem
+		//
+		//	Serves files below a mounted folder from its archive,
+		//	anything else is left to the real file system. Archives
+		//	stay alive until unmountAll so data handed out from them
+		//	never dangles.
+		// =====================================================
+
+		class VirtualFileSystem {
+		public:
+			static string normalizePath(const string &path);
+
+			static bool mount(const string &folder, const string &archiveFile);
+			static bool isMounted(const string &folder);
+			// Mounts the archive packed from folder (folder + fileExtension,
+			// next to it) when there is one and the folder has not changed
+			// since it was packed. An already mounted archive is checked
+			// again and unmounted when the folder changed
+			static bool mountFolderArchive(const string &folder);
+			// Unmounts the archives at or below a folder or a search path
+			// like "techs/megapack/*"
+			static void unmount(const string &folderSearch);
+			static void unmountAll();
+
+			static bool isArchived(const string &path);
+			// Returns false when path is not in a mounted archive
+			static bool readFile(const string &path, vector<char> &data);
+			// A read only stream for an archived file, NULL if it isn't one
+			static FILE *openFile(const string &path);
+			// The archive mounted at the folder of a search path like
+			// "techs/megapack/*", NULL if there is none
+			static const DataArchive *findMountedFolder(const string &folderSearch);
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -0,0 +1,96 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// memory_mapped_file.h: maps a whole file into memory
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_PLATFORMCOMMON_MEMORYMAPPEDFILE_H_
+#define _SHARED_PLATFORMCOMMON_MEMORYMAPPEDFILE_H_
+
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+#include "leak_dumper.h"
+
+using std::string;
+
+namespace Shared {
+	namespace PlatformCommon {
+
+		// =====================================================
+		//	class MemoryMappedFile
+		//
+		//	The mapping is copy-on-write: pages are shared with the
+		//	page cache (and every other process mapping the file)
+		//	until something writes to them, the file itself is
+		//	never modified.
+		// =====================================================
+
+		class MemoryMappedFile {
+		private:
+			string path;
+			char *data;
+			size_t size;
+			void *fileHandle;
+			void *mappingHandle;
+
+		private:
+			MemoryMappedFile(const MemoryMappedFile &);
+			void operator =(const MemoryMappedFile &);
+
+		public:
+			MemoryMappedFile();
+			~MemoryMappedFile();
+
+			// Returns false (and maps nothing) if the file can't be mapped
+			bool open(const string &path);
+			void close();
+
+			bool isOpen() const {
+				return data != NULL;
+			}
+			const string &getPath() const {
+				return path;
+			}
+			size_t getSize() const {
+				return size;
+			}
+
+			// Points at count values of T starting at offset, or NULL when
+			// they don't fit in the file or aren't aligned for T
+			template<typename T>
+			T *getArray(size_t offset, size_t count) const {
+				if (data == NULL || count == 0 || offset > size ||
+					count > (size - offset) / sizeof(T)) {
+					return NULL;
+				}
+				char *result = data + offset;
+				if (reinterpret_cast<uintptr_t>(result) % alignof(T) != 0) {
+					return NULL;
+				}
+				return reinterpret_cast<T *>(result);
+			}
+		};
+
+	}
+}//end namespace
+
+#endif
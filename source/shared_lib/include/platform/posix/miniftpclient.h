@@ -15,6 +15,7 @@
 #include "base_thread.h"
 #include <vector>
 #include <string>
+#include <algorithm>
 #include "platform_common.h"
 #include "leak_dumper.h"
 
@@ -57,6 +58,8 @@ namespace Shared {
 				double upload_now;
 				string currentFilename;
 				FTP_Client_CallbackType downloadType;
+				// Average bytes per second of the current transfer
+				double download_speed;
 			};
 
 			virtual void FTPClient_CallbackEvent(string itemName,
@@ -65,6 +68,30 @@ namespace Shared {
 				void *userdata) = 0;
 		};
 
+		class FTPClientThread;
+
+		// The files of a techtree that differ from the host, fetched one by one
+		// instead of downloading the whole techtree archive
+		struct FTPTechtreeFilesRequest {
+			string techtreeName;
+			string destFolder;
+			vector<string> filesToFetch;
+			vector<string> filesToRemove;
+			unsigned int nextFile;
+			int transfersRunning;
+			pair<FTP_Client_ResultType, string> result;
+		};
+
+		// Extra thread used by FTPClientThread to run several transfers at once
+		class FTPClientTransferThread : public BaseThread {
+		protected:
+			FTPClientThread *owner;
+
+		public:
+			explicit FTPClientTransferThread(FTPClientThread *owner);
+			virtual void execute();
+		};
+
 		class FTPClientThread : public BaseThread, public ShellCommandOutputCallbackInterface {
 		protected:
 			int portNumber;
@@ -94,6 +121,9 @@ namespace Shared {
 			Mutex mutexTempFileList;
 			vector<pair<string, string> > tempFileList;
 
+			Mutex mutexTechtreeFilesList;
+			vector<FTPTechtreeFilesRequest *> techtreeFilesList;
+
 			void getMapFromServer(pair<string, string> mapFilename);
 			pair<FTP_Client_ResultType, string> getMapFromServer(pair<string, string> mapFileName, string ftpUser, string ftpUserPassword);
 
@@ -103,6 +133,10 @@ namespace Shared {
 			void getTechtreeFromServer(pair<string, string> techtreeName);
 			pair<FTP_Client_ResultType, string> getTechtreeFromServer(pair<string, string> techtreeName, string ftpUser, string ftpUserPassword);
 
+			bool processTechtreeFilesRequest();
+			pair<FTP_Client_ResultType, string> getTechtreeFileFromServer(string techtreeName, string destFolder, string fileName);
+			void finishTechtreeFilesRequest(FTPTechtreeFilesRequest *request);
+
 			void getScenarioFromServer(pair<string, string> fileName);
 			pair<FTP_Client_ResultType, string> getScenarioInternalFromServer(pair<string, string> fileName);
 
@@ -113,6 +147,11 @@ namespace Shared {
 			pair<FTP_Client_ResultType, string> getTempFileInternalFromServer(pair<string, string> fileName);
 
 			Mutex mutexProgressMutex;
+			Mutex mutexArchiveExtract;
+
+			int maxConcurrentTransfers;
+			int maxTransferRetries;
+			vector<FTPClientTransferThread *> transferThreads;
 
 			string fileArchiveExtension;
 			string fileArchiveExtractCommand;
@@ -145,12 +184,26 @@ namespace Shared {
 			virtual void signalQuit();
 			virtual bool shutdownAndWait();
 
+			// Must be set before start()
+			void setMaxConcurrentTransfers(int value) {
+				maxConcurrentTransfers = max(1, value);
+			}
+			// How often an interrupted download is resumed before giving up
+			void setMaxTransferRetries(int value) {
+				maxTransferRetries = max(0, value);
+			}
+			bool processRequestQueues();
+
 			void addMapToRequests(string mapFilename, string URL = "");
 			void addTilesetToRequests(string tileSetName, string URL = "");
 			void addTechtreeToRequests(string techtreeName, string URL = "");
 			void addScenarioToRequests(string fileName, string URL = "");
 			void addFileToRequests(string fileName, string URL = "");
 			void addTempFileToRequests(string fileName, string URL = "");
+			// destFolder is the local techtree folder the names of filesToFetch
+			// are relative to, filesToRemove holds full local paths
+			void addTechtreeFilesToRequests(string techtreeName, string destFolder,
+				const vector<string> &filesToFetch, const vector<string> &filesToRemove);
 
 			FTPClientCallbackInterface * getCallBackObject();
 			void setCallBackObject(FTPClientCallbackInterface *value);
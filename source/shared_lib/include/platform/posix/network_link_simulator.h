@@ -0,0 +1,155 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// network_link_simulator.h: in-process TCP relay that injects latency,
+// jitter, bandwidth limits and packet loss between a client and a server
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_PLATFORM_NETWORKLINKSIMULATOR_H_
+#define _SHARED_PLATFORM_NETWORKLINKSIMULATOR_H_
+
+#include "socket.h"
+#include "randomgen.h"
+#include <deque>
+#include <vector>
+#include <string>
+#include "leak_dumper.h"
+
+using namespace std;
+using Shared::Util::RandomGen;
+
+namespace Shared {
+	namespace Platform {
+
+		// =====================================================
+		//	class NetworkLinkConditions
+		//
+		//	Describes how one direction of a simulated link
+		//	behaves. The relay carries TCP, so a dropped or
+		//	reordered segment shows up the way TCP would expose
+		//	it to the game: as a retransmission stall or head of
+		//	line blocking, never as missing or shuffled bytes.
+		// =====================================================
+
+		class NetworkLinkConditions {
+		public:
+			int latencyMilliseconds;
+			int jitterMilliseconds;
+			// 0 means unlimited
+			int bandwidthBytesPerSecond;
+			// Chance in percent [0-100] that a segment is lost and retransmitted
+			int dropPercent;
+			int retransmitMilliseconds;
+			// Chance in percent [0-100] that a segment arrives late
+			int reorderPercent;
+			int reorderMilliseconds;
+			int randomSeed;
+
+			NetworkLinkConditions();
+
+			bool hasImpairment() const;
+			string toString() const;
+		};
+
+		class NetworkLinkStats {
+		public:
+			int64 bytesToServer;
+			int64 bytesToClient;
+			int64 segmentsRelayed;
+			int64 segmentsDropped;
+			int64 segmentsReordered;
+			int acceptedLinks;
+
+			NetworkLinkStats();
+		};
+
+		// =====================================================
+		//	class NetworkLinkSimulator
+		//
+		//	Listens on a local port and relays every accepted
+		//	connection to targetIp:targetPort, delaying the data
+		//	in each direction according to the link conditions.
+		// =====================================================
+
+		class NetworkLinkSimulator : public BaseThread {
+		protected:
+			class Segment {
+			public:
+				int64 deliverAtMillis;
+				std::vector<char> data;
+				size_t sentBytes;
+			};
+
+			class LinkDirection {
+			public:
+				std::deque<Segment> queue;
+				int64 wireFreeAtMillis;
+				int64 lastDeliverAtMillis;
+
+				LinkDirection();
+			};
+
+			class Link {
+			public:
+				Socket *clientSide;
+				ClientSocket *serverSide;
+				LinkDirection toServer;
+				LinkDirection toClient;
+
+				Link();
+				~Link();
+			};
+
+			Mutex *mutexLinkAccessor;
+			NetworkLinkConditions conditions;
+			NetworkLinkStats stats;
+			RandomGen random;
+
+			ServerSocket listenSocket;
+			string targetIp;
+			int targetPort;
+			std::vector<Link *> links;
+
+			void acceptLinks();
+			bool readSegments(Socket *source, LinkDirection &direction, bool towardsServer, const NetworkLinkConditions &linkConditions, int64 nowMillis);
+			bool writeSegments(Socket *destination, LinkDirection &direction, int64 nowMillis);
+			void closeLinks();
+
+		public:
+			NetworkLinkSimulator(const NetworkLinkConditions &conditions, string targetIp, int targetPort, int listenPort = 0);
+			virtual ~NetworkLinkSimulator();
+
+			virtual void execute();
+			virtual bool canShutdown(bool deleteSelfIfShutdownDelayed = false);
+
+			int getListenPort() const {
+				return listenSocket.getBindPort();
+			}
+
+			void setConditions(const NetworkLinkConditions &value);
+			NetworkLinkConditions getConditions();
+			NetworkLinkStats getStats();
+		};
+
+	}
+}//end namespace
+
+#endif
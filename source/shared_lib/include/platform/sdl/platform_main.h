@@ -51,6 +51,7 @@ const char  *GAME_ARGS[] = {
 	"--headless-server-status",
 	"--server-title",
 	"--use-ports",
+	"--headless-server-matches",
 
 	"--load-scenario",
 	"--load-mod",
@@ -135,6 +136,7 @@ enum GAME_ARG_TYPE {
 	GAME_ARG_MASTERSERVER_STATUS,
 	GAME_ARG_SERVER_TITLE,
 	GAME_ARG_USE_PORTS,
+	GAME_ARG_MASTERSERVER_MATCHES,
 
 	GAME_ARG_LOADSCENARIO,
 	GAME_ARG_MOD,
@@ -306,6 +308,19 @@ GAME_ARGS[GAME_ARG_USE_PORTS]);
 
 	printf("\n\n\
   %s=x\n\
+    Run 'x' headless servers side by side and restart each one after it\n\
+    quits. Server 'n' (counting from 0) listens on the ports given by\n\
+    %s shifted by n*11, so every server keeps its own FTP port range.\n\
+    Any %s options are passed on to every server.\n\
+    Every server is a separate process and loads its own copy of the\n\
+    game data, this only saves starting them one by one.\n\
+  NOTE: Not supported on Windows.",
+GAME_ARGS[GAME_ARG_MASTERSERVER_MATCHES],
+GAME_ARGS[GAME_ARG_USE_PORTS],
+GAME_ARGS[GAME_ARG_MASTERSERVER_MODE]);
+
+	printf("\n\n\
+  %s=x\n\
     Set server title.",
 GAME_ARGS[GAME_ARG_SERVER_TITLE]);
 
@@ -546,6 +561,8 @@ GAME_ARGS[GAME_ARG_VALIDATE_TECHTREES]);
 	printf("\n\n                     \tWhere x is one of the following data items to compress:");
 	printf("\n\n                     \t    techtrees, tilesets or all.");
 	printf("\n\n                     \tWhere y = include_main to include main (non mod) data.");
+	printf("\n\n                     \t    and/or packed to write indexed .zgp archives the game");
+	printf("\n\n                     \t    reads from directly (recreate them after editing the data).");
 	printf("\n\n                     \texample: %s %s=all", extractFileFromDirectoryPath(argv0).c_str(), GAME_ARGS[GAME_ARG_CREATE_DATA_ARCHIVES]);
 
 	printf("\n\n%s=x=y  ", GAME_ARGS[GAME_ARG_STEAM]);
@@ -718,6 +735,7 @@ int mainSetup(int argc, char **argv) {
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_VERSION])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_SHOW_INI_SETTINGS])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true ||
+		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_MATCHES])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_STATUS]))) {
 		// Use this for masterserver mode for timers like Chrono
 		if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
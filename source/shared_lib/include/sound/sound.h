@@ -13,15 +13,23 @@
 #define _SHARED_SOUND_SOUND_H_
 
 #include <string>
-#include "sound_file_loader.h" 
+#include <vector>
+#include "sound_file_loader.h"
+#include "thread.h"
 #include "leak_dumper.h"
 
 using namespace std;
 using namespace Shared::Platform;
 
 namespace Shared {
+	namespace PlatformCommon {
+		class BaseThread;
+	}
+
 	namespace Sound {
 
+		class SoundBuffer;
+
 		// =====================================================
 		//	class SoundInfo
 		// =====================================================
@@ -92,7 +100,7 @@ namespace Shared {
 
 			//static void setMasterserverMode(bool value) { masterserverMode=value; }
 
-			const SoundInfo *getInfo() const {
+			virtual const SoundInfo *getInfo() const {
 				return &info;
 			}
 			float getVolume() const {
@@ -113,15 +121,16 @@ namespace Shared {
 
 		class StaticSound : public Sound {
 		private:
-			int8 * samples;
+			// Shared with every other sound of the same file
+			SoundBuffer *buffer;
 
 		public:
 			StaticSound();
 			virtual ~StaticSound();
 
-			int8 *getSamples() const {
-				return samples;
-			}
+			// Both wait for the samples if they are still being decoded
+			virtual const SoundInfo *getInfo() const;
+			const int8 *getSamples() const;
 
 			void load(const string &path);
 			void close();
@@ -133,7 +142,24 @@ namespace Shared {
 
 		class StrSound : public Sound {
 		private:
+			static uint32 prefetchSize;
+
 			StrSound *next;
+			// Held while soundFileLoader is used, taken before prefetchMutex
+			Mutex *decodeMutex;
+			// Guards the prefetch buffer, never held while decoding
+			Mutex *prefetchMutex;
+			Shared::PlatformCommon::BaseThread *prefetchThread;
+			// Decoded but not yet read samples
+			vector<int8> prefetchBuffer;
+			// The chunk the prefetch thread is decoding
+			vector<int8> prefetchChunk;
+			uint32 prefetchStart;
+			uint32 prefetchCount;
+			bool prefetchEnded;
+
+			uint32 readFromPrefetchBuffer(int8 *samples, uint32 size);
+			void stopPrefetch();
 
 		public:
 			StrSound();
@@ -150,6 +176,12 @@ namespace Shared {
 			uint32 read(int8 *samples, uint32 size);
 			void close();
 			void restart();
+
+			// Decodes ahead of read() on an I/O thread, 0 reads on the caller
+			static void setPrefetchSize(uint32 size);
+			static uint32 getPrefetchSize();
+			// Prefetch thread side: decodes one more chunk, false when full
+			bool prefetchNextChunk();
 		};
 
 	}
@@ -0,0 +1,111 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// sound_buffer_cache.h: decoded sound samples shared by every sound
+// loaded from the same file
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_SOUND_SOUNDBUFFERCACHE_H_
+#define _SHARED_SOUND_SOUNDBUFFERCACHE_H_
+
+#include <string>
+#include <vector>
+#include "data_types.h"
+#include "sound.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+
+namespace Shared {
+	namespace Sound {
+
+		using Platform::int8;
+
+		// =====================================================
+		//	class SoundBuffer
+		//
+		//	The samples of one sound file, never changed once
+		//	decoded. Owned by SoundBufferCache.
+		// =====================================================
+
+		class SoundBuffer {
+		private:
+			friend class SoundBufferCache;
+
+			string path;
+			SoundInfo info;
+			vector<int8> samples;
+			bool decoding;
+			bool decoded;
+			int refCount;
+
+			SoundBuffer() : decoding(false), decoded(false), refCount(0) {
+			}
+
+		public:
+			const string &getPath() const {
+				return path;
+			}
+			// Only valid once SoundBufferCache::waitUntilDecoded returned
+			const SoundInfo *getInfo() const {
+				return &info;
+			}
+			const int8 *getSamples() const {
+				return (samples.empty() == true ? NULL : &samples[0]);
+			}
+		};
+
+		// =====================================================
+		//	class SoundBufferCache
+		//
+		//	Hands out one buffer per sound file no matter how many
+		//	sounds use it, and frees it once the last one is
+		//	released. While worker threads run, files are decoded
+		//	in the background; whoever needs the samples first
+		//	decodes them itself if no worker got to it yet.
+		// =====================================================
+
+		class SoundBufferCache {
+		private:
+			static void decodeQueued(SoundBuffer *buffer, Platform::MutexSafeWrapper &safeMutex);
+
+		public:
+			static void start(int threadCount);
+			static void stop();
+			static bool isRunning();
+
+			// Throws if the file does not exist. Decoding errors are logged
+			// and leave the buffer empty; it is not kept for later callers
+			static SoundBuffer *acquire(const string &path);
+			static void release(SoundBuffer *buffer);
+			static void waitUntilDecoded(SoundBuffer *buffer);
+
+			static int getBufferCount();
+
+			// Worker side: decodes the next queued file, false when idle
+			static bool processNextDecode();
+		};
+
+	}
+}//end namespace
+
+#endif
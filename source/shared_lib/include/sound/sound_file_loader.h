@@ -14,6 +14,7 @@
 
 #include <string>
 #include <fstream>
+#include <sstream>
 #include "data_types.h"
 #include "factory.h"
 #include "leak_dumper.h"
@@ -64,9 +65,14 @@ namespace Shared {
 			uint32 dataOffset;
 			uint32 dataSize;
 			uint32 bytesPerSecond;
-			ifstream f;
+			ifstream file;
+			// Holds the whole file when it comes from a data archive
+			std::istringstream archivedFile;
+			// Whichever of the two is being read
+			std::istream *f;
 
 		public:
+			WavSoundFileLoader();
 			virtual void open(const string &path, SoundInfo *soundInfo);
 			virtual uint32 read(int8 *samples, uint32 size);
 			virtual void close();
@@ -14,6 +14,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include "data_types.h"
 #include "thread.h"
 #include "leak_dumper.h"
@@ -38,9 +39,11 @@ namespace Shared {
 
 			static Mutex fileListCacheSynchAccessor;
 			static std::map<string, uint32> fileListCache;
+			static int fileThreadCount;
 
 			void addSum(uint32 value);
 			bool addFileToSum(const string &path);
+			static void computeFileSums(const std::vector<string> &paths, std::vector<uint32> &sums);
 
 		public:
 			Checksum();
@@ -57,9 +60,25 @@ namespace Shared {
 			uint32 addUInt(const uint32 &value);
 			uint32 addInt64(const int64 &value);
 			void addFile(const string &path);
+			// Adds a file whose sum is already known, it is never read
+			void addFile(const string &path, uint32 fileSum);
 
 			static void removeFileFromCache(const string file);
 			static void clearFileCache();
+
+			// Sum of a single file as used by getSum, bypassing the cache
+			static uint32 getFileSum(const string &path);
+
+			// Number of threads getSum uses to hash files that are not cached
+			// yet, the result is the same for any count
+			static void setFileThreadCount(int value);
+			static int getFileThreadCount();
+
+			// Keeps file sums across runs in path, a file is only hashed again
+			// once its size, modification time or inode changes. An empty
+			// path turns the persistent cache off
+			static void setFileCRCCacheFile(const string &path);
+			static string getFileCRCCacheFile();
 		};
 
 	}
@@ -0,0 +1,119 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// merkle_manifest.h: hash tree over a folder's file checksums, used to
+// find the files that differ between two copies of the same game data
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_UTIL_MERKLEMANIFEST_H_
+#define _SHARED_UTIL_MERKLEMANIFEST_H_
+
+#include <string>
+#include <map>
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+using namespace Shared::Platform;
+
+namespace Shared {
+	namespace Util {
+
+		class MerkleManifestDiff {
+		public:
+			vector<string> changed;
+			vector<string> missingLocally;
+			vector<string> missingRemotely;
+			// How many tree nodes had to be visited, identical subtrees are skipped
+			int nodesCompared;
+
+			MerkleManifestDiff() : nodesCompared(0) {
+			}
+			bool empty() const {
+				return changed.empty() && missingLocally.empty() && missingRemotely.empty();
+			}
+		};
+
+		// =====================================================
+		//	class MerkleManifest
+		//
+		//	Folder tree where every file carries its CRC and every
+		//	folder the hash of its children. Two manifests with the
+		//	same root hash hold the same data, otherwise diff() only
+		//	descends into the folders whose hashes differ.
+		// =====================================================
+
+		class MerkleManifest {
+		private:
+			class Node {
+			public:
+				uint32 hash;
+				bool isFile;
+				std::map<string, Node *> children;
+
+				Node();
+				~Node();
+			};
+
+			Node *root;
+			int fileCount;
+
+			// Not copyable
+			MerkleManifest(const MerkleManifest &);
+			MerkleManifest & operator=(const MerkleManifest &);
+
+			void addFile(const string &relativePath, uint32 crc);
+			const Node * findNode(const string &relativePath) const;
+
+			static uint32 computeHash(Node *node);
+			static void collectFiles(const Node *node, const string &path, vector<string> &fileList);
+			static void diffNodes(const Node *local, const Node *remote, const string &path, MerkleManifestDiff &result);
+
+		public:
+			MerkleManifest();
+			~MerkleManifest();
+
+			// Builds the tree from a getFolderTreeContentsCheckSumListRecursively
+			// result. Paths are stored relative to whichever of rootFolders (the
+			// techtree folder in each data path) they start with, so copies
+			// installed in different locations still compare equal. Paths under
+			// none of them are taken as already relative.
+			void build(const vector<std::pair<string, uint32> > &fileList, const vector<string> &rootFolders);
+			void clear();
+
+			static string getRelativePath(const string &path, const vector<string> &rootFolders);
+			static void getRelativeFileList(vector<std::pair<string, uint32> > &fileList, const vector<string> &rootFolders);
+
+			uint32 getRootHash() const;
+			int getFileCount() const {
+				return fileCount;
+			}
+			bool getHash(const string &relativePath, uint32 &hash) const;
+
+			void diff(const MerkleManifest &remote, MerkleManifestDiff &result) const;
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -0,0 +1,90 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// summed_area_table.h: counts marked cells of any square of a grid
+// in constant time, e.g. to find where a building fits
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifndef _SHARED_UTIL_SUMMEDAREATABLE_H_
+#define _SHARED_UTIL_SUMMEDAREATABLE_H_
+
+#include <vector>
+#include "leak_dumper.h"
+
+using std::vector;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class SummedAreaTable
+		//
+		//	Covers a window of a larger grid starting at originX,
+		//	originY. Cells are marked, then build() turns the marks
+		//	into sums so any square is counted with four lookups.
+		//	Cells outside the window count as marked.
+		// =====================================================
+
+		class SummedAreaTable {
+		private:
+			int originX;
+			int originY;
+			int w;
+			int h;
+			bool built;
+			// (w + 1) * (h + 1), entry x, y sums the cells left of and
+			// above it
+			vector<int> sums;
+
+			int getSum(int x, int y) const {
+				return sums[y * (w + 1) + x];
+			}
+
+		public:
+			SummedAreaTable();
+
+			void init(int originX, int originY, int w, int h);
+			void mark(int x, int y);
+			void build();
+
+			int getCount(int x, int y, int size) const;
+			bool isClear(int x, int y, int size) const {
+				return getCount(x, y, size) == 0;
+			}
+
+			int getOriginX() const {
+				return originX;
+			}
+			int getOriginY() const {
+				return originY;
+			}
+			int getW() const {
+				return w;
+			}
+			int getH() const {
+				return h;
+			}
+		};
+
+	}
+}//end namespace
+
+#endif
@@ -159,13 +159,73 @@ namespace Shared {
 			}
 		};
 
+		// =====================================================
+		//	class XmlTreePreloader
+		//
+		//	Parses a list of XML files on worker threads while the
+		//	caller is still busy with earlier ones. XmlTree::load
+		//	takes the parsed result when the path and tag replacement
+		//	values match, so loaders need no changes of their own.
+		// =====================================================
+
+		class XmlTreePreloader {
+		public:
+			// Queues the files in the order they will be loaded and starts
+			// threadCount workers (nothing is done for threadCount <= 0)
+			static void start(const vector<string> &pathList, const std::map<string, string> &mapTagReplacementValues, int threadCount);
+			// Waits for the workers and frees anything that was not picked up
+			static void stop();
+			static bool isRunning();
+
+			// Returns the parsed root node for path, waiting if a worker is
+			// busy with it, or NULL if the caller has to parse it itself
+			static XmlNode * takePreloaded(const string &path, const std::map<string, string> &mapTagReplacementValues);
+
+			// Parses the next queued file, returns false once the queue is empty
+			static bool processNextFile();
+		};
+
+		// =====================================================
+		//	class XmlTreeCache
+		//
+		//	Keeps the parsed, tag replaced trees of a folder of XML
+		//	files in one binary file. While a cache is open
+		//	XmlTree::load takes files below its path prefix from it
+		//	instead of parsing them, and adds the ones it was missing.
+		//	The cache is thrown away whenever the folder CRC or the tag
+		//	replacement values it was written for change.
+		//
+		//	Only the XML step is skipped: the cache holds XmlNode trees,
+		//	not the built tech tree, faction or unit types, which are
+		//	still created from those trees on every load.
+		// =====================================================
+
+		class XmlTreeCache {
+		public:
+			static const Shared::Platform::uint32 version;
+
+			// Reads cacheFile if it was written for the same crc and tag values
+			static void open(const string &cacheFile, Shared::Platform::uint32 crc, const string &pathPrefix, const std::map<string, string> &mapTagReplacementValues);
+			// Writes the cache back when files were added to it and save is true
+			static void close(bool save);
+			static bool isOpen();
+
+			static bool hasFile(const string &path);
+			static int getFileCount();
+
+			// Returns a new tree for path or NULL if it isn't cached
+			static XmlNode * takeCached(const string &path, const std::map<string, string> &mapTagReplacementValues);
+			static void add(const string &path, const std::map<string, string> &mapTagReplacementValues, const XmlNode *rootNode);
+		};
+
 		// =====================================================
 		//	class XmlNode
 		// =====================================================
 
 		class XmlNode {
 		private:
-			string name;
+			// Interned, see XmlNode::internName
+			const string *name;
 			string text;
 			vector<XmlNode*> children;
 			vector<XmlAttribute*> attributes;
@@ -191,12 +251,20 @@ namespace Shared {
 			XmlNode(const string &name);
 			~XmlNode();
 
+			// Element and attribute names come from a small vocabulary, so
+			// every node shares one copy of each instead of owning its own
+			static const string * internName(const string &name);
+
+			// Binary form of the node and its children used by XmlTreeCache
+			void writeCompiled(string &buffer) const;
+			static XmlNode * readCompiled(const char *&data, const char *dataEnd);
+
 			void setSuper(const XmlNode* superNode) const {
 				this->superNode = superNode;
 			}
 
 			const string &getName() const {
-				return name;
+				return *name;
 			}
 			size_t getChildCount() const {
 				return children.size();
@@ -234,15 +302,18 @@ namespace Shared {
 		class XmlAttribute {
 		private:
 			string value;
-			string name;
+			// Interned, see XmlNode::internName
+			const string *name;
 			bool skipRestrictionCheck;
 			bool usesCommondata;
-			std::map<string, string> mapTagReplacementValues;
 
 		private:
 			XmlAttribute(XmlAttribute&);
 			void operator =(XmlAttribute&);
 
+			friend class XmlNode;
+			XmlAttribute(const string &name, const string &value, bool skipRestrictionCheck, bool usesCommondata);
+
 		public:
 
 #if defined(WANT_XERCES)
@@ -255,8 +326,8 @@ namespace Shared {
 			XmlAttribute(const string &name, const string &value, const std::map<string, string> &mapTagReplacementValues);
 
 		public:
-			const string getName() const {
-				return name;
+			const string &getName() const {
+				return *name;
 			}
 			const string getValue(string prefixValue = "", bool trimValueWithStartingSlash = false) const;
 
@@ -463,6 +463,14 @@ LOCAL int ftpCmdRetr(int sessionId, const char* args, int len) {
 		}
 	}
 
+	// The client's partial copy is longer than the file, it belongs to another version
+	if (ftpGetSession(sessionId)->restartOffset > fileInfo.size) {
+		if (VERBOSE_MODE_ENABLED) printf("ERROR In ftpCmdRetr restart position %u past the end of [%s]\n", ftpGetSession(sessionId)->restartOffset, realPath);
+
+		ftpGetSession(sessionId)->restartOffset = 0;
+		ftpSendMsg(MSG_NORMAL, sessionId, 554, ftpMsg042);
+		return 2;
+	}
 
 	if (ftpGetSession(sessionId)->passive == FALSE) {
 		s = ftpEstablishDataConnection(FALSE, &ftpGetSession(sessionId)->remoteIp, &ftpGetSession(sessionId)->remoteDataPort, sessionId);
@@ -486,7 +494,15 @@ LOCAL int ftpCmdRetr(int sessionId, const char* args, int len) {
 
 	fp = ftpOpenFile(realPath, "rb");
 	if (fp) {
-		if (VERBOSE_MODE_ENABLED) printf("In ftpCmdRetr opened realPath [%s] [%p] for sessionId = %d for socket = %d\n", realPath, fp, sessionId, s);
+		uint32_t restartOffset = ftpGetSession(sessionId)->restartOffset;
+		ftpGetSession(sessionId)->restartOffset = 0;
+
+		if (VERBOSE_MODE_ENABLED) printf("In ftpCmdRetr opened realPath [%s] [%p] for sessionId = %d for socket = %d restartOffset = %u\n", realPath, fp, sessionId, s, restartOffset);
+
+		// Resume a partial download (REST), the client already has the first restartOffset bytes
+		if (restartOffset > 0 && fseek((FILE *) fp, restartOffset, SEEK_SET) == 0) {
+			fileInfo.size -= restartOffset;
+		}
 
 		ftpOpenTransmission(sessionId, OP_RETR, fp, s, fileInfo.size);
 		ftpExecTransmission(sessionId);
@@ -503,6 +519,21 @@ LOCAL int ftpCmdRetr(int sessionId, const char* args, int len) {
 	return 0;
 }
 
+LOCAL int ftpCmdRest(int sessionId, const char* args, int len) {
+	char *endPtr = NULL;
+	unsigned long offset = strtoul(args, &endPtr, 10);
+
+	if (len <= 0 || endPtr == args) {
+		ftpSendMsg(MSG_NORMAL, sessionId, 501, ftpMsg042);
+		return 2;
+	}
+
+	ftpGetSession(sessionId)->restartOffset = (uint32_t) offset;
+	ftpSendMsg(MSG_NORMAL, sessionId, 350, ftpMsg041);
+
+	return 0;
+}
+
 LOCAL int ftpCmdStor(int sessionId, const char* args, int len) {
 	socket_t s;
 	void* fp;
@@ -817,6 +848,7 @@ static const ftpCommand_S cmds[] = {
 		{"CWD",  3,	FTP_ACC_DIR,  	TRUE,  FALSE, FALSE, ftpCmdCwd},
 		{"CDUP", 4,	FTP_ACC_DIR, 	TRUE,  FALSE, FALSE, ftpCmdCdup},
 		{"STRU", 4,	0,  			TRUE,  FALSE, FALSE, ftpCmdStru},
+		{"REST", 4,	FTP_ACC_RD,  	TRUE,  TRUE,  FALSE, ftpCmdRest},
 		{"RETR", 4,	FTP_ACC_RD,  	TRUE,  FALSE, FALSE, ftpCmdRetr},
 		{"STOR", 4,	FTP_ACC_WR,  	TRUE,  FALSE, FALSE, ftpCmdStor},
 		{"DELE", 4,	FTP_ACC_WR,  	TRUE,  FALSE, FALSE, ftpCmdDele},
@@ -64,3 +64,5 @@ const char ftpMsg037[] = "Hi";
 const char ftpMsg038[] = "Could not open directory.";
 const char ftpMsg039[] = "Could not read directory.";
 const char ftpMsg040[] = "Aborted.";
+const char ftpMsg041[] = "Restart position accepted";
+const char ftpMsg042[] = "Invalid restart position";
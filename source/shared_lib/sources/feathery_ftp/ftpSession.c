@@ -83,6 +83,7 @@ int ftpOpenSession(socket_t ctrlSocket, ip_t remoteIp, port_t remotePort) {
 			sessions[n].activeTrans.fsHandle = NULL;
 			sessions[n].activeTrans.dataSocket = -1;
 			sessions[n].activeTrans.fileSize = 0;
+			sessions[n].restartOffset = 0;
 
 			if (VERBOSE_MODE_ENABLED) printf("ftpOpenSession started for ctrlSocket: %d\n", ctrlSocket);
 
@@ -145,6 +146,7 @@ int ftpCloseSession(int id) {
 	sessions[id].activeTrans.dataSocket = 0;
 	sessions[id].activeTrans.op = OP_NOP;
 	sessions[id].activeTrans.fileSize = 0;
+	sessions[id].restartOffset = 0;
 	sessions[id].open = FALSE;
 
 	if (VERBOSE_MODE_ENABLED) printf("Session %d closed\n", id);
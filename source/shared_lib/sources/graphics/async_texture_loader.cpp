@@ -0,0 +1,297 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// async_texture_loader.cpp: decodes texture images on worker threads and
+// hands them to the main thread for upload
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "async_texture_loader.h"
+
+#include <list>
+#include <vector>
+#include "base_thread.h"
+#include "platform_util.h"
+#include "conversion.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Shared {
+	namespace Graphics {
+
+		// =====================================================
+		//	class AsyncTextureRequest
+		// =====================================================
+
+		class AsyncTextureRequest {
+		public:
+			// NULL once the texture was ended while a worker was decoding it
+			Texture2D *texture;
+			string path;
+			int components;
+			Texture::Filter filter;
+			int maxAnisotropy;
+
+			bool decoding;
+			bool failed;
+			string error;
+			Pixmap2D *decoded;
+
+			AsyncTextureRequest() : texture(NULL), components(-1), filter(Texture::fBilinear),
+				maxAnisotropy(1), decoding(false), failed(false), decoded(NULL) {
+			}
+			~AsyncTextureRequest() {
+				delete decoded;
+				decoded = NULL;
+			}
+			bool isReady() const {
+				return decoded != NULL || failed == true;
+			}
+		};
+
+		// =====================================================
+		//	class AsyncTextureLoaderThread
+		// =====================================================
+
+		class AsyncTextureLoaderThread : public BaseThread {
+		public:
+			AsyncTextureLoaderThread() : BaseThread() {
+				uniqueID = "AsyncTextureLoaderThread";
+			}
+
+			virtual void execute() {
+				{
+					RunningStatusSafeWrapper runningStatus(this);
+					while (getQuitStatus() == false) {
+						if (AsyncTextureLoader::processNextDecode() == false) {
+							sleep(5);
+						}
+					}
+				}
+				deleteSelfIfRequired();
+			}
+		};
+
+		// =====================================================
+		//	class AsyncTextureLoader
+		// =====================================================
+
+		const int AsyncTextureLoader::maxQueuedUploads = 16;
+
+		static Mutex asyncTextureMutex;
+		static std::list<AsyncTextureRequest *> asyncTextureRequests;
+		static int asyncTextureDecodedCount = 0;
+		static vector<AsyncTextureLoaderThread *> asyncTextureThreads;
+
+		void AsyncTextureLoader::start(int threadCount) {
+			stop();
+			for (int i = 0; i < threadCount; ++i) {
+				AsyncTextureLoaderThread *thread = new AsyncTextureLoaderThread();
+				asyncTextureThreads.push_back(thread);
+				thread->start();
+			}
+		}
+
+		void AsyncTextureLoader::stop() {
+			for (unsigned int i = 0; i < asyncTextureThreads.size(); ++i) {
+				asyncTextureThreads[i]->signalQuit();
+			}
+			// No worker may still be decoding a request freed below
+			for (unsigned int i = 0; i < asyncTextureThreads.size(); ++i) {
+				asyncTextureThreads[i]->shutdownAndJoin();
+				delete asyncTextureThreads[i];
+			}
+			asyncTextureThreads.clear();
+
+			// Whatever is left keeps its placeholder
+			MutexSafeWrapper safeMutex(&asyncTextureMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			for (std::list<AsyncTextureRequest *>::iterator iterList = asyncTextureRequests.begin();
+				iterList != asyncTextureRequests.end(); ++iterList) {
+				delete *iterList;
+			}
+			asyncTextureRequests.clear();
+			asyncTextureDecodedCount = 0;
+		}
+
+		bool AsyncTextureLoader::isRunning() {
+			return asyncTextureThreads.empty() == false;
+		}
+
+		void AsyncTextureLoader::load(Texture2D *texture, const string &path, Texture::Filter filter, int maxAnisotropy) {
+			if (texture == NULL) {
+				return;
+			}
+			if (isRunning() == false) {
+				texture->load(path);
+				return;
+			}
+
+			cancel(texture);
+			texture->initPlaceholder(path);
+
+			AsyncTextureRequest *request = new AsyncTextureRequest();
+			request->texture = texture;
+			request->path = path;
+			request->components = texture->getPixmapConst()->getComponents();
+			request->filter = filter;
+			request->maxAnisotropy = maxAnisotropy;
+
+			MutexSafeWrapper safeMutex(&asyncTextureMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			asyncTextureRequests.push_back(request);
+		}
+
+		void AsyncTextureLoader::cancel(const Texture *texture) {
+			MutexSafeWrapper safeMutex(&asyncTextureMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			for (std::list<AsyncTextureRequest *>::iterator iterList = asyncTextureRequests.begin();
+				iterList != asyncTextureRequests.end();) {
+				AsyncTextureRequest *request = *iterList;
+				if (request->texture != texture) {
+					++iterList;
+				} else if (request->decoding == true) {
+					// The worker drops it when it is done
+					request->texture = NULL;
+					++iterList;
+				} else {
+					if (request->decoded != NULL) {
+						asyncTextureDecodedCount--;
+					}
+					delete request;
+					iterList = asyncTextureRequests.erase(iterList);
+				}
+			}
+		}
+
+		bool AsyncTextureLoader::isPending(const Texture *texture) {
+			MutexSafeWrapper safeMutex(&asyncTextureMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			for (std::list<AsyncTextureRequest *>::iterator iterList = asyncTextureRequests.begin();
+				iterList != asyncTextureRequests.end(); ++iterList) {
+				if ((*iterList)->texture == texture) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		int AsyncTextureLoader::getPendingCount() {
+			MutexSafeWrapper safeMutex(&asyncTextureMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return (int) asyncTextureRequests.size();
+		}
+
+		bool AsyncTextureLoader::processNextDecode() {
+			MutexSafeWrapper safeMutex(&asyncTextureMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			// Bound the memory held by decoded images the main thread has not taken yet
+			if (asyncTextureDecodedCount >= maxQueuedUploads) {
+				return false;
+			}
+
+			AsyncTextureRequest *request = NULL;
+			for (std::list<AsyncTextureRequest *>::iterator iterList = asyncTextureRequests.begin();
+				iterList != asyncTextureRequests.end(); ++iterList) {
+				if ((*iterList)->decoding == false && (*iterList)->isReady() == false) {
+					request = *iterList;
+					break;
+				}
+			}
+			if (request == NULL) {
+				return false;
+			}
+			request->decoding = true;
+			string path = request->path;
+			int components = request->components;
+			safeMutex.ReleaseLock(true);
+
+			Pixmap2D *pixmap = NULL;
+			string error = "";
+			try {
+				pixmap = new Pixmap2D(components);
+				pixmap->load(path);
+			} catch (const exception &ex) {
+				error = ex.what();
+				delete pixmap;
+				pixmap = NULL;
+			}
+
+			safeMutex.Lock();
+			request->decoding = false;
+			if (request->texture == NULL) {
+				delete pixmap;
+				asyncTextureRequests.remove(request);
+				delete request;
+			} else if (pixmap == NULL) {
+				request->failed = true;
+				request->error = error;
+			} else {
+				request->decoded = pixmap;
+				asyncTextureDecodedCount++;
+			}
+			return true;
+		}
+
+		int AsyncTextureLoader::processUploads(int maxMillis) {
+			int uploadCount = 0;
+			Chrono chrono(true);
+			for (;;) {
+				MutexSafeWrapper safeMutex(&asyncTextureMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+				AsyncTextureRequest *request = NULL;
+				for (std::list<AsyncTextureRequest *>::iterator iterList = asyncTextureRequests.begin();
+					iterList != asyncTextureRequests.end(); ++iterList) {
+					if ((*iterList)->isReady() == true) {
+						request = *iterList;
+						asyncTextureRequests.erase(iterList);
+						break;
+					}
+				}
+				if (request == NULL) {
+					break;
+				}
+				if (request->decoded != NULL) {
+					asyncTextureDecodedCount--;
+				}
+				safeMutex.ReleaseLock();
+
+				Texture2D *texture = request->texture;
+				if (request->failed == true) {
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error loading texture [%s]: %s\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, request->path.c_str(), request->error.c_str());
+				} else {
+					bool wasInited = texture->getInited();
+
+					// Swap the placeholder for the real image
+					texture->end(false);
+					texture->getPixmap()->transferFrom(request->decoded);
+					if (wasInited == true) {
+						texture->init(request->filter, request->maxAnisotropy);
+					}
+					uploadCount++;
+				}
+				delete request;
+
+				if (chrono.getMillis() >= maxMillis) {
+					break;
+				}
+			}
+			return uploadCount;
+		}
+
+	}
+}//end namespace
@@ -29,6 +29,7 @@ using namespace Shared::Graphics::Gl;
 #endif
 
 #include "util.h"
+#include "string_utils.h"
 #include "platform_common.h"
 #include "platform_util.h"
 
@@ -82,6 +83,7 @@ namespace Shared {
 
 			Font::faceResolution = 72;
 			Font::langHeightText = "yW";
+			TextLayoutCache::shapingGeneration++;
 
 #if defined(WIN32)
 			string newEnvValue = "MEGAGLEST_FONT=";
@@ -98,7 +100,7 @@ namespace Shared {
 		//	class FontMetrics
 		// =====================================================
 
-		FontMetrics::FontMetrics(Text *textHandler) {
+		FontMetrics::FontMetrics(Text *textHandler) : layoutCache(textHandler) {
 			this->textHandler = textHandler;
 			//SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] this->textHandler = [%p] Owner = [%p]\n", __FILE__, __FUNCTION__, __LINE__, this->textHandler,this);
 			this->widths = new float[Font::charCount];
@@ -116,6 +118,7 @@ namespace Shared {
 
 		void FontMetrics::setTextHandler(Text *textHandler) {
 			this->textHandler = textHandler;
+			layoutCache.setTextHandler(textHandler);
 			//SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] this->textHandler = [%p] Owner = [%p]\n", __FILE__, __FUNCTION__, __LINE__, this->textHandler, this);
 		}
 
@@ -124,6 +127,10 @@ namespace Shared {
 		}
 
 		float FontMetrics::getTextWidth(const string &str) {
+			if (textHandler != NULL) {
+				return (layoutCache.getTextWidth(str) * Font::scaleFontValue);
+			}
+
 			string longestLine = "";
 			size_t found = str.find("\n");
 			if (found == string::npos) {
@@ -141,29 +148,25 @@ namespace Shared {
 				}
 			}
 
-			if (textHandler != NULL) {
-				return (textHandler->Advance(longestLine.c_str()) * Font::scaleFontValue);
-			} else {
-				float width = 0.f;
-				for (unsigned int i = 0; i < longestLine.size() && (int) i < Font::charCount; ++i) {
-					if (longestLine[i] >= Font::charCount) {
-						string sError = "str[i] >= Font::charCount, [" + longestLine + "] i = " + uIntToStr(i);
-						throw megaglest_runtime_error(sError);
-					}
-					//Treat 2 byte characters as spaces
-					if (longestLine[i] < 0) {
-						width += (widths[97]); // This is the letter a which is a normal wide character and good to use for spacing
-					} else {
-						width += widths[(int) longestLine[i]];
-					}
+			float width = 0.f;
+			for (unsigned int i = 0; i < longestLine.size() && (int) i < Font::charCount; ++i) {
+				if (longestLine[i] >= Font::charCount) {
+					string sError = "str[i] >= Font::charCount, [" + longestLine + "] i = " + uIntToStr(i);
+					throw megaglest_runtime_error(sError);
+				}
+				//Treat 2 byte characters as spaces
+				if (longestLine[i] < 0) {
+					width += (widths[97]); // This is the letter a which is a normal wide character and good to use for spacing
+				} else {
+					width += widths[(int) longestLine[i]];
 				}
-				return width;
 			}
+			return width;
 		}
 
 		float FontMetrics::getHeight(const string &str) const {
 			if (textHandler != NULL) {
-				return (textHandler->LineHeight(str.c_str()));
+				return layoutCache.getLineHeight();
 			} else {
 				return height;
 			}
@@ -214,6 +217,7 @@ namespace Shared {
 			size = 10;
 			this->textHandler = NULL;
 			//SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] this->textHandler = [%p] Owner = [%p]\n", __FILE__, __FUNCTION__, __LINE__, this->textHandler, this);
+			metrics.getLayoutCache()->setShaper(type == ftht_3D ? &Font::shapeText3D : &Font::shapeText2D);
 
 #if defined(USE_FTGL)
 
@@ -303,6 +307,27 @@ namespace Shared {
 		//	return !is_non_ASCII(c);
 		//}
 
+		// Matches what the 2D text renderer did to each string before
+		// drawing it
+		void Font::shapeText2D(string &text, bool hasTextHandler) {
+			Font::bidi_cvt(text);
+			if (hasTextHandler == true && Font::fontIsRightToLeft == true) {
+				if (is_string_all_ascii(text) == false) {
+					strrev_utf8(text);
+				}
+			}
+		}
+
+		void Font::shapeText3D(string &text, bool hasTextHandler) {
+			Font::bidi_cvt(text);
+			if (hasTextHandler == true && Font::fontIsMultibyte == true &&
+				Font::fontIsRightToLeft == true) {
+				if (is_string_all_ascii(text) == false) {
+					strrev_utf8(text);
+				}
+			}
+		}
+
 		void Font::bidi_cvt(string &str_) {
 
 #ifdef	HAVE_FRIBIDI
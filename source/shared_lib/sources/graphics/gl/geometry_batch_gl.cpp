@@ -0,0 +1,136 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// geometry_batch_gl.cpp: small effect geometry gathered in client side
+// arrays and drawn with one call per texture and primitive type
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "geometry_batch_gl.h"
+
+#include <stddef.h>
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+
+namespace Shared {
+	namespace Graphics {
+		namespace Gl {
+
+			// =====================================================
+			//	class GeometryBatchGl
+			// =====================================================
+
+			GeometryBatchGl::GeometryBatchGl() : currentColor(1.f, 1.f, 1.f, 1.f), currentTexCoord(0.f, 0.f) {
+			}
+
+			void GeometryBatchGl::begin(GLenum primitive, GLuint textureHandle) {
+				if (primitive != GL_POINTS && primitive != GL_LINES &&
+					primitive != GL_TRIANGLES && primitive != GL_QUADS) {
+					throw megaglest_runtime_error("GeometryBatchGl can not join primitive type: " + intToStr(primitive));
+				}
+				if (draws.empty() == false && draws.back().primitive == primitive &&
+					draws.back().textureHandle == textureHandle) {
+					return;
+				}
+				Draw draw;
+				draw.primitive = primitive;
+				draw.textureHandle = textureHandle;
+				draw.first = (int) vertices.size();
+				draw.count = 0;
+				draws.push_back(draw);
+			}
+
+			void GeometryBatchGl::vertex(const Vec3f &pos) {
+				assert(draws.empty() == false);
+				Vertex vertex;
+				vertex.texCoord = currentTexCoord;
+				vertex.color = currentColor;
+				vertex.pos = pos;
+				vertices.push_back(vertex);
+				draws.back().count++;
+			}
+
+			void GeometryBatchGl::flush() {
+				if (vertices.empty() == true) {
+					clear();
+					return;
+				}
+
+				assertGl();
+
+				GLboolean textureEnabled = glIsEnabled(GL_TEXTURE_2D);
+				bool textured = (textureEnabled == GL_TRUE);
+				GLuint lastTextureHandle = 0;
+
+				glPushAttrib(GL_CURRENT_BIT);
+				glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+				glEnableClientState(GL_VERTEX_ARRAY);
+				glEnableClientState(GL_COLOR_ARRAY);
+				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+				const char *base = reinterpret_cast<const char *>(&vertices[0]);
+				glVertexPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, pos));
+				glColorPointer(4, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, color));
+				glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, texCoord));
+
+				for (unsigned int i = 0; i < draws.size(); ++i) {
+					const Draw &draw = draws[i];
+					if (draw.count == 0) {
+						continue;
+					}
+					if (draw.textureHandle != 0) {
+						if (textured == false) {
+							glEnable(GL_TEXTURE_2D);
+							textured = true;
+						}
+						if (draw.textureHandle != lastTextureHandle) {
+							glBindTexture(GL_TEXTURE_2D, draw.textureHandle);
+							lastTextureHandle = draw.textureHandle;
+						}
+					} else if (textured == true) {
+						glDisable(GL_TEXTURE_2D);
+						textured = false;
+					}
+					glDrawArrays(draw.primitive, draw.first, draw.count);
+				}
+
+				if (textured != (textureEnabled == GL_TRUE)) {
+					if (textured == true) {
+						glDisable(GL_TEXTURE_2D);
+					} else {
+						glEnable(GL_TEXTURE_2D);
+					}
+				}
+				glPopClientAttrib();
+				glPopAttrib();
+
+				assertGl();
+
+				clear();
+			}
+
+			void GeometryBatchGl::clear() {
+				vertices.clear();
+				draws.clear();
+			}
+
+		}
+	}
+}//end namespace
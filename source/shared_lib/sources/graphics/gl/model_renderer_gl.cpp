@@ -31,11 +31,26 @@ namespace Shared {
 			void MeshCallback::execute(const Mesh *mesh, float alpha) {
 				alpha *= mesh->getOpacity();
 				uint8 factionOpacity = mesh->getFactionColorOpacity(); //team color
+				bool teamColors = !(!mesh->getCustomTexture() || factionOpacity == 0 || teamTexture == NULL || MeshCallback::noTeamColors);
+				// The alpha only matters once faded, the opacity only with team colors
+				float stateAlpha = (alpha < 1.f - FLT_EPSILON ? alpha : 1.f);
+				uint8 stateFactionOpacity = (teamColors ? factionOpacity : 0);
+				if (applied == true && appliedTeamTexture == teamTexture &&
+					appliedTeamColors == teamColors && appliedFactionOpacity == stateFactionOpacity &&
+					appliedAlpha == stateAlpha) {
+					return;
+				}
+				applied = true;
+				appliedTeamTexture = teamTexture;
+				appliedTeamColors = teamColors;
+				appliedFactionOpacity = stateFactionOpacity;
+				appliedAlpha = stateAlpha;
+
 				float color[4];
 				color[0] = 1.0f; // Red
 				color[1] = 1.0f; // Green
 				color[2] = 1.0f; // Blue
-				if (!mesh->getCustomTexture() || factionOpacity == 0 || teamTexture == NULL || MeshCallback::noTeamColors) {
+				if (teamColors == false) {
 					glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 					glActiveTexture(GL_TEXTURE1);
 					if (alpha < 1.f - FLT_EPSILON) {
@@ -140,6 +155,8 @@ namespace Shared {
 				duplicateTexCoords = false;
 				secondaryTexCoordUnit = 1;
 				lastTexture = 0;
+				lastTwoSided = -1;
+				lastGlow = -1;
 			}
 
 			void ModelRendererGl::begin(bool renderNormals, bool renderTextures, bool renderColors,
@@ -156,6 +173,11 @@ namespace Shared {
 
 				rendering = true;
 				lastTexture = 0;
+				lastTwoSided = -1;
+				lastGlow = -1;
+				if (meshCallback != NULL) {
+					meshCallback->reset();
+				}
 				glBindTexture(GL_TEXTURE_2D, 0);
 
 				//push attribs
@@ -165,6 +187,7 @@ namespace Shared {
 				//init opengl
 				if (this->colorPickingMode == false) {
 					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					lastGlow = 0;
 				}
 				glBindTexture(GL_TEXTURE_2D, 0);
 				glFrontFace(GL_CCW);
@@ -274,20 +297,27 @@ namespace Shared {
 				assertGl();
 
 				//glPolygonOffset(0.05f, 0.0f);
-				//set cull face
-				if (mesh->getTwoSided()) {
-					glDisable(GL_CULL_FACE);
-				} else {
-					glEnable(GL_CULL_FACE);
+				//set cull face, consecutive meshes often need the same
+				int twoSided = (mesh->getTwoSided() ? 1 : 0);
+				if (twoSided != lastTwoSided) {
+					if (twoSided == 1) {
+						glDisable(GL_CULL_FACE);
+					} else {
+						glEnable(GL_CULL_FACE);
+					}
+					lastTwoSided = twoSided;
 				}
 				glEnable(GL_BLEND);
-				
+
 				//glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, Vec4f(1.0f, 1.0f, 1.0f, alpha).ptr());
-				if (renderMode == rmNormal && mesh->getGlow() == true) {
+				int glow = (renderMode == rmNormal && mesh->getGlow() == true ? 1 : 0);
+				if (glow == 1) {
 					// glow on
 					glBlendFunc(GL_ONE, GL_ONE);
-				} else
+				} else if (lastGlow != 0) {
 					glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				}
+				lastGlow = 0;
 
 				if (this->colorPickingMode == false) {
 					//set color
@@ -110,11 +110,11 @@ namespace Shared {
 				//fill vertex buffer with billboards
 				int bufferIndex = 0;
 
+				const ParticleStore &particles = ps->getParticles();
 				for (int i = 0; i < ps->getAliveParticleCount(); ++i) {
-					const Particle *particle = ps->getParticle(i);
-					float size = particle->getSize() / 2.0f;
-					Vec3f pos = particle->getPos();
-					Vec4f color = particle->getColor();
+					float size = particles.getSize(i) / 2.0f;
+					Vec3f pos = particles.getPos(i);
+					Vec4f color = particles.getColor(i);
 
 					vertexBuffer[bufferIndex] = pos - (rightVector - upVector) * size;
 					vertexBuffer[bufferIndex + 1] = pos - (rightVector + upVector) * size;
@@ -144,7 +144,7 @@ namespace Shared {
 				assert(rendering);
 
 				if (!ps->isEmpty()) {
-					const Particle *particle = ps->getParticle(0);
+					const ParticleStore &particles = ps->getParticles();
 
 					setBlendMode(ps->getBlendMode());
 
@@ -157,14 +157,13 @@ namespace Shared {
 					//fill vertex buffer with lines
 					int bufferIndex = 0;
 
-					glLineWidth(particle->getSize());
+					glLineWidth(particles.getSize(0));
 
 					for (int i = 0; i < ps->getAliveParticleCount(); ++i) {
-						particle = ps->getParticle(i);
-						Vec4f color = particle->getColor();
+						Vec4f color = particles.getColor(i);
 
-						vertexBuffer[bufferIndex] = particle->getPos();
-						vertexBuffer[bufferIndex + 1] = particle->getLastPos();
+						vertexBuffer[bufferIndex] = particles.getPos(i);
+						vertexBuffer[bufferIndex + 1] = particles.getLastPos(i);
 
 						colorBuffer[bufferIndex] = color;
 						colorBuffer[bufferIndex + 1] = color;
@@ -188,7 +187,7 @@ namespace Shared {
 				assert(rendering);
 
 				if (!ps->isEmpty()) {
-					const Particle *particle = ps->getParticle(0);
+					const ParticleStore &particles = ps->getParticles();
 
 					setBlendMode(ps->getBlendMode());
 
@@ -201,14 +200,13 @@ namespace Shared {
 					//fill vertex buffer with lines
 					int bufferIndex = 0;
 
-					glLineWidth(particle->getSize());
+					glLineWidth(particles.getSize(0));
 
 					for (int i = 0; i < ps->getAliveParticleCount(); ++i) {
-						particle = ps->getParticle(i);
-						Vec4f color = particle->getColor();
+						Vec4f color = particles.getColor(i);
 
-						vertexBuffer[bufferIndex] = particle->getPos();
-						vertexBuffer[bufferIndex + 1] = particle->getLastPos();
+						vertexBuffer[bufferIndex] = particles.getPos(i);
+						vertexBuffer[bufferIndex + 1] = particles.getLastPos(i);
 
 						colorBuffer[bufferIndex] = color;
 						colorBuffer[bufferIndex + 1] = color;
@@ -60,11 +60,13 @@ namespace Shared {
 					glColor4fv(color->ptr());
 				}
 
-				string renderText = text;
-				Font::bidi_cvt(renderText);
+				// Shaping, glyph runs and metrics come from the font's
+				// layout cache, most text is the same every frame
+				TextLayoutCache *layoutCache = font->getMetrics()->getLayoutCache();
+				const TextLayout &layout = layoutCache->getLayout(text, centered && font->getTextHandler() != NULL);
+				const string &renderText = layout.shapedText;
 				int line = 0;
 				int size = font->getSize();
-				const unsigned char *utext = NULL;
 				FontMetrics *metrics = NULL;
 
 				//printf("font->getTextHandler() [%p] centered = %d text [%s]\n",font->getTextHandler(),centered,text.c_str());
@@ -76,8 +78,8 @@ namespace Shared {
 					//delete [] utfStr;
 
 					if (centered) {
-						rasterPos.x = x - font->getTextHandler()->Advance(renderText.c_str()) / 2.f;
-						rasterPos.y = y + font->getTextHandler()->LineHeight(renderText.c_str()) / 2;
+						rasterPos.x = x - layout.advance / 2.f;
+						rasterPos.y = y + layoutCache->getLineHeight() / 2;
 						//printf("text [%s] x = %f, y = %f rasterPos [%s]\n",text.c_str(),x,y,rasterPos.getString().c_str());
 					} else {
 						rasterPos = Vec2f(static_cast<float>(x), static_cast<float>(y));
@@ -86,7 +88,6 @@ namespace Shared {
 						//printf("text [%s] x = %f, y = %f rasterPos [%s]\n",text.c_str(),x,y,rasterPos.getString().c_str());
 					}
 				} else {
-					utext = reinterpret_cast<const unsigned char*>(renderText.c_str());
 					metrics = font->getMetrics();
 					if (centered) {
 						rasterPos.x = x - metrics->getTextWidth(renderText) / 2.f;
@@ -106,35 +107,19 @@ namespace Shared {
 				//font->getTextHandler()->Render("Zurück");
 				//return;
 
-				if (Font::fontIsMultibyte == true) {
-					if (font->getTextHandler() != NULL) {
-						//string renderText = text;
-						if (Font::fontIsRightToLeft == true) {
-							//printf("\n\n#A [%s]\n",renderText.c_str());
-							//bool isRLM = utf8::starts_with_rlm(text.begin(), text.end() + text.size());
-
-							//printf("\n\nORIGINAL TEXT [%s] isRLM = %d\n\n",text.c_str(),isRLM);
-							//for(int i = 0; i < renderText.size(); ++i) {
-							//	printf("i = %d c [%c][%d][%X]\n",i,renderText[i],renderText[i],renderText[i]);
-							//}
-							//if(isRLM == true) {
-							if (is_string_all_ascii(renderText) == false) {
-								strrev_utf8(renderText);
-							}
-						}
-
-						//String str("資料");
-						//WString wstr(str);
-						//fontFTGL->Render(wstr.cw_str());
+				if (font->getTextHandler() != NULL) {
+					//String str("資料");
+					//WString wstr(str);
+					//fontFTGL->Render(wstr.cw_str());
 
-						//String str(L"資料");
-						//WString wstr(str);
-						//fontFTGL->Render(wstr.cw_str());
+					//String str(L"資料");
+					//WString wstr(str);
+					//fontFTGL->Render(wstr.cw_str());
 
-						//WString wstr(L"資料");
-						//fontFTGL->Render(wstr.cw_str());
+					//WString wstr(L"資料");
+					//fontFTGL->Render(wstr.cw_str());
 
-						//size_t length = text.length();
+					//size_t length = text.length();
 
 				//		string temp = String::ConvertToUTF8("資料");
 				//		size_t length = temp.length();
@@ -144,182 +129,86 @@ namespace Shared {
 				//		fontFTGL->Render(utf32);
 				//		free(utf32);
 
-						//wstring wstr(L"資料");
-						//fontFTGL->Render(wstr.c_str());
-
-						//fontFTGL->Render(text.c_str());
-
-						//const wchar_t *str = L" 中文";
-						//fontFTGL->Render(str);
-
-						//fontFTGL->Render(" 中文"); // Chinese Works!
-						//fontFTGL->Render("ёшзхсдертбнйуимлопьжющэъ́"); // Russian Works!
-						//fontFTGL->Render("更新履歴はこちらをご覧下さい。"); // Japanese Works!
-
-						//fontFTGL->Render("مرحبا العالم"); //Arabic Works!
-						//wstring temp = L"مرحبا العالم";
-						//temp = wstring (temp.rbegin(), temp.rend());
-						//fontFTGL->Render(temp.c_str());
-
-						// Hebrew is Right To Left
-						//wstring temp = L"שלום העולם";
-						//temp = wstring (temp.rbegin(), temp.rend());
-						//fontFTGL->Render(temp.c_str());
-
-						//fontFTGL->Render("testování slovanský jazyk"); // Czech Works!
-
-						// This works
-						//fontFTGL->Render(text.c_str());
-
-						if (renderText.find("\n") == renderText.npos && renderText.find("\t") == renderText.npos) {
-							font->getTextHandler()->Render(renderText.c_str());
-						} else {
-							bool lastCharacterWasSpecial = true;
-							vector<string> parts;
-							char szBuf[8096] = "";
-
-							for (int i = 0; renderText[i] != '\0'; ++i) {
-								szBuf[0] = '\0';
-								snprintf(szBuf, 8096, "%c", renderText[i]);
-
-								switch (renderText[i]) {
-									case '\t':
-										parts.push_back(szBuf);
-										lastCharacterWasSpecial = true;
-										//rasterPos= Vec2f((rasterPos.x / size + 3.f) * size, y-(size + 1.f) * line);
-										//glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									case '\n':
-										parts.push_back(szBuf);
-										lastCharacterWasSpecial = true;
-										//line++;
-										//rasterPos= Vec2f(static_cast<float>(x), y - (fontFTGL->LineHeight(text.c_str()) * 2.f) * line);
-										//glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									default:
-										//glCallList(font->getHandle()+utext[i]);
-										if (lastCharacterWasSpecial == true) {
-											parts.push_back(szBuf);
-										} else {
-											parts[parts.size() - 1] += szBuf;
-										}
-										lastCharacterWasSpecial = false;
-										break;
-								}
-							}
+					//wstring wstr(L"資料");
+					//fontFTGL->Render(wstr.c_str());
 
-							for (unsigned int i = 0; i < parts.size(); ++i) {
-								switch (parts[i][0]) {
-									case '\t':
-										rasterPos = Vec2f((rasterPos.x / size + 3.f) * size, y - (size + 1.f) * line);
-										glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									case '\n':
-										line++;
-										rasterPos = Vec2f(static_cast<float>(x), y - (font->getTextHandler()->LineHeight(parts[i].c_str())) * line);
-										glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									default:
-										font->getTextHandler()->Render(parts[i].c_str());
-										break;
-								}
-							}
-						}
-					} else {
-						//setlocale(LC_CTYPE, "en_ca.UTF-8");
+					//fontFTGL->Render(text.c_str());
 
-						//wstring wText = widen(text);
-						//glListBase(font->getHandle());
-						//glCallLists(wText.length(), GL_UNSIGNED_SHORT, &wText[0]);
+					//const wchar_t *str = L" 中文";
+					//fontFTGL->Render(str);
 
-						//string utfText = text;
-						//glListBase(font->getHandle());
-						//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
+					//fontFTGL->Render(" 中文"); // Chinese Works!
+					//fontFTGL->Render("ёшзхсдертбнйуимлопьжющэъ́"); // Russian Works!
+					//fontFTGL->Render("更新履歴はこちらをご覧下さい。"); // Japanese Works!
 
-						string utfText = renderText;
-						if (Font::fontIsRightToLeft == true) {
-							if (is_string_all_ascii(utfText) == false) {
-								strrev_utf8(utfText);
-							}
-						}
+					//fontFTGL->Render("مرحبا العالم"); //Arabic Works!
+					//wstring temp = L"مرحبا العالم";
+					//temp = wstring (temp.rbegin(), temp.rend());
+					//fontFTGL->Render(temp.c_str());
 
-						glListBase(font->getHandle());
-						glCallLists((GLsizei) renderText.length(), GL_UNSIGNED_SHORT, &utext[0]);
+					// Hebrew is Right To Left
+					//wstring temp = L"שלום העולם";
+					//temp = wstring (temp.rbegin(), temp.rend());
+					//fontFTGL->Render(temp.c_str());
 
-						//std::locale loc("");
-						//wstring wText = widen(text);
-						//std::string strBuffer(Text.size() * 4 + 1, 0);
-						//std::use_facet<std::ctype<wchar_t> >(loc).narrow(&Text[0], &Text[0] + Text.size(), '?', &strBuffer[0]);
-						//string utfText = std::string(&strBuffer[0]);
-						//glListBase(font->getHandle());
-						//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
-					}
-				} else {
-					if (font->getTextHandler() != NULL) {
-						//string renderText = text;
-						if (Font::fontIsRightToLeft == true) {
-							if (is_string_all_ascii(renderText) == false) {
-								strrev_utf8(renderText);
-							}
-						}
+					//fontFTGL->Render("testování slovanský jazyk"); // Czech Works!
 
-						if (renderText.find("\n") == renderText.npos && renderText.find("\t") == renderText.npos) {
-							font->getTextHandler()->Render(renderText.c_str());
-						} else {
-							bool lastCharacterWasSpecial = true;
-							vector<string> parts;
-							char szBuf[8096] = "";
-
-							for (int i = 0; renderText[i] != '\0'; ++i) {
-								szBuf[0] = '\0';
-								snprintf(szBuf, 8096, "%c", renderText[i]);
-
-								switch (renderText[i]) {
-									case '\t':
-										parts.push_back(szBuf);
-										lastCharacterWasSpecial = true;
-										//rasterPos= Vec2f((rasterPos.x / size + 3.f) * size, y-(size + 1.f) * line);
-										//glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									case '\n':
-										parts.push_back(szBuf);
-										lastCharacterWasSpecial = true;
-										//line++;
-										//rasterPos= Vec2f(static_cast<float>(x), y - (fontFTGL->LineHeight(text.c_str()) * 2.f) * line);
-										//glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									default:
-										//glCallList(font->getHandle()+utext[i]);
-										if (lastCharacterWasSpecial == true) {
-											parts.push_back(szBuf);
-										} else {
-											parts[parts.size() - 1] += szBuf;
-										}
-										lastCharacterWasSpecial = false;
-										break;
-								}
-							}
+					// This works
+					//fontFTGL->Render(text.c_str());
 
-							for (unsigned int i = 0; i < parts.size(); ++i) {
-								switch (parts[i][0]) {
-									case '\t':
-										rasterPos = Vec2f((rasterPos.x / size + 3.f) * size, y - (size + 1.f) * line);
-										glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									case '\n':
-										line++;
-										rasterPos = Vec2f(static_cast<float>(x), y - (font->getTextHandler()->LineHeight(parts[i].c_str())) * line);
-										glRasterPos2f(rasterPos.x, rasterPos.y);
-										break;
-									default:
-										font->getTextHandler()->Render(parts[i].c_str());
-										break;
-								}
+					if (layout.runs.empty() == true) {
+						font->getTextHandler()->Render(renderText.c_str());
+					} else {
+						for (unsigned int i = 0; i < layout.runs.size(); ++i) {
+							const string &run = layout.runs[i];
+							switch (run[0]) {
+								case '\t':
+									rasterPos = Vec2f((rasterPos.x / size + 3.f) * size, y - (size + 1.f) * line);
+									glRasterPos2f(rasterPos.x, rasterPos.y);
+									break;
+								case '\n':
+									line++;
+									rasterPos = Vec2f(static_cast<float>(x), y - layoutCache->getLineHeight() * line);
+									glRasterPos2f(rasterPos.x, rasterPos.y);
+									break;
+								default:
+									font->getTextHandler()->Render(run.c_str());
+									break;
 							}
 						}
+					}
+				} else if (Font::fontIsMultibyte == true) {
+					//setlocale(LC_CTYPE, "en_ca.UTF-8");
+
+					//wstring wText = widen(text);
+					//glListBase(font->getHandle());
+					//glCallLists(wText.length(), GL_UNSIGNED_SHORT, &wText[0]);
+
+					//string utfText = text;
+					//glListBase(font->getHandle());
+					//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
+
+					const unsigned char *utext = reinterpret_cast<const unsigned char*>(renderText.c_str());
+					glListBase(font->getHandle());
+					glCallLists((GLsizei) renderText.length(), GL_UNSIGNED_SHORT, &utext[0]);
+
+					//std::locale loc("");
+					//wstring wText = widen(text);
+					//std::string strBuffer(Text.size() * 4 + 1, 0);
+					//std::use_facet<std::ctype<wchar_t> >(loc).narrow(&Text[0], &Text[0] + Text.size(), '?', &strBuffer[0]);
+					//string utfText = std::string(&strBuffer[0]);
+					//glListBase(font->getHandle());
+					//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
+				} else {
+					// One call list per glyph, a glyph run is drawn in one call
+					glPushAttrib(GL_LIST_BIT);
+					glListBase(font->getHandle());
+					if (layout.runs.empty() == true) {
+						glCallLists((GLsizei) renderText.length(), GL_UNSIGNED_BYTE, renderText.c_str());
 					} else {
-						for (int i = 0; utext[i] != '\0'; ++i) {
-							switch (utext[i]) {
+						for (unsigned int i = 0; i < layout.runs.size(); ++i) {
+							const string &run = layout.runs[i];
+							switch (run[0]) {
 								case '\t':
 									rasterPos = Vec2f((rasterPos.x / size + 3.f)*size, y - (size + 1.f)*line);
 									glRasterPos2f(rasterPos.x, rasterPos.y);
@@ -330,10 +219,12 @@ namespace Shared {
 									glRasterPos2f(rasterPos.x, rasterPos.y);
 									break;
 								default:
-									glCallList(font->getHandle() + utext[i]);
+									glCallLists((GLsizei) run.length(), GL_UNSIGNED_BYTE, run.c_str());
+									break;
 							}
 						}
 					}
+					glPopAttrib();
 				}
 
 				if (color != NULL) {
@@ -381,33 +272,10 @@ namespace Shared {
 				assert(rendering);
 
 				if (text.empty() == false) {
-					string renderText = text;
-					Font::bidi_cvt(renderText);
-
-					if (Font::fontIsMultibyte == true) {
-						if (font->getTextHandler() != NULL) {
-							if (Font::fontIsRightToLeft == true) {
-								//printf("\n\n#A [%s]\n",renderText.c_str());
-								//bool isRLM = utf8::starts_with_rlm(text.begin(), text.end() + text.size());
-
-								//printf("\n\nORIGINAL TEXT [%s] isRLM = %d\n\n",text.c_str(),isRLM);
-								//for(int i = 0; i < renderText.size(); ++i) {
-								//	printf("i = %d c [%c][%d][%X]\n",i,renderText[i],renderText[i],renderText[i]);
-								//}
-								//if(isRLM == true) {
-								if (is_string_all_ascii(renderText) == false) {
-									//printf("\n\nORIGINAL TEXT [%s]\n\n",text.c_str());
-									//for(int i = 0; i < renderText.size(); ++i) {
-									//	printf("i = %d c [%c][%d][%X]\n",i,renderText[i],renderText[i],renderText[i]);
-									//}
-
-									strrev_utf8(renderText);
-								}
-							}
-						}
-					}
-
-					internalRender(renderText, x, y, centered, color);
+					// Shaping, glyph runs and metrics come from the font's
+					// layout cache, most text is the same every frame
+					const TextLayout &layout = font->getMetrics()->getLayoutCache()->getLayout(text, centered && font->getTextHandler() != NULL);
+					internalRender(layout, x, y, centered, color);
 				}
 			}
 
@@ -433,7 +301,7 @@ namespace Shared {
 				//}
 			}
 
-			void TextRenderer3DGl::internalRender(const string &text, float  x, float y, bool centered, Vec4f *color) {
+			void TextRenderer3DGl::internalRender(const TextLayout &layout, float  x, float y, bool centered, Vec4f *color) {
 				//assert(rendering);
 
 				if (color != NULL) {
@@ -447,8 +315,8 @@ namespace Shared {
 					//assertGl();
 				}
 
-				string renderText = text;
-				const unsigned char *utext = NULL;
+				const string &renderText = layout.shapedText;
+				TextLayoutCache *layoutCache = font->getMetrics()->getLayoutCache();
 				//assertGl();
 
 				//glMatrixMode(GL_TEXTURE);
@@ -483,10 +351,10 @@ namespace Shared {
 			//			translatePos.x = x - scale * font->getTextHandler()->Advance(text.c_str()) / 2.f;
 			//			translatePos.y = y - scale * font->getTextHandler()->LineHeight(text.c_str()) / font->getYOffsetFactor();
 						//assertGl();
-						translatePos.x = x - (font->getTextHandler()->Advance(renderText.c_str()) / 2.f);
+						translatePos.x = x - (layout.advance / 2.f);
 						//assertGl();
 						//translatePos.y = y - (font->getTextHandler()->LineHeight(text.c_str()) / font->getYOffsetFactor());
-						translatePos.y = y - ((font->getTextHandler()->LineHeight(renderText.c_str()) * Font::scaleFontValue) / 2.f);
+						translatePos.y = y - ((layoutCache->getLineHeight() * Font::scaleFontValue) / 2.f);
 						//assertGl();
 
 						translatePos.z = 0;
@@ -504,7 +372,6 @@ namespace Shared {
 					float scale = 1.0f;
 					//float scale= size;
 
-					utext = reinterpret_cast<const unsigned char*>(renderText.c_str());
 					if (centered) {
 						//glTranslatef(x-scale*metrics->getTextWidth(text)/2.f, y-scale*metrics->getHeight()/2.f, 0);
 						translatePos.x = x - scale*metrics->getTextWidth(renderText) / 2.f;
@@ -554,64 +421,24 @@ namespace Shared {
 					float scaleZ = 1.0;
 
 					glScalef(scaleX, scaleY, scaleZ);
-					if (renderText.find("\n") == renderText.npos && renderText.find("\t") == renderText.npos) {
+					if (layout.runs.empty() == true) {
 						//assertGl();
 						font->getTextHandler()->Render(renderText.c_str());
 						specialFTGLErrorCheckWorkaround(renderText);
 					} else {
-						int line = 0;
-						bool lastCharacterWasSpecial = true;
-						vector<string> parts;
-						char szBuf[8096] = "";
-
-						//for (int i=0; renderText[i] != '\0'; ++i) {
-						for (size_t i = 0; i < renderText.size(); ++i) {
-							szBuf[0] = '\0';
-							snprintf(szBuf, 8096, "%c", renderText[i]);
-
-							switch (renderText[i]) {
-								case '\t':
-									parts.push_back(szBuf);
-									lastCharacterWasSpecial = true;
-									break;
-								case '\n':
-									parts.push_back(szBuf);
-									lastCharacterWasSpecial = true;
-									break;
-								default:
-									if (lastCharacterWasSpecial == true) {
-										parts.push_back(szBuf);
-									} else {
-										parts[parts.size() - 1] += szBuf;
-									}
-									lastCharacterWasSpecial = false;
-									break;
-							}
-						}
-
 						bool needsRecursiveRender = false;
-						for (unsigned int i = 0; i < parts.size(); ++i) {
-							switch (parts[i][0]) {
+						for (unsigned int i = 0; i < layout.runs.size(); ++i) {
+							const string &run = layout.runs[i];
+							switch (run[0]) {
 								case '\t':
 									//translatePos= Vec3f((translatePos.x / size + 3.f) * size, y-(size + 1.f) * line, translatePos.z);
 									translatePos = Vec3f((translatePos.x / size + 3.f) * size, translatePos.y, translatePos.z);
 									needsRecursiveRender = true;
 									break;
 								case '\n':
-								{
-									line++;
-									//assertGl();
-									//float yLineValue = (font->getTextHandler()->LineHeight(parts[i].c_str()) * Font::scaleFontValue);
-									//float yLineValue = (font->getTextHandler()->LineHeight("W") * Font::scaleFontValue);
-									float yLineValue = font->getTextHandler()->LineHeight("W");
-									//assertGl();
-
-									//printf("Trying to render newline [%s] i = %d yLineValue = %f font->getTextHandler()->LineHeight(parts[i].c_str()) = %f\n",renderText.c_str(),i,yLineValue,font->getTextHandler()->LineHeight(parts[i].c_str()));
-
-									translatePos = Vec3f(translatePosOriginal.x, translatePos.y - yLineValue, translatePos.z);
+									translatePos = Vec3f(translatePosOriginal.x, translatePos.y - layoutCache->getLineHeight(), translatePos.z);
 									needsRecursiveRender = true;
-								}
-								break;
+									break;
 								default:
 									if (needsRecursiveRender == true) {
 										//internalRender(parts[i], translatePos.x, translatePos.y, false, color);
@@ -619,49 +446,49 @@ namespace Shared {
 										glLoadIdentity();
 										glTranslatef(translatePos.x, translatePos.y, translatePos.z);
 										glScalef(scaleX, scaleY, scaleZ);
-										font->getTextHandler()->Render(parts[i].c_str());
-										specialFTGLErrorCheckWorkaround(parts[i]);
+										font->getTextHandler()->Render(run.c_str());
+										specialFTGLErrorCheckWorkaround(run);
 										glPopMatrix();
 
 										needsRecursiveRender = false;
 									} else {
 										//assertGl();
 
-										font->getTextHandler()->Render(parts[i].c_str());
-										specialFTGLErrorCheckWorkaround(parts[i]);
+										font->getTextHandler()->Render(run.c_str());
+										specialFTGLErrorCheckWorkaround(run);
 									}
 									break;
 							}
 						}
 					}
+				} else if (Font::fontIsMultibyte == true) {
+					//setlocale(LC_CTYPE, "en_ca.UTF-8");
+
+					//wstring wText = widen(text);
+					//glListBase(font->getHandle());
+					//glCallLists(wText.length(), GL_UNSIGNED_SHORT, &wText[0]);
+
+					//string utfText = text;
+					//glListBase(font->getHandle());
+					//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
+
+					const unsigned char *utext = reinterpret_cast<const unsigned char*>(renderText.c_str());
+					glListBase(font->getHandle());
+					glCallLists((GLsizei) renderText.length(), GL_UNSIGNED_SHORT, &utext[0]);
+
+					//std::locale loc("");
+					//wstring wText = widen(text);
+					//std::string strBuffer(Text.size() * 4 + 1, 0);
+					//std::use_facet<std::ctype<wchar_t> >(loc).narrow(&Text[0], &Text[0] + Text.size(), '?', &strBuffer[0]);
+					//string utfText = std::string(&strBuffer[0]);
+					//glListBase(font->getHandle());
+					//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
 				} else {
-					if (Font::fontIsMultibyte == true) {
-						//setlocale(LC_CTYPE, "en_ca.UTF-8");
-
-						//wstring wText = widen(text);
-						//glListBase(font->getHandle());
-						//glCallLists(wText.length(), GL_UNSIGNED_SHORT, &wText[0]);
-
-						//string utfText = text;
-						//glListBase(font->getHandle());
-						//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
-
-						string utfText = renderText;
-						glListBase(font->getHandle());
-						glCallLists((GLsizei) renderText.length(), GL_UNSIGNED_SHORT, &utext[0]);
-
-						//std::locale loc("");
-						//wstring wText = widen(text);
-						//std::string strBuffer(Text.size() * 4 + 1, 0);
-						//std::use_facet<std::ctype<wchar_t> >(loc).narrow(&Text[0], &Text[0] + Text.size(), '?', &strBuffer[0]);
-						//string utfText = std::string(&strBuffer[0]);
-						//glListBase(font->getHandle());
-						//glCallLists(utfText.length(), GL_UNSIGNED_SHORT, &utfText[0]);
-					} else {
-						for (int i = 0; utext[i] != '\0'; ++i) {
-							glCallList(font->getHandle() + utext[i]);
-						}
-					}
+					// One call list per glyph, the whole text is drawn in one call
+					glPushAttrib(GL_LIST_BIT);
+					glListBase(font->getHandle());
+					glCallLists((GLsizei) renderText.length(), GL_UNSIGNED_BYTE, renderText.c_str());
+					glPopAttrib();
 				}
 
 				//assertGl();
@@ -14,6 +14,13 @@
 #include <cassert>
 #include <algorithm>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define INTERPOLATION_SSE2
+#endif
+
 #include "model.h"
 #include "conversion.h"
 #include "util.h"
@@ -32,6 +39,12 @@ namespace Shared {
 		// =====================================================
 
 		bool InterpolationData::enableInterpolation = true;
+		int InterpolationData::cacheSteps = 64;
+		int InterpolationData::cacheSize = 8;
+		int InterpolationData::frameSlots = 64;
+		uint32 InterpolationData::currentFrame = 0;
+		uint32 InterpolationData::cacheHits = 0;
+		uint32 InterpolationData::cacheMisses = 0;
 
 		InterpolationData::InterpolationData(const Mesh *mesh) {
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
@@ -47,26 +60,63 @@ namespace Shared {
 		}
 
 		InterpolationData::~InterpolationData() {
-			delete[] vertices;
+			clearCache(vertexCache);
+			clearCache(normalCache);
 			vertices = NULL;
-			delete[] normals;
 			normals = NULL;
 		}
 
+		void InterpolationData::clearCache(CacheEntries &cache) {
+			for (unsigned int i = 0; i < cache.size(); ++i) {
+				delete[] cache[i].data;
+			}
+			cache.clear();
+		}
+
+		void InterpolationData::lerp(const Vec3f *prev, const Vec3f *next, Vec3f *dest, uint32 count, float t) {
+			// Vec3f is three packed floats, so the arrays are treated as flat
+			const float *a = prev->ptr();
+			const float *b = next->ptr();
+			float *out = dest->ptr();
+			uint32 floatCount = count * 3;
+			uint32 i = 0;
+
+#if defined(__AVX__)
+			__m256 factor8 = _mm256_set1_ps(t);
+			for (; i + 8 <= floatCount; i += 8) {
+				__m256 va = _mm256_loadu_ps(a + i);
+				__m256 vb = _mm256_loadu_ps(b + i);
+				_mm256_storeu_ps(out + i, _mm256_add_ps(va, _mm256_mul_ps(_mm256_sub_ps(vb, va), factor8)));
+			}
+#endif
+#if defined(__AVX__) || defined(INTERPOLATION_SSE2)
+			__m128 factor4 = _mm_set1_ps(t);
+			for (; i + 4 <= floatCount; i += 4) {
+				__m128 va = _mm_loadu_ps(a + i);
+				__m128 vb = _mm_loadu_ps(b + i);
+				_mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), factor4)));
+			}
+#endif
+			// Same operations as Vec3f::lerp so every path gives the same result
+			for (; i < floatCount; ++i) {
+				out[i] = a[i] + (b[i] - a[i]) * t;
+			}
+		}
+
 		void InterpolationData::update(float t, bool cycle) {
 			updateVertices(t, cycle);
 			updateNormals(t, cycle);
 		}
 
 		void InterpolationData::updateVertices(float t, bool cycle) {
-			update(mesh->getVertices(), vertices, t, cycle);
+			update(mesh->getVertices(), vertexCache, vertices, t, cycle);
 		}
 
 		void InterpolationData::updateNormals(float t, bool cycle) {
-			update(mesh->getNormals(), normals, t, cycle);
+			update(mesh->getNormals(), normalCache, normals, t, cycle);
 		}
 
-		void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cycle) {
+		void InterpolationData::update(const Vec3f* src, CacheEntries &cache, const Vec3f* &dest, float t, bool cycle) {
 
 			if (t <0.0f || t>1.0f) {
 				printf("ERROR t = [%f] for cycle [%d] f [%d] v [%d]\n", t, cycle, mesh->getFrameCount(), mesh->getVertexCount());
@@ -106,12 +156,58 @@ namespace Shared {
 				assert(nextFrame < frameCount);
 
 				if (enableInterpolation) {
-					if (!dest) { // not previously allocated
-						dest = new Vec3f[vertexCount];
+					if (cacheSteps > 0) {
+						localT = static_cast<float>(static_cast<int>(localT * cacheSteps + 0.5f)) / cacheSteps;
 					}
-					for (uint32 j = 0; j < vertexCount; ++j) {
-						dest[j] = src[prevFrameBase + j].lerp(localT, src[nextFrameBase + j]);
+
+					// Drop what the last frame did not use and look for a match
+					CacheEntry *entry = NULL;
+					for (unsigned int i = 0; i < cache.size();) {
+						CacheEntry &current = cache[i];
+						if (current.prevFrame == prevFrame && current.nextFrame == nextFrame && current.localT == localT) {
+							entry = &current;
+							break;
+						}
+						if (current.lastUsedFrame + 1 < currentFrame) {
+							delete[] current.data;
+							cache.erase(cache.begin() + i);
+						} else {
+							++i;
+						}
+					}
+
+					if (entry != NULL) {
+						cacheHits++;
+					} else {
+						cacheMisses++;
+						if ((int) cache.size() < max(cacheSize, 1)) {
+							entry = NULL;
+						} else {
+							entry = &cache[0];
+							for (unsigned int i = 1; i < cache.size(); ++i) {
+								if (cache[i].lastUsedFrame < entry->lastUsedFrame) {
+									entry = &cache[i];
+								}
+							}
+							// Recycling a frame drawn this frame would make the
+							// shadow and selection passes interpolate it again
+							if (entry->lastUsedFrame == currentFrame && (int) cache.size() < frameSlots) {
+								entry = NULL;
+							}
+						}
+						if (entry == NULL) {
+							CacheEntry newEntry;
+							newEntry.data = new Vec3f[vertexCount];
+							cache.push_back(newEntry);
+							entry = &cache.back();
+						}
+						entry->prevFrame = prevFrame;
+						entry->nextFrame = nextFrame;
+						entry->localT = localT;
+						lerp(&src[prevFrameBase], &src[nextFrameBase], entry->data, vertexCount, localT);
 					}
+					entry->lastUsedFrame = currentFrame;
+					dest = entry->data;
 				} else {
 					raw_frame_ofs = prevFrameBase;
 				}
@@ -19,6 +19,8 @@
 #include "conversion.h"
 #include "util.h"
 #include "platform_common.h"
+#include "data_archive.h"
+#include "async_texture_loader.h"
 #include "opengl.h"
 #include "platform_util.h"
 //#include <memory>
@@ -215,7 +217,10 @@ namespace Shared {
 			normals = NULL;
 			texCoords = NULL;
 			indices = NULL;
+			verticesMapped = false;
+			normalsMapped = false;
 			interpolationData = NULL;
+			boundsBuilt = false;
 
 			for (int i = 0; i < MESH_TEXTURE_COUNT; ++i) {
 				textures[i] = NULL;
@@ -276,10 +281,17 @@ namespace Shared {
 		void Mesh::end() {
 			ReleaseVBOs();
 
-			delete[] vertices;
+			if (verticesMapped == false) {
+				delete[] vertices;
+			}
 			vertices = NULL;
-			delete[] normals;
+			verticesMapped = false;
+			if (normalsMapped == false) {
+				delete[] normals;
+			}
 			normals = NULL;
+			normalsMapped = false;
+			boundsBuilt = false;
 			delete[] texCoords;
 			texCoords = NULL;
 			delete[] indices;
@@ -325,9 +337,41 @@ namespace Shared {
 			}
 		}
 
+		void Mesh::getBounds(Vec3f &boundsMin, Vec3f &boundsMax) const {
+			if (boundsBuilt == false) {
+				this->boundsMin = Vec3f(0.f);
+				this->boundsMax = Vec3f(0.f);
+				if (vertices != NULL) {
+					uint32 count = frameCount * vertexCount;
+					for (uint32 i = 0; i < count; ++i) {
+						const Vec3f &v = vertices[i];
+						if (i == 0) {
+							this->boundsMin = v;
+							this->boundsMax = v;
+							continue;
+						}
+						this->boundsMin.x = min(this->boundsMin.x, v.x);
+						this->boundsMin.y = min(this->boundsMin.y, v.y);
+						this->boundsMin.z = min(this->boundsMin.z, v.z);
+						this->boundsMax.x = max(this->boundsMax.x, v.x);
+						this->boundsMax.y = max(this->boundsMax.y, v.y);
+						this->boundsMax.z = max(this->boundsMax.z, v.z);
+					}
+				}
+				boundsBuilt = true;
+			}
+			boundsMin = this->boundsMin;
+			boundsMax = this->boundsMax;
+		}
+
 		void Mesh::BuildVBOs() {
 			if (getVBOSupported() == true) {
 				if (hasBuiltVBOs == false) {
+					// Picking still needs the extent once the vertices are gone
+					Vec3f unusedMin;
+					Vec3f unusedMax;
+					getBounds(unusedMin, unusedMax);
+
 					//printf("In [%s::%s Line: %d] setting up a VBO...\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 					// Generate And Bind The Vertex Buffer
@@ -359,9 +403,17 @@ namespace Shared {
 					glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
 
 					// Our Copy Of The Data Is No Longer Necessary, It Is Safe In The Graphics Card
-					delete[] vertices; vertices = NULL;
+					if (verticesMapped == false) {
+						delete[] vertices;
+					}
+					vertices = NULL;
+					verticesMapped = false;
 					delete[] texCoords; texCoords = NULL;
-					delete[] normals; normals = NULL;
+					if (normalsMapped == false) {
+						delete[] normals;
+					}
+					normals = NULL;
+					normalsMapped = false;
 					delete[] indices; indices = NULL;
 
 					delete interpolationData;
@@ -406,7 +458,7 @@ namespace Shared {
 
 		void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
 			bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList,
-			string sourceLoader, string modelFile) {
+			string sourceLoader, string modelFile, MemoryMappedFile *mappedFile) {
 			this->textureManager = textureManager;
 			//read header
 			MeshHeaderV2 meshHeader;
@@ -490,21 +542,7 @@ namespace Shared {
 			}
 
 			//read data
-			readBytes = fread(vertices, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
-			if (readBytes != 1 && (frameCount * vertexCount) != 0) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.", readBytes, frameCount, vertexCount, __LINE__);
-				throw megaglest_runtime_error(szBuf);
-			}
-			fromEndianVecArray<Vec3f>(vertices, frameCount*vertexCount);
-
-			readBytes = fread(normals, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
-			if (readBytes != 1 && (frameCount * vertexCount) != 0) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.", readBytes, frameCount, vertexCount, __LINE__);
-				throw megaglest_runtime_error(szBuf);
-			}
-			fromEndianVecArray<Vec3f>(normals, frameCount*vertexCount);
+			readFrameData(f, mappedFile);
 
 			if ((textureFlags & mtDiffuse) == mtDiffuse) {
 				readBytes = fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
@@ -549,7 +587,7 @@ namespace Shared {
 		void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 			TextureManager *textureManager, bool deletePixMapAfterLoad,
 			std::map<string, vector<pair<string, string> > > *loadedFileList,
-			string sourceLoader, string modelFile) {
+			string sourceLoader, string modelFile, MemoryMappedFile *mappedFile) {
 			this->textureManager = textureManager;
 
 			//read header
@@ -631,21 +669,7 @@ namespace Shared {
 			}
 
 			//read data
-			readBytes = fread(vertices, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
-			if (readBytes != 1 && (frameCount * vertexCount) != 0) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.", readBytes, frameCount, vertexCount, __LINE__);
-				throw megaglest_runtime_error(szBuf);
-			}
-			fromEndianVecArray<Vec3f>(vertices, frameCount*vertexCount);
-
-			readBytes = fread(normals, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
-			if (readBytes != 1 && (frameCount * vertexCount) != 0) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.", readBytes, frameCount, vertexCount, __LINE__);
-				throw megaglest_runtime_error(szBuf);
-			}
-			fromEndianVecArray<Vec3f>(normals, frameCount*vertexCount);
+			readFrameData(f, mappedFile);
 
 			if ((textureFlags & mtDiffuse) == mtDiffuse) {
 				for (unsigned int i = 0; i < meshHeader.texCoordFrameCount; ++i) {
@@ -690,6 +714,57 @@ namespace Shared {
 			Shared::PlatformByteOrder::fromEndianTypeArray<uint32>(indices, indexCount);
 		}
 
+		void Mesh::readFrameData(FILE *f, MemoryMappedFile *mappedFile) {
+			uint32 frameDataCount = frameCount * vertexCount;
+
+			// Vertices and normals are stored back to back, share them with
+			// the file mapping when no byte swapping is needed and they are
+			// aligned (v4 files put them at odd offsets, those get copied)
+			Vec3f *mappedFrames = NULL;
+			if (mappedFile != NULL && frameDataCount != 0 &&
+				Shared::PlatformByteOrder::isBigEndian() == false) {
+				long offset = ftell(f);
+				if (offset >= 0) {
+					mappedFrames = mappedFile->getArray<Vec3f>((size_t) offset, (size_t) frameDataCount * 2);
+				}
+			}
+			if (mappedFrames != NULL) {
+				int seek_result = fseek(f, (long) (sizeof(Vec3f) * frameDataCount * 2), SEEK_CUR);
+				if (seek_result != 0) {
+					char szBuf[8096] = "";
+					snprintf(szBuf, 8096, "fseek returned failure = %d [%u][%u] on line: %d.", seek_result, frameCount, vertexCount, __LINE__);
+					throw megaglest_runtime_error(szBuf);
+				}
+				if (verticesMapped == false) {
+					delete[] vertices;
+				}
+				if (normalsMapped == false) {
+					delete[] normals;
+				}
+				vertices = mappedFrames;
+				normals = mappedFrames + frameDataCount;
+				verticesMapped = true;
+				normalsMapped = true;
+				return;
+			}
+
+			size_t readBytes = fread(vertices, sizeof(Vec3f)*frameDataCount, 1, f);
+			if (readBytes != 1 && frameDataCount != 0) {
+				char szBuf[8096] = "";
+				snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.", readBytes, frameCount, vertexCount, __LINE__);
+				throw megaglest_runtime_error(szBuf);
+			}
+			fromEndianVecArray<Vec3f>(vertices, frameDataCount);
+
+			readBytes = fread(normals, sizeof(Vec3f)*frameDataCount, 1, f);
+			if (readBytes != 1 && frameDataCount != 0) {
+				char szBuf[8096] = "";
+				snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.", readBytes, frameCount, vertexCount, __LINE__);
+				throw megaglest_runtime_error(szBuf);
+			}
+			fromEndianVecArray<Vec3f>(normals, frameDataCount);
+		}
+
 		Texture2D* Mesh::loadMeshTexture(int meshIndex, int textureIndex,
 			TextureManager *textureManager, string textureFile,
 			int textureChannelCount, bool &textureOwned, bool deletePixMapAfterLoad,
@@ -719,7 +794,13 @@ namespace Shared {
 					if (textureChannelCount != -1) {
 						texture->getPixmap()->init(textureChannelCount);
 					}
-					texture->load(textureFile);
+					bool loadAsync = textureManager->getLoadAsync();
+					if (loadAsync == true) {
+						// Shows a placeholder until the decoded image is uploaded
+						AsyncTextureLoader::load(texture, textureFile, textureManager->getTextureFilter(), textureManager->getMaxAnisotropy());
+					} else {
+						texture->load(textureFile);
+					}
 					if (loadedFileList) {
 						(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader, sourceLoader));
 					}
@@ -728,7 +809,7 @@ namespace Shared {
 
 					textureOwned = true;
 					texture->init(textureManager->getTextureFilter(), textureManager->getMaxAnisotropy());
-					if (deletePixMapAfterLoad == true) {
+					if (deletePixMapAfterLoad == true && loadAsync == false) {
 						texture->deletePixels();
 					}
 
@@ -744,7 +825,7 @@ namespace Shared {
 
 		void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
 			bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList,
-			string sourceLoader, string modelFile) {
+			string sourceLoader, string modelFile, MemoryMappedFile *mappedFile) {
 			this->textureManager = textureManager;
 
 			//read header
@@ -825,21 +906,7 @@ namespace Shared {
 			}
 
 			//read data
-			readBytes = fread(vertices, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
-			if (readBytes != 1 && (frameCount * vertexCount) != 0) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.", readBytes, frameCount, vertexCount, __LINE__);
-				throw megaglest_runtime_error(szBuf);
-			}
-			fromEndianVecArray<Vec3f>(vertices, frameCount*vertexCount);
-
-			readBytes = fread(normals, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
-			if (readBytes != 1 && (frameCount * vertexCount) != 0) {
-				char szBuf[8096] = "";
-				snprintf(szBuf, 8096, "fread returned wrong size = " MG_SIZE_T_SPECIFIER " [%u][%u] on line: %d.", readBytes, frameCount, vertexCount, __LINE__);
-				throw megaglest_runtime_error(szBuf);
-			}
-			fromEndianVecArray<Vec3f>(normals, frameCount*vertexCount);
+			readFrameData(f, mappedFile);
 
 			if (meshHeader.textures != 0) {
 				readBytes = fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
@@ -1073,6 +1140,7 @@ namespace Shared {
 
 			meshCount = 0;
 			meshes = NULL;
+			mappedFile = NULL;
 			fileVersion = 0;
 			textureManager = NULL;
 			lastTData = -1;
@@ -1084,6 +1152,8 @@ namespace Shared {
 		Model::~Model() {
 			if (meshes) delete[] meshes;
 			meshes = NULL;
+			delete mappedFile;
+			mappedFile = NULL;
 		}
 
 		// ==================== data ====================
@@ -1132,6 +1202,27 @@ namespace Shared {
 			return vertexCount;
 		}
 
+		void Model::getBounds(Vec3f &boundsMin, Vec3f &boundsMax) const {
+			boundsMin = Vec3f(0.f);
+			boundsMax = Vec3f(0.f);
+			for (uint32 i = 0; i < meshCount; ++i) {
+				Vec3f meshMin;
+				Vec3f meshMax;
+				meshes[i].getBounds(meshMin, meshMax);
+				if (i == 0) {
+					boundsMin = meshMin;
+					boundsMax = meshMax;
+					continue;
+				}
+				boundsMin.x = min(boundsMin.x, meshMin.x);
+				boundsMin.y = min(boundsMin.y, meshMin.y);
+				boundsMin.z = min(boundsMin.z, meshMin.z);
+				boundsMax.x = max(boundsMax.x, meshMax.x);
+				boundsMax.y = max(boundsMax.y, meshMax.y);
+				boundsMax.z = max(boundsMax.z, meshMax.z);
+			}
+		}
+
 		// ==================== io ====================
 
 		void Model::load(const string &path, bool deletePixMapAfterLoad,
@@ -1168,11 +1259,15 @@ namespace Shared {
 			string sourceLoader) {
 
 			try {
+				FILE *f = VirtualFileSystem::openFile(path);
+				bool archived = (f != NULL);
+				if (archived == false) {
 #ifdef WIN32
-				FILE *f = _wfopen(utf8_decode(path).c_str(), L"rb");
+					f = _wfopen(utf8_decode(path).c_str(), L"rb");
 #else
-				FILE *f = fopen(path.c_str(), "rb");
+					f = fopen(path.c_str(), "rb");
 #endif
+				}
 				if (f == NULL) {
 					printf("In [%s::%s] cannot load file = [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, path.c_str());
 					throw megaglest_runtime_error("Error opening g3d model file [" + path + "]", true);
@@ -1182,6 +1277,15 @@ namespace Shared {
 					(*loadedFileList)[path].push_back(make_pair(sourceLoader, sourceLoader));
 				}
 
+				// Archived models are already read from a mapping of the archive
+				if (archived == false) {
+					mappedFile = new MemoryMappedFile();
+					if (mappedFile->open(path) == false) {
+						delete mappedFile;
+						mappedFile = NULL;
+					}
+				}
+
 				string dir = extractDirectoryPathFromFile(path);
 
 				//file header
@@ -1240,7 +1344,7 @@ namespace Shared {
 
 					for (uint32 i = 0; i < meshCount; ++i) {
 						meshes[i].load(i, dir, f, textureManager, deletePixMapAfterLoad,
-							loadedFileList, sourceLoader, path);
+							loadedFileList, sourceLoader, path, mappedFile);
 						meshes[i].buildInterpolationData();
 					}
 				}
@@ -1266,7 +1370,7 @@ namespace Shared {
 
 					for (uint32 i = 0; i < meshCount; ++i) {
 						meshes[i].loadV3(i, dir, f, textureManager, deletePixMapAfterLoad,
-							loadedFileList, sourceLoader, path);
+							loadedFileList, sourceLoader, path, mappedFile);
 						meshes[i].buildInterpolationData();
 					}
 				}
@@ -1293,7 +1397,7 @@ namespace Shared {
 
 					for (uint32 i = 0; i < meshCount; ++i) {
 						meshes[i].loadV2(i, dir, f, textureManager, deletePixMapAfterLoad,
-							loadedFileList, sourceLoader, path);
+							loadedFileList, sourceLoader, path, mappedFile);
 						meshes[i].buildInterpolationData();
 					}
 				} else {
@@ -1303,6 +1407,16 @@ namespace Shared {
 				fclose(f);
 
 				autoJoinMeshFrames();
+
+				// Nothing ended up pointing into the mapping (misaligned or joined data)
+				bool frameDataMapped = false;
+				for (uint32 i = 0; i < meshCount && frameDataMapped == false; ++i) {
+					frameDataMapped = meshes[i].hasMappedFrameData();
+				}
+				if (frameDataMapped == false) {
+					delete mappedFile;
+					mappedFile = NULL;
+				}
 			} catch (megaglest_runtime_error& ex) {
 				//printf("1111111 ex.wantStackTrace() = %d\n",ex.wantStackTrace());
 				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what());
@@ -1405,14 +1519,20 @@ namespace Shared {
 		};
 
 		void Mesh::setVertices(Vec3f *data, uint32 count) {
-			delete[] this->vertices;
+			if (this->verticesMapped == false) {
+				delete[] this->vertices;
+			}
 			this->vertices = data;
+			this->verticesMapped = false;
 
 			this->vertexCount = count;
 		}
 		void Mesh::setNormals(Vec3f *data, uint32 count) {
-			delete[] this->normals;
+			if (this->normalsMapped == false) {
+				delete[] this->normals;
+			}
 			this->normals = data;
+			this->normalsMapped = false;
 
 			this->vertexCount = count;
 		}
@@ -1453,17 +1573,26 @@ namespace Shared {
 
 			//vertex data
 			if (dest->vertices != NULL) {
-				delete[] dest->vertices;
+				if (dest->verticesMapped == false) {
+					delete[] dest->vertices;
+				}
 				dest->vertices = NULL;
+				dest->verticesMapped = false;
 			}
 			if (this->vertices != NULL) {
 				dest->vertices = new Vec3f[this->frameCount * this->vertexCount];
 				memcpy(&dest->vertices[0], &this->vertices[0], this->frameCount * this->vertexCount * sizeof(Vec3f));
 			}
+			dest->boundsBuilt = this->boundsBuilt;
+			dest->boundsMin = this->boundsMin;
+			dest->boundsMax = this->boundsMax;
 
 			if (dest->normals != NULL) {
-				delete[] dest->normals;
+				if (dest->normalsMapped == false) {
+					delete[] dest->normals;
+				}
 				dest->normals = NULL;
+				dest->normalsMapped = false;
 			}
 			if (this->normals != NULL) {
 				dest->normals = new Vec3f[this->frameCount * this->vertexCount];
@@ -2145,8 +2274,18 @@ namespace Shared {
 				}
 				unsigned char *pixelBuffer = cachedPixels->getPixels();
 
-				map<int, bool> modelAlreadyPickedList;
-				map<unsigned char, map<unsigned char, map<unsigned char, bool> > > colorAlreadyPickedList;
+				// Look models up by color instead of comparing every sampled
+				// pixel with every model, when colors repeat the first wins
+				map<uint32, int> modelByColor;
+				for (unsigned int i = 0; i < rendererModels.size(); ++i) {
+					BaseColorPickEntity *model = rendererModels[i];
+					if (model != NULL) {
+						const unsigned char *color = model->getUniqueColorID();
+						uint32 colorKey = (color[0] << 16) | (color[1] << 8) | color[2];
+						modelByColor.insert(make_pair(colorKey, (int) i));
+					}
+				}
+				vector<bool> modelAlreadyPickedList(rendererModels.size(), false);
 
 				int skipSteps = 4;
 				//unsigned char *oldpixel = &pixelBuffer[0];
@@ -2154,8 +2293,8 @@ namespace Shared {
 				// now we check the screenshot if we find pixels in color of unit identity
 				// to speedup we only check every "skipSteps" line and pixel in a row if we find such a color.
 				// this is exact enough for MG purpose
-				for (int hh = 0; hh < h && pickedModels.size() < rendererModels.size(); hh = hh + skipSteps) {
-					for (int ww = 0; ww < w && pickedModels.size() < rendererModels.size(); ww = ww + skipSteps) {
+				for (int hh = 0; hh < h && pickedModels.size() < modelByColor.size(); hh = hh + skipSteps) {
+					for (int ww = 0; ww < w && pickedModels.size() < modelByColor.size(); ww = ww + skipSteps) {
 
 						int index = (hh*w + ww) * COLOR_COMPONENTS;
 						unsigned char *pixel = &pixelBuffer[index];
@@ -2169,33 +2308,13 @@ namespace Shared {
 						//					if(memcmp(pixel,oldpixel,3)) continue;
 						//				}
 
-						// Skip duplicate scanned colors
-						map<unsigned char, map<unsigned char, map<unsigned char, bool> > >::const_iterator iterFind1 = colorAlreadyPickedList.find(pixel[0]);
-						if (iterFind1 != colorAlreadyPickedList.end()) {
-							map<unsigned char, map<unsigned char, bool> >::const_iterator iterFind2 = iterFind1->second.find(pixel[1]);
-							if (iterFind2 != iterFind1->second.end()) {
-								map<unsigned char, bool>::const_iterator iterFind3 = iterFind2->second.find(pixel[2]);
-								if (iterFind3 != iterFind2->second.end()) {
-									continue;
-								}
-							}
-						}
-
-						for (unsigned int i = 0; i < rendererModels.size(); ++i) {
-							// Skip models already selected
-							if (modelAlreadyPickedList.find(i) != modelAlreadyPickedList.end()) {
-								continue;
-							}
-							const BaseColorPickEntity *model = rendererModels[i];
+						uint32 colorKey = (pixel[0] << 16) | (pixel[1] << 8) | pixel[2];
+						map<uint32, int>::const_iterator iterFind = modelByColor.find(colorKey);
+						if (iterFind != modelByColor.end() && modelAlreadyPickedList[iterFind->second] == false) {
+							//printf("Found match pixel [%d.%d.%d] for model [%s] ptr [%p][%s]\n",pixel[0],pixel[1],pixel[2],model->getColorDescription().c_str(), model,model->getUniquePickName().c_str());
 
-							if (model != NULL && model->isUniquePickingColor(pixel) == true) {
-								//printf("Found match pixel [%d.%d.%d] for model [%s] ptr [%p][%s]\n",pixel[0],pixel[1],pixel[2],model->getColorDescription().c_str(), model,model->getUniquePickName().c_str());
-
-								pickedModels.push_back(i);
-								modelAlreadyPickedList[i] = true;
-								colorAlreadyPickedList[pixel[0]][pixel[1]][pixel[2]] = true;
-								break;
-							}
+							pickedModels.push_back(iterFind->second);
+							modelAlreadyPickedList[iterFind->second] = true;
 						}
 					}
 				}
@@ -14,6 +14,7 @@
 #include "graphics_interface.h"
 #include "graphics_factory.h"
 #include <cstdlib>
+#include <set>
 #include <stdexcept>
 #include "util.h"
 #include "platform_util.h"
@@ -35,18 +36,74 @@ namespace Shared {
 			}
 
 			textureManager = NULL;
+			lastModel = NULL;
 		}
 
 		ModelManager::~ModelManager() {
 			end();
 		}
 
+		string ModelManager::getModelKey(const string &path, bool deletePixMapAfterLoad) {
+			string key = path;
+			updatePathClimbingParts(key);
+			return key + (deletePixMapAfterLoad == true ? "|1" : "|0");
+		}
+
 		Model *ModelManager::newModel(const string &path, bool deletePixMapAfterLoad, std::map<string, vector<pair<string, string> > > *loadedFileList, string *sourceLoader) {
+			string key = getModelKey(path, deletePixMapAfterLoad);
+			std::map<string, Model *>::iterator iterFind = modelsByPath.find(key);
+			if (iterFind != modelsByPath.end()) {
+				Model *model = iterFind->second;
+				modelRefCounts[model]++;
+				// Record the new user, the same way a fresh load would have,
+				// including the textures the model uses
+				if (loadedFileList) {
+					string loader = (sourceLoader != NULL ? *sourceLoader : "");
+					(*loadedFileList)[path].push_back(make_pair(loader, loader));
+
+					std::set<string> texturePaths;
+					for (uint32 i = 0; i < model->getMeshCount(); ++i) {
+						const Mesh *mesh = model->getMesh(i);
+						for (int j = 0; j < MESH_TEXTURE_COUNT; ++j) {
+							const Texture2D *texture = mesh->getTexture(j);
+							if (texture != NULL && texture->getPath() != "" &&
+								texturePaths.insert(texture->getPath()).second == true) {
+								(*loadedFileList)[texture->getPath()].push_back(make_pair(loader, loader));
+							}
+						}
+					}
+				}
+				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] sharing model [%s] refs = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, path.c_str(), modelRefCounts[model]);
+				lastModel = model;
+				return model;
+			}
+
 			Model *model = GraphicsInterface::getInstance().getFactory()->newModel(path, textureManager, deletePixMapAfterLoad, loadedFileList, sourceLoader);
 			models.push_back(model);
+			if (model != NULL) {
+				modelsByPath[key] = model;
+				modelRefCounts[model] = 1;
+			}
+			lastModel = model;
 			return model;
 		}
 
+		int ModelManager::getRefCount(const Model *model) const {
+			std::map<Model *, int>::const_iterator iterFind = modelRefCounts.find(const_cast<Model *>(model));
+			return (iterFind != modelRefCounts.end() ? iterFind->second : 0);
+		}
+
+		void ModelManager::forgetModel(Model *model) {
+			modelRefCounts.erase(model);
+			for (std::map<string, Model *>::iterator iterMap = modelsByPath.begin();
+				iterMap != modelsByPath.end(); ++iterMap) {
+				if (iterMap->second == model) {
+					modelsByPath.erase(iterMap);
+					break;
+				}
+			}
+		}
+
 		void ModelManager::init() {
 			for (size_t i = 0; i < models.size(); ++i) {
 				if (models[i] != NULL) {
@@ -64,10 +121,24 @@ namespace Shared {
 				}
 			}
 			models.clear();
+			modelsByPath.clear();
+			modelRefCounts.clear();
+			lastModel = NULL;
 		}
 
 		void ModelManager::endModel(Model *model, bool mustExistInList) {
 			if (model != NULL) {
+				// Still in use by another newModel caller
+				std::map<Model *, int>::iterator iterRef = modelRefCounts.find(model);
+				if (iterRef != modelRefCounts.end() && iterRef->second > 1) {
+					iterRef->second--;
+					return;
+				}
+				forgetModel(model);
+				if (model == lastModel) {
+					lastModel = NULL;
+				}
+
 				bool found = false;
 				for (unsigned int idx = 0; idx < models.size(); idx++) {
 					Model *curModel = models[idx];
@@ -87,22 +158,17 @@ namespace Shared {
 			}
 		}
 
+		// models.back() is not what the last caller got when that model was
+		// already loaded and shared, so this ends the model newModel returned
 		void ModelManager::endLastModel(bool mustExistInList) {
-			bool found = false;
-			if (models.size() > 0) {
-				found = true;
-				size_t index = models.size() - 1;
-				Model *curModel = models[index];
-				models.erase(models.begin() + index);
-
-				curModel->end();
-				delete curModel;
-			}
-			if (found == false && mustExistInList == true) {
+			if (lastModel != NULL) {
+				Model *model = lastModel;
+				lastModel = NULL;
+				endModel(model, mustExistInList);
+			} else if (mustExistInList == true) {
 				throw std::runtime_error("found == false in endLastModel");
 			}
 		}
 
-
 	}
 }//end namespace
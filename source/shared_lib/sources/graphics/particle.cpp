@@ -15,6 +15,7 @@
 #include <stdexcept>
 #include <cassert>
 #include <algorithm>
+#include <string.h>
 
 #include "util.h"
 #include "particle_renderer.h"
@@ -24,6 +25,7 @@
 #include "model.h"
 #include "texture.h"
 #include "platform_util.h"
+#include "base_thread.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -88,12 +90,361 @@ namespace Shared {
 			energy = particleNode->getAttribute("energy")->getIntValue();
 		}
 
-		ParticleSystem::ParticleSystem(int particleCount) {
+		// =====================================================
+		//	class ParticleStore
+		// =====================================================
+
+		void ParticleStore::resize(int count) {
+			posX.resize(count);
+			posY.resize(count);
+			posZ.resize(count);
+			lastPosX.resize(count);
+			lastPosY.resize(count);
+			lastPosZ.resize(count);
+			speedX.resize(count);
+			speedY.resize(count);
+			speedZ.resize(count);
+			speedUpRelative.resize(count);
+			speedUpConstantX.resize(count);
+			speedUpConstantY.resize(count);
+			speedUpConstantZ.resize(count);
+			accelX.resize(count);
+			accelY.resize(count);
+			accelZ.resize(count);
+			colorR.resize(count);
+			colorG.resize(count);
+			colorB.resize(count);
+			colorA.resize(count);
+			size.resize(count);
+			energy.resize(count);
+			energyRatio.resize(count);
+		}
+
+		void ParticleStore::clear() {
+			resize(0);
+		}
+
+		void ParticleStore::swap(ParticleStore &store) {
+			posX.swap(store.posX);
+			posY.swap(store.posY);
+			posZ.swap(store.posZ);
+			lastPosX.swap(store.lastPosX);
+			lastPosY.swap(store.lastPosY);
+			lastPosZ.swap(store.lastPosZ);
+			speedX.swap(store.speedX);
+			speedY.swap(store.speedY);
+			speedZ.swap(store.speedZ);
+			speedUpRelative.swap(store.speedUpRelative);
+			speedUpConstantX.swap(store.speedUpConstantX);
+			speedUpConstantY.swap(store.speedUpConstantY);
+			speedUpConstantZ.swap(store.speedUpConstantZ);
+			accelX.swap(store.accelX);
+			accelY.swap(store.accelY);
+			accelZ.swap(store.accelZ);
+			colorR.swap(store.colorR);
+			colorG.swap(store.colorG);
+			colorB.swap(store.colorB);
+			colorA.swap(store.colorA);
+			size.swap(store.size);
+			energy.swap(store.energy);
+			energyRatio.swap(store.energyRatio);
+		}
+
+		void ParticleStore::set(int i, const Particle &p) {
+			posX[i] = p.pos.x;
+			posY[i] = p.pos.y;
+			posZ[i] = p.pos.z;
+			lastPosX[i] = p.lastPos.x;
+			lastPosY[i] = p.lastPos.y;
+			lastPosZ[i] = p.lastPos.z;
+			speedX[i] = p.speed.x;
+			speedY[i] = p.speed.y;
+			speedZ[i] = p.speed.z;
+			speedUpRelative[i] = p.speedUpRelative;
+			speedUpConstantX[i] = p.speedUpConstant.x;
+			speedUpConstantY[i] = p.speedUpConstant.y;
+			speedUpConstantZ[i] = p.speedUpConstant.z;
+			accelX[i] = p.accel.x;
+			accelY[i] = p.accel.y;
+			accelZ[i] = p.accel.z;
+			colorR[i] = p.color.x;
+			colorG[i] = p.color.y;
+			colorB[i] = p.color.z;
+			colorA[i] = p.color.w;
+			size[i] = p.size;
+			energy[i] = p.energy;
+		}
+
+		Particle ParticleStore::get(int i) const {
+			Particle p;
+			p.pos = getPos(i);
+			p.lastPos = getLastPos(i);
+			p.speed = Vec3f(speedX[i], speedY[i], speedZ[i]);
+			p.speedUpRelative = speedUpRelative[i];
+			p.speedUpConstant = Vec3f(speedUpConstantX[i], speedUpConstantY[i], speedUpConstantZ[i]);
+			p.accel = Vec3f(accelX[i], accelY[i], accelZ[i]);
+			p.color = getColor(i);
+			p.size = size[i];
+			p.energy = energy[i];
+			return p;
+		}
+
+		void ParticleStore::move(int from, int to) {
+			posX[to] = posX[from];
+			posY[to] = posY[from];
+			posZ[to] = posZ[from];
+			lastPosX[to] = lastPosX[from];
+			lastPosY[to] = lastPosY[from];
+			lastPosZ[to] = lastPosZ[from];
+			speedX[to] = speedX[from];
+			speedY[to] = speedY[from];
+			speedZ[to] = speedZ[from];
+			speedUpRelative[to] = speedUpRelative[from];
+			speedUpConstantX[to] = speedUpConstantX[from];
+			speedUpConstantY[to] = speedUpConstantY[from];
+			speedUpConstantZ[to] = speedUpConstantZ[from];
+			accelX[to] = accelX[from];
+			accelY[to] = accelY[from];
+			accelZ[to] = accelZ[from];
+			colorR[to] = colorR[from];
+			colorG[to] = colorG[from];
+			colorB[to] = colorB[from];
+			colorA[to] = colorA[from];
+			size[to] = size[from];
+			energy[to] = energy[from];
+		}
+
+		// =====================================================
+		//	Update kernels
+		//
+		//	Each works on one component array at a time with no
+		//	calls or data dependent branches in the loop body, so
+		//	-O3 turns them into SIMD loops.
+		// =====================================================
+
+		// Float compares may trap, so with the default -ftrapping-math gcc
+		// won't turn a select on one into vector code. The kernels test and
+		// select on the bit patterns instead.
+		static inline int32 getFloatBits(float value) {
+			int32 bits;
+			memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		static inline float getBitsFloat(int32 bits) {
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		// mask is all ones to pick a, zero to pick b
+		static inline float selectFloat(int32 mask, float a, float b) {
+			return getBitsFloat((getFloatBits(a) & mask) | (getFloatBits(b) & ~mask));
+		}
+
+		// Same as truncateDecimal<float>(value, 6) but without the int64 and
+		// long double math that keeps loops from being vectorized. Floats
+		// of 2^23 and up have no fraction left to cut off, the rest fit an
+		// int.
+		static inline float truncateParticleValue(float value) {
+			float scaled = value * 1000000.0f;
+			int32 fraction = -static_cast<int32>((getFloatBits(scaled) & 0x7fffffff) < 0x4b000000);
+			float whole = static_cast<float>(static_cast<int32>(selectFloat(fraction, scaled, 0.0f)));
+			return selectFloat(fraction, whole, scaled) / 1000000.0f;
+		}
+
+		// lastPos = pos, pos += speed, speed += accel
+		static void integrateParticles(float *pos, float *lastPos, float *speed, const float *accel, int first, int last) {
+			for (int i = first; i < last; ++i) {
+				lastPos[i] = pos[i];
+				pos[i] = pos[i] + speed[i];
+				speed[i] = speed[i] + accel[i];
+			}
+		}
+
+		static void truncateParticleValues(float *values, int first, int last) {
+			for (int i = first; i < last; ++i) {
+				values[i] = truncateParticleValue(values[i]);
+			}
+		}
+
+		// value += offset, truncated
+		static void addParticleOffset(float *values, const float *offset, int first, int last) {
+			for (int i = first; i < last; ++i) {
+				values[i] = truncateParticleValue(values[i] + offset[i]);
+			}
+		}
+
+		static void addParticleConstant(float *values, float offset, int first, int last) {
+			for (int i = first; i < last; ++i) {
+				values[i] = truncateParticleValue(values[i] + offset);
+			}
+		}
+
+		static void copyParticleValues(const float *from, float *to, int first, int last) {
+			for (int i = first; i < last; ++i) {
+				to[i] = from[i];
+			}
+		}
+
+		static void decreaseParticleEnergy(int *energy, int first, int last) {
+			for (int i = first; i < last; ++i) {
+				energy[i]--;
+			}
+		}
+
+		// energy / maxEnergy clamped to [0, 1]
+		static void computeEnergyRatios(const int *energy, float *energyRatio, int maxEnergy, bool truncate, int first, int last) {
+			if (maxEnergy <= 0) {
+				for (int i = first; i < last; ++i) {
+					float ratio = clamp(static_cast<float>(energy[i]) / maxEnergy, 0.f, 1.f);
+					energyRatio[i] = (truncate == true ? truncateParticleValue(ratio) : ratio);
+				}
+				return;
+			}
+			// Clamping the energy instead of the ratio gives the same result
+			// without float compares
+			float floatMaxEnergy = static_cast<float>(maxEnergy);
+			for (int i = first; i < last; ++i) {
+				int clampedEnergy = (energy[i] < 0 ? 0 : energy[i]);
+				clampedEnergy = (clampedEnergy > maxEnergy ? maxEnergy : clampedEnergy);
+				energyRatio[i] = static_cast<float>(clampedEnergy) / floatMaxEnergy;
+			}
+			if (truncate == true) {
+				truncateParticleValues(energyRatio, first, last);
+			}
+		}
+
+		// Fades one value from full energy to no energy as energy runs out
+		static void blendParticleValues(float *values, const float *energyRatio, float full, float noEnergy, int first, int last) {
+			for (int i = first; i < last; ++i) {
+				values[i] = full * energyRatio[i] + noEnergy * (1.0f - energyRatio[i]);
+			}
+		}
+
+		static void blendParticlesByEnergy(ParticleStore &particles, Vec4f color, Vec4f colorNoEnergy,
+			float size, float sizeNoEnergy, int first, int last) {
+			const float *energyRatio = &particles.energyRatio[0];
+			blendParticleValues(&particles.colorR[0], energyRatio, color.x, colorNoEnergy.x, first, last);
+			blendParticleValues(&particles.colorG[0], energyRatio, color.y, colorNoEnergy.y, first, last);
+			blendParticleValues(&particles.colorB[0], energyRatio, color.z, colorNoEnergy.z, first, last);
+			blendParticleValues(&particles.colorA[0], energyRatio, color.w, colorNoEnergy.w, first, last);
+			blendParticleValues(&particles.size[0], energyRatio, size, sizeNoEnergy, first, last);
+			truncateParticleValues(&particles.size[0], first, last);
+		}
+
+		class ParticleEnergyDepleted {
+		public:
+			bool operator()(const ParticleStore &particles, int i) const {
+				return particles.energy[i] <= 0;
+			}
+		};
+
+		class ParticleBelowGround {
+		public:
+			bool operator()(const ParticleStore &particles, int i) const {
+				return particles.posY[i] < 0;
+			}
+		};
+
+		// =====================================================
+		//	Particle store pools
+		// =====================================================
+
+		static Mutex particleStorePoolMutex;
+		static vector<ParticleStore *> particleStorePools[ParticleSystem::pst_Count];
+		static int particleStorePoolSize = 32;
+
+		static bool isPooledParticleSystemType(ParticleSystem::ParticleSystemType type) {
+			return type == ParticleSystem::pst_ProjectileParticleSystem ||
+				type == ParticleSystem::pst_SplashParticleSystem ||
+				type == ParticleSystem::pst_UnitParticleSystem;
+		}
+
+		void ParticleSystem::setParticleStorePoolSize(int poolSize) {
+			MutexSafeWrapper safeMutex(&particleStorePoolMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			particleStorePoolSize = max(poolSize, 0);
+			for (int type = 0; type < pst_Count; ++type) {
+				vector<ParticleStore *> &pool = particleStorePools[type];
+				while ((int) pool.size() > particleStorePoolSize) {
+					delete pool.back();
+					pool.pop_back();
+				}
+			}
+		}
+
+		int ParticleSystem::getPooledParticleStoreCount(ParticleSystemType type) {
+			MutexSafeWrapper safeMutex(&particleStorePoolMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return (int) particleStorePools[type].size();
+		}
+
+		void ParticleSystem::clearParticleStorePools() {
+			MutexSafeWrapper safeMutex(&particleStorePoolMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			for (int type = 0; type < pst_Count; ++type) {
+				vector<ParticleStore *> &pool = particleStorePools[type];
+				for (unsigned int i = 0; i < pool.size(); ++i) {
+					delete pool[i];
+				}
+				pool.clear();
+			}
+		}
+
+		void ParticleSystem::acquireParticleStore(int particleCount) {
+			if (isPooledParticleSystemType(systemType) == true) {
+				MutexSafeWrapper safeMutex(&particleStorePoolMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+				vector<ParticleStore *> &pool = particleStorePools[systemType];
+				if (pool.empty() == false) {
+					// Prefer one that is big enough, the others grow
+					int index = (int) pool.size() - 1;
+					for (int i = index; i >= 0; --i) {
+						if (pool[i]->getCapacity() >= particleCount) {
+							index = i;
+							break;
+						}
+					}
+					ParticleStore *store = pool[index];
+					pool[index] = pool.back();
+					pool.pop_back();
+					safeMutex.ReleaseLock();
+
+					particles.swap(*store);
+					delete store;
+				}
+			}
+			// Stale particles are fine, each one is set when it is emitted
+			particles.resize(particleCount);
+		}
+
+		void ParticleSystem::releaseParticleStore() {
+			if (isPooledParticleSystemType(systemType) == true && particles.getCapacity() > 0) {
+				MutexSafeWrapper safeMutex(&particleStorePoolMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+				vector<ParticleStore *> &pool = particleStorePools[systemType];
+				if ((int) pool.size() < particleStorePoolSize) {
+					ParticleStore *store = new ParticleStore();
+					store->swap(particles);
+					pool.push_back(store);
+				}
+			}
+			particles.clear();
+		}
+
+		// =====================================================
+		//	class ParticleSystem
+		// =====================================================
+
+		bool ParticleSystem::deferParticleSteps = false;
+
+		ParticleSystem::ParticleSystem(int particleCount, ParticleSystemType systemType) {
 			if (checkMemory) {
 				printf("++ Create ParticleSystem [%p]\n", this);
 				memoryObjectList[this]++;
 			}
 
+			this->systemType = systemType;
+			pendingParticleStep = false;
+			pendingEmissions = 0;
+			pendingStepState = sPlay;
+
 			textureFileLoadDeferred = "";
 			textureFileLoadDeferredSystemId = 0;
 			textureFileLoadDeferredFormat = Texture::fAuto;
@@ -102,9 +453,8 @@ namespace Shared {
 			//init particle vector
 			blendMode = bmOne;
 			//particles= new Particle[particleCount];
-			particles.clear();
 			//particles.reserve(particleCount);
-			particles.resize(particleCount);
+			acquireParticleStore(particleCount);
 
 			state = sPlay;
 			aliveParticleCount = 0;
@@ -146,7 +496,7 @@ namespace Shared {
 			}
 
 			//delete [] particles;
-			particles.clear();
+			releaseParticleStore();
 
 			delete particleObserver;
 			particleObserver = NULL;
@@ -199,40 +549,52 @@ namespace Shared {
 
 		//updates all living particles and creates new ones
 		void ParticleSystem::update() {
-			if (aliveParticleCount > (int) particles.size()) {
-				throw megaglest_runtime_error("aliveParticleCount >= particles.size()");
+			if (aliveParticleCount > particles.getCount()) {
+				throw megaglest_runtime_error("aliveParticleCount >= particles.getCount()");
 			}
 			if (particleSystemStartDelay > 0) {
 				particleSystemStartDelay--;
 			} else if (state != sPause) {
-				for (int i = 0; i < aliveParticleCount; ++i) {
-					updateParticle(&particles[i]);
-
-					if (deathTest(&particles[i])) {
-
-						//kill the particle
-						killParticle(&particles[i]);
-
-						//maintain alive particles at front of the array
-						if (aliveParticleCount > 0) {
-							particles[i] = particles[aliveParticleCount];
-						}
-					}
-				}
-
+				pendingEmissions = 0;
 				if (state != ParticleSystem::sFade) {
 					emissionState = emissionState + emissionRate;
 					int emissionIntValue = (int) emissionState;
-					for (int i = 0; i < emissionIntValue; i++) {
-						Particle *p = createParticle();
-						initParticle(p, i);
-					}
+					pendingEmissions = emissionIntValue;
 					emissionState = emissionState - (float) emissionIntValue;
 					emissionState = truncateDecimal<float>(emissionState, 6);
 				}
+				pendingStepState = state;
+				pendingParticleStep = true;
+
+				if (deferParticleSteps == false) {
+					stepParticles();
+				}
 			}
 		}
 
+		void ParticleSystem::stepParticles() {
+			if (pendingParticleStep == false) {
+				return;
+			}
+			pendingParticleStep = false;
+
+			// A deferred step must come out the same as one run right away,
+			// even if something faded the system in between
+			State currentState = state;
+			state = pendingStepState;
+
+			if (aliveParticleCount > 0) {
+				updateParticles(0, aliveParticleCount);
+				removeDeadParticles();
+			}
+			for (int i = 0; i < pendingEmissions; i++) {
+				emitParticle(i);
+			}
+			pendingEmissions = 0;
+
+			state = currentState;
+		}
+
 		void ParticleSystem::render(ParticleRenderer *pr, ModelRenderer *mr) {
 			if (active) {
 				pr->renderSystem(this);
@@ -332,7 +694,7 @@ namespace Shared {
 		string ParticleSystem::toString() const {
 			string result = "ParticleSystem ";
 
-			result += "particles = " + intToStr(particles.size());
+			result += "particles = " + intToStr(particles.getCount());
 
 			//	for(unsigned int i = 0; i < particles.size(); ++i) {
 			//		Particle &particle = particles[i];
@@ -580,25 +942,47 @@ namespace Shared {
 
 		// if there is one dead particle it returns it else, return the particle with 
 		// less energy
-		Particle * ParticleSystem::createParticle() {
+		int ParticleSystem::createParticle() {
 
 			//if any dead particles
 			if (aliveParticleCount < particleCount) {
 				++aliveParticleCount;
-				return &particles[aliveParticleCount - 1];
+				return aliveParticleCount - 1;
 			}
 
 			//if not
-			int minEnergy = particles[0].energy;
+			int minEnergy = particles.energy[0];
 			int minEnergyParticle = 0;
 
 			for (int i = 0; i < particleCount; ++i) {
-				if (particles[i].energy < minEnergy) {
-					minEnergy = particles[i].energy;
+				if (particles.energy[i] < minEnergy) {
+					minEnergy = particles.energy[i];
 					minEnergyParticle = i;
 				}
 			}
-			return &particles[minEnergyParticle];
+			return minEnergyParticle;
+		}
+
+		template<typename DeathTest>
+		void ParticleSystem::compactParticles(const DeathTest &deathTest) {
+			for (int i = 0; i < aliveParticleCount;) {
+				if (deathTest(particles, i) == true) {
+					aliveParticleCount--;
+					if (i < aliveParticleCount) {
+						particles.move(aliveParticleCount, i);
+					}
+				} else {
+					++i;
+				}
+			}
+		}
+
+		int ParticleSystem::emitParticle(int particleIndex) {
+			int index = createParticle();
+			Particle p;
+			initParticle(&p, particleIndex);
+			particles.set(index, p);
+			return index;
 		}
 
 		void ParticleSystem::initParticle(Particle *p, int particleIndex) {
@@ -612,19 +996,16 @@ namespace Shared {
 			p->energy = maxParticleEnergy + random.randRange(-varParticleEnergy, varParticleEnergy);
 		}
 
-		void ParticleSystem::updateParticle(Particle *p) {
-			p->lastPos = p->pos;
-			p->pos = p->pos + p->speed;
-			p->speed = p->speed + p->accel;
-			p->energy--;
-		}
-
-		bool ParticleSystem::deathTest(Particle *p) {
-			return p->energy <= 0;
+		void ParticleSystem::updateParticles(int first, int last) {
+			ParticleStore &p = particles;
+			integrateParticles(&p.posX[0], &p.lastPosX[0], &p.speedX[0], &p.accelX[0], first, last);
+			integrateParticles(&p.posY[0], &p.lastPosY[0], &p.speedY[0], &p.accelY[0], first, last);
+			integrateParticles(&p.posZ[0], &p.lastPosZ[0], &p.speedZ[0], &p.accelZ[0], first, last);
+			decreaseParticleEnergy(&p.energy[0], first, last);
 		}
 
-		void ParticleSystem::killParticle(Particle *p) {
-			aliveParticleCount--;
+		void ParticleSystem::removeDeadParticles() {
+			compactParticles(ParticleEnergyDepleted());
 		}
 
 		void ParticleSystem::setFactionColor(Vec4f factionColor) {
@@ -647,7 +1028,7 @@ namespace Shared {
 
 
 		FireParticleSystem::FireParticleSystem(int particleCount) :
-			ParticleSystem(particleCount) {
+			ParticleSystem(particleCount, pst_FireParticleSystem) {
 
 			radius = 0.5f;
 			speed = 0.01f;
@@ -694,23 +1075,38 @@ namespace Shared {
 
 		}
 
-		void FireParticleSystem::updateParticle(Particle *p) {
-			p->lastPos = p->pos;
-			p->pos = p->pos + p->speed;
-			p->energy--;
-
-			if (p->color.x > 0.0f)
-				p->color.x *= 0.98f;
-			if (p->color.y > 0.0f)
-				p->color.y *= 0.98f;
-			if (p->color.w > 0.0f)
-				p->color.w *= 0.98f;
+		void FireParticleSystem::updateParticles(int first, int last) {
+			ParticleStore &p = particles;
+			float *pos[3] = { &p.posX[0], &p.posY[0], &p.posZ[0] };
+			float *lastPos[3] = { &p.lastPosX[0], &p.lastPosY[0], &p.lastPosZ[0] };
+			float *speed[3] = { &p.speedX[0], &p.speedY[0], &p.speedZ[0] };
+			for (int axis = 0; axis < 3; ++axis) {
+				float *axisPos = pos[axis];
+				const float *axisSpeed = speed[axis];
+				copyParticleValues(axisPos, lastPos[axis], first, last);
+				for (int i = first; i < last; ++i) {
+					axisPos[i] = axisPos[i] + axisSpeed[i];
+				}
+			}
+			decreaseParticleEnergy(&p.energy[0], first, last);
 
-			p->speed.x *= 1.001f;
-			p->speed.x = truncateDecimal<float>(p->speed.x, 6);
-			p->speed.y = truncateDecimal<float>(p->speed.y, 6);
-			p->speed.z = truncateDecimal<float>(p->speed.z, 6);
+			float *fading[3] = { &p.colorR[0], &p.colorG[0], &p.colorA[0] };
+			for (int channel = 0; channel < 3; ++channel) {
+				float *color = fading[channel];
+				for (int i = first; i < last; ++i) {
+					// Positive floats are the ones with positive bit patterns
+					int32 positive = -static_cast<int32>(getFloatBits(color[i]) > 0);
+					color[i] = selectFloat(positive, color[i] * 0.98f, color[i]);
+				}
+			}
 
+			float *speedX = speed[0];
+			for (int i = first; i < last; ++i) {
+				speedX[i] *= 1.001f;
+			}
+			for (int axis = 0; axis < 3; ++axis) {
+				truncateParticleValues(speed[axis], first, last);
+			}
 		}
 
 		string FireParticleSystem::toString() const {
@@ -779,8 +1175,8 @@ namespace Shared {
 		//  GameParticleSystem
 		// ===========================================================================
 
-		GameParticleSystem::GameParticleSystem(int particleCount) :
-			ParticleSystem(particleCount),
+		GameParticleSystem::GameParticleSystem(int particleCount, ParticleSystemType systemType) :
+			ParticleSystem(particleCount, systemType),
 			primitive(pQuad),
 			model(NULL),
 			modelCycle(0.0f),
@@ -1004,7 +1400,7 @@ namespace Shared {
 		Vec3f UnitParticleSystem::lightColor = Vec3f(1.0f, 1.0f, 1.0f);
 
 		UnitParticleSystem::UnitParticleSystem(int particleCount) :
-			GameParticleSystem(particleCount), parent(NULL) {
+			GameParticleSystem(particleCount, pst_UnitParticleSystem), parent(NULL) {
 
 			particleSystemType = NULL;
 			radius = 0.5f;
@@ -1251,76 +1647,74 @@ namespace Shared {
 			ParticleSystem::update();
 		}
 
-		void UnitParticleSystem::updateParticle(Particle *p) {
-			float energyRatio;
+		void UnitParticleSystem::updateParticles(int first, int last) {
+			ParticleStore &p = particles;
+			const int *energy = &p.energy[0];
+			float *energyRatio = &p.energyRatio[0];
 			if (alternations > 0) {
 				int interval = (maxParticleEnergy / alternations);
-				float moduloValue = (float) ((int) (static_cast<float> (p->energy)) % interval);
 				float floatInterval = static_cast<float> (interval);
-
-				if (moduloValue < floatInterval / 2.0f) {
-					energyRatio = (floatInterval - moduloValue) / floatInterval;
-				} else {
-					energyRatio = moduloValue / floatInterval;
+				for (int i = first; i < last; ++i) {
+					float moduloValue = (float) (energy[i] % interval);
+					float ratio = (moduloValue < floatInterval / 2.0f ?
+						(floatInterval - moduloValue) / floatInterval : moduloValue / floatInterval);
+					ratio = (ratio < 0.0f ? 0.0f : (ratio > 1.0f ? 1.0f : ratio));
+					energyRatio[i] = truncateParticleValue(ratio);
 				}
-				energyRatio = clamp(energyRatio, 0.f, 1.f);
 			} else {
-				energyRatio = clamp(static_cast<float> (p->energy) / static_cast<float> (maxParticleEnergy), 0.f, 1.f);
+				computeEnergyRatios(energy, energyRatio, maxParticleEnergy, true, first, last);
+			}
+
+			float *pos[3] = { &p.posX[0], &p.posY[0], &p.posZ[0] };
+			float *lastPos[3] = { &p.lastPosX[0], &p.lastPosY[0], &p.lastPosZ[0] };
+			float *speed[3] = { &p.speedX[0], &p.speedY[0], &p.speedZ[0] };
+			const float *accel[3] = { &p.accelX[0], &p.accelY[0], &p.accelZ[0] };
+			const float *speedUpConstant[3] = { &p.speedUpConstantX[0], &p.speedUpConstantY[0], &p.speedUpConstantZ[0] };
+			const float *speedUpRelative = &p.speedUpRelative[0];
+			for (int axis = 0; axis < 3; ++axis) {
+				addParticleOffset(lastPos[axis], speed[axis], first, last);
+				addParticleOffset(pos[axis], speed[axis], first, last);
+				if (fixed) {
+					addParticleConstant(lastPos[axis], fixedAddition.ptr()[axis], first, last);
+					addParticleConstant(pos[axis], fixedAddition.ptr()[axis], first, last);
+				}
+				float *axisSpeed = speed[axis];
+				const float *axisAccel = accel[axis];
+				const float *axisSpeedUpConstant = speedUpConstant[axis];
+				for (int i = first; i < last; ++i) {
+					float value = axisSpeed[i] + axisAccel[i] + axisSpeedUpConstant[i];
+					axisSpeed[i] = truncateParticleValue(value * (1 + speedUpRelative[i]));
+				}
 			}
 
-			energyRatio = truncateDecimal<float>(energyRatio, 6);
-
-			p->lastPos += p->speed;
-			p->lastPos.x = truncateDecimal<float>(p->lastPos.x, 6);
-			p->lastPos.y = truncateDecimal<float>(p->lastPos.y, 6);
-			p->lastPos.z = truncateDecimal<float>(p->lastPos.z, 6);
-
-			p->pos += p->speed;
-			p->pos.x = truncateDecimal<float>(p->pos.x, 6);
-			p->pos.y = truncateDecimal<float>(p->pos.y, 6);
-			p->pos.z = truncateDecimal<float>(p->pos.z, 6);
-
-			if (fixed) {
-				p->lastPos += fixedAddition;
-				p->lastPos.x = truncateDecimal<float>(p->lastPos.x, 6);
-				p->lastPos.y = truncateDecimal<float>(p->lastPos.y, 6);
-				p->lastPos.z = truncateDecimal<float>(p->lastPos.z, 6);
-
-				p->pos += fixedAddition;
-				p->pos.x = truncateDecimal<float>(p->pos.x, 6);
-				p->pos.y = truncateDecimal<float>(p->pos.y, 6);
-				p->pos.z = truncateDecimal<float>(p->pos.z, 6);
-			}
-			p->speed += p->accel;
-			p->speed += p->speedUpConstant;
-			p->speed = p->speed*(1 + p->speedUpRelative);
-			p->speed.x = truncateDecimal<float>(p->speed.x, 6);
-			p->speed.y = truncateDecimal<float>(p->speed.y, 6);
-			p->speed.z = truncateDecimal<float>(p->speed.z, 6);
-
-			p->color = color * energyRatio + colorNoEnergy * (1.0f - energyRatio);
+			blendParticlesByEnergy(p, color, colorNoEnergy, particleSize, sizeNoEnergy, first, last);
 			if (isDaylightAffected == true) {
-				p->color.x = p->color.x*lightColor.x;
-				p->color.y = p->color.y*lightColor.y;
-				p->color.z = p->color.z*lightColor.z;
+				float *channels[3] = { &p.colorR[0], &p.colorG[0], &p.colorB[0] };
+				for (int channel = 0; channel < 3; ++channel) {
+					float *value = channels[channel];
+					float light = lightColor.ptr()[channel];
+					for (int i = first; i < last; ++i) {
+						value[i] = value[i] * light;
+					}
+				}
 			}
-			p->size = particleSize * energyRatio + sizeNoEnergy * (1.0f - energyRatio);
-			p->size = truncateDecimal<float>(p->size, 6);
 
 			if (state == ParticleSystem::sFade || staticParticleCount < 1) {
-				p->energy--;
-			} else {
-				if (maxParticleEnergy > 2) {
+				decreaseParticleEnergy(&p.energy[0], first, last);
+			} else if (maxParticleEnergy > 2) {
+				// energyUp is shared by all particles, so this one stays in order
+				int *particleEnergy = &p.energy[0];
+				for (int i = first; i < last; ++i) {
 					if (energyUp) {
-						p->energy++;
+						particleEnergy[i]++;
 					} else {
-						p->energy--;
+						particleEnergy[i]--;
 					}
 
-					if (p->energy == 1) {
+					if (particleEnergy[i] == 1) {
 						energyUp = true;
 					}
-					if (p->energy == maxParticleEnergy) {
+					if (particleEnergy[i] == maxParticleEnergy) {
 						energyUp = false;
 					}
 				}
@@ -1535,7 +1929,7 @@ namespace Shared {
 		//  RainParticleSystem
 		// ===========================================================================
 		RainParticleSystem::RainParticleSystem(int particleCount) :
-			ParticleSystem(particleCount) {
+			ParticleSystem(particleCount, pst_RainParticleSystem) {
 			setWind(0.0f, 0.0f);
 			setRadius(20.0f);
 
@@ -1570,8 +1964,8 @@ namespace Shared {
 			p->speed.z = truncateDecimal<float>(p->speed.z, 6);
 		}
 
-		bool RainParticleSystem::deathTest(Particle *p) {
-			return p->pos.y < 0;
+		void RainParticleSystem::removeDeadParticles() {
+			compactParticles(ParticleBelowGround());
 		}
 
 		void RainParticleSystem::setRadius(float radius) {
@@ -1615,7 +2009,7 @@ namespace Shared {
 		// ===========================================================================
 
 		SnowParticleSystem::SnowParticleSystem(int particleCount) :
-			ParticleSystem(particleCount) {
+			ParticleSystem(particleCount, pst_SnowParticleSystem) {
 			setWind(0.0f, 0.0f);
 			setRadius(30.0f);
 
@@ -1649,8 +2043,8 @@ namespace Shared {
 			p->speed.z = truncateDecimal<float>(p->speed.z, 6);
 		}
 
-		bool SnowParticleSystem::deathTest(Particle *p) {
-			return p->pos.y < 0;
+		void SnowParticleSystem::removeDeadParticles() {
+			compactParticles(ParticleBelowGround());
 		}
 
 		void SnowParticleSystem::setRadius(float radius) {
@@ -1694,8 +2088,8 @@ namespace Shared {
 		//  AttackParticleSystem
 		// ===========================================================================
 
-		AttackParticleSystem::AttackParticleSystem(int particleCount) :
-			GameParticleSystem(particleCount) {
+		AttackParticleSystem::AttackParticleSystem(int particleCount, ParticleSystemType systemType) :
+			GameParticleSystem(particleCount, systemType) {
 			primitive = pQuad;
 			gravity = 0.0f;
 			sizeNoEnergy = 0.0;
@@ -1745,7 +2139,7 @@ namespace Shared {
 		// ===========================================================================
 
 		ProjectileParticleSystem::ProjectileParticleSystem(int particleCount) :
-			AttackParticleSystem(particleCount) {
+			AttackParticleSystem(particleCount, pst_ProjectileParticleSystem) {
 			setEmissionRate(20.0f);
 			setColor(Vec4f(1.0f, 0.3f, 0.0f, 0.5f));
 			setMaxParticleEnergy(100);
@@ -1928,33 +2322,33 @@ namespace Shared {
 			p->accel.x = truncateDecimal<float>(p->accel.x, 6);
 			p->accel.y = truncateDecimal<float>(p->accel.y, 6);
 			p->accel.z = truncateDecimal<float>(p->accel.z, 6);
+		}
 
-			updateParticle(p);
+		int ProjectileParticleSystem::emitParticle(int particleIndex) {
+			int index = ParticleSystem::emitParticle(particleIndex);
+			// New particles get their first step right away
+			updateParticles(index, index + 1);
+			return index;
 		}
 
-		void ProjectileParticleSystem::updateParticle(Particle *p) {
-			float energyRatio = clamp(static_cast<float> (p->energy) / maxParticleEnergy, 0.f, 1.f);
-			energyRatio = truncateDecimal<float>(energyRatio, 6);
+		void ProjectileParticleSystem::updateParticles(int first, int last) {
+			ParticleStore &p = particles;
+			computeEnergyRatios(&p.energy[0], &p.energyRatio[0], maxParticleEnergy, true, first, last);
 
-			p->lastPos += p->speed;
-			p->lastPos.x = truncateDecimal<float>(p->lastPos.x, 6);
-			p->lastPos.y = truncateDecimal<float>(p->lastPos.y, 6);
-			p->lastPos.z = truncateDecimal<float>(p->lastPos.z, 6);
+			addParticleOffset(&p.lastPosX[0], &p.speedX[0], first, last);
+			addParticleOffset(&p.lastPosY[0], &p.speedY[0], first, last);
+			addParticleOffset(&p.lastPosZ[0], &p.speedZ[0], first, last);
 
-			p->pos += p->speed;
-			p->pos.x = truncateDecimal<float>(p->pos.x, 6);
-			p->pos.y = truncateDecimal<float>(p->pos.y, 6);
-			p->pos.z = truncateDecimal<float>(p->pos.z, 6);
+			addParticleOffset(&p.posX[0], &p.speedX[0], first, last);
+			addParticleOffset(&p.posY[0], &p.speedY[0], first, last);
+			addParticleOffset(&p.posZ[0], &p.speedZ[0], first, last);
 
-			p->speed += p->accel;
-			p->speed.x = truncateDecimal<float>(p->speed.x, 6);
-			p->speed.y = truncateDecimal<float>(p->speed.y, 6);
-			p->speed.z = truncateDecimal<float>(p->speed.z, 6);
+			addParticleOffset(&p.speedX[0], &p.accelX[0], first, last);
+			addParticleOffset(&p.speedY[0], &p.accelY[0], first, last);
+			addParticleOffset(&p.speedZ[0], &p.accelZ[0], first, last);
 
-			p->color = color * energyRatio + colorNoEnergy * (1.0f - energyRatio);
-			p->size = particleSize * energyRatio + sizeNoEnergy * (1.0f - energyRatio);
-			p->size = truncateDecimal<float>(p->size, 6);
-			p->energy--;
+			blendParticlesByEnergy(p, color, colorNoEnergy, particleSize, sizeNoEnergy, first, last);
+			decreaseParticleEnergy(&p.energy[0], first, last);
 		}
 
 		void ProjectileParticleSystem::setPath(Vec3f startPos, Vec3f endPos) {
@@ -2165,7 +2559,7 @@ namespace Shared {
 		// ===========================================================================
 
 		SplashParticleSystem::SplashParticleSystem(int particleCount) :
-			AttackParticleSystem(particleCount) {
+			AttackParticleSystem(particleCount, pst_SplashParticleSystem) {
 			setColor(Vec4f(1.0f, 0.3f, 0.0f, 0.8f));
 			setMaxParticleEnergy(100);
 			setVarParticleEnergy(50);
@@ -2249,26 +2643,31 @@ namespace Shared {
 			p->speedUpConstant = Vec3f(speedUpConstant)*p->speed;
 		}
 
-		void SplashParticleSystem::updateParticle(Particle *p) {
-			float energyRatio = clamp(static_cast<float> (p->energy) / maxParticleEnergy, 0.f, 1.f);
-
-			p->lastPos = p->pos;
-			p->pos = p->pos + p->speed;
-			p->pos.x = truncateDecimal<float>(p->pos.x, 6);
-			p->pos.y = truncateDecimal<float>(p->pos.y, 6);
-			p->pos.z = truncateDecimal<float>(p->pos.z, 6);
-
-			p->speed += p->speedUpConstant;
-			p->speed = p->speed*(1 + p->speedUpRelative);
-			p->speed = p->speed + p->accel;
-			p->speed.x = truncateDecimal<float>(p->speed.x, 6);
-			p->speed.y = truncateDecimal<float>(p->speed.y, 6);
-			p->speed.z = truncateDecimal<float>(p->speed.z, 6);
+		void SplashParticleSystem::updateParticles(int first, int last) {
+			ParticleStore &p = particles;
+			computeEnergyRatios(&p.energy[0], &p.energyRatio[0], maxParticleEnergy, false, first, last);
+
+			float *pos[3] = { &p.posX[0], &p.posY[0], &p.posZ[0] };
+			float *lastPos[3] = { &p.lastPosX[0], &p.lastPosY[0], &p.lastPosZ[0] };
+			float *speed[3] = { &p.speedX[0], &p.speedY[0], &p.speedZ[0] };
+			const float *accel[3] = { &p.accelX[0], &p.accelY[0], &p.accelZ[0] };
+			const float *speedUpConstant[3] = { &p.speedUpConstantX[0], &p.speedUpConstantY[0], &p.speedUpConstantZ[0] };
+			const float *speedUpRelative = &p.speedUpRelative[0];
+			for (int axis = 0; axis < 3; ++axis) {
+				copyParticleValues(pos[axis], lastPos[axis], first, last);
+				addParticleOffset(pos[axis], speed[axis], first, last);
+
+				float *axisSpeed = speed[axis];
+				const float *axisAccel = accel[axis];
+				const float *axisSpeedUpConstant = speedUpConstant[axis];
+				for (int i = first; i < last; ++i) {
+					float value = (axisSpeed[i] + axisSpeedUpConstant[i]) * (1 + speedUpRelative[i]);
+					axisSpeed[i] = truncateParticleValue(value + axisAccel[i]);
+				}
+			}
 
-			p->energy--;
-			p->color = color * energyRatio + colorNoEnergy * (1.0f - energyRatio);
-			p->size = particleSize * energyRatio + sizeNoEnergy * (1.0f - energyRatio);
-			p->size = truncateDecimal<float>(p->size, 6);
+			decreaseParticleEnergy(&p.energy[0], first, last);
+			blendParticlesByEnergy(p, color, colorNoEnergy, particleSize, sizeNoEnergy, first, last);
 		}
 
 		void SplashParticleSystem::saveGame(XmlNode *rootNode) {
@@ -2352,17 +2751,157 @@ namespace Shared {
 			return result;
 		}
 
+		// ===========================================================================
+		//  ParticleStepThread
+		// ===========================================================================
+
+		class ParticleStepThread : public BaseThread {
+		private:
+			Semaphore *stepSignal;
+
+		public:
+			ParticleStepThread(Semaphore *stepSignal) : BaseThread(), stepSignal(stepSignal) {
+				uniqueID = "ParticleStepThread";
+			}
+
+			virtual void execute() {
+				{
+					RunningStatusSafeWrapper runningStatus(this);
+#ifdef USE_STREFLOP
+					streflop_init<streflop::Simple>();
+#endif
+					while (getQuitStatus() == false) {
+						if (ParticleManager::processNextStep() == false) {
+							stepSignal->waitTillSignalled(100);
+						}
+					}
+				}
+				deleteSelfIfRequired();
+			}
+		};
+
+		static Mutex particleStepMutex;
+		static Semaphore *particleStepSignal = NULL;
+		static Semaphore *particleStepsDone = NULL;
+		static vector<ParticleStepThread *> particleStepThreads;
+		static vector<ParticleSystem *> particleSteps;
+		static int nextParticleStep = 0;
+		static int particleStepsLeft = 0;
+		static string particleStepError;
+
 		// ===========================================================================
 		//  ParticleManager
 		// ===========================================================================
 
 		ParticleManager::ParticleManager() {
+			removedParticleSystemCount = 0;
 		}
 
 		ParticleManager::~ParticleManager() {
 			end();
 		}
 
+		void ParticleManager::startWorkers(int threadCount) {
+			stopWorkers();
+			if (threadCount <= 0) {
+				return;
+			}
+			particleStepSignal = new Semaphore();
+			particleStepsDone = new Semaphore();
+			for (int i = 0; i < threadCount; ++i) {
+				ParticleStepThread *thread = new ParticleStepThread(particleStepSignal);
+				particleStepThreads.push_back(thread);
+				thread->start();
+			}
+		}
+
+		void ParticleManager::stopWorkers() {
+			for (unsigned int i = 0; i < particleStepThreads.size(); ++i) {
+				particleStepThreads[i]->signalQuit();
+				particleStepSignal->signal();
+			}
+			for (unsigned int i = 0; i < particleStepThreads.size(); ++i) {
+				// They wait on the semaphores deleted below
+				particleStepThreads[i]->shutdownAndJoin();
+				delete particleStepThreads[i];
+			}
+			particleStepThreads.clear();
+
+			delete particleStepSignal;
+			particleStepSignal = NULL;
+			delete particleStepsDone;
+			particleStepsDone = NULL;
+		}
+
+		int ParticleManager::getWorkerCount() {
+			return (int) particleStepThreads.size();
+		}
+
+		bool ParticleManager::processNextStep() {
+			MutexSafeWrapper safeMutex(&particleStepMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (nextParticleStep >= (int) particleSteps.size()) {
+				return false;
+			}
+			ParticleSystem *ps = particleSteps[nextParticleStep++];
+			safeMutex.ReleaseLock(true);
+
+			string error;
+			try {
+				ps->stepParticles();
+			} catch (const exception &ex) {
+				error = ex.what();
+			}
+
+			safeMutex.Lock();
+			if (error.empty() == false && particleStepError.empty() == true) {
+				particleStepError = error;
+			}
+			particleStepsLeft--;
+			if (particleStepsLeft == 0) {
+				particleStepsDone->signal();
+			}
+			return true;
+		}
+
+		void ParticleManager::stepParticleSystems() {
+			MutexSafeWrapper safeMutex(&particleStepMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			particleSteps.clear();
+			for (unsigned int i = 0; i < updatedSlots.size(); ++i) {
+				ParticleSystem *ps = particleSystems[updatedSlots[i]];
+				if (ps != NULL && ps->hasPendingParticleStep() == true) {
+					particleSteps.push_back(ps);
+				}
+			}
+			if (particleStepThreads.empty() == true || particleSteps.size() < 2) {
+				for (unsigned int i = 0; i < particleSteps.size(); ++i) {
+					particleSteps[i]->stepParticles();
+				}
+				particleSteps.clear();
+				return;
+			}
+			nextParticleStep = 0;
+			particleStepsLeft = (int) particleSteps.size();
+			particleStepError = "";
+			safeMutex.ReleaseLock(true);
+
+			for (unsigned int i = 0; i < particleStepThreads.size() && i + 1 < particleSteps.size(); ++i) {
+				particleStepSignal->signal();
+			}
+			// Lend a hand, then wait for the steps still running elsewhere
+			while (processNextStep() == true) {
+			}
+			particleStepsDone->waitTillSignalled();
+
+			safeMutex.Lock();
+			particleSteps.clear();
+			string error = particleStepError;
+			safeMutex.ReleaseLock();
+
+			if (error.empty() == false) {
+				throw megaglest_runtime_error(error);
+			}
+		}
+
 		void ParticleManager::render(ParticleRenderer *pr, ModelRenderer *mr) const {
 			for (unsigned int i = 0; i < particleSystems.size(); i++) {
 				ParticleSystem *ps = particleSystems[i];
@@ -2372,31 +2911,26 @@ namespace Shared {
 			}
 		}
 
+		static bool isParticleSystemShown(const ParticleSystem *ps) {
+			if (ps->getParticleSystemType() == ParticleSystem::pst_UnitParticleSystem ||
+				ps->getParticleSystemType() == ParticleSystem::pst_FireParticleSystem) {
+				return ps->getVisible() || (ps->getState() == ParticleSystem::sFade);
+			}
+			return true;
+		}
+
 		bool ParticleManager::hasActiveParticleSystem(ParticleSystem::ParticleSystemType type) const {
 			bool result = false;
 
-			//size_t particleSystemCount= particleSystems.size();
-			//int currentParticleCount= 0;
-
-			//vector<ParticleSystem *> cleanupParticleSystemsList;
 			for (unsigned int i = 0; i < particleSystems.size(); i++) {
 				ParticleSystem *ps = particleSystems[i];
-				if (ps != NULL) {
-					//currentParticleCount+= ps->getAliveParticleCount();
-
-					bool showParticle = true;
-					if (dynamic_cast<UnitParticleSystem *> (ps) != NULL ||
-						dynamic_cast<FireParticleSystem *> (ps) != NULL) {
-						showParticle = ps->getVisible() || (ps->getState() == ParticleSystem::sFade);
-					}
-					if (showParticle == true) {
-						//printf("Looking for [%d] current id [%d] i = %d\n",type,ps->getParticleSystemType(),i);
+				if (ps != NULL && isParticleSystemShown(ps) == true) {
+					//printf("Looking for [%d] current id [%d] i = %d\n",type,ps->getParticleSystemType(),i);
 
-						if (type == ParticleSystem::pst_All || type == ps->getParticleSystemType()) {
-							//printf("FOUND particle system type match for [%d] current id [%d] i = %d\n",type,ps->getParticleSystemType(),i);
-							result = true;
-							break;
-						}
+					if (type == ParticleSystem::pst_All || type == ps->getParticleSystemType()) {
+						//printf("FOUND particle system type match for [%d] current id [%d] i = %d\n",type,ps->getParticleSystemType(),i);
+						result = true;
+						break;
 					}
 				}
 			}
@@ -2408,38 +2942,52 @@ namespace Shared {
 			Chrono chrono;
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) chrono.start();
 
+			compactParticleSystems();
+
 			size_t particleSystemCount = particleSystems.size();
 			int currentParticleCount = 0;
 
-			vector<ParticleSystem *> cleanupParticleSystemsList;
-			for (unsigned int i = 0; i < particleSystems.size(); i++) {
-				ParticleSystem *ps = particleSystems[i];
-				if (ps != NULL) {
-					currentParticleCount += ps->getAliveParticleCount();
-
-					bool showParticle = true;
-					if (dynamic_cast<UnitParticleSystem *> (ps) != NULL ||
-						dynamic_cast<FireParticleSystem *> (ps) != NULL) {
-						showParticle = ps->getVisible() || (ps->getState() == ParticleSystem::sFade);
-					}
-					if (showParticle == true) {
-						ps->update();
-						if (ps->isEmpty() && ps->getState() == ParticleSystem::sFade) {
-							cleanupParticleSystemsList.push_back(ps);
+			// System logic runs in order, it moves children and calls
+			// observers that may add or remove systems
+			ParticleSystem::deferParticleSteps = (getWorkerCount() > 0);
+			updatedSlots.clear();
+			try {
+				for (unsigned int i = 0; i < particleSystems.size(); i++) {
+					ParticleSystem *ps = particleSystems[i];
+					if (ps != NULL) {
+						currentParticleCount += ps->getAliveParticleCount();
+
+						if (isParticleSystemShown(ps) == true) {
+							ps->update();
+							updatedSlots.push_back(i);
 						}
 					}
 				}
+			} catch (...) {
+				ParticleSystem::deferParticleSteps = false;
+				throw;
+			}
+			ParticleSystem::deferParticleSteps = false;
+
+			stepParticleSystems();
+
+			vector<ParticleSystem *> cleanupParticleSystemsList;
+			for (unsigned int i = 0; i < updatedSlots.size(); i++) {
+				ParticleSystem *ps = particleSystems[updatedSlots[i]];
+				if (ps != NULL && ps->isEmpty() && ps->getState() == ParticleSystem::sFade) {
+					cleanupParticleSystemsList.push_back(ps);
+				}
 			}
-			//particleSystems.remove(NULL);
+			updatedSlots.clear();
 			cleanupParticleSystems(cleanupParticleSystemsList);
+			compactParticleSystems();
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0)
 				SystemFlags::OutputDebug(SystemFlags::debugPerformance, "In [%s::%s] Line: %d took msecs: %lld, particleSystemCount = %d, currentParticleCount = %d\n", __FILE__, __FUNCTION__, __LINE__, chrono.getMillis(), particleSystemCount, currentParticleCount);
 		}
 
 		bool ParticleManager::validateParticleSystemStillExists(ParticleSystem * particleSystem) const {
-			int index = findParticleSystems(particleSystem, this->particleSystems);
-			return (index >= 0);
+			return particleSystemSlots.find(particleSystem) != particleSystemSlots.end();
 		}
 
 		void ParticleManager::removeParticleSystemsForParticleOwner(ParticleOwner *particleOwner) {
@@ -2470,28 +3018,46 @@ namespace Shared {
 			return result;
 		}
 
-		void ParticleManager::cleanupParticleSystems(ParticleSystem *ps) {
-
-			int index = findParticleSystems(ps, this->particleSystems);
-			if (ps != NULL && index >= 0) {
-				//		printf("-- Delete cleanupParticleSystems [%p]\n",ps);
-				//		static map<void *,int> deleteList;
-				//		if(deleteList.find(ps) != deleteList.end()) {
-				//			assert(deleteList.find(ps) == deleteList.end());
-				//		}
-				//		deleteList[ps]++;
+		void ParticleManager::removeParticleSystem(int slot) {
+			ParticleSystem *ps = particleSystems[slot];
+			ps->callParticleOwnerEnd(ps);
 
-						// This code causes segfault on game end, no need to fade, just delete
-						//if(ps->getState() != ParticleSystem::sFade) {
-						//	ps->fade();
-						//}
+			// The owner may have removed it already
+			if (particleSystems[slot] == ps) {
+				particleSystemSlots.erase(ps);
+				particleSystems[slot] = NULL;
+				removedParticleSystemCount++;
+				delete ps;
+			}
+		}
 
+		void ParticleManager::compactParticleSystems() {
+			if (removedParticleSystemCount == 0) {
+				return;
+			}
+			int count = 0;
+			for (unsigned int i = 0; i < particleSystems.size(); i++) {
+				ParticleSystem *ps = particleSystems[i];
 				if (ps != NULL) {
-					ps->callParticleOwnerEnd(ps);
+					if (count != (int) i) {
+						particleSystems[count] = ps;
+						particleSystemSlots[ps] = count;
+					}
+					count++;
 				}
+			}
+			particleSystems.resize(count);
+			removedParticleSystemCount = 0;
+		}
 
-				delete ps;
-				this->particleSystems.erase(this->particleSystems.begin() + index);
+		void ParticleManager::cleanupParticleSystems(ParticleSystem *ps) {
+			std::unordered_map<const ParticleSystem *, int>::iterator iterFind = particleSystemSlots.find(ps);
+			if (ps != NULL && iterFind != particleSystemSlots.end()) {
+				// This code causes segfault on game end, no need to fade, just delete
+				//if(ps->getState() != ParticleSystem::sFade) {
+				//	ps->fade();
+				//}
+				removeParticleSystem(iterFind->second);
 			}
 		}
 
@@ -2517,7 +3083,8 @@ namespace Shared {
 		}
 
 		void ParticleManager::manage(ParticleSystem *ps) {
-			assert((std::find(particleSystems.begin(), particleSystems.end(), ps) == particleSystems.end()) && "particle cannot be added twice");
+			assert((particleSystemSlots.find(ps) == particleSystemSlots.end()) && "particle cannot be added twice");
+			particleSystemSlots[ps] = (int) particleSystems.size();
 			particleSystems.push_back(ps);
 			for (int i = ps->getChildCount() - 1; i >= 0; i--) {
 				manage(ps->getChild(i));
@@ -2526,21 +3093,15 @@ namespace Shared {
 
 		void ParticleManager::end() {
 			while (particleSystems.empty() == false) {
-				ParticleSystem *ps = particleSystems.back();
-
-				//		printf("-- Delete end() [%p]\n",ps);
-				//		static map<void *,int> deleteList;
-				//		if(deleteList.find(ps) != deleteList.end()) {
-				//			assert(deleteList.find(ps) == deleteList.end());
-				//		}
-				//		deleteList[ps]++;
-
-				if (ps != NULL) {
-					ps->callParticleOwnerEnd(ps);
+				if (particleSystems.back() != NULL) {
+					removeParticleSystem((int) particleSystems.size() - 1);
+				}
+				while (particleSystems.empty() == false && particleSystems.back() == NULL) {
+					particleSystems.pop_back();
 				}
-				delete ps;
-				particleSystems.pop_back();
 			}
+			particleSystemSlots.clear();
+			removedParticleSystemCount = 0;
 		}
 
 		}
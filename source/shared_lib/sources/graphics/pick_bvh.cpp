@@ -0,0 +1,236 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// pick_bvh.cpp: bounding volume hierarchy of axis aligned boxes, finds
+// what a picking ray hits first or what lies inside a selection frustum
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "pick_bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared {
+	namespace Graphics {
+
+		// =====================================================
+		//	class PickBox
+		// =====================================================
+
+		PickBox::PickBox() {
+			id = -1;
+		}
+
+		PickBox::PickBox(const Vec3f &boxMin, const Vec3f &boxMax, int id) : boxMin(boxMin), boxMax(boxMax) {
+			this->id = id;
+		}
+
+		void PickBox::add(const Vec3f &point) {
+			boxMin.x = min(boxMin.x, point.x);
+			boxMin.y = min(boxMin.y, point.y);
+			boxMin.z = min(boxMin.z, point.z);
+			boxMax.x = max(boxMax.x, point.x);
+			boxMax.y = max(boxMax.y, point.y);
+			boxMax.z = max(boxMax.z, point.z);
+		}
+
+		// =====================================================
+		//	class PickBvh
+		// =====================================================
+
+		class PickBoxCenterLess {
+			int axis;
+		public:
+			PickBoxCenterLess(int axis) {
+				this->axis = axis;
+			}
+			bool operator()(const PickBox &a, const PickBox &b) const {
+				return a.boxMin.ptr()[axis] + a.boxMax.ptr()[axis] < b.boxMin.ptr()[axis] + b.boxMax.ptr()[axis];
+			}
+		};
+
+		void PickBvh::build(const vector<PickBox> &boxes) {
+			this->boxes = boxes;
+			nodes.clear();
+			if (this->boxes.empty() == false) {
+				nodes.reserve(this->boxes.size() * 2 / maxLeafBoxes + 1);
+				buildNode(0, (int) this->boxes.size());
+			}
+		}
+
+		void PickBvh::clear() {
+			boxes.clear();
+			nodes.clear();
+		}
+
+		int PickBvh::buildNode(int first, int count) {
+			int nodeIndex = (int) nodes.size();
+			nodes.push_back(Node());
+
+			PickBox bounds = boxes[first];
+			for (int i = first + 1; i < first + count; ++i) {
+				bounds.add(boxes[i].boxMin);
+				bounds.add(boxes[i].boxMax);
+			}
+
+			int left = -1;
+			int right = -1;
+			if (count > maxLeafBoxes) {
+				Vec3f extent = bounds.boxMax - bounds.boxMin;
+				int axis = 0;
+				if (extent.y > extent.x) {
+					axis = 1;
+				}
+				if (extent.z > max(extent.x, extent.y)) {
+					axis = 2;
+				}
+				int half = count / 2;
+				nth_element(boxes.begin() + first, boxes.begin() + first + half,
+					boxes.begin() + first + count, PickBoxCenterLess(axis));
+				left = buildNode(first, half);
+				right = buildNode(first + half, count - half);
+			}
+
+			// Children were pushed after this node, look it up again
+			Node &node = nodes[nodeIndex];
+			node.boxMin = bounds.boxMin;
+			node.boxMax = bounds.boxMax;
+			node.left = left;
+			node.right = right;
+			node.first = first;
+			node.count = count;
+			return nodeIndex;
+		}
+
+		bool PickBvh::intersectRay(const Vec3f &boxMin, const Vec3f &boxMax,
+			const Vec3f &origin, const Vec3f &direction, float &distance) {
+			const float *boxMinAxes = boxMin.ptr();
+			const float *boxMaxAxes = boxMax.ptr();
+			const float *originAxes = origin.ptr();
+			const float *directionAxes = direction.ptr();
+			float entry = 0.f;
+			float exit = 1e30f;
+			for (int axis = 0; axis < 3; ++axis) {
+				if (fabs(directionAxes[axis]) < 1e-9f) {
+					if (originAxes[axis] < boxMinAxes[axis] || originAxes[axis] > boxMaxAxes[axis]) {
+						return false;
+					}
+					continue;
+				}
+				float inverse = 1.f / directionAxes[axis];
+				float slabNear = (boxMinAxes[axis] - originAxes[axis]) * inverse;
+				float slabFar = (boxMaxAxes[axis] - originAxes[axis]) * inverse;
+				if (slabNear > slabFar) {
+					swap(slabNear, slabFar);
+				}
+				entry = max(entry, slabNear);
+				exit = min(exit, slabFar);
+				if (entry > exit) {
+					return false;
+				}
+			}
+			distance = entry;
+			return true;
+		}
+
+		int PickBvh::findNearest(const Vec3f &origin, const Vec3f &direction, float *distance) const {
+			int nearestId = -1;
+			float nearestDistance = 1e30f;
+			if (nodes.empty() == true) {
+				return nearestId;
+			}
+
+			int stack[64];
+			int stackSize = 0;
+			stack[stackSize++] = 0;
+			while (stackSize > 0) {
+				const Node &node = nodes[stack[--stackSize]];
+				float nodeDistance = 0;
+				if (intersectRay(node.boxMin, node.boxMax, origin, direction, nodeDistance) == false ||
+					nodeDistance >= nearestDistance) {
+					continue;
+				}
+				if (node.left < 0) {
+					for (int i = node.first; i < node.first + node.count; ++i) {
+						float boxDistance = 0;
+						if (intersectRay(boxes[i].boxMin, boxes[i].boxMax, origin, direction, boxDistance) == true &&
+							boxDistance < nearestDistance) {
+							nearestDistance = boxDistance;
+							nearestId = boxes[i].id;
+						}
+					}
+				} else {
+					stack[stackSize++] = node.right;
+					stack[stackSize++] = node.left;
+				}
+			}
+			if (distance != NULL && nearestId >= 0) {
+				*distance = nearestDistance;
+			}
+			return nearestId;
+		}
+
+		// A box is outside a plane when its corner furthest along the
+		// plane normal still is behind it
+		static bool isBoxOutside(const Vec3f &boxMin, const Vec3f &boxMax, const Vec4f *planes, int planeCount) {
+			for (int i = 0; i < planeCount; ++i) {
+				const Vec4f &plane = planes[i];
+				float x = (plane.x >= 0 ? boxMax.x : boxMin.x);
+				float y = (plane.y >= 0 ? boxMax.y : boxMin.y);
+				float z = (plane.z >= 0 ? boxMax.z : boxMin.z);
+				if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void PickBvh::findInside(const Vec4f *planes, int planeCount, vector<int> &ids) const {
+			if (nodes.empty() == true) {
+				return;
+			}
+
+			int stack[64];
+			int stackSize = 0;
+			stack[stackSize++] = 0;
+			while (stackSize > 0) {
+				const Node &node = nodes[stack[--stackSize]];
+				if (isBoxOutside(node.boxMin, node.boxMax, planes, planeCount) == true) {
+					continue;
+				}
+				if (node.left < 0) {
+					for (int i = node.first; i < node.first + node.count; ++i) {
+						if (isBoxOutside(boxes[i].boxMin, boxes[i].boxMax, planes, planeCount) == false) {
+							ids.push_back(boxes[i].id);
+						}
+					}
+				} else {
+					stack[stackSize++] = node.right;
+					stack[stackSize++] = node.left;
+				}
+			}
+		}
+
+	}
+}//end namespace
@@ -1356,6 +1356,20 @@ namespace Shared {
 			CalculatePixelsCRC(pixels, getPixelByteCount(), crc);
 		}
 
+		void Pixmap2D::transferFrom(Pixmap2D *sourcePixmap) {
+			deletePixels();
+			w = sourcePixmap->w;
+			h = sourcePixmap->h;
+			components = sourcePixmap->components;
+			pixels = sourcePixmap->pixels;
+			path = sourcePixmap->path;
+			crc = sourcePixmap->crc;
+
+			sourcePixmap->pixels = NULL;
+			sourcePixmap->w = -1;
+			sourcePixmap->h = -1;
+		}
+
 		void Pixmap2D::subCopy(int x, int y, const Pixmap2D *sourcePixmap) {
 			assert(components == sourcePixmap->getComponents());
 
@@ -0,0 +1,147 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// render_queue.cpp: draw items of a render pass sorted by the state
+// they need
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "render_queue.h"
+
+#include <string.h>
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Platform;
+
+namespace Shared {
+	namespace Graphics {
+
+		// Key layout, lowest keys are drawn first:
+		// opaque:  0 | 31 unused bits | 16 bits team texture | 16 bits model
+		// blended: 1 | 32 bits inverted depth | 15 bits team texture | 16 bits model
+		static const int maxModelSlot = 0xFFFF;
+		static const int maxTeamTextureSlot = 0x7FFF;
+
+		// =====================================================
+		//	class RenderQueue
+		// =====================================================
+
+		RenderQueue::RenderQueue() {
+			batchCount = 0;
+			stateChangeCount = 0;
+		}
+
+		void RenderQueue::clear() {
+			items.clear();
+			keys.clear();
+			order.clear();
+			modelSlots.clear();
+			teamTextureSlots.clear();
+			batchCount = 0;
+			stateChangeCount = 0;
+		}
+
+		int RenderQueue::getSlot(std::map<const void *, int> &slots, const void *ptr, int maxSlot) {
+			std::map<const void *, int>::iterator iterFind = slots.find(ptr);
+			if (iterFind != slots.end()) {
+				return iterFind->second;
+			}
+			// Past the limit items still draw right, just not grouped
+			int slot = ((int) slots.size() < maxSlot ? (int) slots.size() : maxSlot);
+			slots[ptr] = slot;
+			return slot;
+		}
+
+		void RenderQueue::add(const RenderQueueItem &item) {
+			uint64 key = (uint64) getSlot(modelSlots, item.model, maxModelSlot);
+			uint64 teamTextureSlot = (uint64) getSlot(teamTextureSlots, item.teamTexture, maxTeamTextureSlot);
+			if (item.blended == true) {
+				// Non negative floats order like their bits
+				float depth = (item.depth > 0 ? item.depth : 0);
+				uint32 depthBits = 0;
+				memcpy(&depthBits, &depth, sizeof(depthBits));
+				key |= ((uint64) 1 << 63) | ((uint64) (0xFFFFFFFFu - depthBits) << 31) | (teamTextureSlot << 16);
+			} else {
+				key |= (teamTextureSlot << 16);
+			}
+
+			order.push_back((int) items.size());
+			keys.push_back(key);
+			items.push_back(item);
+		}
+
+		void RenderQueue::sort() {
+			radixSort();
+			countStateChanges();
+		}
+
+		// Least significant byte first, bytes every key shares are skipped
+		void RenderQueue::radixSort() {
+			int count = (int) keys.size();
+			sortKeys.resize(count);
+			sortOrder.resize(count);
+			for (int shift = 0; shift < 64; shift += 8) {
+				int offsets[256];
+				memset(offsets, 0, sizeof(offsets));
+				for (int i = 0; i < count; ++i) {
+					offsets[(keys[i] >> shift) & 0xFF]++;
+				}
+				if (count == 0 || offsets[(keys[0] >> shift) & 0xFF] == count) {
+					continue;
+				}
+				int total = 0;
+				for (int digit = 0; digit < 256; ++digit) {
+					int digitCount = offsets[digit];
+					offsets[digit] = total;
+					total += digitCount;
+				}
+				for (int i = 0; i < count; ++i) {
+					int dest = offsets[(keys[i] >> shift) & 0xFF]++;
+					sortKeys[dest] = keys[i];
+					sortOrder[dest] = order[i];
+				}
+				keys.swap(sortKeys);
+				order.swap(sortOrder);
+			}
+		}
+
+		void RenderQueue::countStateChanges() {
+			batchCount = 0;
+			stateChangeCount = 0;
+			for (int i = 0; i < (int) order.size(); ++i) {
+				const RenderQueueItem &item = items[order[i]];
+				if (i == 0) {
+					batchCount++;
+					continue;
+				}
+				const RenderQueueItem &lastItem = items[order[i - 1]];
+				int changes = (item.blended != lastItem.blended ? 1 : 0) +
+					(item.teamTexture != lastItem.teamTexture ? 1 : 0) +
+					(item.model != lastItem.model ? 1 : 0);
+				if (changes > 0) {
+					batchCount++;
+					stateChangeCount += changes;
+				}
+			}
+		}
+
+	}
+}//end namespace
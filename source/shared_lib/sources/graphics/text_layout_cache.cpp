@@ -0,0 +1,169 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// text_layout_cache.cpp: shaped text, glyph runs and metrics of strings
+// rendered again and again with the same font
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "text_layout_cache.h"
+
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared {
+	namespace Graphics {
+
+		int TextLayoutCache::shapingGeneration = 0;
+
+		// =====================================================
+		//	class TextLayout
+		// =====================================================
+
+		TextLayout::TextLayout() {
+			shaped = false;
+			advance = -1;
+			width = -1;
+		}
+
+		// =====================================================
+		//	class TextLayoutCache
+		// =====================================================
+
+		TextLayoutCache::TextLayoutCache(Text *textHandler, TextShaper shaper, int maxLayouts) {
+			this->textHandler = textHandler;
+			this->shaper = shaper;
+			this->maxLayouts = maxLayouts;
+			generation = shapingGeneration;
+			hitCount = 0;
+			missCount = 0;
+		}
+
+		void TextLayoutCache::setTextHandler(Text *textHandler) {
+			this->textHandler = textHandler;
+			clear();
+		}
+
+		void TextLayoutCache::setShaper(TextShaper shaper) {
+			this->shaper = shaper;
+			clear();
+		}
+
+		void TextLayoutCache::clear() {
+			layouts.clear();
+			lineHeights.clear();
+			generation = shapingGeneration;
+		}
+
+		int TextLayoutCache::getFaceSize() {
+			return (textHandler != NULL ? textHandler->GetFaceSize() : 0);
+		}
+
+		TextLayout &TextLayoutCache::findLayout(const string &text) {
+			if (generation != shapingGeneration) {
+				clear();
+			}
+			LayoutKey key(getFaceSize(), text);
+			std::map<LayoutKey, TextLayout>::iterator iterFind = layouts.find(key);
+			if (iterFind != layouts.end()) {
+				hitCount++;
+				return iterFind->second;
+			}
+			missCount++;
+			if ((int) layouts.size() >= maxLayouts) {
+				layouts.clear();
+			}
+			return layouts[key];
+		}
+
+		const TextLayout &TextLayoutCache::getLayout(const string &text, bool measureAdvance) {
+			TextLayout &layout = findLayout(text);
+			if (layout.shaped == false) {
+				layout.shapedText = text;
+				if (shaper != NULL) {
+					shaper(layout.shapedText, textHandler != NULL);
+				}
+
+				const string &shapedText = layout.shapedText;
+				if (shapedText.find_first_of("\t\n") != shapedText.npos) {
+					bool lastCharacterWasSpecial = true;
+					for (size_t i = 0; i < shapedText.size(); ++i) {
+						char c = shapedText[i];
+						if (c == '\t' || c == '\n') {
+							layout.runs.push_back(string(1, c));
+							lastCharacterWasSpecial = true;
+						} else if (lastCharacterWasSpecial == true) {
+							layout.runs.push_back(string(1, c));
+							lastCharacterWasSpecial = false;
+						} else {
+							layout.runs.back() += c;
+						}
+					}
+				}
+				layout.shaped = true;
+			}
+			if (measureAdvance == true && layout.advance < 0) {
+				layout.advance = (textHandler != NULL ? textHandler->Advance(layout.shapedText.c_str()) : 0);
+			}
+			return layout;
+		}
+
+		float TextLayoutCache::getTextWidth(const string &text) {
+			TextLayout &layout = findLayout(text);
+			if (layout.width < 0) {
+				size_t longestStart = 0;
+				size_t longestLength = 0;
+				for (size_t lineStart = 0; lineStart <= text.size();) {
+					size_t lineEnd = text.find('\n', lineStart);
+					if (lineEnd == text.npos) {
+						lineEnd = text.size();
+					}
+					if (lineEnd - lineStart > longestLength) {
+						longestStart = lineStart;
+						longestLength = lineEnd - lineStart;
+					}
+					lineStart = lineEnd + 1;
+				}
+				layout.width = (textHandler != NULL ? textHandler->Advance(text.substr(longestStart, longestLength).c_str()) : 0);
+			}
+			return layout.width;
+		}
+
+		// The line height of a face does not depend on the text
+		float TextLayoutCache::getLineHeight() {
+			if (generation != shapingGeneration) {
+				clear();
+			}
+			if (textHandler == NULL) {
+				return 0;
+			}
+			int faceSize = getFaceSize();
+			std::map<int, float>::iterator iterFind = lineHeights.find(faceSize);
+			if (iterFind != lineHeights.end()) {
+				return iterFind->second;
+			}
+			float lineHeight = textHandler->LineHeight(" ");
+			lineHeights[faceSize] = lineHeight;
+			return lineHeight;
+		}
+
+	}
+}//end namespace
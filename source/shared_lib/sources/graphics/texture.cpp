@@ -229,6 +229,16 @@ namespace Shared {
 			this->path = path;
 		}
 
+		void Texture2D::initPlaceholder(const string &path) {
+			int components = (pixmap.getComponents() == -1 ? defaultComponents : pixmap.getComponents());
+			Pixmap2D placeholder(1, 1, components);
+			for (int i = 0; i < components; ++i) {
+				placeholder.setComponent(0, 0, i, (uint8) (i == 3 ? 255 : 128));
+			}
+			pixmap.transferFrom(&placeholder);
+			this->path = path;
+		}
+
 		string Texture2D::getPath() const {
 			return (pixmap.getPath() != "" ? pixmap.getPath() : path);
 		}
@@ -16,6 +16,7 @@
 
 #include "graphics_interface.h"
 #include "graphics_factory.h"
+#include "async_texture_loader.h"
 
 #include "util.h"
 #include "platform_util.h"
@@ -39,6 +40,7 @@ namespace Shared {
 
 			textureFilter = Texture::fBilinear;
 			maxAnisotropy = 1;
+			loadAsync = false;
 		}
 
 		TextureManager::~TextureManager() {
@@ -65,6 +67,7 @@ namespace Shared {
 				if (found == false && mustExistInList == true) {
 					throw std::runtime_error("found == false in endTexture");
 				}
+				AsyncTextureLoader::cancel(texture);
 				texture->end();
 				delete texture;
 			}
@@ -78,6 +81,7 @@ namespace Shared {
 				Texture *curTexture = textures[index];
 				textures.erase(textures.begin() + index);
 
+				AsyncTextureLoader::cancel(curTexture);
 				curTexture->end();
 				delete curTexture;
 			}
@@ -105,6 +109,7 @@ namespace Shared {
 		void TextureManager::end() {
 			for (unsigned int i = 0; i < textures.size(); ++i) {
 				if (textures[i] != NULL) {
+					AsyncTextureLoader::cancel(textures[i]);
 					textures[i]->end();
 					delete textures[i];
 				}
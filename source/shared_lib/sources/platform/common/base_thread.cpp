@@ -360,5 +360,11 @@ namespace Shared {
 			return ret;
 		}
 
+		void BaseThread::shutdownAndJoin() {
+			while (shutdownAndWait() == false) {
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] uniqueID [%s] still running, waiting\n", __FILE__, __FUNCTION__, __LINE__, getUniqueID().c_str());
+			}
+		}
+
 	}
 }//end namespace
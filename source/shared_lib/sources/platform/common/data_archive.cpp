@@ -0,0 +1,631 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// data_archive.cpp: packed game data archives and the file system
+// layer that reads from them
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "data_archive.h"
+#include <algorithm>
+#include <string.h>
+#include <sys/stat.h>
+#include "byte_order.h"
+#include "checksum.h"
+#include "conversion.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "thread.h"
+#include "util.h"
+#include "utf8.h"
+
+#ifdef HAVE_ZLIB
+	#include <zlib.h>
+#else
+	#include "miniz/miniz.h"
+#endif
+
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::Platform;
+
+namespace Shared {
+	namespace PlatformCommon {
+
+		// =====================================================
+		//	class DataArchive
+		// =====================================================
+
+		static const uint32 dataArchiveMagic = 0x5A475041;
+		static const size_t dataArchiveHeaderSize = 32;
+
+		const uint32 DataArchive::version = 2;
+		const string DataArchive::fileExtension = ".zgp";
+		const uint64 DataArchive::blobAlignment = 4096;
+
+		template<typename T>
+		static void appendArchiveValue(string &buffer, T value) {
+			value = Shared::PlatformByteOrder::toCommonEndian(value);
+			buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+
+		template<typename T>
+		static bool readArchiveValue(const char *&data, const char *dataEnd, T &value) {
+			if ((size_t) (dataEnd - data) < sizeof(value)) {
+				return false;
+			}
+			memcpy(&value, data, sizeof(value));
+			value = Shared::PlatformByteOrder::fromCommonEndian(value);
+			data += sizeof(value);
+			return true;
+		}
+
+		static FILE *openArchiveFile(const string &path, const char *mode) {
+#ifdef WIN32
+			return _wfopen(utf8_decode(path).c_str(), utf8_decode(mode).c_str());
+#else
+			return fopen(path.c_str(), mode);
+#endif
+		}
+
+		static bool readWholeFile(const string &path, vector<char> &data) {
+			FILE *fp = openArchiveFile(path, "rb");
+			if (fp == NULL) {
+				return false;
+			}
+			data.clear();
+			char buffer[64 * 1024];
+			size_t readBytes = 0;
+			while ((readBytes = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+				data.insert(data.end(), buffer, buffer + readBytes);
+			}
+			bool result = (ferror(fp) == 0);
+			fclose(fp);
+			return result;
+		}
+
+		static bool getArchiveFileStamp(const string &path, uint64 &size, int64 &modified) {
+#ifdef WIN32
+			struct _stat64 fileStat;
+			if (_wstat64(utf8_decode(path).c_str(), &fileStat) != 0) {
+				return false;
+			}
+#else
+			struct stat fileStat;
+			if (stat(path.c_str(), &fileStat) != 0) {
+				return false;
+			}
+#endif
+			size = (uint64) fileStat.st_size;
+			modified = (int64) fileStat.st_mtime * 1000000000;
+#if defined(__APPLE__)
+			modified += (int64) fileStat.st_mtimespec.tv_nsec;
+#elif !defined(WIN32)
+			modified += (int64) fileStat.st_mtim.tv_nsec;
+#endif
+			return true;
+		}
+
+		// The files below rootPath that get packed, relative to it
+		static vector<string> getArchiveFolderFiles(const string &rootPath) {
+			vector<string> files = getFolderTreeContentsListRecursively(rootPath + "*", "");
+			vector<string> result;
+			for (unsigned int i = 0; i < files.size(); ++i) {
+				// Same files a folder checksum walk picks up
+				if (EndsWith(files[i], ".git") == true || StartsWith(files[i], rootPath) == false) {
+					continue;
+				}
+				result.push_back(VirtualFileSystem::normalizePath(files[i].substr(rootPath.size())));
+			}
+			return result;
+		}
+
+		static bool compareEntries(const DataArchiveEntry &a, const DataArchiveEntry &b) {
+			return a.path < b.path;
+		}
+
+		static bool compareEntryPath(const DataArchiveEntry &entry, const string &path) {
+			return entry.path < path;
+		}
+
+		DataArchive::DataArchive() {
+		}
+
+		DataArchive::~DataArchive() {
+			close();
+		}
+
+		bool DataArchive::create(const string &folder, const string &archiveFile, bool compress) {
+			string rootPath = folder;
+			endPathWithSlash(rootPath);
+
+			vector<string> files = getArchiveFolderFiles(rootPath);
+			vector<DataArchiveEntry> newEntries;
+			for (unsigned int i = 0; i < files.size(); ++i) {
+				DataArchiveEntry entry;
+				entry.path = files[i];
+				newEntries.push_back(entry);
+			}
+			std::sort(newEntries.begin(), newEntries.end(), compareEntries);
+
+			string tempFile = archiveFile + ".tmp";
+			FILE *fp = openArchiveFile(tempFile, "wb");
+			if (fp == NULL) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Can not create data archive [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, tempFile.c_str());
+				return false;
+			}
+
+			// The header is written last, once the index position is known
+			bool result = true;
+			vector<char> padding((size_t) blobAlignment, 0);
+			uint64 position = blobAlignment;
+			result = (fwrite(&padding[0], padding.size(), 1, fp) == 1);
+
+			vector<char> data;
+			vector<unsigned char> compressed;
+			for (unsigned int i = 0; result == true && i < newEntries.size(); ++i) {
+				DataArchiveEntry &entry = newEntries[i];
+				string filePath = rootPath + entry.path;
+				if (readWholeFile(filePath, data) == false) {
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Can not read [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, filePath.c_str());
+					result = false;
+					break;
+				}
+				uint64 fileSize = 0;
+				if (getArchiveFileStamp(filePath, fileSize, entry.modified) == false) {
+					result = false;
+					break;
+				}
+				entry.crc = Checksum::getFileSum(filePath);
+				entry.offset = position;
+				entry.size = data.size();
+				entry.storedSize = data.size();
+
+				const char *blob = (data.empty() == false ? &data[0] : NULL);
+				if (compress == true && data.empty() == false) {
+					uLongf compressedSize = compressBound((uLong) data.size());
+					compressed.resize(compressedSize);
+					int compressResult = compress2(&compressed[0], &compressedSize,
+						reinterpret_cast<const unsigned char *>(&data[0]), (uLong) data.size(), Z_BEST_COMPRESSION);
+					// Only worth inflating on every read if it saves something
+					if (compressResult == Z_OK && compressedSize < data.size() - data.size() / 10) {
+						entry.flags |= DataArchiveEntry::fCompressed;
+						entry.storedSize = compressedSize;
+						blob = reinterpret_cast<const char *>(&compressed[0]);
+					}
+				}
+
+				if (entry.storedSize > 0) {
+					result = (fwrite(blob, (size_t) entry.storedSize, 1, fp) == 1);
+					position += entry.storedSize;
+				}
+				uint64 paddingSize = (blobAlignment - position % blobAlignment) % blobAlignment;
+				if (result == true && paddingSize > 0) {
+					result = (fwrite(&padding[0], (size_t) paddingSize, 1, fp) == 1);
+					position += paddingSize;
+				}
+			}
+
+			if (result == true) {
+				string index;
+				for (unsigned int i = 0; i < newEntries.size(); ++i) {
+					const DataArchiveEntry &entry = newEntries[i];
+					appendArchiveValue(index, (uint32) entry.path.size());
+					index.append(entry.path);
+					appendArchiveValue(index, entry.crc);
+					appendArchiveValue(index, entry.flags);
+					appendArchiveValue(index, entry.offset);
+					appendArchiveValue(index, entry.size);
+					appendArchiveValue(index, entry.storedSize);
+					appendArchiveValue(index, entry.modified);
+				}
+				string header;
+				appendArchiveValue(header, dataArchiveMagic);
+				appendArchiveValue(header, version);
+				appendArchiveValue(header, (uint32) newEntries.size());
+				appendArchiveValue(header, (uint32) 0);
+				appendArchiveValue(header, position);
+				appendArchiveValue(header, (uint64) index.size());
+
+				result = (index.empty() == true || fwrite(index.data(), index.size(), 1, fp) == 1) &&
+					fseek(fp, 0, SEEK_SET) == 0 &&
+					fwrite(header.data(), header.size(), 1, fp) == 1;
+			}
+			if (fclose(fp) != 0) {
+				result = false;
+			}
+
+			if (result == true) {
+				removeFile(archiveFile);
+				result = renameFile(tempFile, archiveFile);
+			}
+			if (result == false) {
+				removeFile(tempFile);
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Failed to write data archive [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, archiveFile.c_str());
+			}
+			return result;
+		}
+
+		bool DataArchive::open(const string &archiveFile) {
+			close();
+			if (mappedFile.open(archiveFile) == false) {
+				return false;
+			}
+
+			const char *fileStart = mappedFile.getArray<char>(0, mappedFile.getSize());
+			const char *fileEnd = fileStart + mappedFile.getSize();
+			const char *data = fileStart;
+			uint32 magic = 0;
+			uint32 fileVersion = 0;
+			uint32 fileCount = 0;
+			uint32 reserved = 0;
+			uint64 indexOffset = 0;
+			uint64 indexSize = 0;
+			bool valid = mappedFile.getSize() >= dataArchiveHeaderSize &&
+				readArchiveValue(data, fileEnd, magic) && magic == dataArchiveMagic &&
+				readArchiveValue(data, fileEnd, fileVersion) && fileVersion == version &&
+				readArchiveValue(data, fileEnd, fileCount) &&
+				readArchiveValue(data, fileEnd, reserved) &&
+				readArchiveValue(data, fileEnd, indexOffset) &&
+				readArchiveValue(data, fileEnd, indexSize) &&
+				indexOffset <= mappedFile.getSize() && indexSize <= mappedFile.getSize() - indexOffset;
+
+			if (valid == true) {
+				data = fileStart + indexOffset;
+				const char *indexEnd = data + indexSize;
+				entries.resize(fileCount);
+				for (uint32 i = 0; valid == true && i < fileCount; ++i) {
+					DataArchiveEntry &entry = entries[i];
+					uint32 pathLength = 0;
+					valid = readArchiveValue(data, indexEnd, pathLength) &&
+						pathLength <= (uint32) (indexEnd - data);
+					if (valid == true) {
+						entry.path.assign(data, pathLength);
+						data += pathLength;
+						valid = readArchiveValue(data, indexEnd, entry.crc) &&
+							readArchiveValue(data, indexEnd, entry.flags) &&
+							readArchiveValue(data, indexEnd, entry.offset) &&
+							readArchiveValue(data, indexEnd, entry.size) &&
+							readArchiveValue(data, indexEnd, entry.storedSize) &&
+							readArchiveValue(data, indexEnd, entry.modified) &&
+							entry.offset <= indexOffset && entry.storedSize <= indexOffset - entry.offset &&
+							(i == 0 || entries[i - 1].path < entry.path);
+					}
+				}
+			}
+
+			if (valid == false) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Invalid data archive [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, archiveFile.c_str());
+				close();
+				return false;
+			}
+
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] opened data archive [%s] with %d files\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, archiveFile.c_str(), (int) entries.size());
+			return true;
+		}
+
+		void DataArchive::close() {
+			entries.clear();
+			mappedFile.close();
+		}
+
+		const DataArchiveEntry *DataArchive::findEntry(const string &relativePath) const {
+			vector<DataArchiveEntry>::const_iterator iterFind =
+				std::lower_bound(entries.begin(), entries.end(), relativePath, compareEntryPath);
+			if (iterFind != entries.end() && iterFind->path == relativePath) {
+				return &(*iterFind);
+			}
+			return NULL;
+		}
+
+		const char *DataArchive::getMappedData(const DataArchiveEntry &entry) const {
+			if (entry.isCompressed() == true || entry.size == 0) {
+				return NULL;
+			}
+			return mappedFile.getArray<char>((size_t) entry.offset, (size_t) entry.size);
+		}
+
+		bool DataArchive::readFile(const DataArchiveEntry &entry, vector<char> &data) const {
+			data.resize((size_t) entry.size);
+			if (entry.size == 0) {
+				return true;
+			}
+			if (entry.isCompressed() == false) {
+				const char *mappedData = getMappedData(entry);
+				if (mappedData == NULL) {
+					return false;
+				}
+				memcpy(&data[0], mappedData, (size_t) entry.size);
+				return true;
+			}
+
+			const unsigned char *compressedData = mappedFile.getArray<unsigned char>((size_t) entry.offset, (size_t) entry.storedSize);
+			uLongf size = (uLongf) entry.size;
+			if (compressedData == NULL ||
+				uncompress(reinterpret_cast<unsigned char *>(&data[0]), &size, compressedData, (uLong) entry.storedSize) != Z_OK ||
+				size != entry.size) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Can not inflate [%s] from [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, entry.path.c_str(), getPath().c_str());
+				return false;
+			}
+			return true;
+		}
+
+		uint32 DataArchive::getContentCheckSum(const string &filterFileExt) const {
+			// Folder checksums simply add up the per file sums
+			uint32 sum = 0;
+			for (unsigned int i = 0; i < entries.size(); ++i) {
+				if (filterFileExt == "" || EndsWith(entries[i].path, filterFileExt) == true) {
+					sum += entries[i].crc;
+				}
+			}
+			return sum;
+		}
+
+		void DataArchive::addToChecksum(const string &folder, const string &filterFileExt, Checksum &checksum) const {
+			string rootPath = folder;
+			endPathWithSlash(rootPath);
+			for (unsigned int i = 0; i < entries.size(); ++i) {
+				if (filterFileExt == "" || EndsWith(entries[i].path, filterFileExt) == true) {
+					checksum.addFile(rootPath + entries[i].path, entries[i].crc);
+				}
+			}
+		}
+
+		bool DataArchive::matchesFolder(const string &folder) const {
+			string rootPath = folder;
+			endPathWithSlash(rootPath);
+
+			// Only the directory listing and a stat per file, nothing is read
+			vector<string> files = getArchiveFolderFiles(rootPath);
+			if (files.size() != entries.size()) {
+				return false;
+			}
+			for (unsigned int i = 0; i < files.size(); ++i) {
+				const DataArchiveEntry *entry = findEntry(files[i]);
+				uint64 size = 0;
+				int64 modified = 0;
+				if (entry == NULL ||
+					getArchiveFileStamp(rootPath + files[i], size, modified) == false ||
+					size != entry->size || modified != entry->modified) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// =====================================================
+		//	class VirtualFileSystem
+		// =====================================================
+
+		static Mutex virtualFileSystemMutex;
+		// Keyed by the normalized folder, ending with a slash
+		static std::map<string, DataArchive *> mountedArchives;
+		static vector<DataArchive *> replacedArchives;
+
+		// Finds the archive holding path, relativePath is set to its name in there
+		static DataArchive *findMountedArchive(const string &path, string &relativePath) {
+			string normalizedPath = VirtualFileSystem::normalizePath(path);
+			MutexSafeWrapper safeMutex(&virtualFileSystemMutex);
+			for (std::map<string, DataArchive *>::const_iterator iterMap = mountedArchives.begin();
+				iterMap != mountedArchives.end(); ++iterMap) {
+				if (normalizedPath.size() > iterMap->first.size() &&
+					normalizedPath.compare(0, iterMap->first.size(), iterMap->first) == 0) {
+					relativePath = normalizedPath.substr(iterMap->first.size());
+					return iterMap->second;
+				}
+			}
+			return NULL;
+		}
+
+		static const DataArchiveEntry *findArchivedFile(const string &path, DataArchive *&archive) {
+			string relativePath;
+			archive = findMountedArchive(path, relativePath);
+			return (archive != NULL ? archive->findEntry(relativePath) : NULL);
+		}
+
+		string VirtualFileSystem::normalizePath(const string &path) {
+			string result = path;
+			std::replace(result.begin(), result.end(), '\\', '/');
+			for (size_t pos = result.find("/./"); pos != string::npos; pos = result.find("/./")) {
+				result.erase(pos, 2);
+			}
+			for (size_t pos = result.find("//"); pos != string::npos; pos = result.find("//")) {
+				result.erase(pos, 1);
+			}
+			return result;
+		}
+
+		// Takes over archive
+		static void mountArchive(const string &folder, DataArchive *archive) {
+			string mountPath = VirtualFileSystem::normalizePath(folder);
+			endPathWithSlash(mountPath);
+
+			MutexSafeWrapper safeMutex(&virtualFileSystemMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			std::map<string, DataArchive *>::iterator iterFind = mountedArchives.find(mountPath);
+			if (iterFind != mountedArchives.end()) {
+				// Loaders may still be reading from the old one
+				replacedArchives.push_back(iterFind->second);
+			}
+			mountedArchives[mountPath] = archive;
+
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] mounted [%s] at [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, archive->getPath().c_str(), mountPath.c_str());
+		}
+
+		bool VirtualFileSystem::mount(const string &folder, const string &archiveFile) {
+			DataArchive *archive = new DataArchive();
+			if (archive->open(archiveFile) == false) {
+				delete archive;
+				return false;
+			}
+			mountArchive(folder, archive);
+			return true;
+		}
+
+		bool VirtualFileSystem::isMounted(const string &folder) {
+			string mountPath = normalizePath(folder);
+			endPathWithSlash(mountPath);
+
+			MutexSafeWrapper safeMutex(&virtualFileSystemMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return mountedArchives.find(mountPath) != mountedArchives.end();
+		}
+
+		// Moves the archives mounted at or below mountPath out of the way,
+		// the caller holds virtualFileSystemMutex
+		static void unmountArchives(const string &mountPath) {
+			for (std::map<string, DataArchive *>::iterator iterMap = mountedArchives.begin();
+				iterMap != mountedArchives.end();) {
+				if (iterMap->first.compare(0, mountPath.size(), mountPath) == 0) {
+					// Loaders may still be reading from it
+					replacedArchives.push_back(iterMap->second);
+					mountedArchives.erase(iterMap++);
+				} else {
+					++iterMap;
+				}
+			}
+		}
+
+		// "techs/megapack/*" and "techs/megapack" both give "techs/megapack/"
+		static string getMountPath(const string &folderSearch) {
+			string folder = folderSearch;
+			if (EndsWith(folder, "*.") == true) {
+				folder.erase(folder.size() - 2);
+			} else if (EndsWith(folder, "*") == true) {
+				folder.erase(folder.size() - 1);
+			}
+			folder = VirtualFileSystem::normalizePath(folder);
+			endPathWithSlash(folder);
+			return folder;
+		}
+
+		bool VirtualFileSystem::mountFolderArchive(const string &folder) {
+			string mountPath = normalizePath(folder);
+			endPathWithSlash(mountPath);
+
+			MutexSafeWrapper safeMutex(&virtualFileSystemMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			std::map<string, DataArchive *>::const_iterator iterFind = mountedArchives.find(mountPath);
+			const DataArchive *mounted = (iterFind != mountedArchives.end() ? iterFind->second : NULL);
+			safeMutex.ReleaseLock();
+
+			if (mounted != NULL) {
+				// The folder may have been updated (a techtree download
+				// for example) since the archive was mounted
+				if (mounted->matchesFolder(folder) == true) {
+					return true;
+				}
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Unmounting data archive [%s], [%s] changed after it was packed\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, mounted->getPath().c_str(), folder.c_str());
+				unmount(mountPath);
+			}
+
+			string archiveFile = folder;
+			while (archiveFile.empty() == false &&
+				(archiveFile[archiveFile.size() - 1] == '/' || archiveFile[archiveFile.size() - 1] == '\\')) {
+				archiveFile.erase(archiveFile.size() - 1);
+			}
+			archiveFile += DataArchive::fileExtension;
+			if (archiveFile == DataArchive::fileExtension || fileExists(archiveFile) == false) {
+				return false;
+			}
+
+			DataArchive *archive = new DataArchive();
+			if (archive->open(archiveFile) == false) {
+				delete archive;
+				return false;
+			}
+			// An archive left over from before the folder was updated would
+			// serve old data and report its old checksums
+			if (archive->matchesFolder(folder) == false) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Ignoring data archive [%s], [%s] changed after it was packed\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, archiveFile.c_str(), folder.c_str());
+				delete archive;
+				return false;
+			}
+			mountArchive(folder, archive);
+			return true;
+		}
+
+		void VirtualFileSystem::unmount(const string &folderSearch) {
+			string mountPath = getMountPath(folderSearch);
+
+			MutexSafeWrapper safeMutex(&virtualFileSystemMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			unmountArchives(mountPath);
+		}
+
+		void VirtualFileSystem::unmountAll() {
+			MutexSafeWrapper safeMutex(&virtualFileSystemMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			for (std::map<string, DataArchive *>::iterator iterMap = mountedArchives.begin();
+				iterMap != mountedArchives.end(); ++iterMap) {
+				delete iterMap->second;
+			}
+			mountedArchives.clear();
+			for (unsigned int i = 0; i < replacedArchives.size(); ++i) {
+				delete replacedArchives[i];
+			}
+			replacedArchives.clear();
+		}
+
+		bool VirtualFileSystem::isArchived(const string &path) {
+			DataArchive *archive = NULL;
+			return findArchivedFile(path, archive) != NULL;
+		}
+
+		bool VirtualFileSystem::readFile(const string &path, vector<char> &data) {
+			DataArchive *archive = NULL;
+			const DataArchiveEntry *entry = findArchivedFile(path, archive);
+			return entry != NULL && archive->readFile(*entry, data) == true;
+		}
+
+		FILE *VirtualFileSystem::openFile(const string &path) {
+			DataArchive *archive = NULL;
+			const DataArchiveEntry *entry = findArchivedFile(path, archive);
+			if (entry == NULL) {
+				return NULL;
+			}
+
+#ifndef WIN32
+			// Stored files are read in place, archives are never unmapped
+			// while the game runs
+			const char *mappedData = archive->getMappedData(*entry);
+			if (mappedData != NULL) {
+				return fmemopen(const_cast<char *>(mappedData), (size_t) entry->size, "rb");
+			}
+#endif
+			vector<char> data;
+			if (archive->readFile(*entry, data) == false) {
+				return NULL;
+			}
+			FILE *fp = tmpfile();
+			if (fp != NULL && data.empty() == false &&
+				(fwrite(&data[0], data.size(), 1, fp) != 1 || fseek(fp, 0, SEEK_SET) != 0)) {
+				fclose(fp);
+				fp = NULL;
+			}
+			return fp;
+		}
+
+		const DataArchive *VirtualFileSystem::findMountedFolder(const string &folderSearch) {
+			string folder = getMountPath(folderSearch);
+
+			MutexSafeWrapper safeMutex(&virtualFileSystemMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			std::map<string, DataArchive *>::const_iterator iterFind = mountedArchives.find(folder);
+			return (iterFind != mountedArchives.end() ? iterFind->second : NULL);
+		}
+
+	}
+}//end namespace
@@ -0,0 +1,133 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// memory_mapped_file.cpp: maps a whole file into memory
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "memory_mapped_file.h"
+#include "util.h"
+#include "utf8.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::Platform;
+
+namespace Shared {
+	namespace PlatformCommon {
+
+		// =====================================================
+		//	class MemoryMappedFile
+		// =====================================================
+
+		MemoryMappedFile::MemoryMappedFile() {
+			data = NULL;
+			size = 0;
+			fileHandle = NULL;
+			mappingHandle = NULL;
+		}
+
+		MemoryMappedFile::~MemoryMappedFile() {
+			close();
+		}
+
+		bool MemoryMappedFile::open(const string &path) {
+			close();
+			this->path = path;
+
+#ifdef WIN32
+			HANDLE file = CreateFileW(utf8_decode(path).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+			LARGE_INTEGER fileSize;
+			if (GetFileSizeEx(file, &fileSize) == FALSE || fileSize.QuadPart <= 0) {
+				CloseHandle(file);
+				return false;
+			}
+			HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+			if (mapping == NULL) {
+				CloseHandle(file);
+				return false;
+			}
+			void *view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			if (view == NULL) {
+				CloseHandle(mapping);
+				CloseHandle(file);
+				return false;
+			}
+			fileHandle = file;
+			mappingHandle = mapping;
+			size = (size_t) fileSize.QuadPart;
+			data = static_cast<char *>(view);
+#else
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				return false;
+			}
+			struct stat fileStat;
+			if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+				::close(fd);
+				return false;
+			}
+			void *view = mmap(NULL, (size_t) fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			// The mapping stays valid after the descriptor is closed
+			::close(fd);
+			if (view == MAP_FAILED) {
+				return false;
+			}
+			size = (size_t) fileStat.st_size;
+			data = static_cast<char *>(view);
+#endif
+
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] mapped [%s] size = " MG_SIZE_T_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, path.c_str(), size);
+			return true;
+		}
+
+		void MemoryMappedFile::close() {
+			if (data != NULL) {
+#ifdef WIN32
+				UnmapViewOfFile(data);
+				CloseHandle(static_cast<HANDLE>(mappingHandle));
+				CloseHandle(static_cast<HANDLE>(fileHandle));
+#else
+				munmap(data, size);
+#endif
+			}
+			data = NULL;
+			size = 0;
+			fileHandle = NULL;
+			mappingHandle = NULL;
+		}
+
+	}
+}//end namespace
@@ -63,6 +63,7 @@
 #include "noimpl.h"
 
 #include "checksum.h"
+#include "data_archive.h"
 #include "socket.h"
 #include <algorithm>
 #include <map>
@@ -680,6 +681,7 @@ namespace Shared {
 
 		void setCRCCacheFilePath(const string &path) {
 			crcCachePath = path;
+			Checksum::setFileCRCCacheFile(path != "" ? path + "FILE_CRC_CACHE" : "");
 		}
 
 		void setUnexpectedHandler(void(*handler)(const char*)) {
@@ -994,6 +996,9 @@ namespace Shared {
 				bool result = removeFile(crcCacheFile);
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] fileitem [%s] result = %d\n", __FILE__, __FUNCTION__, __LINE__, crcCacheFile.c_str(), result);
 			}
+			// The folder is about to change (or just did), its archive
+			// would keep serving the old files and sums
+			VirtualFileSystem::unmount(path);
 		}
 
 		//finds all filenames like path and gets their checksum of all files combined
@@ -1010,6 +1015,18 @@ namespace Shared {
 				return crcTreeCache[cacheKey];
 			}
 
+			// A mounted data archive already knows the sum of every file in it,
+			// forceNoCache asks for what is on disk right now
+			const DataArchive *archive = (forceNoCache == false ? VirtualFileSystem::findMountedFolder(path) : NULL);
+			if (archive != NULL) {
+				if (recursiveChecksum != NULL) {
+					archive->addToChecksum(path.substr(0, path.find_last_of('/') + 1), filterFileExt, *recursiveChecksum);
+					return 0;
+				}
+				crcTreeCache[cacheKey] = archive->getContentCheckSum(filterFileExt);
+				return crcTreeCache[cacheKey];
+			}
+
 			string crcCacheFile = getFormattedCRCCacheFileName(cacheKeys);
 			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Looking for CRC Cache file [%s]\n",crcCacheFile.c_str());
 
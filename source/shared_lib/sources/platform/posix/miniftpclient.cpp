@@ -53,6 +53,9 @@ namespace Shared {
 			string currentFilename;
 			bool isValidXfer;
 			FTP_Client_CallbackType downloadType;
+			// Set when continuing a partial download
+			CURL *curl;
+			curl_off_t resumeFromBytes;
 		};
 
 		static size_t my_fwrite(void *buffer, size_t size, size_t nmemb, void *stream) {
@@ -88,11 +91,11 @@ namespace Shared {
 				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("===> FTP Client thread opening file for writing [%s]\n", fullFilePath.c_str());
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "===> FTP Client thread opening file for writing [%s]\n", fullFilePath.c_str());
 
-				/* open file for writing */
+				/* open file for writing, append when resuming */
 #ifdef WIN32
-				out->stream = _wfopen(utf8_decode(fullFilePath).c_str(), L"wb");
+				out->stream = _wfopen(utf8_decode(fullFilePath).c_str(), (out->resumeFromBytes > 0 ? L"ab" : L"wb"));
 #else
-				out->stream = fopen(fullFilePath.c_str(), "wb");
+				out->stream = fopen(fullFilePath.c_str(), (out->resumeFromBytes > 0 ? "ab" : "wb"));
 #endif
 				if (out->stream == NULL) {
 					if (SystemFlags::VERBOSE_MODE_ENABLED) printf("===> FTP Client thread FAILED to open file for writing [%s]\n", fullFilePath.c_str());
@@ -210,13 +213,18 @@ namespace Shared {
 
 					return -1;
 				}
+				// curl only counts what is left of a resumed file
 				FTPClientCallbackInterface::FtpProgressStats stats;
-				stats.download_total = download_total;
-				stats.download_now = download_now;
+				stats.download_total = (download_total > 0 ? download_total + out->resumeFromBytes : download_total);
+				stats.download_now = download_now + out->resumeFromBytes;
 				stats.upload_total = upload_total;
 				stats.upload_now = upload_now;
 				stats.currentFilename = out->currentFilename;
 				stats.downloadType = out->downloadType;
+				stats.download_speed = 0;
+				if (out->curl != NULL) {
+					curl_easy_getinfo(out->curl, CURLINFO_SPEED_DOWNLOAD, &stats.download_speed);
+				}
 
 				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
 				MutexSafeWrapper safeMutex(out->ftpServer->getProgressMutex(), mutexOwnerId);
@@ -231,6 +239,80 @@ namespace Shared {
 			return 0;
 		}
 
+		// A kept .part file remembers the size and modification time the remote
+		// file had, it is only continued (REST) while the remote file still matches
+		static string getPartialFileStampName(const string &destFilePartial) {
+			return destFilePartial + ".stamp";
+		}
+
+		static void savePartialFileStamp(CURL *curl, curl_off_t resumeFromBytes, const string &destFilePartial) {
+			double remainingBytes = -1;
+			long remoteFileTime = -1;
+			curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &remainingBytes);
+			curl_easy_getinfo(curl, CURLINFO_FILETIME, &remoteFileTime);
+			if (remoteFileTime < 0 || remainingBytes < 0) {
+				removeFile(getPartialFileStampName(destFilePartial));
+				return;
+			}
+
+#ifdef WIN32
+			FILE *fp = _wfopen(utf8_decode(getPartialFileStampName(destFilePartial)).c_str(), L"wt");
+#else
+			FILE *fp = fopen(getPartialFileStampName(destFilePartial).c_str(), "wt");
+#endif
+			if (fp != NULL) {
+				fprintf(fp, "%lld %ld\n", (long long) resumeFromBytes + (long long) remainingBytes, remoteFileTime);
+				fclose(fp);
+			}
+		}
+
+		// For FTP curl reports the size and time as header lines, nothing to keep
+		static size_t discard_fwrite(void *buffer, size_t size, size_t nmemb, void *stream) {
+			return size * nmemb;
+		}
+
+		static bool isPartialFileCurrent(const string &url, const string &destFilePartial) {
+			long long savedSize = -1;
+			long savedFileTime = -1;
+#ifdef WIN32
+			FILE *fp = _wfopen(utf8_decode(getPartialFileStampName(destFilePartial)).c_str(), L"rt");
+#else
+			FILE *fp = fopen(getPartialFileStampName(destFilePartial).c_str(), "rt");
+#endif
+			if (fp == NULL) {
+				return false;
+			}
+			int readCount = fscanf(fp, "%lld %ld", &savedSize, &savedFileTime);
+			fclose(fp);
+			if (readCount != 2) {
+				return false;
+			}
+
+			double remoteSize = -1;
+			long remoteFileTime = -1;
+			CURL *curl = SystemFlags::initHTTP();
+			if (curl == NULL) {
+				return false;
+			}
+			curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+			curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
+			curl_easy_setopt(curl, CURLOPT_FTP_USE_EPSV, 0L);
+			curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+			curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+			curl_easy_setopt(curl, CURLOPT_FTP_RESPONSE_TIMEOUT, 120L);
+			curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard_fwrite);
+			curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, discard_fwrite);
+			if (curl_easy_perform(curl) == CURLE_OK) {
+				curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &remoteSize);
+				curl_easy_getinfo(curl, CURLINFO_FILETIME, &remoteFileTime);
+			}
+			SystemFlags::cleanupHTTP(&curl);
+
+			return (remoteFileTime >= 0 && remoteFileTime == savedFileTime &&
+				(long long) remoteSize == savedSize &&
+				(long long) getFileSize(destFilePartial) <= savedSize);
+		}
+
 		FTPClientThread::FTPClientThread(int portNumber, string serverUrl,
 			std::pair<string, string> mapsPath,
 			std::pair<string, string> tilesetsPath,
@@ -244,6 +326,8 @@ namespace Shared {
 			string tempFilesPath) : BaseThread() {
 
 			uniqueID = "FTPClientThread";
+			this->maxConcurrentTransfers = 1;
+			this->maxTransferRetries = 3;
 			this->portNumber = portNumber;
 			this->serverUrl = serverUrl;
 			this->mapsPath = mapsPath;
@@ -470,6 +554,23 @@ namespace Shared {
 			}
 		}
 
+		void FTPClientThread::addTechtreeFilesToRequests(string techtreeName, string destFolder,
+			const vector<string> &filesToFetch, const vector<string> &filesToRemove) {
+			FTPTechtreeFilesRequest *request = new FTPTechtreeFilesRequest();
+			request->techtreeName = techtreeName;
+			request->destFolder = destFolder;
+			request->filesToFetch = filesToFetch;
+			request->filesToRemove = filesToRemove;
+			request->nextFile = 0;
+			request->transfersRunning = 0;
+			request->result = make_pair(ftp_crt_SUCCESS, "");
+
+			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex(&mutexTechtreeFilesList, mutexOwnerId);
+			mutexTechtreeFilesList.setOwnerId(mutexOwnerId);
+			techtreeFilesList.push_back(request);
+		}
+
 		void FTPClientThread::getTilesetFromServer(pair<string, string> tileSetName) {
 			bool findArchive = executeShellCommand(
 				this->fileArchiveExtractCommand,
@@ -590,6 +691,9 @@ namespace Shared {
 						destRootArchiveFolder,
 						destRootArchiveFolder + tileSetName.first + this->fileArchiveExtension);
 
+					// Archives are extracted one at a time, shellCommandCallbackUserData is shared
+					MutexSafeWrapper safeMutexExtract(&mutexArchiveExtract, string(__FILE__) + "_" + intToStr(__LINE__));
+
 					static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
 					MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 					this->getProgressMutex()->setOwnerId(mutexOwnerId);
@@ -713,6 +817,9 @@ namespace Shared {
 					destRootArchiveFolder,
 					destRootArchiveFolder + techtreeName.first + this->fileArchiveExtension);
 
+				// Archives are extracted one at a time, shellCommandCallbackUserData is shared
+				MutexSafeWrapper safeMutexExtract(&mutexArchiveExtract, string(__FILE__) + "_" + intToStr(__LINE__));
+
 				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
 				MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 				this->getProgressMutex()->setOwnerId(mutexOwnerId);
@@ -735,6 +842,103 @@ namespace Shared {
 
 		}
 
+		// Hands out one file of the oldest request per call so the transfer
+		// threads fetch the files of a techtree side by side
+		bool FTPClientThread::processTechtreeFilesRequest() {
+			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex(&mutexTechtreeFilesList, mutexOwnerId);
+			mutexTechtreeFilesList.setOwnerId(mutexOwnerId);
+			if (techtreeFilesList.empty() == true) {
+				return false;
+			}
+
+			FTPTechtreeFilesRequest *request = techtreeFilesList[0];
+			bool moreFiles = (request->nextFile < request->filesToFetch.size() && request->result.first == ftp_crt_SUCCESS);
+			if (moreFiles == false) {
+				// Other threads still fetch its last files, they finish it
+				if (request->transfersRunning > 0) {
+					return false;
+				}
+				techtreeFilesList.erase(techtreeFilesList.begin());
+				safeMutex.ReleaseLock();
+
+				finishTechtreeFilesRequest(request);
+				return true;
+			}
+
+			string fileName = request->filesToFetch[request->nextFile++];
+			request->transfersRunning++;
+			safeMutex.ReleaseLock();
+
+			pair<FTP_Client_ResultType, string> result = getTechtreeFileFromServer(request->techtreeName, request->destFolder, fileName);
+
+			safeMutex.Lock();
+			request->transfersRunning--;
+			if (result.first != ftp_crt_SUCCESS && request->result.first == ftp_crt_SUCCESS) {
+				request->result = result;
+			}
+			bool finished = (request->transfersRunning == 0 &&
+				(request->nextFile >= request->filesToFetch.size() || request->result.first != ftp_crt_SUCCESS));
+			if (finished == true) {
+				techtreeFilesList.erase(std::find(techtreeFilesList.begin(), techtreeFilesList.end(), request));
+			}
+			safeMutex.ReleaseLock();
+
+			if (finished == true) {
+				finishTechtreeFilesRequest(request);
+			}
+			return true;
+		}
+
+		pair<FTP_Client_ResultType, string> FTPClientThread::getTechtreeFileFromServer(string techtreeName, string destFolder, string fileName) {
+			// The names come from the host, never write outside the techtree folder
+			vector<string> parts;
+			Tokenize(fileName, parts, "/");
+			if (fileName == "" || fileName[0] == '/' || fileName.find(':') != string::npos ||
+				fileName.find('\\') != string::npos ||
+				std::find(parts.begin(), parts.end(), "..") != parts.end()) {
+				return make_pair(ftp_crt_FAIL, "invalid techtree file name [" + fileName + "]");
+			}
+
+			endPathWithSlash(destFolder);
+			string destFileSaveAs = destFolder + fileName;
+			string remotePath = techtreeName + "/" + fileName;
+
+			pair<FTP_Client_ResultType, string> result = getFileFromServer(ftp_cct_Techtree,
+				make_pair(techtreeName, string("")), remotePath, destFileSaveAs,
+				FTP_TECHTREES_CUSTOM_USERNAME, FTP_COMMON_PASSWORD);
+			if (result.first == ftp_crt_FAIL && this->getQuitStatus() == false) {
+				result = getFileFromServer(ftp_cct_Techtree,
+					make_pair(techtreeName, string("")), remotePath, destFileSaveAs,
+					FTP_TECHTREES_USERNAME, FTP_COMMON_PASSWORD);
+			}
+			return result;
+		}
+
+		void FTPClientThread::finishTechtreeFilesRequest(FTPTechtreeFilesRequest *request) {
+			if (request->result.first == ftp_crt_SUCCESS) {
+				// Full local paths the client picked itself, possibly in
+				// other data paths than destFolder
+				for (unsigned int idx = 0; idx < request->filesToRemove.size(); ++idx) {
+					removeFile(request->filesToRemove[idx]);
+				}
+			}
+
+			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
+			this->getProgressMutex()->setOwnerId(mutexOwnerId);
+			if (this->pCBObject != NULL) {
+				this->pCBObject->FTPClient_CallbackEvent(
+					request->techtreeName,
+					ftp_cct_Techtree,
+					request->result,
+					NULL);
+			}
+			safeMutex.ReleaseLock();
+
+			delete request;
+		}
+
 		void FTPClientThread::getScenarioFromServer(pair<string, string> fileName) {
 			pair<FTP_Client_ResultType, string> result = make_pair(ftp_crt_FAIL, "");
 			bool findArchive = executeShellCommand(
@@ -786,6 +990,9 @@ namespace Shared {
 					destRootArchiveFolder,
 					destRootArchiveFolder + fileName.first + this->fileArchiveExtension);
 
+				// Archives are extracted one at a time, shellCommandCallbackUserData is shared
+				MutexSafeWrapper safeMutexExtract(&mutexArchiveExtract, string(__FILE__) + "_" + intToStr(__LINE__));
+
 				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
 				MutexSafeWrapper safeMutex(this->getProgressMutex(), mutexOwnerId);
 				this->getProgressMutex()->setOwnerId(mutexOwnerId);
@@ -942,19 +1149,24 @@ namespace Shared {
 			}
 
 			bool wantDirList = (wantDirListOnly != NULL);
+			// Data is written to a .part file first, if the transfer breaks off it
+			// is continued from there (REST) instead of starting over
+			string destFilePartial = (wantDirList == true ? destFileSaveAs : destFileSaveAs + ".part");
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("===> FTP Client thread about to try to RETR into [%s] wantDirList = %d\n", destFileSaveAs.c_str(), wantDirList);
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "===> FTP Client thread about to try to RETR into [%s] wantDirList = %d\n", destFileSaveAs.c_str(), wantDirList);
 
 			struct FtpFile ftpfile = {
 				fileNameTitle.first.c_str(),
-				destFileSaveAs.c_str(), // name to store the file as if successful
+				destFilePartial.c_str(), // name to store the file as if successful
 				NULL,
 				NULL,
 				this,
 				"",
 				false,
-				downloadType
+				downloadType,
+				NULL,
+				0
 			};
 
 			CURL *curl = SystemFlags::initHTTP();
@@ -1006,7 +1218,47 @@ namespace Shared {
 				// Switch on full protocol/debug output
 				if (SystemFlags::VERBOSE_MODE_ENABLED) curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
 
-				CURLcode res = curl_easy_perform(curl);
+				ftpfile.curl = curl;
+				CURLcode res = CURLE_OK;
+				if (wantDirList == false) {
+					curl_easy_setopt(curl, CURLOPT_FILETIME, 1L);
+				}
+				for (int attempt = 0;; ++attempt) {
+					// Bytes kept from an older version of the remote file are worthless
+					if (wantDirList == false && getFileSize(destFilePartial) > 0 &&
+						isPartialFileCurrent(szBuf, destFilePartial) == false) {
+						if (SystemFlags::VERBOSE_MODE_ENABLED) printf("===> FTP Client remote file changed since [%s] was kept, starting over\n", destFilePartial.c_str());
+						removeFile(destFilePartial);
+					}
+					ftpfile.resumeFromBytes = (wantDirList == true ? 0 : (curl_off_t) getFileSize(destFilePartial));
+					curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, ftpfile.resumeFromBytes);
+
+					res = curl_easy_perform(curl);
+					if (ftpfile.stream) {
+						fclose(ftpfile.stream);
+						ftpfile.stream = NULL;
+					}
+					if (res != CURLE_OK && wantDirList == false) {
+						savePartialFileStamp(curl, ftpfile.resumeFromBytes, destFilePartial);
+					}
+					if (res == CURLE_OK || wantDirList == true ||
+						attempt >= maxTransferRetries || this->getQuitStatus() == true) {
+						break;
+					}
+
+					if (res == CURLE_FTP_COULDNT_USE_REST || res == CURLE_RANGE_ERROR ||
+						res == CURLE_BAD_DOWNLOAD_RESUME ||
+						(res == CURLE_FTP_COULDNT_RETR_FILE && ftpfile.resumeFromBytes > 0)) {
+						// The other side can't resume (older server), start over
+						removeFile(destFilePartial);
+					} else if (res != CURLE_PARTIAL_FILE && ftpfile.isValidXfer == false) {
+						break;
+					}
+
+					if (SystemFlags::VERBOSE_MODE_ENABLED) printf("===> FTP Client transfer of [%s] interrupted: %d [%s], retry #%d from byte: %lld\n", destFileSaveAs.c_str(), res, curl_easy_strerror(res), attempt + 1, (long long) getFileSize(destFilePartial));
+					if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "===> FTP Client transfer of [%s] interrupted: %d [%s], retry #%d from byte: %lld\n", destFileSaveAs.c_str(), res, curl_easy_strerror(res), attempt + 1, (long long) getFileSize(destFilePartial));
+					sleep(250);
+				}
 
 				if (res != CURLE_OK) {
 					result.second = curl_easy_strerror(res);
@@ -1021,16 +1273,27 @@ namespace Shared {
 					}
 
 
-					if (destRootFolder != "") {
+					// Keep a partial download around so the next request can resume it
+					bool keepPartialFile = (wantDirList == false && result.first == ftp_crt_PARTIALFAIL &&
+						this->getQuitStatus() == false && getFileSize(destFilePartial) > 0);
+					if (destRootFolder != "" && keepPartialFile == false) {
 						if (pathCreated == true) {
 							removeFolder(destRootFolder);
 						} else {
-							removeFile(destFileSaveAs);
+							removeFile(destFilePartial);
 						}
 					}
 				} else {
 					result.first = ftp_crt_SUCCESS;
 
+					if (wantDirList == false && fileExists(destFilePartial) == true) {
+						removeFile(destFileSaveAs);
+						if (renameFile(destFilePartial, destFileSaveAs) == false) {
+							result.first = ftp_crt_FAIL;
+							result.second = "could not rename [" + destFilePartial + "] to [" + destFileSaveAs + "]";
+						}
+					}
+
 					if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] result.first = %d wantDirListOnly = %p\n", __FILE__, __FUNCTION__, __LINE__, result.first, wantDirListOnly);
 
 					if (wantDirListOnly) {
@@ -1062,6 +1325,9 @@ namespace Shared {
 
 				SystemFlags::cleanupHTTP(&curl);
 			}
+			if (wantDirList == false && fileExists(destFilePartial) == false) {
+				removeFile(getPartialFileStampName(destFilePartial));
+			}
 
 			if (ftpfile.stream) {
 				fclose(ftpfile.stream);
@@ -1103,103 +1369,153 @@ namespace Shared {
 			return &shellCommandCallbackUserData;
 		}
 
-		void FTPClientThread::execute() {
-			{
-				RunningStatusSafeWrapper runningStatus(this);
-				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
+		// Takes at most one request from each queue, returns true if anything was transferred
+		bool FTPClientThread::processRequestQueues() {
+			bool processed = false;
 
-				if (getQuitStatus() == true) {
-					return;
-				}
+			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex(&mutexMapFileList, mutexOwnerId);
+			mutexMapFileList.setOwnerId(mutexOwnerId);
+			if (mapFileList.size() > 0) {
+				pair<string, string> mapFilename = mapFileList[0];
+				mapFileList.erase(mapFileList.begin() + 0);
+				safeMutex.ReleaseLock();
 
-				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("===> FTP Client thread is running\n");
-				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "FTP Client thread is running\n");
+				getMapFromServer(mapFilename);
+				processed = true;
+			} else {
+				safeMutex.ReleaseLock();
+			}
 
-				try {
-					while (this->getQuitStatus() == false) {
-						static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
-						MutexSafeWrapper safeMutex(&mutexMapFileList, mutexOwnerId);
-						mutexMapFileList.setOwnerId(mutexOwnerId);
-						if (mapFileList.size() > 0) {
-							pair<string, string> mapFilename = mapFileList[0];
-							mapFileList.erase(mapFileList.begin() + 0);
-							safeMutex.ReleaseLock();
-
-							getMapFromServer(mapFilename);
-						} else {
-							safeMutex.ReleaseLock();
-						}
+			if (this->getQuitStatus() == true) {
+				return processed;
+			}
 
-						if (this->getQuitStatus() == true) {
-							break;
-						}
+			static string mutexOwnerId2 = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex2(&mutexTilesetList, mutexOwnerId2);
+			mutexTilesetList.setOwnerId(mutexOwnerId2);
+			if (tilesetList.size() > 0) {
+				pair<string, string> tileset = tilesetList[0];
+				tilesetList.erase(tilesetList.begin() + 0);
+				safeMutex2.ReleaseLock();
 
-						static string mutexOwnerId2 = string(__FILE__) + string("_") + intToStr(__LINE__);
-						MutexSafeWrapper safeMutex2(&mutexTilesetList, mutexOwnerId2);
-						mutexTilesetList.setOwnerId(mutexOwnerId2);
-						if (tilesetList.size() > 0) {
-							pair<string, string> tileset = tilesetList[0];
-							tilesetList.erase(tilesetList.begin() + 0);
-							safeMutex2.ReleaseLock();
+				getTilesetFromServer(tileset);
+				processed = true;
+			} else {
+				safeMutex2.ReleaseLock();
+			}
 
-							getTilesetFromServer(tileset);
-						} else {
-							safeMutex2.ReleaseLock();
-						}
+			static string mutexOwnerId3 = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex3(&mutexTechtreeList, mutexOwnerId3);
+			mutexTechtreeList.setOwnerId(mutexOwnerId3);
+			if (techtreeList.size() > 0) {
+				pair<string, string> techtree = techtreeList[0];
+				techtreeList.erase(techtreeList.begin() + 0);
+				safeMutex3.ReleaseLock();
 
-						static string mutexOwnerId3 = string(__FILE__) + string("_") + intToStr(__LINE__);
-						MutexSafeWrapper safeMutex3(&mutexTechtreeList, mutexOwnerId3);
-						mutexTechtreeList.setOwnerId(mutexOwnerId3);
-						if (techtreeList.size() > 0) {
-							pair<string, string> techtree = techtreeList[0];
-							techtreeList.erase(techtreeList.begin() + 0);
-							safeMutex3.ReleaseLock();
+				getTechtreeFromServer(techtree);
+				processed = true;
+			} else {
+				safeMutex3.ReleaseLock();
+			}
 
-							getTechtreeFromServer(techtree);
-						} else {
-							safeMutex3.ReleaseLock();
-						}
+			if (processTechtreeFilesRequest() == true) {
+				processed = true;
+			}
 
-						static string mutexOwnerId4 = string(__FILE__) + string("_") + intToStr(__LINE__);
-						MutexSafeWrapper safeMutex4(&mutexScenarioList, mutexOwnerId4);
-						mutexScenarioList.setOwnerId(mutexOwnerId4);
-						if (scenarioList.size() > 0) {
-							pair<string, string> file = scenarioList[0];
-							scenarioList.erase(scenarioList.begin() + 0);
-							safeMutex4.ReleaseLock();
+			static string mutexOwnerId4 = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex4(&mutexScenarioList, mutexOwnerId4);
+			mutexScenarioList.setOwnerId(mutexOwnerId4);
+			if (scenarioList.size() > 0) {
+				pair<string, string> file = scenarioList[0];
+				scenarioList.erase(scenarioList.begin() + 0);
+				safeMutex4.ReleaseLock();
 
-							getScenarioFromServer(file);
-						} else {
-							safeMutex4.ReleaseLock();
-						}
+				getScenarioFromServer(file);
+				processed = true;
+			} else {
+				safeMutex4.ReleaseLock();
+			}
 
-						static string mutexOwnerId5 = string(__FILE__) + string("_") + intToStr(__LINE__);
-						MutexSafeWrapper safeMutex5(&mutexFileList, mutexOwnerId5);
-						mutexFileList.setOwnerId(mutexOwnerId5);
-						if (fileList.size() > 0) {
-							pair<string, string> file = fileList[0];
-							fileList.erase(fileList.begin() + 0);
-							safeMutex5.ReleaseLock();
+			static string mutexOwnerId5 = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex5(&mutexFileList, mutexOwnerId5);
+			mutexFileList.setOwnerId(mutexOwnerId5);
+			if (fileList.size() > 0) {
+				pair<string, string> file = fileList[0];
+				fileList.erase(fileList.begin() + 0);
+				safeMutex5.ReleaseLock();
 
-							getFileFromServer(file);
-						} else {
-							safeMutex5.ReleaseLock();
-						}
+				getFileFromServer(file);
+				processed = true;
+			} else {
+				safeMutex5.ReleaseLock();
+			}
 
-						static string mutexOwnerId6 = string(__FILE__) + string("_") + intToStr(__LINE__);
-						MutexSafeWrapper safeMutex6(&mutexTempFileList, mutexOwnerId6);
-						mutexTempFileList.setOwnerId(mutexOwnerId6);
-						if (tempFileList.size() > 0) {
-							pair<string, string> file = tempFileList[0];
-							tempFileList.erase(tempFileList.begin() + 0);
-							safeMutex6.ReleaseLock();
+			static string mutexOwnerId6 = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex6(&mutexTempFileList, mutexOwnerId6);
+			mutexTempFileList.setOwnerId(mutexOwnerId6);
+			if (tempFileList.size() > 0) {
+				pair<string, string> file = tempFileList[0];
+				tempFileList.erase(tempFileList.begin() + 0);
+				safeMutex6.ReleaseLock();
 
-							getTempFileFromServer(file);
-						} else {
-							safeMutex6.ReleaseLock();
+				getTempFileFromServer(file);
+				processed = true;
+			} else {
+				safeMutex6.ReleaseLock();
+			}
+
+			return processed;
+		}
+
+		// =====================================================
+		//	class FTPClientTransferThread
+		// =====================================================
+
+		FTPClientTransferThread::FTPClientTransferThread(FTPClientThread *owner) : BaseThread() {
+			uniqueID = "FTPClientTransferThread";
+			this->owner = owner;
+		}
+
+		void FTPClientTransferThread::execute() {
+			{
+				RunningStatusSafeWrapper runningStatus(this);
+				try {
+					while (this->getQuitStatus() == false && owner->getQuitStatus() == false) {
+						if (owner->processRequestQueues() == false && this->getQuitStatus() == false) {
+							sleep(25);
 						}
+					}
+				} catch (const exception &ex) {
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", __FILE__, __FUNCTION__, __LINE__, ex.what());
+				} catch (...) {
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] UNKNOWN Error\n", __FILE__, __FUNCTION__, __LINE__);
+				}
+			}
+			deleteSelfIfRequired();
+		}
 
-						if (this->getQuitStatus() == false) {
+		void FTPClientThread::execute() {
+			{
+				RunningStatusSafeWrapper runningStatus(this);
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
+
+				if (getQuitStatus() == true) {
+					return;
+				}
+
+				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("===> FTP Client thread is running\n");
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "FTP Client thread is running\n");
+
+				try {
+					for (int idx = 1; idx < maxConcurrentTransfers; ++idx) {
+						FTPClientTransferThread *transferThread = new FTPClientTransferThread(this);
+						transferThread->start();
+						transferThreads.push_back(transferThread);
+					}
+
+					while (this->getQuitStatus() == false) {
+						if (processRequestQueues() == false && this->getQuitStatus() == false) {
 							sleep(25);
 						}
 					}
@@ -1214,6 +1530,26 @@ namespace Shared {
 					if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] unknown error\n", __FILE__, __FUNCTION__, __LINE__);
 				}
 
+				// The transfer threads use this object and the request lists,
+				// they have to be gone before any of it is freed
+				for (unsigned int idx = 0; idx < transferThreads.size(); ++idx) {
+					transferThreads[idx]->signalQuit();
+				}
+				for (unsigned int idx = 0; idx < transferThreads.size(); ++idx) {
+					transferThreads[idx]->shutdownAndJoin();
+					delete transferThreads[idx];
+				}
+				transferThreads.clear();
+
+				static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+				MutexSafeWrapper safeMutex(&mutexTechtreeFilesList, mutexOwnerId);
+				mutexTechtreeFilesList.setOwnerId(mutexOwnerId);
+				for (unsigned int idx = 0; idx < techtreeFilesList.size(); ++idx) {
+					delete techtreeFilesList[idx];
+				}
+				techtreeFilesList.clear();
+				safeMutex.ReleaseLock();
+
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] FTP Client thread is exiting\n", __FILE__, __FUNCTION__, __LINE__);
 			}
 
@@ -0,0 +1,336 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// network_link_simulator.cpp: in-process TCP relay that injects latency,
+// jitter, bandwidth limits and packet loss between a client and a server
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "network_link_simulator.h"
+
+#include <algorithm>
+#include "conversion.h"
+#include "util.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+
+namespace Shared {
+	namespace Platform {
+
+		// Typical ethernet TCP payload, so drops and bandwidth apply per segment
+		static const int NETWORK_LINK_SEGMENT_SIZE = 1460;
+
+		// =====================================================
+		//	class NetworkLinkConditions
+		// =====================================================
+
+		NetworkLinkConditions::NetworkLinkConditions() {
+			latencyMilliseconds = 0;
+			jitterMilliseconds = 0;
+			bandwidthBytesPerSecond = 0;
+			dropPercent = 0;
+			retransmitMilliseconds = 200;
+			reorderPercent = 0;
+			reorderMilliseconds = 50;
+			randomSeed = 1;
+		}
+
+		bool NetworkLinkConditions::hasImpairment() const {
+			return (latencyMilliseconds > 0 || jitterMilliseconds > 0 ||
+				bandwidthBytesPerSecond > 0 || dropPercent > 0 ||
+				reorderPercent > 0);
+		}
+
+		string NetworkLinkConditions::toString() const {
+			string result = "latency: " + intToStr(latencyMilliseconds) +
+				" jitter: " + intToStr(jitterMilliseconds) +
+				" bandwidth: " + intToStr(bandwidthBytesPerSecond) +
+				" drop%: " + intToStr(dropPercent) +
+				" retransmit: " + intToStr(retransmitMilliseconds) +
+				" reorder%: " + intToStr(reorderPercent) +
+				" reorderDelay: " + intToStr(reorderMilliseconds) +
+				" seed: " + intToStr(randomSeed);
+			return result;
+		}
+
+		NetworkLinkStats::NetworkLinkStats() {
+			bytesToServer = 0;
+			bytesToClient = 0;
+			segmentsRelayed = 0;
+			segmentsDropped = 0;
+			segmentsReordered = 0;
+			acceptedLinks = 0;
+		}
+
+		// =====================================================
+		//	class NetworkLinkSimulator
+		// =====================================================
+
+		NetworkLinkSimulator::LinkDirection::LinkDirection() {
+			wireFreeAtMillis = 0;
+			lastDeliverAtMillis = 0;
+		}
+
+		NetworkLinkSimulator::Link::Link() {
+			clientSide = NULL;
+			serverSide = NULL;
+		}
+
+		NetworkLinkSimulator::Link::~Link() {
+			delete clientSide;
+			clientSide = NULL;
+			delete serverSide;
+			serverSide = NULL;
+		}
+
+		NetworkLinkSimulator::NetworkLinkSimulator(const NetworkLinkConditions &conditions,
+			string targetIp, int targetPort, int listenPort) : BaseThread(), listenSocket(true) {
+			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] target [%s:%d] listenPort = %d conditions [%s]\n", __FILE__, __FUNCTION__, __LINE__, targetIp.c_str(), targetPort, listenPort, conditions.toString().c_str());
+
+			mutexLinkAccessor = new Mutex(CODE_AT_LINE);
+			this->conditions = conditions;
+			this->targetIp = targetIp;
+			this->targetPort = targetPort;
+			uniqueID = "NetworkLinkSimulator";
+
+			random.setDisableLastCallerTracking(true);
+			random.init(conditions.randomSeed);
+
+			// Only ever reachable from this machine
+			listenSocket.setBindSpecificAddress("127.0.0.1");
+			listenSocket.bind(listenPort);
+			listenSocket.listen();
+		}
+
+		NetworkLinkSimulator::~NetworkLinkSimulator() {
+			closeLinks();
+			listenSocket.disconnectSocket();
+
+			delete mutexLinkAccessor;
+			mutexLinkAccessor = NULL;
+		}
+
+		void NetworkLinkSimulator::setConditions(const NetworkLinkConditions &value) {
+			MutexSafeWrapper safeMutex(mutexLinkAccessor, CODE_AT_LINE);
+			if (this->conditions.randomSeed != value.randomSeed) {
+				random.init(value.randomSeed);
+			}
+			this->conditions = value;
+		}
+
+		NetworkLinkConditions NetworkLinkSimulator::getConditions() {
+			MutexSafeWrapper safeMutex(mutexLinkAccessor, CODE_AT_LINE);
+			return this->conditions;
+		}
+
+		NetworkLinkStats NetworkLinkSimulator::getStats() {
+			MutexSafeWrapper safeMutex(mutexLinkAccessor, CODE_AT_LINE);
+			return this->stats;
+		}
+
+		bool NetworkLinkSimulator::canShutdown(bool deleteSelfIfShutdownDelayed) {
+			bool ret = (getExecutingTask() == false);
+			if (ret == false && deleteSelfIfShutdownDelayed == true) {
+				setDeleteSelfOnExecutionDone(deleteSelfIfShutdownDelayed);
+				deleteSelfIfRequired();
+				signalQuit();
+			}
+
+			return ret;
+		}
+
+		void NetworkLinkSimulator::acceptLinks() {
+			if (listenSocket.hasDataToRead() == false) {
+				return;
+			}
+
+			Socket *clientSide = listenSocket.accept(false);
+			if (clientSide == NULL) {
+				return;
+			}
+
+			ClientSocket *serverSide = new ClientSocket();
+			serverSide->connect(Ip(targetIp), targetPort);
+			if (serverSide->isConnected() == false) {
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] could not reach target [%s:%d]\n", __FILE__, __FUNCTION__, __LINE__, targetIp.c_str(), targetPort);
+
+				delete serverSide;
+				delete clientSide;
+				return;
+			}
+
+			clientSide->setBlock(false);
+			serverSide->setBlock(false);
+
+			Link *link = new Link();
+			link->clientSide = clientSide;
+			link->serverSide = serverSide;
+			links.push_back(link);
+
+			MutexSafeWrapper safeMutex(mutexLinkAccessor, CODE_AT_LINE);
+			stats.acceptedLinks++;
+		}
+
+		bool NetworkLinkSimulator::readSegments(Socket *source, LinkDirection &direction,
+			bool towardsServer, const NetworkLinkConditions &linkConditions, int64 nowMillis) {
+			if (source->hasDataToRead() == false) {
+				return true;
+			}
+			int available = source->getDataToRead(true);
+			if (available <= 0) {
+				// Readable with nothing to read means the peer hung up
+				return source->isConnected();
+			}
+
+			MutexSafeWrapper safeMutex(mutexLinkAccessor, CODE_AT_LINE);
+			while (available > 0) {
+				Segment segment;
+				segment.sentBytes = 0;
+				segment.data.resize(min(available, NETWORK_LINK_SEGMENT_SIZE));
+
+				int received = source->receive(&segment.data[0], (int) segment.data.size(), false);
+				if (received <= 0) {
+					return false;
+				}
+				segment.data.resize(received);
+				available -= received;
+
+				// Serialize onto the wire first, then add propagation delay
+				int64 wireStart = max(nowMillis, direction.wireFreeAtMillis);
+				int64 wireMillis = 0;
+				if (linkConditions.bandwidthBytesPerSecond > 0) {
+					wireMillis = ((int64) received * 1000) / linkConditions.bandwidthBytesPerSecond;
+				}
+				direction.wireFreeAtMillis = wireStart + wireMillis;
+
+				int64 deliverAt = direction.wireFreeAtMillis + linkConditions.latencyMilliseconds;
+				if (linkConditions.jitterMilliseconds > 0) {
+					deliverAt += random.randRange(-linkConditions.jitterMilliseconds, linkConditions.jitterMilliseconds);
+				}
+				if (linkConditions.dropPercent > 0 &&
+					random.randRange(0, 99) < linkConditions.dropPercent) {
+					deliverAt += linkConditions.retransmitMilliseconds;
+					stats.segmentsDropped++;
+				}
+				if (linkConditions.reorderPercent > 0 &&
+					random.randRange(0, 99) < linkConditions.reorderPercent) {
+					deliverAt += linkConditions.reorderMilliseconds;
+					stats.segmentsReordered++;
+				}
+
+				// TCP hands bytes to the application in order, so a late
+				// segment holds back everything queued behind it
+				deliverAt = max(deliverAt, max(nowMillis, direction.lastDeliverAtMillis));
+				direction.lastDeliverAtMillis = deliverAt;
+				segment.deliverAtMillis = deliverAt;
+
+				if (towardsServer == true) {
+					stats.bytesToServer += received;
+				} else {
+					stats.bytesToClient += received;
+				}
+				stats.segmentsRelayed++;
+
+				direction.queue.push_back(segment);
+			}
+			return true;
+		}
+
+		bool NetworkLinkSimulator::writeSegments(Socket *destination, LinkDirection &direction, int64 nowMillis) {
+			while (direction.queue.empty() == false &&
+				direction.queue.front().deliverAtMillis <= nowMillis) {
+				Segment &segment = direction.queue.front();
+				int remaining = (int) (segment.data.size() - segment.sentBytes);
+				int sent = destination->send(&segment.data[segment.sentBytes], remaining);
+				if (sent < 0) {
+					return destination->isConnected();
+				}
+				segment.sentBytes += sent;
+				if (sent < remaining) {
+					break;
+				}
+				direction.queue.pop_front();
+			}
+			return true;
+		}
+
+		void NetworkLinkSimulator::closeLinks() {
+			for (unsigned int index = 0; index < links.size(); ++index) {
+				delete links[index];
+			}
+			links.clear();
+		}
+
+		void NetworkLinkSimulator::execute() {
+			RunningStatusSafeWrapper runningStatus(this);
+			try {
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] relaying port %d to [%s:%d]\n", __FILE__, __FUNCTION__, __LINE__, getListenPort(), targetIp.c_str(), targetPort);
+
+				for (; getQuitStatus() == false;) {
+					ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+
+					acceptLinks();
+
+					NetworkLinkConditions linkConditions = getConditions();
+					bool pendingData = false;
+					for (int index = (int) links.size() - 1; index >= 0; --index) {
+						Link *link = links[index];
+						int64 nowMillis = Chrono::getCurMillis();
+
+						bool linkOk = readSegments(link->clientSide, link->toServer, true, linkConditions, nowMillis);
+						linkOk = linkOk && readSegments(link->serverSide, link->toClient, false, linkConditions, nowMillis);
+						linkOk = linkOk && writeSegments(link->serverSide, link->toServer, nowMillis);
+						linkOk = linkOk && writeSegments(link->clientSide, link->toClient, nowMillis);
+
+						if (linkOk == false) {
+							if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] closing link %d\n", __FILE__, __FUNCTION__, __LINE__, index);
+
+							delete link;
+							links.erase(links.begin() + index);
+							continue;
+						}
+						if (link->toServer.queue.empty() == false ||
+							link->toClient.queue.empty() == false) {
+							pendingData = true;
+						}
+					}
+
+					safeExecutingTaskMutex.Disable();
+					if (pendingData == false) {
+						sleep(1);
+					} else {
+						sleep(0);
+					}
+				}
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", __FILE__, __FUNCTION__, __LINE__, ex.what());
+			} catch (...) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] UNKNOWN error\n", __FILE__, __FUNCTION__, __LINE__);
+			}
+
+			closeLinks();
+			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] END\n", __FILE__, __FUNCTION__, __LINE__);
+		}
+
+	}
+}//end namespace
@@ -2367,6 +2367,15 @@ namespace Shared {
 			}
 			portBound = true;
 
+			// Port 0 asks the OS for any free port, remember which one we got
+			if (port == 0) {
+				struct sockaddr_in boundAddr;
+				socklen_t boundAddrLen = sizeof(boundAddr);
+				if (getsockname(sock, reinterpret_cast<sockaddr*>(&boundAddr), &boundAddrLen) == 0) {
+					boundPort = ntohs(boundAddr.sin_port);
+				}
+			}
+
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] Line: %d port = %d, portBound = %d END\n", __FILE__, __FUNCTION__, __LINE__, port, portBound);
 		}
 
@@ -13,10 +13,15 @@
 
 #include <fstream>
 #include <stdexcept>
+#include <algorithm>
+#include "sound_buffer_cache.h"
+#include "base_thread.h"
+#include "platform_util.h"
 #include "util.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
 namespace Shared {
 	namespace Sound {
 
@@ -49,7 +54,7 @@ namespace Shared {
 		// =====================================================
 
 		StaticSound::StaticSound() {
-			samples = NULL;
+			buffer = NULL;
 			soundFileLoader = NULL;
 			fileName = "";
 		}
@@ -58,17 +63,25 @@ namespace Shared {
 			close();
 		}
 
-		void StaticSound::close() {
-			if (samples != NULL) {
-				delete[] samples;
-				samples = NULL;
+		const SoundInfo *StaticSound::getInfo() const {
+			if (buffer == NULL) {
+				return &info;
 			}
+			SoundBufferCache::waitUntilDecoded(buffer);
+			return buffer->getInfo();
+		}
 
-			if (soundFileLoader != NULL) {
-				soundFileLoader->close();
-				delete soundFileLoader;
-				soundFileLoader = NULL;
+		const int8 *StaticSound::getSamples() const {
+			if (buffer == NULL) {
+				return NULL;
 			}
+			SoundBufferCache::waitUntilDecoded(buffer);
+			return buffer->getSamples();
+		}
+
+		void StaticSound::close() {
+			SoundBufferCache::release(buffer);
+			buffer = NULL;
 		}
 
 		void StaticSound::load(const string &path) {
@@ -79,29 +92,57 @@ namespace Shared {
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 				return;
 			}
-			string ext = (path.empty() == false ? path.substr(path.find_last_of('.') + 1) : "");
-			soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
-
-			if (soundFileLoader == NULL) {
-				throw megaglest_runtime_error("soundFileLoader == NULL");
-			}
-			soundFileLoader->open(path, &info);
-			samples = new int8[info.getSize()];
-			soundFileLoader->read(samples, info.getSize());
-			soundFileLoader->close();
-
-			delete soundFileLoader;
-			soundFileLoader = NULL;
+			buffer = SoundBufferCache::acquire(path);
 		}
 
 		// =====================================================
 		//	class StrSound
 		// =====================================================
 
+		class StrSoundPrefetchThread : public BaseThread {
+		private:
+			StrSound *sound;
+
+		public:
+			explicit StrSoundPrefetchThread(StrSound *sound) : BaseThread(), sound(sound) {
+				uniqueID = "StrSoundPrefetchThread";
+			}
+
+			virtual void execute() {
+				{
+					RunningStatusSafeWrapper runningStatus(this);
+					while (getQuitStatus() == false) {
+						if (sound->prefetchNextChunk() == false) {
+							sleep(5);
+						}
+					}
+				}
+				deleteSelfIfRequired();
+			}
+		};
+
+		uint32 StrSound::prefetchSize = 256 * 1024;
+		// Small enough that read() never waits long for a chunk in progress
+		static const uint32 prefetchChunkSize = 16 * 1024;
+
 		StrSound::StrSound() {
 			soundFileLoader = NULL;
 			next = NULL;
 			fileName = "";
+			decodeMutex = NULL;
+			prefetchMutex = NULL;
+			prefetchThread = NULL;
+			prefetchStart = 0;
+			prefetchCount = 0;
+			prefetchEnded = false;
+		}
+
+		void StrSound::setPrefetchSize(uint32 size) {
+			prefetchSize = size;
+		}
+
+		uint32 StrSound::getPrefetchSize() {
+			return prefetchSize;
 		}
 
 		StrSound::~StrSound() {
@@ -121,17 +162,112 @@ namespace Shared {
 
 			soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
 			soundFileLoader->open(path, &info);
+
+			if (prefetchSize > 0) {
+				decodeMutex = new Mutex(CODE_AT_LINE);
+				prefetchMutex = new Mutex(CODE_AT_LINE);
+				prefetchBuffer.resize(prefetchSize);
+				prefetchStart = 0;
+				prefetchCount = 0;
+				prefetchEnded = false;
+				prefetchThread = new StrSoundPrefetchThread(this);
+				prefetchThread->start();
+			}
+		}
+
+		uint32 StrSound::readFromPrefetchBuffer(int8 *samples, uint32 size) {
+			uint32 result = 0;
+			while (result < size && prefetchCount > 0) {
+				uint32 count = std::min(std::min(size - result, prefetchCount), (uint32) prefetchBuffer.size() - prefetchStart);
+				memcpy(samples + result, &prefetchBuffer[prefetchStart], count);
+				result += count;
+				prefetchStart = (prefetchStart + count) % (uint32) prefetchBuffer.size();
+				prefetchCount -= count;
+			}
+			return result;
+		}
+
+		bool StrSound::prefetchNextChunk() {
+			MutexSafeWrapper safeDecodeMutex(decodeMutex);
+			MutexSafeWrapper safeMutex(prefetchMutex);
+			uint32 bufferSize = (uint32) prefetchBuffer.size();
+			if (soundFileLoader == NULL || prefetchEnded == true || bufferSize - prefetchCount < prefetchChunkSize) {
+				return false;
+			}
+			// read() only drains the buffer meanwhile, so the space stays free
+			safeMutex.ReleaseLock(true);
+
+			prefetchChunk.resize(prefetchChunkSize);
+			uint32 readCount = soundFileLoader->read(&prefetchChunk[0], prefetchChunkSize);
+
+			safeMutex.Lock();
+			uint32 writePos = (prefetchStart + prefetchCount) % bufferSize;
+			uint32 count = std::min(readCount, bufferSize - writePos);
+			memcpy(&prefetchBuffer[writePos], &prefetchChunk[0], count);
+			memcpy(&prefetchBuffer[0], &prefetchChunk[0] + count, readCount - count);
+			prefetchCount += readCount;
+			if (readCount < prefetchChunkSize) {
+				prefetchEnded = true;
+			}
+			return true;
 		}
 
 		uint32 StrSound::read(int8 *samples, uint32 size) {
 			if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 				return 0;
 			}
+			if (prefetchThread == NULL) {
+				return soundFileLoader->read(samples, size);
+			}
+
+			MutexSafeWrapper safeMutex(prefetchMutex);
+			uint32 result = readFromPrefetchBuffer(samples, size);
+			if (result == size || prefetchEnded == true) {
+				return result;
+			}
 
-			return soundFileLoader->read(samples, size);
+			// Whatever the prefetch thread has not decoded yet is decoded
+			// here, after the buffered part so the order stays intact. A
+			// chunk in progress is finished and taken from the buffer first
+			safeMutex.ReleaseLock(true);
+			MutexSafeWrapper safeDecodeMutex(decodeMutex);
+			safeMutex.Lock();
+			result += readFromPrefetchBuffer(samples + result, size - result);
+			if (result < size && prefetchEnded == false) {
+				uint32 count = size - result;
+				safeMutex.ReleaseLock(true);
+				uint32 readCount = soundFileLoader->read(samples + result, count);
+				safeMutex.Lock();
+				if (readCount < count) {
+					prefetchEnded = true;
+				}
+				result += readCount;
+			}
+			return result;
+		}
+
+		void StrSound::stopPrefetch() {
+			if (prefetchThread != NULL) {
+				// It uses soundFileLoader and the mutexes deleted below
+				prefetchThread->signalQuit();
+				prefetchThread->shutdownAndJoin();
+				delete prefetchThread;
+				prefetchThread = NULL;
+			}
+			delete prefetchMutex;
+			prefetchMutex = NULL;
+			delete decodeMutex;
+			decodeMutex = NULL;
+			prefetchBuffer.clear();
+			prefetchChunk.clear();
+			prefetchStart = 0;
+			prefetchCount = 0;
+			prefetchEnded = false;
 		}
 
 		void StrSound::close() {
+			stopPrefetch();
+
 			if (soundFileLoader != NULL) {
 				soundFileLoader->close();
 				delete soundFileLoader;
@@ -144,7 +280,17 @@ namespace Shared {
 				return;
 			}
 
+			if (prefetchThread == NULL) {
+				soundFileLoader->restart();
+				return;
+			}
+
+			MutexSafeWrapper safeDecodeMutex(decodeMutex);
+			MutexSafeWrapper safeMutex(prefetchMutex);
 			soundFileLoader->restart();
+			prefetchStart = 0;
+			prefetchCount = 0;
+			prefetchEnded = false;
 		}
 
 	}
@@ -0,0 +1,255 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// sound_buffer_cache.cpp: decoded sound samples shared by every sound
+// loaded from the same file
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "sound_buffer_cache.h"
+
+#include <map>
+#include <list>
+#include "base_thread.h"
+#include "data_archive.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "conversion.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Shared {
+	namespace Sound {
+
+		// =====================================================
+		//	class SoundBufferDecodeThread
+		// =====================================================
+
+		class SoundBufferDecodeThread : public BaseThread {
+		public:
+			SoundBufferDecodeThread() : BaseThread() {
+				uniqueID = "SoundBufferDecodeThread";
+			}
+
+			virtual void execute() {
+				{
+					RunningStatusSafeWrapper runningStatus(this);
+					while (getQuitStatus() == false) {
+						if (SoundBufferCache::processNextDecode() == false) {
+							sleep(5);
+						}
+					}
+				}
+				deleteSelfIfRequired();
+			}
+		};
+
+		// =====================================================
+		//	class SoundBufferCache
+		// =====================================================
+
+		static Mutex soundBufferMutex;
+		// Keyed by the canonical path so "a/./b.wav" and "a//b.wav" share
+		static std::map<string, SoundBuffer *> soundBuffers;
+		static std::list<SoundBuffer *> soundBufferQueue;
+		static vector<SoundBufferDecodeThread *> soundBufferThreads;
+
+		static string getCanonicalSoundPath(const string &path) {
+			string result = VirtualFileSystem::normalizePath(path);
+			updatePathClimbingParts(result);
+			return result;
+		}
+
+		// Called without soundBufferMutex held, false if the file can't be decoded
+		static bool decodeSoundFile(const string &path, SoundInfo &info, vector<int8> &samples) {
+			string ext = (path.empty() == false ? path.substr(path.find_last_of('.') + 1) : "");
+			SoundFileLoader *soundFileLoader = NULL;
+			try {
+				soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
+				if (soundFileLoader == NULL) {
+					throw megaglest_runtime_error("soundFileLoader == NULL");
+				}
+				soundFileLoader->open(path, &info);
+				samples.resize(info.getSize());
+				if (samples.empty() == false) {
+					soundFileLoader->read(&samples[0], info.getSize());
+				}
+				soundFileLoader->close();
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error decoding sound [%s]: %s\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, path.c_str(), ex.what());
+				info = SoundInfo();
+				samples.clear();
+				delete soundFileLoader;
+				return false;
+			}
+			delete soundFileLoader;
+			return true;
+		}
+
+		// Expects soundBufferMutex to be held. The path may already have been
+		// handed a new buffer if this one failed to decode
+		static void eraseSoundBuffer(SoundBuffer *buffer) {
+			std::map<string, SoundBuffer *>::iterator iterFind = soundBuffers.find(getCanonicalSoundPath(buffer->getPath()));
+			if (iterFind != soundBuffers.end() && iterFind->second == buffer) {
+				soundBuffers.erase(iterFind);
+			}
+		}
+
+		// Expects soundBufferMutex to be held by safeMutex and buffer to be
+		// queued, returns with the lock held and buffer decoded
+		void SoundBufferCache::decodeQueued(SoundBuffer *buffer, MutexSafeWrapper &safeMutex) {
+			soundBufferQueue.remove(buffer);
+			buffer->decoding = true;
+			string path = buffer->path;
+			safeMutex.ReleaseLock(true);
+
+			SoundInfo info;
+			vector<int8> samples;
+			bool decoded = decodeSoundFile(path, info, samples);
+
+			safeMutex.Lock();
+			buffer->info = info;
+			buffer->samples.swap(samples);
+			buffer->decoding = false;
+			buffer->decoded = true;
+			if (decoded == false) {
+				// Current users get silence, the next acquire tries the file again
+				eraseSoundBuffer(buffer);
+			}
+		}
+
+		void SoundBufferCache::start(int threadCount) {
+			stop();
+			for (int i = 0; i < threadCount; ++i) {
+				SoundBufferDecodeThread *thread = new SoundBufferDecodeThread();
+				soundBufferThreads.push_back(thread);
+				thread->start();
+			}
+		}
+
+		void SoundBufferCache::stop() {
+			for (unsigned int i = 0; i < soundBufferThreads.size(); ++i) {
+				soundBufferThreads[i]->signalQuit();
+			}
+			for (unsigned int i = 0; i < soundBufferThreads.size(); ++i) {
+				// A worker may be in the middle of filling a buffer
+				soundBufferThreads[i]->shutdownAndJoin();
+				delete soundBufferThreads[i];
+			}
+			// Anything still queued is decoded by waitUntilDecoded
+			soundBufferThreads.clear();
+		}
+
+		bool SoundBufferCache::isRunning() {
+			return soundBufferThreads.empty() == false;
+		}
+
+		SoundBuffer *SoundBufferCache::acquire(const string &path) {
+			string canonicalPath = getCanonicalSoundPath(path);
+
+			MutexSafeWrapper safeMutex(&soundBufferMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			std::map<string, SoundBuffer *>::iterator iterFind = soundBuffers.find(canonicalPath);
+			if (iterFind != soundBuffers.end()) {
+				iterFind->second->refCount++;
+				return iterFind->second;
+			}
+			safeMutex.ReleaseLock(true);
+
+			// Missing files still fail the load right away like they always did
+			if (fileExists(path) == false && VirtualFileSystem::isArchived(path) == false) {
+				throw megaglest_runtime_error("Can not open sound file: [" + path + "]", true);
+			}
+
+			SoundBuffer *buffer = new SoundBuffer();
+			buffer->path = path;
+			buffer->refCount = 1;
+
+			safeMutex.Lock();
+			iterFind = soundBuffers.find(canonicalPath);
+			if (iterFind != soundBuffers.end()) {
+				// Another thread got here first
+				delete buffer;
+				iterFind->second->refCount++;
+				return iterFind->second;
+			}
+			soundBuffers[canonicalPath] = buffer;
+			soundBufferQueue.push_back(buffer);
+			if (isRunning() == false) {
+				decodeQueued(buffer, safeMutex);
+			}
+			return buffer;
+		}
+
+		void SoundBufferCache::release(SoundBuffer *buffer) {
+			if (buffer == NULL) {
+				return;
+			}
+			MutexSafeWrapper safeMutex(&soundBufferMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			buffer->refCount--;
+			// One being decoded is freed by the thread decoding it
+			if (buffer->refCount > 0 || buffer->decoding == true) {
+				return;
+			}
+			soundBufferQueue.remove(buffer);
+			eraseSoundBuffer(buffer);
+			delete buffer;
+		}
+
+		void SoundBufferCache::waitUntilDecoded(SoundBuffer *buffer) {
+			MutexSafeWrapper safeMutex(&soundBufferMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (buffer->decoded == true) {
+				return;
+			}
+			if (buffer->decoding == false) {
+				decodeQueued(buffer, safeMutex);
+				return;
+			}
+			while (buffer->decoded == false) {
+				safeMutex.ReleaseLock(true);
+				sleep(1);
+				safeMutex.Lock();
+			}
+		}
+
+		int SoundBufferCache::getBufferCount() {
+			MutexSafeWrapper safeMutex(&soundBufferMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return (int) soundBuffers.size();
+		}
+
+		bool SoundBufferCache::processNextDecode() {
+			MutexSafeWrapper safeMutex(&soundBufferMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (soundBufferQueue.empty() == true) {
+				return false;
+			}
+			SoundBuffer *buffer = soundBufferQueue.front();
+			decodeQueued(buffer, safeMutex);
+			if (buffer->refCount <= 0) {
+				eraseSoundBuffer(buffer);
+				delete buffer;
+			}
+			return true;
+		}
+
+	}
+}//end namespace
@@ -18,11 +18,13 @@
 #include "util.h"
 #include "platform_util.h"
 #include "byte_order.h"
+#include "data_archive.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Platform;
 using namespace std;
 using namespace Shared::Util;
+using Shared::PlatformCommon::VirtualFileSystem;
 
 namespace Shared {
 	namespace Sound {
@@ -31,6 +33,13 @@ namespace Shared {
 		//	class WavSoundFileLoader
 		// =====================================================
 
+		WavSoundFileLoader::WavSoundFileLoader() {
+			dataOffset = 0;
+			dataSize = 0;
+			bytesPerSecond = 0;
+			f = &file;
+		}
+
 		void WavSoundFileLoader::open(const string &path, SoundInfo *soundInfo) {
 			char chunkId[] = { '-', '-', '-', '-', '\0' };
 			uint32 size32 = 0;
@@ -38,14 +47,21 @@ namespace Shared {
 			int count;
 			fileName = path;
 
-			f.open(path.c_str(), ios_base::in | ios_base::binary);
+			vector<char> archivedData;
+			if (VirtualFileSystem::readFile(path, archivedData) == true) {
+				archivedFile.str(string(archivedData.begin(), archivedData.end()));
+				f = &archivedFile;
+			} else {
+				file.open(path.c_str(), ios_base::in | ios_base::binary);
 
-			if (!f.is_open()) {
-				throw megaglest_runtime_error("Error opening wav file: " + string(path), true);
+				if (!file.is_open()) {
+					throw megaglest_runtime_error("Error opening wav file: " + string(path), true);
+				}
+				f = &file;
 			}
 
 			//RIFF chunk - Id
-			f.read(chunkId, 4);
+			f->read(chunkId, 4);
 			static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 			if (bigEndianSystem == true) {
 				for (unsigned int i = 0; i < 4; ++i) {
@@ -58,13 +74,13 @@ namespace Shared {
 			}
 
 			//RIFF chunk - Size 
-			f.read((char*) &size32, 4);
+			f->read((char*) &size32, 4);
 			if (bigEndianSystem == true) {
 				size32 = Shared::PlatformByteOrder::fromCommonEndian(size32);
 			}
 
 			//RIFF chunk - Data (WAVE string)
-			f.read(chunkId, 4);
+			f->read(chunkId, 4);
 			if (bigEndianSystem == true) {
 				for (unsigned int i = 0; i < 4; ++i) {
 					chunkId[i] = Shared::PlatformByteOrder::fromCommonEndian(chunkId[i]);
@@ -78,7 +94,7 @@ namespace Shared {
 			// === HEADER ===
 
 			//first sub-chunk (header) - Id
-			f.read(chunkId, 4);
+			f->read(chunkId, 4);
 			if (bigEndianSystem == true) {
 				for (unsigned int i = 0; i < 4; ++i) {
 					chunkId[i] = Shared::PlatformByteOrder::fromCommonEndian(chunkId[i]);
@@ -90,19 +106,19 @@ namespace Shared {
 			}
 
 			//first sub-chunk (header) - Size 
-			f.read((char*) &size32, 4);
+			f->read((char*) &size32, 4);
 			if (bigEndianSystem == true) {
 				size32 = Shared::PlatformByteOrder::fromCommonEndian(size32);
 			}
 
 			//first sub-chunk (header) - Data (encoding type) - Ignore
-			f.read((char*) &size16, 2);
+			f->read((char*) &size16, 2);
 			if (bigEndianSystem == true) {
 				size16 = Shared::PlatformByteOrder::fromCommonEndian(size16);
 			}
 
 			//first sub-chunk (header) - Data (nChannels)
-			f.read((char*) &size16, 2);
+			f->read((char*) &size16, 2);
 			if (bigEndianSystem == true) {
 				size16 = Shared::PlatformByteOrder::fromCommonEndian(size16);
 			}
@@ -110,7 +126,7 @@ namespace Shared {
 			soundInfo->setChannels(size16);
 
 			//first sub-chunk (header) - Data (nsamplesPerSecond)
-			f.read((char*) &size32, 4);
+			f->read((char*) &size32, 4);
 			if (bigEndianSystem == true) {
 				size32 = Shared::PlatformByteOrder::fromCommonEndian(size32);
 			}
@@ -118,19 +134,19 @@ namespace Shared {
 			soundInfo->setsamplesPerSecond(size32);
 
 			//first sub-chunk (header) - Data (nAvgBytesPerSec)  - Ignore
-			f.read((char*) &size32, 4);
+			f->read((char*) &size32, 4);
 			if (bigEndianSystem == true) {
 				size32 = Shared::PlatformByteOrder::fromCommonEndian(size32);
 			}
 
 			//first sub-chunk (header) - Data (blockAlign) - Ignore
-			f.read((char*) &size16, 2);
+			f->read((char*) &size16, 2);
 			if (bigEndianSystem == true) {
 				size16 = Shared::PlatformByteOrder::fromCommonEndian(size16);
 			}
 
 			//first sub-chunk (header) - Data (nsamplesPerSecond)
-			f.read((char*) &size16, 2);
+			f->read((char*) &size16, 2);
 			if (bigEndianSystem == true) {
 				size16 = Shared::PlatformByteOrder::fromCommonEndian(size16);
 			}
@@ -150,7 +166,7 @@ namespace Shared {
 
 				// === DATA ===
 				//second sub-chunk (samples) - Id
-				f.read(chunkId, 4);
+				f->read(chunkId, 4);
 				if (bigEndianSystem == true) {
 					for (unsigned int i = 0; i < 4; ++i) {
 						chunkId[i] = Shared::PlatformByteOrder::fromCommonEndian(chunkId[i]);
@@ -162,7 +178,7 @@ namespace Shared {
 				}
 
 				//second sub-chunk (samples) - Size
-				f.read((char*) &size32, 4);
+				f->read((char*) &size32, 4);
 				if (bigEndianSystem == true) {
 					size32 = Shared::PlatformByteOrder::fromCommonEndian(size32);
 				}
@@ -171,30 +187,33 @@ namespace Shared {
 				soundInfo->setSize(dataSize);
 			} while (strncmp(chunkId, "data", 4) != 0 && count < maxDataRetryCount);
 
-			if (f.bad() || count == maxDataRetryCount) {
+			if (f->bad() || count == maxDataRetryCount) {
 				throw megaglest_runtime_error("Error reading samples: " + path, true);
 			}
 
-			dataOffset = (uint32) f.tellg();
+			dataOffset = (uint32) f->tellg();
 
 		}
 
 		uint32 WavSoundFileLoader::read(int8 *samples, uint32 size) {
-			f.read(reinterpret_cast<char*> (samples), size);
+			f->read(reinterpret_cast<char*> (samples), size);
 			static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 			if (bigEndianSystem == true) {
 				Shared::PlatformByteOrder::toEndianTypeArray<int8>(samples, size);
 			}
 
-			return (uint32) f.gcount();
+			return (uint32) f->gcount();
 		}
 
 		void WavSoundFileLoader::close() {
-			f.close();
+			file.close();
+			archivedFile.str(string());
 		}
 
 		void WavSoundFileLoader::restart() {
-			f.seekg(dataOffset, ios_base::beg);
+			// Reading up to the end left failbit set, which makes seekg fail
+			f->clear();
+			f->seekg(dataOffset, ios_base::beg);
 		}
 
 		// =======================================
@@ -209,11 +228,14 @@ namespace Shared {
 		void OggSoundFileLoader::open(const string &path, SoundInfo *soundInfo) {
 			fileName = path;
 
+			f = VirtualFileSystem::openFile(path);
+			if (f == NULL) {
 #ifdef WIN32
-			f = _wfopen(utf8_decode(path).c_str(), L"rb");
+				f = _wfopen(utf8_decode(path).c_str(), L"rb");
 #else
-			f = fopen(path.c_str(), "rb");
+				f = fopen(path.c_str(), "rb");
 #endif
+			}
 			if (f == NULL) {
 				throw megaglest_runtime_error("Can't open ogg file: " + path, true);
 			}
@@ -17,12 +17,19 @@
 
 #ifdef WIN32
 #include <io.h> // for open()
+#include <process.h> // for _getpid()
+#else
+#include <unistd.h> // for write() and getpid()
 #endif
 
 #include <sys/stat.h> // for open()
 
+#include <thread>
+
 #include "util.h"
 #include "platform_common.h"
+#include "base_thread.h"
+#include "byte_order.h"
 #include "conversion.h"
 #include "platform_util.h"
 #include "leak_dumper.h"
@@ -40,6 +47,264 @@ namespace Shared {
 
 		Mutex Checksum::fileListCacheSynchAccessor;
 		std::map<string, uint32> Checksum::fileListCache;
+		int Checksum::fileThreadCount = std::max((int) std::thread::hardware_concurrency(), 1);
+
+		// Fewer files than this per thread are not worth starting threads for
+		static const int minFilesPerChecksumThread = 8;
+
+		// =====================================================
+		//	Persistent file crc cache
+		//
+		//	An append only log of (path, size, mtime, inode, crc)
+		//	records, the last record for a path wins. It is rewritten
+		//	without the outdated records once they make up most of it.
+		//	Processes sharing the file append whole batches in one
+		//	write and rewrite it through a temporary file and a rename.
+		// =====================================================
+
+		// Bump whenever the way a file sum is computed changes
+		static const uint32 fileCRCCacheVersion = 2;
+		static const uint32 fileCRCCacheMagic = 0x5A474643;
+
+		class FileCRCStamp {
+		public:
+			uint64 size;
+			int64 modified;
+			uint64 inode;
+
+			FileCRCStamp() : size(0), modified(0), inode(0) {
+			}
+			bool operator ==(const FileCRCStamp &other) const {
+				return size == other.size && modified == other.modified && inode == other.inode;
+			}
+		};
+
+		class FileCRCCacheEntry {
+		public:
+			FileCRCStamp stamp;
+			uint32 crc;
+
+			FileCRCCacheEntry() : crc(0) {
+			}
+		};
+
+		static Mutex fileCRCCacheMutex;
+		static string fileCRCCacheFile;
+		static std::map<string, FileCRCCacheEntry> fileCRCCache;
+		static vector<std::pair<string, FileCRCCacheEntry> > fileCRCCacheUnsaved;
+		static int fileCRCCacheRecordCount = 0;
+
+		static bool getFileCRCStamp(const string &path, FileCRCStamp &stamp) {
+#ifdef WIN32
+			struct _stat64 fileStat;
+			if (_wstat64(utf8_decode(path).c_str(), &fileStat) != 0) {
+				return false;
+			}
+#else
+			struct stat fileStat;
+			if (stat(path.c_str(), &fileStat) != 0) {
+				return false;
+			}
+#endif
+			stamp.size = (uint64) fileStat.st_size;
+			// In nanoseconds where the platform has them, so a file rewritten
+			// twice within one second with the same size is still noticed
+			stamp.modified = (int64) fileStat.st_mtime * 1000000000;
+#if defined(__APPLE__)
+			stamp.modified += (int64) fileStat.st_mtimespec.tv_nsec;
+#elif !defined(WIN32)
+			stamp.modified += (int64) fileStat.st_mtim.tv_nsec;
+#endif
+			stamp.inode = (uint64) fileStat.st_ino;
+			return true;
+		}
+
+		template<typename T>
+		static void writeFileCRCCacheValue(string &buffer, T value) {
+			value = Shared::PlatformByteOrder::toCommonEndian(value);
+			buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+
+		template<typename T>
+		static bool readFileCRCCacheValue(FILE *fp, T &value) {
+			if (fread(&value, sizeof(value), 1, fp) != 1) {
+				return false;
+			}
+			value = Shared::PlatformByteOrder::fromCommonEndian(value);
+			return true;
+		}
+
+		static void writeFileCRCCacheRecord(string &buffer, const string &path, const FileCRCCacheEntry &entry) {
+			writeFileCRCCacheValue(buffer, (uint32) path.size());
+			buffer.append(path);
+			writeFileCRCCacheValue(buffer, entry.stamp.size);
+			writeFileCRCCacheValue(buffer, entry.stamp.modified);
+			writeFileCRCCacheValue(buffer, entry.stamp.inode);
+			writeFileCRCCacheValue(buffer, entry.crc);
+		}
+
+		static FILE * openFileCRCCache(const string &path, const char *mode) {
+#ifdef WIN32
+			return _wfopen(utf8_decode(path).c_str(), utf8_decode(mode).c_str());
+#else
+			return fopen(path.c_str(), mode);
+#endif
+		}
+
+		// Expects fileCRCCacheMutex to be held
+		static void loadFileCRCCache() {
+			fileCRCCache.clear();
+			fileCRCCacheUnsaved.clear();
+			fileCRCCacheRecordCount = 0;
+			if (fileCRCCacheFile == "") {
+				return;
+			}
+			FILE *fp = openFileCRCCache(fileCRCCacheFile, "rb");
+			if (fp == NULL) {
+				return;
+			}
+			uint32 magic = 0;
+			uint32 version = 0;
+			if (readFileCRCCacheValue(fp, magic) == true && magic == fileCRCCacheMagic &&
+				readFileCRCCacheValue(fp, version) == true && version == fileCRCCacheVersion) {
+				// A record cut short by a crash ends the log
+				for (;;) {
+					uint32 pathLength = 0;
+					if (readFileCRCCacheValue(fp, pathLength) == false || pathLength > 8096) {
+						break;
+					}
+					string path(pathLength, '\0');
+					FileCRCCacheEntry entry;
+					if ((pathLength > 0 && fread(&path[0], pathLength, 1, fp) != 1) ||
+						readFileCRCCacheValue(fp, entry.stamp.size) == false ||
+						readFileCRCCacheValue(fp, entry.stamp.modified) == false ||
+						readFileCRCCacheValue(fp, entry.stamp.inode) == false ||
+						readFileCRCCacheValue(fp, entry.crc) == false) {
+						break;
+					}
+					fileCRCCache[path] = entry;
+					fileCRCCacheRecordCount++;
+				}
+			}
+			fclose(fp);
+
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] loaded %d file crc records for %d files from [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, fileCRCCacheRecordCount, (int) fileCRCCache.size(), fileCRCCacheFile.c_str());
+		}
+
+		// Several game processes can share one cache file. New records go out
+		// in a single write to the end of the file so records appended by two
+		// processes at once never interleave
+		static bool appendFileCRCCache(const string &path, const string &buffer) {
+#ifdef WIN32
+			int fd = _wopen(utf8_decode(path).c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+			if (fd < 0) {
+				return false;
+			}
+			bool result = (_write(fd, buffer.data(), (unsigned int) buffer.size()) == (int) buffer.size());
+			_close(fd);
+#else
+			int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+			if (fd < 0) {
+				return false;
+			}
+			bool result = (write(fd, buffer.data(), buffer.size()) == (ssize_t) buffer.size());
+			close(fd);
+#endif
+			return result;
+		}
+
+		// A full rewrite goes to a file of this process first and then
+		// replaces the cache, other processes see the old or the new file
+		static bool replaceFileCRCCache(const string &path, const string &buffer) {
+#ifdef WIN32
+			string tempPath = path + "." + intToStr(_getpid()) + ".tmp";
+#else
+			string tempPath = path + "." + intToStr(getpid()) + ".tmp";
+#endif
+			FILE *fp = openFileCRCCache(tempPath, "wb");
+			if (fp == NULL) {
+				return false;
+			}
+			bool result = (fwrite(buffer.data(), buffer.size(), 1, fp) == 1);
+			if (fclose(fp) != 0) {
+				result = false;
+			}
+#ifdef WIN32
+			result = result && (MoveFileExW(utf8_decode(tempPath).c_str(), utf8_decode(path).c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+			result = result && (rename(tempPath.c_str(), path.c_str()) == 0);
+#endif
+			if (result == false) {
+				removeFile(tempPath);
+			}
+			return result;
+		}
+
+		// Expects fileCRCCacheMutex to be held
+		static void saveFileCRCCache() {
+			if (fileCRCCacheFile == "" || fileCRCCacheUnsaved.empty() == true) {
+				return;
+			}
+			string buffer;
+			bool rewrite = false;
+			int recordCount = fileCRCCacheRecordCount + (int) fileCRCCacheUnsaved.size();
+			if (fileCRCCacheRecordCount == 0 || recordCount > 2 * (int) fileCRCCache.size() + 1024) {
+				// New, or mostly outdated records: write it out from scratch
+				rewrite = true;
+				writeFileCRCCacheValue(buffer, fileCRCCacheMagic);
+				writeFileCRCCacheValue(buffer, fileCRCCacheVersion);
+				for (std::map<string, FileCRCCacheEntry>::const_iterator iterMap = fileCRCCache.begin();
+					iterMap != fileCRCCache.end(); ++iterMap) {
+					writeFileCRCCacheRecord(buffer, iterMap->first, iterMap->second);
+				}
+				recordCount = (int) fileCRCCache.size();
+			} else {
+				for (unsigned int i = 0; i < fileCRCCacheUnsaved.size(); ++i) {
+					writeFileCRCCacheRecord(buffer, fileCRCCacheUnsaved[i].first, fileCRCCacheUnsaved[i].second);
+				}
+			}
+			fileCRCCacheUnsaved.clear();
+
+			bool saved = (rewrite == true ?
+				replaceFileCRCCache(fileCRCCacheFile, buffer) :
+				appendFileCRCCache(fileCRCCacheFile, buffer));
+			if (saved == false) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Can not write file crc cache [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, fileCRCCacheFile.c_str());
+				return;
+			}
+			fileCRCCacheRecordCount = recordCount;
+		}
+
+		// Sum of the file, taken from the persistent cache when it is unchanged
+		static uint32 getCachedFileSum(const string &path) {
+			MutexSafeWrapper safeMutex(&fileCRCCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (fileCRCCacheFile == "") {
+				safeMutex.ReleaseLock();
+				return Checksum::getFileSum(path);
+			}
+			safeMutex.ReleaseLock(true);
+
+			FileCRCStamp stamp;
+			if (getFileCRCStamp(path, stamp) == false) {
+				return Checksum::getFileSum(path);
+			}
+
+			safeMutex.Lock();
+			std::map<string, FileCRCCacheEntry>::const_iterator iterFind = fileCRCCache.find(path);
+			if (iterFind != fileCRCCache.end() && iterFind->second.stamp == stamp) {
+				return iterFind->second.crc;
+			}
+			safeMutex.ReleaseLock(true);
+
+			FileCRCCacheEntry entry;
+			entry.stamp = stamp;
+			entry.crc = Checksum::getFileSum(path);
+
+			safeMutex.Lock();
+			fileCRCCache[path] = entry;
+			fileCRCCacheUnsaved.push_back(make_pair(path, entry));
+			return entry.crc;
+		}
 
 		unsigned int crc_table[256] =
 		{
@@ -77,6 +342,28 @@ namespace Shared {
 			0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 		};
 
+		// Slicing-by-8 tables: crc_slice_table[k][b] is the crc of byte b
+		// followed by k zero bytes, which lets addBytes consume 8 bytes
+		// per step with the same result as the byte at a time loop
+		class CrcSliceTables {
+		public:
+			uint32 table[8][256];
+
+			CrcSliceTables() {
+				for (int i = 0; i < 256; ++i) {
+					table[0][i] = crc_table[i];
+				}
+				for (int k = 1; k < 8; ++k) {
+					for (int i = 0; i < 256; ++i) {
+						uint32 previous = table[k - 1][i];
+						table[k][i] = (previous >> 8) ^ crc_table[previous & 0xff];
+					}
+				}
+			}
+		};
+
+		static const CrcSliceTables crc_slice_tables;
+
 		Checksum::Checksum() {
 			sum = 0;
 			r = 55665;
@@ -102,7 +389,16 @@ namespace Shared {
 
 		uint32 Checksum::addBytes(const void *_data, size_t _size) {
 			const unsigned char *rVal = reinterpret_cast<const unsigned char *>(_data);
+			const uint32 (*table)[256] = crc_slice_tables.table;
 			sum = ~sum;
+			for (; _size >= 8; _size -= 8, rVal += 8) {
+				uint32 low = sum ^ ((uint32) rVal[0] | ((uint32) rVal[1] << 8) |
+					((uint32) rVal[2] << 16) | ((uint32) rVal[3] << 24));
+				sum = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+					table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+					table[3][rVal[4]] ^ table[2][rVal[5]] ^
+					table[1][rVal[6]] ^ table[0][rVal[7]];
+			}
 			while (_size--) {
 				sum = (sum >> 8) ^ crc_table[*rVal++ ^ (sum & 0xff)];
 			}
@@ -164,9 +460,7 @@ namespace Shared {
 		}
 
 		void Checksum::addString(const string &value) {
-			for (unsigned int i = 0; i < value.size(); ++i) {
-				addByte(value[i]);
-			}
+			addBytes(value.data(), value.size());
 		}
 
 		void Checksum::addFile(const string &path) {
@@ -175,6 +469,15 @@ namespace Shared {
 			}
 		}
 
+		void Checksum::addFile(const string &path, uint32 fileSum) {
+			if (path != "") {
+				fileList[path] = 0;
+
+				MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+				Checksum::fileListCache[path] = fileSum;
+			}
+		}
+
 		bool Checksum::addFileToSum(const string &path) {
 
 			// OLD SLOW FILE I/O
@@ -311,39 +614,28 @@ namespace Shared {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] buf.size() = %d, path [%s], isXMLFile = %d\n", __FILE__, __FUNCTION__, __LINE__, buf.size(), path.c_str(), isXMLFile);
 
 				if (isXMLFile == true) {
+					// Ignore comments and spaces in XML files as they are
+					// ONLY for formatting, the rest is hashed in one go
+					std::vector<char> content;
+					content.reserve(buf.size());
 					bool inCommentTag = false;
 					for (std::size_t i = 0; i < buf.size(); ++i) {
-						// Ignore Spaces in XML files as they are
-						// ONLY for formatting
-						//if(isXMLFile == true) {
 						if (inCommentTag == true) {
 							if (buf[i] == '>' && i >= 3 && buf[i - 1] == '-' && buf[i - 2] == '-') {
 								inCommentTag = false;
-								//printf("TURNING OFF comment TAG, i = %d [%c]",i,buf[i]);
-								if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] i = %d\n", __FILE__, __FUNCTION__, __LINE__, i);
-							} else {
-								//printf("SKIPPING XML comment character, i = %d [%c]",i,buf[i]);
-								if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] i = %d\n", __FILE__, __FUNCTION__, __LINE__, i);
 							}
 							continue;
-						}
-						//else if(buf[i] == '-' && i >= 4 && buf[i-1] == '-' && buf[i-2] == '!' && buf[i-3] == '<') {
-						else if (buf[i] == '<' && i + 4 < bufSize && buf[i + 1] == '!' && buf[i + 2] == '-' && buf[i + 3] == '-') {
+						} else if (buf[i] == '<' && i + 4 < bufSize && buf[i + 1] == '!' && buf[i + 2] == '-' && buf[i + 3] == '-') {
 							inCommentTag = true;
-							//printf("TURNING ON comment TAG, i = %d [%c]",i,buf[i]);
-							if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] i = %d\n", __FILE__, __FUNCTION__, __LINE__, i);
 							continue;
 						} else if (buf[i] == ' ' || buf[i] == '\t' || buf[i] == '\n' || buf[i] == '\r') {
-							//printf("SKIPPING special character, i = %d [%c]",i,buf[i]);
-							if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] i = %d\n", __FILE__, __FUNCTION__, __LINE__, i);
 							continue;
 						}
-						//}
-						uint32 cipher = addByte(buf[i]);
-
-						if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] %d / %d, cipher = %u\n", __FILE__, __FUNCTION__, __LINE__, i, buf.size(), cipher);
+						content.push_back(buf[i]);
 					}
-				} else {
+					uint32 cipher = (content.empty() == false ? addBytes(&content[0], content.size()) : sum);
+					if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] %d / %d, cipher = %u\n", __FILE__, __FUNCTION__, __LINE__, content.size(), buf.size(), cipher);
+				} else if (buf.empty() == false) {
 					uint32 cipher = addBytes(&buf[0], buf.size());
 					if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] %d, cipher = %u\n", __FILE__, __FUNCTION__, __LINE__, buf.size(), cipher);
 				}
@@ -365,26 +657,37 @@ namespace Shared {
 			if (fileList.size() > 0) {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] fileList.size() = %d\n", __FILE__, __FUNCTION__, __LINE__, fileList.size());
 
-				Checksum newResult;
+				vector<string> pendingFiles;
+				MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+				for (std::map<string, uint32>::iterator iterMap = fileList.begin();
+					iterMap != fileList.end(); ++iterMap) {
+					if (Checksum::fileListCache.find(iterMap->first) == Checksum::fileListCache.end()) {
+						pendingFiles.push_back(iterMap->first);
+					}
+				}
+				safeMutexSocketDestructorFlag.ReleaseLock(true);
 
-				{
+				// Hashed without holding the cache lock so other threads
+				// checking different folders are not held up
+				vector<uint32> pendingSums(pendingFiles.size());
+				computeFileSums(pendingFiles, pendingSums);
 
-					for (std::map<string, uint32>::iterator iterMap = fileList.begin();
-						iterMap != fileList.end(); ++iterMap) {
-
-						MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
-						if (Checksum::fileListCache.find(iterMap->first) == Checksum::fileListCache.end()) {
-							Checksum fileResult;
-							//bool fileAddedOk = fileResult.addFileToSum(iterMap->first);
-							fileResult.addFileToSum(iterMap->first);
-							Checksum::fileListCache[iterMap->first] = fileResult.getSum();
-							//printf("fileAddedOk = %d for file [%s] CRC [%d]\n",fileAddedOk,iterMap->first.c_str(),Checksum::fileListCache[iterMap->first]);
-						} else {
-							//printf("Getting checksum from CACHE for file [%s] CRC [%d]\n",iterMap->first.c_str(),Checksum::fileListCache[iterMap->first]);
-						}
+				// The per file sums are simply added up, so the order they
+				// were computed in makes no difference to the result
+				Checksum newResult;
+				size_t pendingIndex = 0;
+				safeMutexSocketDestructorFlag.Lock();
+				for (std::map<string, uint32>::iterator iterMap = fileList.begin();
+					iterMap != fileList.end(); ++iterMap) {
+					if (pendingIndex < pendingFiles.size() && pendingFiles[pendingIndex] == iterMap->first) {
+						Checksum::fileListCache[iterMap->first] = pendingSums[pendingIndex];
+						newResult.addSum(pendingSums[pendingIndex]);
+						pendingIndex++;
+					} else {
 						newResult.addSum(Checksum::fileListCache[iterMap->first]);
 					}
 				}
+				safeMutexSocketDestructorFlag.ReleaseLock();
 
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] fileList.size() = %d\n", __FILE__, __FUNCTION__, __LINE__, fileList.size());
 
@@ -393,6 +696,109 @@ namespace Shared {
 			return sum;
 		}
 
+		uint32 Checksum::getFileSum(const string &path) {
+			Checksum fileResult;
+			fileResult.addFileToSum(path);
+			return fileResult.getSum();
+		}
+
+		// =====================================================
+		//	class ChecksumFileThread
+		// =====================================================
+
+		class ChecksumFileJob {
+		public:
+			Mutex mutex;
+			const vector<string> *paths;
+			vector<uint32> *sums;
+			size_t nextIndex;
+
+			ChecksumFileJob(const vector<string> *paths, vector<uint32> *sums) :
+				paths(paths), sums(sums), nextIndex(0) {
+			}
+
+			// Hashes the next file, returns false once all are taken
+			bool processNextFile() {
+				MutexSafeWrapper safeMutex(&mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+				if (nextIndex >= paths->size()) {
+					return false;
+				}
+				size_t index = nextIndex++;
+				safeMutex.ReleaseLock();
+
+				(*sums)[index] = getCachedFileSum((*paths)[index]);
+				return true;
+			}
+		};
+
+		class ChecksumFileThread : public BaseThread {
+		private:
+			ChecksumFileJob *job;
+
+		public:
+			explicit ChecksumFileThread(ChecksumFileJob *job) : BaseThread(), job(job) {
+				uniqueID = "ChecksumFileThread";
+			}
+
+			virtual void execute() {
+				{
+					RunningStatusSafeWrapper runningStatus(this);
+					while (getQuitStatus() == false && job->processNextFile() == true) {
+					}
+				}
+				deleteSelfIfRequired();
+			}
+		};
+
+		void Checksum::computeFileSums(const vector<string> &paths, vector<uint32> &sums) {
+			int threadCount = std::min(getFileThreadCount(), (int) paths.size() / minFilesPerChecksumThread);
+			ChecksumFileJob job(&paths, &sums);
+
+			// The calling thread hashes files too
+			vector<ChecksumFileThread *> threads;
+			for (int i = 1; i < threadCount; ++i) {
+				ChecksumFileThread *thread = new ChecksumFileThread(&job);
+				threads.push_back(thread);
+				thread->start();
+			}
+			while (job.processNextFile() == true) {
+			}
+			// job and sums live on this stack frame, a thread may still be
+			// hashing its last file so every one has to be gone before returning
+			for (unsigned int i = 0; i < threads.size(); ++i) {
+				threads[i]->shutdownAndJoin();
+				delete threads[i];
+			}
+
+			MutexSafeWrapper safeMutex(&fileCRCCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			saveFileCRCCache();
+		}
+
+		void Checksum::setFileCRCCacheFile(const string &path) {
+			MutexSafeWrapper safeMutex(&fileCRCCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (path == fileCRCCacheFile) {
+				return;
+			}
+			saveFileCRCCache();
+			fileCRCCacheFile = path;
+			loadFileCRCCache();
+		}
+
+		string Checksum::getFileCRCCacheFile() {
+			MutexSafeWrapper safeMutex(&fileCRCCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return fileCRCCacheFile;
+		}
+
+		void Checksum::setFileThreadCount(int value) {
+			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+			fileThreadCount = std::max(value, 1);
+		}
+
+		int Checksum::getFileThreadCount() {
+			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+			return fileThreadCount;
+		}
+
 		uint32 Checksum::getFinalFileListSum() {
 			sum = 0;
 			return getSum();
@@ -0,0 +1,220 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// merkle_manifest.cpp: hash tree over a folder's file checksums, used to
+// find the files that differ between two copies of the same game data
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "merkle_manifest.h"
+
+#include "checksum.h"
+#include "platform_common.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::PlatformCommon;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class MerkleManifest::Node
+		// =====================================================
+
+		MerkleManifest::Node::Node() : hash(0), isFile(false) {
+		}
+
+		MerkleManifest::Node::~Node() {
+			for (std::map<string, Node *>::iterator iterMap = children.begin();
+				iterMap != children.end(); ++iterMap) {
+				delete iterMap->second;
+			}
+			children.clear();
+		}
+
+		// =====================================================
+		//	class MerkleManifest
+		// =====================================================
+
+		MerkleManifest::MerkleManifest() : root(new Node()), fileCount(0) {
+		}
+
+		MerkleManifest::~MerkleManifest() {
+			delete root;
+			root = NULL;
+		}
+
+		void MerkleManifest::clear() {
+			delete root;
+			root = new Node();
+			fileCount = 0;
+		}
+
+		string MerkleManifest::getRelativePath(const string &path, const vector<string> &rootFolders) {
+			string result = path;
+			replaceAll(result, "\\", "/");
+
+			for (unsigned int idx = 0; idx < rootFolders.size(); ++idx) {
+				string searchFolder = rootFolders[idx];
+				replaceAll(searchFolder, "\\", "/");
+				if (searchFolder == "") {
+					continue;
+				}
+				endPathWithSlash(searchFolder);
+				// A whole leading folder, not any place the name shows up
+				if (StartsWith(result, searchFolder) == true) {
+					return result.substr(searchFolder.size());
+				}
+			}
+			return result;
+		}
+
+		void MerkleManifest::getRelativeFileList(vector<std::pair<string, uint32> > &fileList, const vector<string> &rootFolders) {
+			for (unsigned int idx = 0; idx < fileList.size(); ++idx) {
+				fileList[idx].first = getRelativePath(fileList[idx].first, rootFolders);
+			}
+		}
+
+		void MerkleManifest::build(const vector<std::pair<string, uint32> > &fileList, const vector<string> &rootFolders) {
+			clear();
+			for (unsigned int idx = 0; idx < fileList.size(); ++idx) {
+				addFile(getRelativePath(fileList[idx].first, rootFolders), fileList[idx].second);
+			}
+			computeHash(root);
+		}
+
+		void MerkleManifest::addFile(const string &relativePath, uint32 crc) {
+			vector<string> parts;
+			Tokenize(relativePath, parts, "/");
+			if (parts.empty() == true) {
+				return;
+			}
+
+			Node *node = root;
+			for (unsigned int idx = 0; idx < parts.size(); ++idx) {
+				Node *&child = node->children[parts[idx]];
+				if (child == NULL) {
+					child = new Node();
+				}
+				node = child;
+			}
+			if (node->isFile == false) {
+				fileCount++;
+			}
+			node->isFile = true;
+			node->hash = crc;
+		}
+
+		uint32 MerkleManifest::computeHash(Node *node) {
+			if (node->isFile == true && node->children.empty() == true) {
+				return node->hash;
+			}
+
+			// Children are kept sorted by name so both sides hash them in the same order
+			Checksum checksum;
+			for (std::map<string, Node *>::iterator iterMap = node->children.begin();
+				iterMap != node->children.end(); ++iterMap) {
+				checksum.addString(iterMap->first);
+				checksum.addUInt(computeHash(iterMap->second));
+			}
+			node->hash = checksum.getSum();
+			return node->hash;
+		}
+
+		uint32 MerkleManifest::getRootHash() const {
+			return root->hash;
+		}
+
+		const MerkleManifest::Node * MerkleManifest::findNode(const string &relativePath) const {
+			vector<string> parts;
+			Tokenize(relativePath, parts, "/");
+
+			const Node *node = root;
+			for (unsigned int idx = 0; idx < parts.size(); ++idx) {
+				std::map<string, Node *>::const_iterator iterFind = node->children.find(parts[idx]);
+				if (iterFind == node->children.end()) {
+					return NULL;
+				}
+				node = iterFind->second;
+			}
+			return node;
+		}
+
+		bool MerkleManifest::getHash(const string &relativePath, uint32 &hash) const {
+			const Node *node = findNode(relativePath);
+			if (node == NULL) {
+				return false;
+			}
+			hash = node->hash;
+			return true;
+		}
+
+		void MerkleManifest::collectFiles(const Node *node, const string &path, vector<string> &fileList) {
+			if (node->isFile == true) {
+				fileList.push_back(path);
+			}
+			for (std::map<string, Node *>::const_iterator iterMap = node->children.begin();
+				iterMap != node->children.end(); ++iterMap) {
+				collectFiles(iterMap->second, (path == "" ? iterMap->first : path + "/" + iterMap->first), fileList);
+			}
+		}
+
+		void MerkleManifest::diffNodes(const Node *local, const Node *remote, const string &path, MerkleManifestDiff &result) {
+			result.nodesCompared++;
+			if (local->hash == remote->hash && local->isFile == remote->isFile &&
+				local->children.size() == remote->children.size()) {
+				return;
+			}
+
+			if (local->isFile == true && remote->isFile == true) {
+				result.changed.push_back(path);
+				return;
+			} else if (local->isFile == true) {
+				result.missingRemotely.push_back(path);
+			} else if (remote->isFile == true) {
+				result.missingLocally.push_back(path);
+			}
+
+			// Both child maps are sorted, walk them side by side
+			std::map<string, Node *>::const_iterator iterLocal = local->children.begin();
+			std::map<string, Node *>::const_iterator iterRemote = remote->children.begin();
+			while (iterLocal != local->children.end() || iterRemote != remote->children.end()) {
+				if (iterRemote == remote->children.end() ||
+					(iterLocal != local->children.end() && iterLocal->first < iterRemote->first)) {
+					collectFiles(iterLocal->second, (path == "" ? iterLocal->first : path + "/" + iterLocal->first), result.missingRemotely);
+					++iterLocal;
+				} else if (iterLocal == local->children.end() || iterRemote->first < iterLocal->first) {
+					collectFiles(iterRemote->second, (path == "" ? iterRemote->first : path + "/" + iterRemote->first), result.missingLocally);
+					++iterRemote;
+				} else {
+					diffNodes(iterLocal->second, iterRemote->second, (path == "" ? iterLocal->first : path + "/" + iterLocal->first), result);
+					++iterLocal;
+					++iterRemote;
+				}
+			}
+		}
+
+		void MerkleManifest::diff(const MerkleManifest &remote, MerkleManifestDiff &result) const {
+			diffNodes(root, remote.root, "", result);
+		}
+
+	}
+}//end namespace
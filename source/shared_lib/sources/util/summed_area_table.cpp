@@ -0,0 +1,99 @@
+//
+// This file is part of ZetaGlest Shared
+// Library<https://github.com/ZetaGlest>
+//
+// summed_area_table.cpp: counts marked cells of any square of a grid
+// in constant time, e.g. to find where a building fits
+//
+// Copyright (C) 2018  The ZetaGlest team
+//
+// ZetaGlest is a fork of MegaGlest <https://megaglest.org>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>
+//
+
+#include "summed_area_table.h"
+
+#include <algorithm>
+#include <cassert>
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared {
+	namespace Util {
+
+		// =====================================================
+		//	class SummedAreaTable
+		// =====================================================
+
+		SummedAreaTable::SummedAreaTable() {
+			originX = 0;
+			originY = 0;
+			w = 0;
+			h = 0;
+			built = false;
+		}
+
+		void SummedAreaTable::init(int originX, int originY, int w, int h) {
+			this->originX = originX;
+			this->originY = originY;
+			this->w = max(w, 0);
+			this->h = max(h, 0);
+			built = false;
+			// Keeps its capacity when the table is reused
+			sums.assign((this->w + 1) * (this->h + 1), 0);
+		}
+
+		void SummedAreaTable::mark(int x, int y) {
+			assert(built == false);
+			x -= originX;
+			y -= originY;
+			if (x >= 0 && y >= 0 && x < w && y < h) {
+				sums[(y + 1) * (w + 1) + x + 1]++;
+			}
+		}
+
+		void SummedAreaTable::build() {
+			for (int y = 1; y <= h; ++y) {
+				int rowSum = 0;
+				for (int x = 1; x <= w; ++x) {
+					int index = y * (w + 1) + x;
+					rowSum += sums[index];
+					sums[index] = rowSum + sums[index - (w + 1)];
+				}
+			}
+			built = true;
+		}
+
+		int SummedAreaTable::getCount(int x, int y, int size) const {
+			assert(built == true);
+			if (size <= 0) {
+				return 0;
+			}
+			x -= originX;
+			y -= originY;
+			int x1 = max(x, 0);
+			int y1 = max(y, 0);
+			int x2 = min(x + size, w);
+			int y2 = min(y + size, h);
+			if (x1 >= x2 || y1 >= y2) {
+				return size * size;
+			}
+			int outside = size * size - (x2 - x1) * (y2 - y1);
+			return getSum(x2, y2) - getSum(x1, y2) - getSum(x2, y1) + getSum(x1, y1) + outside;
+		}
+
+	}
+}//end namespace
@@ -16,6 +16,9 @@
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <iterator>
+#include <set>
+#include <string.h>
 
 #include "conversion.h"
 
@@ -32,6 +35,9 @@
 #include "platform_common.h"
 #include "platform_util.h"
 #include "cache_manager.h"
+#include "data_archive.h"
+#include "base_thread.h"
+#include "byte_order.h"
 
 #include "rapidxml/rapidxml_print.hpp"
 #include "leak_dumper.h"
@@ -342,47 +348,62 @@ namespace Shared {
 			XmlNode *rootNode = NULL;
 			try {
 
-				if (folderExists(path) == true) {
-					throw megaglest_runtime_error("Can not open file: [" + path + "] as it is a folder!", true);
-				}
+				// Load data and add terminating 0
+				vector<char> buffer;
+				int64 file_size = -1;
+				if (VirtualFileSystem::readFile(path, buffer) == true) {
+					file_size = (int64) buffer.size();
+					if (file_size <= 0) {
+						throw megaglest_runtime_error("Invalid file size for file: [" + path + "] size = " + intToStr(file_size));
+					}
+					buffer.resize((unsigned int) file_size + 100);
+				} else {
+					if (folderExists(path) == true) {
+						throw megaglest_runtime_error("Can not open file: [" + path + "] as it is a folder!", true);
+					}
 
 #if defined(WIN32) && !defined(__MINGW32__)
-				FILE *fp = _wfopen(utf8_decode(path).c_str(), L"rb");
-				ifstream xmlFile(fp);
+					FILE *fp = _wfopen(utf8_decode(path).c_str(), L"rb");
+					ifstream xmlFile(fp);
 #else
-				ifstream xmlFile(path.c_str(), ios::binary);
+					ifstream xmlFile(path.c_str(), ios::binary);
 #endif
-				if (xmlFile.is_open() == false) {
-					throw megaglest_runtime_error("Can not open file: [" + path + "]", true);
-				}
+					if (xmlFile.is_open() == false) {
+						throw megaglest_runtime_error("Can not open file: [" + path + "]", true);
+					}
 
-				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
+					if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
 
-				xmlFile.unsetf(ios::skipws);
+					xmlFile.unsetf(ios::skipws);
 
-				// Determine stream size
-				int64 file_size = -1;
-				if ((double) xmlFile.tellg() != -1) {
-					streampos size1 = xmlFile.tellg();
-					xmlFile.seekg(0, ios::end);
+					// Determine stream size
 					if ((double) xmlFile.tellg() != -1) {
-						streampos size2 = xmlFile.tellg();
-						xmlFile.seekg(0);
-						file_size = size2 - size1;
+						streampos size1 = xmlFile.tellg();
+						xmlFile.seekg(0, ios::end);
+						if ((double) xmlFile.tellg() != -1) {
+							streampos size2 = xmlFile.tellg();
+							xmlFile.seekg(0);
+							file_size = size2 - size1;
+						}
 					}
-				}
 
-				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
+					if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
 
-				if (file_size <= 0) {
-					throw megaglest_runtime_error("Invalid file size for file: [" + path + "] size = " + intToStr(file_size));
-				}
-				//printf("File size is: " MG_I64_SPECIFIER " for [%s]\n",file_size,path.c_str());
+					if (file_size <= 0) {
+						throw megaglest_runtime_error("Invalid file size for file: [" + path + "] size = " + intToStr(file_size));
+					}
+					//printf("File size is: " MG_I64_SPECIFIER " for [%s]\n",file_size,path.c_str());
 
-				// Load data and add terminating 0
-				vector<char> buffer;
-				buffer.resize((unsigned int) file_size + 100);
-				xmlFile.read(&buffer.front(), static_cast<streamsize>(file_size));
+					buffer.resize((unsigned int) file_size + 100);
+					xmlFile.read(&buffer.front(), static_cast<streamsize>(file_size));
+
+#if defined(WIN32) && !defined(__MINGW32__)
+					xmlFile.close();
+					if (fp) {
+						fclose(fp);
+					}
+#endif
+				}
 				buffer[(unsigned int) file_size] = 0;
 
 				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
@@ -401,12 +422,6 @@ namespace Shared {
 				rootNode = new XmlNode(doc.first_node(), mapTagReplacementValues, skipUpdatePathClimbingParts);
 
 				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
-
-#if defined(WIN32) && !defined(__MINGW32__)
-				if (fp) {
-					fclose(fp);
-				}
-#endif
 			} catch (parse_error& ex) {
 				//		char szBuf[8096]="";
 				//		snprintf(szBuf,8096,"%s",ex.where<char>());
@@ -565,7 +580,20 @@ namespace Shared {
 			} else
 #endif
 			{
-				this->rootNode = XmlIoRapid::getInstance().load(path, mapTagReplacementValues, noValidation, skipStackTrace, this->skipUpdatePathClimbingParts);
+				bool fromCache = false;
+				if (this->skipUpdatePathClimbingParts == false) {
+					this->rootNode = XmlTreeCache::takeCached(path, mapTagReplacementValues);
+					fromCache = (this->rootNode != NULL);
+					if (this->rootNode == NULL) {
+						this->rootNode = XmlTreePreloader::takePreloaded(path, mapTagReplacementValues);
+					}
+				}
+				if (this->rootNode == NULL) {
+					this->rootNode = XmlIoRapid::getInstance().load(path, mapTagReplacementValues, noValidation, skipStackTrace, this->skipUpdatePathClimbingParts);
+				}
+				if (fromCache == false && this->skipUpdatePathClimbingParts == false) {
+					XmlTreeCache::add(path, mapTagReplacementValues, this->rootNode);
+				}
 			}
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] about to load [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, path.c_str());
@@ -605,6 +633,381 @@ namespace Shared {
 			clearRootNode();
 		}
 
+		// =====================================================
+		//	class XmlTreePreloader
+		// =====================================================
+
+		enum XmlPreloadState {
+			xpsQueued,
+			xpsParsing,
+			xpsParsed,
+			xpsFailed
+		};
+
+		class XmlPreloadEntry {
+		public:
+			XmlPreloadState state;
+			XmlNode *rootNode;
+
+			XmlPreloadEntry() : state(xpsQueued), rootNode(NULL) {
+			}
+		};
+
+		class XmlTreePreloadThread : public BaseThread {
+		public:
+			XmlTreePreloadThread() : BaseThread() {
+				uniqueID = "XmlTreePreloadThread";
+			}
+
+			virtual void execute() {
+				{
+					RunningStatusSafeWrapper runningStatus(this);
+					while (getQuitStatus() == false && XmlTreePreloader::processNextFile() == true) {
+					}
+				}
+				deleteSelfIfRequired();
+			}
+		};
+
+		static Mutex xmlPreloadMutex;
+		static std::map<string, string> xmlPreloadTagReplacementValues;
+		static std::map<string, XmlPreloadEntry> xmlPreloadEntries;
+		static vector<string> xmlPreloadQueue;
+		static size_t xmlPreloadNextIndex = 0;
+		static vector<XmlTreePreloadThread *> xmlPreloadThreads;
+
+		void XmlTreePreloader::start(const vector<string> &pathList, const std::map<string, string> &mapTagReplacementValues, int threadCount) {
+			stop();
+			if (threadCount <= 0 || pathList.empty() == true) {
+				return;
+			}
+
+			MutexSafeWrapper safeMutex(&xmlPreloadMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			xmlPreloadTagReplacementValues = mapTagReplacementValues;
+			for (unsigned int i = 0; i < pathList.size(); ++i) {
+				if (xmlPreloadEntries.find(pathList[i]) == xmlPreloadEntries.end()) {
+					xmlPreloadEntries[pathList[i]] = XmlPreloadEntry();
+					xmlPreloadQueue.push_back(pathList[i]);
+				}
+			}
+			xmlPreloadNextIndex = 0;
+			safeMutex.ReleaseLock();
+
+			// Make sure the parser singleton exists before the workers use it
+			XmlIoRapid::getInstance();
+
+			threadCount = std::min(threadCount, (int) xmlPreloadQueue.size());
+			for (int i = 0; i < threadCount; ++i) {
+				XmlTreePreloadThread *thread = new XmlTreePreloadThread();
+				xmlPreloadThreads.push_back(thread);
+				thread->start();
+			}
+
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] preloading %d xml files using %d threads\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, (int) xmlPreloadQueue.size(), threadCount);
+		}
+
+		void XmlTreePreloader::stop() {
+			for (unsigned int i = 0; i < xmlPreloadThreads.size(); ++i) {
+				xmlPreloadThreads[i]->signalQuit();
+			}
+			// The threads parse into the entries freed below, never leave one running
+			for (unsigned int i = 0; i < xmlPreloadThreads.size(); ++i) {
+				xmlPreloadThreads[i]->shutdownAndJoin();
+				delete xmlPreloadThreads[i];
+			}
+			xmlPreloadThreads.clear();
+
+			MutexSafeWrapper safeMutex(&xmlPreloadMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			for (std::map<string, XmlPreloadEntry>::iterator iterMap = xmlPreloadEntries.begin();
+				iterMap != xmlPreloadEntries.end(); ++iterMap) {
+				delete iterMap->second.rootNode;
+			}
+			xmlPreloadEntries.clear();
+			xmlPreloadQueue.clear();
+			xmlPreloadNextIndex = 0;
+			xmlPreloadTagReplacementValues.clear();
+		}
+
+		bool XmlTreePreloader::isRunning() {
+			return xmlPreloadThreads.empty() == false;
+		}
+
+		bool XmlTreePreloader::processNextFile() {
+			MutexSafeWrapper safeMutex(&xmlPreloadMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			// Skip files the loader already parsed itself
+			while (xmlPreloadNextIndex < xmlPreloadQueue.size() &&
+				xmlPreloadEntries.find(xmlPreloadQueue[xmlPreloadNextIndex]) == xmlPreloadEntries.end()) {
+				xmlPreloadNextIndex++;
+			}
+			if (xmlPreloadNextIndex >= xmlPreloadQueue.size()) {
+				return false;
+			}
+			string path = xmlPreloadQueue[xmlPreloadNextIndex++];
+			xmlPreloadEntries[path].state = xpsParsing;
+			std::map<string, string> mapTagReplacementValues = xmlPreloadTagReplacementValues;
+			safeMutex.ReleaseLock(true);
+
+			XmlNode *rootNode = NULL;
+			try {
+				rootNode = XmlIoRapid::getInstance().load(path, mapTagReplacementValues, false, true, false);
+			} catch (const exception &ex) {
+				// The loader parses the file again and reports the error itself
+				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] preload of [%s] failed: %s\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, path.c_str(), ex.what());
+			}
+
+			safeMutex.Lock();
+			XmlPreloadEntry &entry = xmlPreloadEntries[path];
+			entry.rootNode = rootNode;
+			entry.state = (rootNode != NULL ? xpsParsed : xpsFailed);
+			return true;
+		}
+
+		XmlNode * XmlTreePreloader::takePreloaded(const string &path, const std::map<string, string> &mapTagReplacementValues) {
+			MutexSafeWrapper safeMutex(&xmlPreloadMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			for (;;) {
+				std::map<string, XmlPreloadEntry>::iterator iterFind = xmlPreloadEntries.find(path);
+				if (iterFind == xmlPreloadEntries.end() ||
+					xmlPreloadTagReplacementValues != mapTagReplacementValues) {
+					return NULL;
+				}
+				if (iterFind->second.state != xpsParsing) {
+					XmlNode *rootNode = iterFind->second.rootNode;
+					xmlPreloadEntries.erase(iterFind);
+					return rootNode;
+				}
+
+				// A worker is in the middle of it, that is quicker than starting over
+				safeMutex.ReleaseLock(true);
+				sleep(1);
+				safeMutex.Lock();
+			}
+		}
+
+		// =====================================================
+		//	class XmlTreeCache
+		// =====================================================
+
+		// Bump whenever the layout written by XmlNode::writeCompiled changes
+		const uint32 XmlTreeCache::version = 1;
+		static const uint32 xmlTreeCacheMagic = 0x5A475843;
+
+		static Mutex xmlTreeCacheMutex;
+		static bool xmlTreeCacheOpen = false;
+		static bool xmlTreeCacheChanged = false;
+		static string xmlTreeCacheFile;
+		static string xmlTreeCachePathPrefix;
+		static uint32 xmlTreeCacheCRC = 0;
+		static std::map<string, string> xmlTreeCacheTagReplacementValues;
+		// Path of each file to its compiled tree
+		static std::map<string, string> xmlTreeCacheEntries;
+
+		static void writeCompiledUInt32(string &buffer, uint32 value) {
+			value = Shared::PlatformByteOrder::toCommonEndian(value);
+			buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+
+		static void writeCompiledString(string &buffer, const string &value) {
+			writeCompiledUInt32(buffer, (uint32) value.size());
+			buffer.append(value);
+		}
+
+		static uint32 readCompiledUInt32(const char *&data, const char *dataEnd) {
+			if (dataEnd - data < (ptrdiff_t) sizeof(uint32)) {
+				throw megaglest_runtime_error("Compiled xml data is truncated");
+			}
+			uint32 value = 0;
+			memcpy(&value, data, sizeof(value));
+			data += sizeof(value);
+			return Shared::PlatformByteOrder::fromCommonEndian(value);
+		}
+
+		static string readCompiledString(const char *&data, const char *dataEnd) {
+			uint32 length = readCompiledUInt32(data, dataEnd);
+			if ((uint32) (dataEnd - data) < length) {
+				throw megaglest_runtime_error("Compiled xml data is truncated");
+			}
+			string value(data, length);
+			data += length;
+			return value;
+		}
+
+		static bool readXmlTreeCacheFile(const string &cacheFile, uint32 crc,
+			const std::map<string, string> &mapTagReplacementValues, std::map<string, string> &entries) {
+			if (fileExists(cacheFile) == false) {
+				return false;
+			}
+#if defined(WIN32) && !defined(__MINGW32__)
+			FILE *fp = _wfopen(utf8_decode(cacheFile).c_str(), L"rb");
+			ifstream cacheStream(fp);
+#else
+			ifstream cacheStream(cacheFile.c_str(), ios::binary);
+#endif
+			string buffer;
+			if (cacheStream.is_open() == true) {
+				buffer.assign(std::istreambuf_iterator<char>(cacheStream), std::istreambuf_iterator<char>());
+			}
+#if defined(WIN32) && !defined(__MINGW32__)
+			if (fp) {
+				fclose(fp);
+			}
+#endif
+
+			try {
+				const char *data = buffer.data();
+				const char *dataEnd = data + buffer.size();
+				if (readCompiledUInt32(data, dataEnd) != xmlTreeCacheMagic ||
+					readCompiledUInt32(data, dataEnd) != XmlTreeCache::version ||
+					readCompiledUInt32(data, dataEnd) != crc) {
+					return false;
+				}
+
+				std::map<string, string> tagValues;
+				uint32 tagCount = readCompiledUInt32(data, dataEnd);
+				for (uint32 i = 0; i < tagCount; ++i) {
+					string key = readCompiledString(data, dataEnd);
+					tagValues[key] = readCompiledString(data, dataEnd);
+				}
+				if (tagValues != mapTagReplacementValues) {
+					return false;
+				}
+
+				uint32 entryCount = readCompiledUInt32(data, dataEnd);
+				for (uint32 i = 0; i < entryCount; ++i) {
+					string path = readCompiledString(data, dataEnd);
+					entries[path] = readCompiledString(data, dataEnd);
+				}
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Ignoring xml cache [%s]: %s\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, cacheFile.c_str(), ex.what());
+				entries.clear();
+				return false;
+			}
+			return true;
+		}
+
+		static void writeXmlTreeCacheFile(const string &cacheFile, uint32 crc,
+			const std::map<string, string> &mapTagReplacementValues, const std::map<string, string> &entries) {
+			string buffer;
+			writeCompiledUInt32(buffer, xmlTreeCacheMagic);
+			writeCompiledUInt32(buffer, XmlTreeCache::version);
+			writeCompiledUInt32(buffer, crc);
+			writeCompiledUInt32(buffer, (uint32) mapTagReplacementValues.size());
+			for (std::map<string, string>::const_iterator iterMap = mapTagReplacementValues.begin();
+				iterMap != mapTagReplacementValues.end(); ++iterMap) {
+				writeCompiledString(buffer, iterMap->first);
+				writeCompiledString(buffer, iterMap->second);
+			}
+			writeCompiledUInt32(buffer, (uint32) entries.size());
+			for (std::map<string, string>::const_iterator iterMap = entries.begin();
+				iterMap != entries.end(); ++iterMap) {
+				writeCompiledString(buffer, iterMap->first);
+				writeCompiledString(buffer, iterMap->second);
+			}
+
+#if defined(WIN32) && !defined(__MINGW32__)
+			FILE *fp = _wfopen(utf8_decode(cacheFile).c_str(), L"wb");
+			ofstream cacheStream(fp);
+#else
+			ofstream cacheStream(cacheFile.c_str(), ios::binary);
+#endif
+			if (cacheStream.is_open() == true) {
+				cacheStream.write(buffer.data(), buffer.size());
+			} else {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Can not write xml cache [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, cacheFile.c_str());
+			}
+#if defined(WIN32) && !defined(__MINGW32__)
+			cacheStream.close();
+			if (fp) {
+				fclose(fp);
+			}
+#endif
+		}
+
+		void XmlTreeCache::open(const string &cacheFile, uint32 crc, const string &pathPrefix, const std::map<string, string> &mapTagReplacementValues) {
+			close(false);
+
+			std::map<string, string> entries;
+			bool valid = readXmlTreeCacheFile(cacheFile, crc, mapTagReplacementValues, entries);
+
+			MutexSafeWrapper safeMutex(&xmlTreeCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			xmlTreeCacheOpen = true;
+			xmlTreeCacheChanged = (valid == false);
+			xmlTreeCacheFile = cacheFile;
+			xmlTreeCachePathPrefix = pathPrefix;
+			xmlTreeCacheCRC = crc;
+			xmlTreeCacheTagReplacementValues = mapTagReplacementValues;
+			xmlTreeCacheEntries.swap(entries);
+
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] xml cache [%s] crc = %u valid = %d files = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, cacheFile.c_str(), crc, valid, (int) xmlTreeCacheEntries.size());
+		}
+
+		void XmlTreeCache::close(bool save) {
+			MutexSafeWrapper safeMutex(&xmlTreeCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (xmlTreeCacheOpen == false) {
+				return;
+			}
+			if (save == true && xmlTreeCacheChanged == true) {
+				writeXmlTreeCacheFile(xmlTreeCacheFile, xmlTreeCacheCRC, xmlTreeCacheTagReplacementValues, xmlTreeCacheEntries);
+			}
+			xmlTreeCacheOpen = false;
+			xmlTreeCacheChanged = false;
+			xmlTreeCacheFile = "";
+			xmlTreeCachePathPrefix = "";
+			xmlTreeCacheCRC = 0;
+			xmlTreeCacheTagReplacementValues.clear();
+			xmlTreeCacheEntries.clear();
+		}
+
+		bool XmlTreeCache::isOpen() {
+			MutexSafeWrapper safeMutex(&xmlTreeCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return xmlTreeCacheOpen;
+		}
+
+		bool XmlTreeCache::hasFile(const string &path) {
+			MutexSafeWrapper safeMutex(&xmlTreeCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return xmlTreeCacheEntries.find(path) != xmlTreeCacheEntries.end();
+		}
+
+		int XmlTreeCache::getFileCount() {
+			MutexSafeWrapper safeMutex(&xmlTreeCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			return (int) xmlTreeCacheEntries.size();
+		}
+
+		XmlNode * XmlTreeCache::takeCached(const string &path, const std::map<string, string> &mapTagReplacementValues) {
+			MutexSafeWrapper safeMutex(&xmlTreeCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (xmlTreeCacheOpen == false || xmlTreeCacheTagReplacementValues != mapTagReplacementValues) {
+				return NULL;
+			}
+			std::map<string, string>::const_iterator iterFind = xmlTreeCacheEntries.find(path);
+			if (iterFind == xmlTreeCacheEntries.end()) {
+				return NULL;
+			}
+
+			const char *data = iterFind->second.data();
+			const char *dataEnd = data + iterFind->second.size();
+			XmlNode *rootNode = NULL;
+			try {
+				rootNode = XmlNode::readCompiled(data, dataEnd);
+			} catch (const exception &ex) {
+				// Parsed from the file again and stored over the broken entry
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Ignoring cached [%s]: %s\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, path.c_str(), ex.what());
+				xmlTreeCacheEntries.erase(path);
+			}
+			return rootNode;
+		}
+
+		void XmlTreeCache::add(const string &path, const std::map<string, string> &mapTagReplacementValues, const XmlNode *rootNode) {
+			MutexSafeWrapper safeMutex(&xmlTreeCacheMutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (xmlTreeCacheOpen == false || rootNode == NULL ||
+				StartsWith(path, xmlTreeCachePathPrefix) == false ||
+				xmlTreeCacheTagReplacementValues != mapTagReplacementValues) {
+				return;
+			}
+			string &buffer = xmlTreeCacheEntries[path];
+			buffer.clear();
+			rootNode->writeCompiled(buffer);
+			xmlTreeCacheChanged = true;
+		}
+
 		// =====================================================
 		//	class XmlNode
 		// =====================================================
@@ -619,11 +1022,11 @@ namespace Shared {
 			//get name
 			char str[strSize] = "";
 			XMLString::transcode(node->getNodeName(), str, strSize - 1);
-			name = str;
+			name = internName(str);
 
 			//check document
 			if (node->getNodeType() == DOMNode::DOCUMENT_NODE) {
-				name = "document";
+				name = internName("document");
 			}
 
 			//check children
@@ -667,16 +1070,30 @@ namespace Shared {
 			}
 
 			//get name
-			name = node->name();
-			children.reserve(1000);
-			attributes.reserve(1000);
+			name = internName(node->name());
 
 			//check document
 			if (node->type() == node_document) {
-				name = "document";
+				name = internName("document");
 			}
 
-			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n", name.c_str(), node->value());
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n", name->c_str(), node->value());
+
+			// Size the lists exactly, most nodes only have a handful of entries
+			size_t childCount = 0;
+			for (xml_node<> *currentNode = node->first_node();
+				currentNode; currentNode = currentNode->next_sibling()) {
+				if (currentNode->type() == node_element) {
+					childCount++;
+				}
+			}
+			size_t attributeCount = 0;
+			for (xml_attribute<> *attr = node->first_attribute();
+				attr; attr = attr->next_attribute()) {
+				attributeCount++;
+			}
+			children.reserve(childCount);
+			attributes.reserve(attributeCount);
 
 			//check children
 			for (xml_node<> *currentNode = node->first_node();
@@ -712,7 +1129,25 @@ namespace Shared {
 		}
 
 		XmlNode::XmlNode(const string &name) : superNode(NULL) {
-			this->name = name;
+			this->name = internName(name);
+		}
+
+		static ReadWriteMutex xmlNameMutex;
+		static std::set<string> xmlNames;
+
+		const string * XmlNode::internName(const string &name) {
+			// Called for every node and attribute from the preload threads too.
+			// Nearly every name is known already, those lookups share the read
+			// lock and only a new name takes the write lock
+			ReadWriteMutexSafeWrapper safeReadLock(&xmlNameMutex, true);
+			std::set<string>::const_iterator iterFind = xmlNames.find(name);
+			if (iterFind != xmlNames.end()) {
+				return &*iterFind;
+			}
+			safeReadLock.ReleaseLock();
+
+			ReadWriteMutexSafeWrapper safeWriteLock(&xmlNameMutex, false);
+			return &*xmlNames.insert(name).first;
 		}
 
 		XmlNode::~XmlNode() {
@@ -726,6 +1161,47 @@ namespace Shared {
 			attributes.clear();
 		}
 
+		void XmlNode::writeCompiled(string &buffer) const {
+			writeCompiledString(buffer, *name);
+			writeCompiledString(buffer, text);
+			writeCompiledUInt32(buffer, (uint32) attributes.size());
+			for (unsigned int i = 0; i < attributes.size(); ++i) {
+				writeCompiledString(buffer, *attributes[i]->name);
+				writeCompiledString(buffer, attributes[i]->value);
+				writeCompiledUInt32(buffer, (attributes[i]->skipRestrictionCheck ? 1 : 0) |
+					(attributes[i]->usesCommondata ? 2 : 0));
+			}
+			writeCompiledUInt32(buffer, (uint32) children.size());
+			for (unsigned int i = 0; i < children.size(); ++i) {
+				children[i]->writeCompiled(buffer);
+			}
+		}
+
+		XmlNode * XmlNode::readCompiled(const char *&data, const char *dataEnd) {
+			XmlNode *node = new XmlNode(readCompiledString(data, dataEnd));
+			try {
+				node->text = readCompiledString(data, dataEnd);
+				uint32 attributeCount = readCompiledUInt32(data, dataEnd);
+				node->attributes.reserve(std::min<uint32>(attributeCount, 1000));
+				for (uint32 i = 0; i < attributeCount; ++i) {
+					string attributeName = readCompiledString(data, dataEnd);
+					string attributeValue = readCompiledString(data, dataEnd);
+					uint32 flags = readCompiledUInt32(data, dataEnd);
+					node->attributes.push_back(new XmlAttribute(attributeName, attributeValue,
+						(flags & 1) != 0, (flags & 2) != 0));
+				}
+				uint32 childCount = readCompiledUInt32(data, dataEnd);
+				node->children.reserve(std::min<uint32>(childCount, 1000));
+				for (uint32 i = 0; i < childCount; ++i) {
+					node->children.push_back(readCompiled(data, dataEnd));
+				}
+			} catch (...) {
+				delete node;
+				throw;
+			}
+			return node;
+		}
+
 		XmlAttribute *XmlNode::getAttribute(unsigned int i) const {
 			if (i >= attributes.size()) {
 				throw megaglest_runtime_error(getName() + " node doesn't have " + uIntToStr(i) + " attributes", true);
@@ -793,7 +1269,7 @@ namespace Shared {
 				return superNode->getChild(childName, i);
 			}
 			if (i >= children.size()) {
-				throw megaglest_runtime_error("\"" + name + "\" node doesn't have " + uIntToStr(i + 1) + " children named \"" + childName + "\"\n\nTree: " + getTreeString(), true);
+				throw megaglest_runtime_error("\"" + getName() + "\" node doesn't have " + uIntToStr(i + 1) + " children named \"" + childName + "\"\n\nTree: " + getTreeString(), true);
 			}
 
 			unsigned int count = 0;
@@ -825,7 +1301,7 @@ namespace Shared {
 					return superNode->getChild(childName, childIndex);
 				}
 				if (childIndex >= children.size()) {
-					throw megaglest_runtime_error("\"" + name + "\" node doesn't have " + intToStr(childIndex + 1) + " children named \"" + childName + "\"\n\nTree: " + getTreeString(), true);
+					throw megaglest_runtime_error("\"" + getName() + "\" node doesn't have " + intToStr(childIndex + 1) + " children named \"" + childName + "\"\n\nTree: " + getTreeString(), true);
 				}
 
 				unsigned int count = 0;
@@ -893,7 +1369,7 @@ namespace Shared {
 
 		DOMElement *XmlNode::buildElement(XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument *document) const {
 			XMLCh str[strSize];
-			XMLString::transcode(name.c_str(), str, strSize - 1);
+			XMLString::transcode(name->c_str(), str, strSize - 1);
 
 			DOMElement *node = document->createElement(str);
 
@@ -917,7 +1393,7 @@ namespace Shared {
 #endif
 
 		xml_node<>* XmlNode::buildElement(xml_document<> *document) const {
-			xml_node<>* node = document->allocate_node(node_element, document->allocate_string(name.c_str()));
+			xml_node<>* node = document->allocate_node(node_element, document->allocate_string(name->c_str()));
 
 			for (unsigned int i = 0; i < attributes.size(); ++i) {
 				node->append_attribute(
@@ -963,16 +1439,15 @@ namespace Shared {
 
 			skipRestrictionCheck = false;
 			usesCommondata = false;
-			this->mapTagReplacementValues = mapTagReplacementValues;
 			char str[strSize] = "";
 
 			XMLString::transcode(attribute->getNodeValue(), str, strSize - 1);
 			value = str;
 			usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &this->mapTagReplacementValues);
+			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &mapTagReplacementValues);
 
 			XMLString::transcode(attribute->getNodeName(), str, strSize - 1);
-			name = str;
+			name = XmlNode::internName(str);
 		}
 
 #endif
@@ -984,31 +1459,32 @@ namespace Shared {
 
 			skipRestrictionCheck = false;
 			usesCommondata = false;
-			if (mapTagReplacementValues.size() > 0) {
-				this->mapTagReplacementValues = mapTagReplacementValues;
-			}
 			//char str[strSize]				= "";
 
 			//XMLString::transcode(attribute->getNodeValue(), str, strSize-1);
 			value = attribute->value();
 			usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &this->mapTagReplacementValues);
+			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &mapTagReplacementValues);
 
 			//XMLString::transcode(attribute->getNodeName(), str, strSize-1);
-			name = attribute->name();
+			name = XmlNode::internName(attribute->name());
 		}
 
 		XmlAttribute::XmlAttribute(const string &name, const string &value, const std::map<string, string> &mapTagReplacementValues) {
 			skipRestrictionCheck = false;
 			usesCommondata = false;
-			if (mapTagReplacementValues.size() > 0) {
-				this->mapTagReplacementValues = mapTagReplacementValues;
-			}
-			this->name = name;
+			this->name = XmlNode::internName(name);
 			this->value = value;
 
 			usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &this->mapTagReplacementValues);
+			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &mapTagReplacementValues);
+		}
+
+		XmlAttribute::XmlAttribute(const string &name, const string &value, bool skipRestrictionCheck, bool usesCommondata) {
+			this->name = XmlNode::internName(name);
+			this->value = value;
+			this->skipRestrictionCheck = skipRestrictionCheck;
+			this->usesCommondata = usesCommondata;
 		}
 
 		bool XmlAttribute::getBoolValue() const {
@@ -0,0 +1,31 @@
+// ==============================================================
+//	This file is part of ZetaGlest Benchmarks <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/CompilerOutputter.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+// Timings over real game data, kept out of zetaglest_tests so the unit
+// tests stay quick and don't depend on an installed data folder. Pass
+// a benchmark name (for example FtpTransferBenchmark) to run only that one
+int main(int argc, char* argv[])
+{
+  CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
+
+  CppUnit::TextUi::TestRunner runner;
+  runner.addTest( suite );
+
+  runner.setOutputter( new CppUnit::CompilerOutputter( &runner.result(),
+                                                       std::cerr ) );
+  bool wasSucessful = runner.run( argc > 1 ? argv[1] : "" );
+
+  return wasSucessful ? 0 : 1;
+}
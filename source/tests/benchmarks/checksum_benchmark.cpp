@@ -0,0 +1,76 @@
+// ==============================================================
+//	This file is part of ZetaGlest Benchmarks <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "checksum.h"
+#include "conversion.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+//
+// Hashes a real data folder the way the lobby does
+//
+class ChecksumBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ChecksumBenchmark );
+
+	CPPUNIT_TEST( benchmark_data_folder );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	// Set ZETAGLEST_CRC_BENCHMARK_PATH to a data folder (for example an
+	// installed techs folder) to time hashing it with one and all threads
+	void benchmark_data_folder() {
+		const char *benchmarkPath = getenv("ZETAGLEST_CRC_BENCHMARK_PATH");
+		if (benchmarkPath == NULL || string(benchmarkPath) == "") {
+			printf("\nSet ZETAGLEST_CRC_BENCHMARK_PATH to a data folder to time its checksum\n");
+			return;
+		}
+		string path = benchmarkPath;
+		endPathWithSlash(path);
+		vector<string> files = getFolderTreeContentsListRecursively(path + "*", "");
+		CPPUNIT_ASSERT( files.empty() == false );
+
+		int threadCount = Checksum::getFileThreadCount();
+		uint32 sums[2] = { 0, 0 };
+		int threadCounts[2] = { 1, std::max(threadCount, 2) };
+		for (int run = 0; run < 2; ++run) {
+			Checksum::setFileThreadCount(threadCounts[run]);
+			Checksum::clearFileCache();
+			Checksum checksum;
+			for (unsigned int i = 0; i < files.size(); ++i) {
+				checksum.addFile(files[i]);
+			}
+
+			Chrono chrono(true);
+			sums[run] = checksum.getFinalFileListSum();
+			printf("\nCRC of %d files in [%s] using %d thread(s): %u in " MG_I64_SPECIFIER " ms\n",
+				(int) files.size(), path.c_str(), threadCounts[run], sums[run], chrono.getMillis());
+		}
+		Checksum::setFileThreadCount(threadCount);
+		Checksum::clearFileCache();
+
+		CPPUNIT_ASSERT_EQUAL( sums[0], sums[1] );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ChecksumBenchmark );
@@ -0,0 +1,173 @@
+// ==============================================================
+//	This file is part of ZetaGlest Benchmarks <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "miniftpserver.h"
+#include "miniftpclient.h"
+#include "platform_common.h"
+#include "conversion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+//
+// Downloads a techtree sized file from the built-in FTP server over loopback
+//
+class FtpTransferBenchmark : public CppUnit::TestFixture, public FTPClientCallbackInterface,
+	public FTPClientValidationInterface {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( FtpTransferBenchmark );
+
+	CPPUNIT_TEST( benchmark_techtree_transfer );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static const int FTP_BENCHMARK_PORT = 61359;
+
+	string serverFolder;
+	string clientFolder;
+	Mutex mutexResults;
+	std::vector<string> finishedFiles;
+	std::vector<FTP_Client_ResultType> finishedResults;
+
+	static std::vector<char> readData(const string &fileName) {
+		std::vector<char> result;
+		FILE *fp = fopen(fileName.c_str(), "rb");
+		if(fp != NULL) {
+			char buf[65536];
+			size_t bytes = 0;
+			while((bytes = fread(buf, 1, sizeof(buf), fp)) > 0) {
+				result.insert(result.end(), buf, buf + bytes);
+			}
+			fclose(fp);
+		}
+		return result;
+	}
+
+	static void writeData(const string &fileName, const std::vector<char> &data) {
+		FILE *fp = fopen(fileName.c_str(), "wb");
+		CPPUNIT_ASSERT( fp != NULL );
+		if(data.empty() == false) {
+			CPPUNIT_ASSERT_EQUAL( data.size(), fwrite(&data[0], 1, data.size(), fp) );
+		}
+		fclose(fp);
+	}
+
+	// Serves serverFolder as the temp files account, downloads fileName into
+	// clientFolder and returns how long that took
+	int64 transfer(const string &fileName, FTP_Client_ResultType &result) {
+		FTPServerThread *server = new FTPServerThread(
+			make_pair(string(""), string("")), make_pair(string(""), string("")),
+			make_pair(string(""), string("")), false, false, false,
+			FTP_BENCHMARK_PORT, 1, this, serverFolder);
+		server->start();
+		sleep(250);
+
+		FTPClientThread *client = new FTPClientThread(FTP_BENCHMARK_PORT, "127.0.0.1",
+			make_pair(string(""), string("")), make_pair(string(""), string("")),
+			make_pair(string(""), string("")), make_pair(string(""), string("")),
+			this, ".7z", "", "", 0, clientFolder);
+		client->setMaxConcurrentTransfers(2);
+
+		Chrono chrono(true);
+		client->start();
+		client->addTempFileToRequests(fileName, fileName);
+
+		bool finished = false;
+		while(finished == false && chrono.getMillis() < 600000) {
+			sleep(10);
+			MutexSafeWrapper safeMutex(&mutexResults);
+			finished = (finishedFiles.empty() == false);
+		}
+		int64 elapsed = chrono.getMillis();
+
+		client->signalQuit();
+		client->shutdownAndJoin();
+		delete client;
+		server->signalQuit();
+		server->shutdownAndJoin();
+		delete server;
+
+		CPPUNIT_ASSERT_EQUAL( true, finished );
+		result = finishedResults[0];
+		return elapsed;
+	}
+
+public:
+
+	virtual int isValidClientType(uint32 clientIp) {
+		return 1;
+	}
+	virtual int isClientAllowedToGetFile(uint32 clientIp, const char *username, const char *filename) {
+		return 1;
+	}
+
+	virtual void FTPClient_CallbackEvent(string itemName,
+		FTP_Client_CallbackType type,
+		pair<FTP_Client_ResultType, string> result,
+		void *userdata) {
+		if(type == ftp_cct_TempFile) {
+			MutexSafeWrapper safeMutex(&mutexResults);
+			finishedFiles.push_back(itemName);
+			finishedResults.push_back(result.first);
+		}
+	}
+
+	void setUp() {
+		serverFolder = getUserHome() + "/.zetaglest_ftp_benchmark/server/";
+		clientFolder = getUserHome() + "/.zetaglest_ftp_benchmark/client/";
+		createDirectoryPaths(serverFolder);
+		createDirectoryPaths(clientFolder);
+		finishedFiles.clear();
+		finishedResults.clear();
+	}
+
+	void tearDown() {
+		removeFolder(getUserHome() + "/.zetaglest_ftp_benchmark/");
+	}
+
+	// Set ZETAGLEST_FTP_BENCHMARK_FILE to a packed techtree (for example
+	// megapack.7z) to transfer that, otherwise 64 MB of generated data
+	// stand in for one
+	void benchmark_techtree_transfer() {
+		std::vector<char> data;
+		const char *benchmarkFile = getenv("ZETAGLEST_FTP_BENCHMARK_FILE");
+		if(benchmarkFile != NULL && string(benchmarkFile) != "") {
+			data = readData(benchmarkFile);
+			CPPUNIT_ASSERT( data.empty() == false );
+		} else {
+			data.resize(64 * 1024 * 1024);
+			for(size_t idx = 0; idx < data.size(); ++idx) {
+				data[idx] = (char)((idx * 7 + idx / 4096) & 0xFF);
+			}
+		}
+		writeData(serverFolder + "techtree.7z", data);
+
+		FTP_Client_ResultType result = ftp_crt_FAIL;
+		int64 elapsed = transfer("techtree.7z", result);
+		CPPUNIT_ASSERT_EQUAL( ftp_crt_SUCCESS, result );
+		CPPUNIT_ASSERT( readData(clientFolder + "techtree.7z") == data );
+
+		printf("\nFTP loopback: %.1f MB in " MG_I64_SPECIFIER " ms (%.1f MB/s)\n",
+			data.size() / (1024.0 * 1024.0), elapsed,
+			(elapsed > 0 ? (data.size() / (1024.0 * 1024.0)) / (elapsed / 1000.0) : 0.0));
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( FtpTransferBenchmark );
@@ -0,0 +1,108 @@
+// ==============================================================
+//	This file is part of ZetaGlest Benchmarks <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "model.h"
+#include "interpolation.h"
+#include "opengl.h"
+#include "platform_common.h"
+#include "platform_util.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::PlatformCommon;
+
+class InterpolationBenchmarkModel : public Model {
+public:
+	InterpolationBenchmarkModel(const string &path) : Model() {
+		load(path, false, NULL, NULL);
+	}
+	virtual void init() {
+	}
+	virtual void end() {
+	}
+};
+
+//
+// Interpolates a real unit model for a battle sized group of units
+//
+class InterpolationBenchmark : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( InterpolationBenchmark );
+
+	CPPUNIT_TEST( benchmark_units_interpolation );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static int64 renderFrames(Model &model, int units, int frames) {
+		Chrono chrono(true);
+		for (int frame = 0; frame < frames; ++frame) {
+			for (int unit = 0; unit < units; ++unit) {
+				// Units in a group are a few ticks apart in their cycle
+				float t = (float)((frame + (unit % 4) * 3) % 100) / 100.0f;
+				for (uint32 i = 0; i < model.getMeshCount(); ++i) {
+					model.getMeshPtr(i)->updateInterpolationData(t, true);
+				}
+			}
+			InterpolationData::advanceFrame();
+		}
+		return chrono.getMicros();
+	}
+
+public:
+
+	void setUp() {
+		// There is no GL context, keep meshes away from VBOs
+		Shared::Graphics::Gl::setVBOSupported(false);
+	}
+
+	void tearDown() {
+		InterpolationData::setCacheSteps(64);
+		InterpolationData::setCacheSize(8);
+		InterpolationData::setFrameSlots(64);
+	}
+
+	// The models the game ships are not part of the source tree, set
+	// ZETAGLEST_BENCHMARK_G3D to one (for example an archer of megapack)
+	void benchmark_units_interpolation() {
+		const char *modelPath = getenv("ZETAGLEST_BENCHMARK_G3D");
+		if (modelPath == NULL || fileExists(modelPath) == false) {
+			printf("\nSet ZETAGLEST_BENCHMARK_G3D to a g3d model to time its interpolation\n");
+			return;
+		}
+		InterpolationBenchmarkModel model(modelPath);
+		const int units = 200;
+		const int frames = 100;
+
+		InterpolationData::setCacheSteps(0);
+		InterpolationData::setCacheSize(1);
+		InterpolationData::setFrameSlots(0);
+		int64 uncached = renderFrames(model, units, frames);
+
+		InterpolationData::setCacheSteps(64);
+		InterpolationData::setCacheSize(8);
+		InterpolationData::setFrameSlots(64);
+		InterpolationData::resetCacheStats();
+		int64 cached = renderFrames(model, units, frames);
+
+		printf("\nInterpolating [%s] for %d units and %d frames: %lld us one frame per mesh, %lld us shared (%u hits, %u misses)\n",
+			modelPath, units, frames, (long long)uncached, (long long)cached,
+			InterpolationData::getCacheHits(), InterpolationData::getCacheMisses());
+		CPPUNIT_ASSERT( InterpolationData::getCacheHits() > InterpolationData::getCacheMisses() );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( InterpolationBenchmark );
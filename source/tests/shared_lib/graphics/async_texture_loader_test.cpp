@@ -0,0 +1,129 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "async_texture_loader.h"
+#include "platform_common.h"
+#include "platform_util.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+
+// Keeps track of init calls instead of talking to OpenGL
+class AsyncTestTexture2D : public Texture2D {
+public:
+	int initCount;
+
+	AsyncTestTexture2D() : Texture2D(), initCount(0) {
+	}
+	virtual void init(Filter filter = fBilinear, int maxAnisotropy = 1) {
+		inited = true;
+		initCount++;
+	}
+	virtual void end(bool deletePixelBuffer = true) {
+		inited = false;
+	}
+};
+
+//
+// Tests for background texture decoding
+//
+class AsyncTextureLoaderTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( AsyncTextureLoaderTest );
+
+	CPPUNIT_TEST( test_placeholder_then_upload );
+	CPPUNIT_TEST( test_cancel_pending );
+	CPPUNIT_TEST( test_missing_file_keeps_placeholder );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	string imageFile;
+
+	// Uploads until nothing is pending or about two seconds have passed
+	static int waitForUploads() {
+		int uploadCount = 0;
+		for (int i = 0; i < 200 && AsyncTextureLoader::getPendingCount() > 0; ++i) {
+			sleep(10);
+			uploadCount += AsyncTextureLoader::processUploads(100);
+		}
+		return uploadCount;
+	}
+
+public:
+
+	void setUp() {
+		imageFile = getUserHome() + "/.zetaglest_async_texture_test.tga";
+		Pixmap2D pixmap(8, 4, 4);
+		for (int x = 0; x < 8; ++x) {
+			for (int y = 0; y < 4; ++y) {
+				uint8 value[4] = { (uint8) (x * 30), (uint8) (y * 60), 7, 255 };
+				pixmap.setPixel(x, y, value, 4);
+			}
+		}
+		pixmap.save(imageFile);
+		AsyncTextureLoader::start(1);
+	}
+
+	void tearDown() {
+		AsyncTextureLoader::stop();
+		removeFile(imageFile);
+	}
+
+	void test_placeholder_then_upload() {
+		AsyncTestTexture2D texture;
+		texture.getPixmap()->init(4);
+		AsyncTextureLoader::load(&texture, imageFile, Texture::fBilinear, 1);
+
+		CPPUNIT_ASSERT_EQUAL( 1, texture.getTextureWidth() );
+		CPPUNIT_ASSERT_EQUAL( 1, texture.getTextureHeight() );
+		CPPUNIT_ASSERT_EQUAL( imageFile, texture.getPath() );
+		texture.init();
+
+		CPPUNIT_ASSERT_EQUAL( 1, waitForUploads() );
+		CPPUNIT_ASSERT_EQUAL( 8, texture.getTextureWidth() );
+		CPPUNIT_ASSERT_EQUAL( 4, texture.getTextureHeight() );
+		CPPUNIT_ASSERT_EQUAL( imageFile, texture.getPath() );
+		// Inited with the placeholder, so it has to be inited again
+		CPPUNIT_ASSERT_EQUAL( 2, texture.initCount );
+
+		uint8 pixel[4] = { 0, 0, 0, 0 };
+		texture.getPixmapConst()->getPixel(5, 3, pixel);
+		CPPUNIT_ASSERT_EQUAL( 150, (int) pixel[0] );
+		CPPUNIT_ASSERT_EQUAL( 180, (int) pixel[1] );
+	}
+
+	void test_cancel_pending() {
+		AsyncTestTexture2D texture;
+		AsyncTextureLoader::load(&texture, imageFile, Texture::fBilinear, 1);
+		AsyncTextureLoader::cancel(&texture);
+		CPPUNIT_ASSERT_EQUAL( false, AsyncTextureLoader::isPending(&texture) );
+
+		sleep(100);
+		CPPUNIT_ASSERT_EQUAL( 0, AsyncTextureLoader::processUploads(100) );
+		CPPUNIT_ASSERT_EQUAL( 1, texture.getTextureWidth() );
+	}
+
+	void test_missing_file_keeps_placeholder() {
+		AsyncTestTexture2D texture;
+		AsyncTextureLoader::load(&texture, imageFile + ".missing.tga", Texture::fBilinear, 1);
+		CPPUNIT_ASSERT_EQUAL( 0, waitForUploads() );
+		CPPUNIT_ASSERT_EQUAL( 0, AsyncTextureLoader::getPendingCount() );
+		CPPUNIT_ASSERT_EQUAL( 1, texture.getTextureWidth() );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( AsyncTextureLoaderTest );
@@ -0,0 +1,78 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "geometry_batch_gl.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::Graphics::Gl;
+
+//
+// Tests for batching of immediate mode geometry
+//
+class GeometryBatchGlTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( GeometryBatchGlTest );
+
+	CPPUNIT_TEST( test_consecutive_geometry_joined );
+	CPPUNIT_TEST( test_unjoinable_primitive_rejected );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static void addQuad(GeometryBatchGl &batch, GLuint textureHandle) {
+		batch.begin(GL_QUADS, textureHandle);
+		for (int i = 0; i < 4; ++i) {
+			batch.vertex(Vec3f((float) i, 0.f, 0.f));
+		}
+	}
+
+public:
+
+	void test_consecutive_geometry_joined() {
+		GeometryBatchGl batch;
+		CPPUNIT_ASSERT( batch.isEmpty() );
+
+		// A hundred health bars become one draw
+		for (int i = 0; i < 100; ++i) {
+			addQuad(batch, 0);
+		}
+		CPPUNIT_ASSERT_EQUAL( 400, batch.getVertexCount() );
+		CPPUNIT_ASSERT_EQUAL( 1, batch.getDrawCount() );
+
+		// Another texture or primitive type starts a new draw, going
+		// back to an earlier one does too so the draw order is kept
+		addQuad(batch, 7);
+		addQuad(batch, 7);
+		batch.begin(GL_LINES);
+		batch.vertex(Vec3f(0.f, 0.f, 0.f));
+		batch.vertex(Vec3f(1.f, 0.f, 0.f));
+		addQuad(batch, 0);
+		CPPUNIT_ASSERT_EQUAL( 4, batch.getDrawCount() );
+		CPPUNIT_ASSERT_EQUAL( 414, batch.getVertexCount() );
+
+		batch.clear();
+		CPPUNIT_ASSERT( batch.isEmpty() );
+		CPPUNIT_ASSERT_EQUAL( 0, batch.getDrawCount() );
+	}
+
+	void test_unjoinable_primitive_rejected() {
+		GeometryBatchGl batch;
+		CPPUNIT_ASSERT_THROW( batch.begin(GL_TRIANGLE_STRIP), megaglest_runtime_error );
+		CPPUNIT_ASSERT_THROW( batch.begin(GL_LINE_LOOP), megaglest_runtime_error );
+		CPPUNIT_ASSERT_EQUAL( 0, batch.getDrawCount() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( GeometryBatchGlTest );
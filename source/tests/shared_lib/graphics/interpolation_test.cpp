@@ -0,0 +1,210 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdio.h>
+#include <string.h>
+#include "model.h"
+#include "interpolation.h"
+#include "opengl.h"
+#include "platform_common.h"
+#include "platform_util.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::PlatformCommon;
+
+class InterpolationTestModel : public Model {
+public:
+	InterpolationTestModel(const string &path) : Model() {
+		load(path, false, NULL, NULL);
+	}
+	virtual void init() {
+	}
+	virtual void end() {
+	}
+};
+
+//
+// Tests for the shared interpolated frame cache
+//
+class InterpolationTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( InterpolationTest );
+
+	CPPUNIT_TEST( test_lerp_matches_vec_lerp );
+	CPPUNIT_TEST( test_units_share_frames );
+	CPPUNIT_TEST( test_unused_frames_dropped );
+	CPPUNIT_TEST( test_frame_slots_kept_for_later_passes );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static const uint32 testFrames = 20;
+	static const uint32 testPoints = 2000;
+
+	string path;
+
+	static Vec3f testVertex(uint32 index) {
+		return Vec3f((float)(index % 97) * 0.25f, (float)(index % 13) - 6.0f, (float)index * 0.001f);
+	}
+
+	// One untextured v4 mesh, sized like a typical unit model
+	void writeModel() {
+		FILE *f = fopen(path.c_str(), "wb");
+		CPPUNIT_ASSERT( f != NULL );
+		FileHeader fileHeader = { { 'G', '3', 'D' }, 4 };
+		fwrite(&fileHeader, sizeof(fileHeader), 1, f);
+		ModelHeader modelHeader;
+		modelHeader.meshCount = 1;
+		modelHeader.type = mtMorphMesh;
+		fwrite(&modelHeader, sizeof(modelHeader), 1, f);
+
+		MeshHeader meshHeader;
+		memset(&meshHeader, 0, sizeof(meshHeader));
+		meshHeader.frameCount = testFrames;
+		meshHeader.vertexCount = testPoints;
+		meshHeader.indexCount = 3;
+		meshHeader.opacity = 1.0f;
+		fwrite(&meshHeader, sizeof(meshHeader), 1, f);
+
+		for (uint32 i = 0; i < testFrames * testPoints * 2; ++i) {
+			Vec3f value = testVertex(i);
+			fwrite(value.ptr(), sizeof(float), 3, f);
+		}
+		uint32 indices[3] = { 0, 1, 2 };
+		fwrite(indices, sizeof(uint32), 3, f);
+		fclose(f);
+	}
+
+public:
+
+	void setUp() {
+		// There is no GL context, keep meshes away from VBOs
+		Shared::Graphics::Gl::setVBOSupported(false);
+		path = getUserHome() + "/.zetaglest_interpolation_test.g3d";
+		writeModel();
+		InterpolationData::setCacheSteps(64);
+		InterpolationData::setCacheSize(8);
+		InterpolationData::setFrameSlots(64);
+		InterpolationData::resetCacheStats();
+	}
+
+	void tearDown() {
+		removeFile(path);
+	}
+
+	void test_lerp_matches_vec_lerp() {
+		// Odd lengths run the scalar tail after the vector loop
+		const uint32 counts[] = { 1, 2, 3, 5, 11, 64, 101 };
+		for (unsigned int c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+			uint32 count = counts[c];
+			vector<Vec3f> prev(count), next(count), dest(count);
+			for (uint32 i = 0; i < count; ++i) {
+				prev[i] = testVertex(i);
+				next[i] = testVertex(i * 7 + 3);
+			}
+			InterpolationData::lerp(&prev[0], &next[0], &dest[0], count, 0.37f);
+			for (uint32 i = 0; i < count; ++i) {
+				CPPUNIT_ASSERT( dest[i] == prev[i].lerp(0.37f, next[i]) );
+			}
+		}
+	}
+
+	void test_units_share_frames() {
+		InterpolationTestModel model(path);
+		Mesh *mesh = model.getMeshPtr(0);
+		const InterpolationData *data = mesh->getInterpolationData();
+		CPPUNIT_ASSERT( data != NULL );
+
+		mesh->updateInterpolationData(0.5f, true);
+		const Vec3f *firstUnit = data->getVertices();
+		// Half a step apart at 64 steps per key frame gives the same frame
+		mesh->updateInterpolationData(0.5f + 0.25f / (64.0f * testFrames), true);
+		CPPUNIT_ASSERT( firstUnit == data->getVertices() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)2, InterpolationData::getCacheHits() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)2, InterpolationData::getCacheMisses() );
+
+		// Between key frames 10 and 11 of the cycle
+		mesh->updateInterpolationData(0.5f + 0.5f / testFrames, true);
+		const Vec3f *vertices = data->getVertices();
+		CPPUNIT_ASSERT( firstUnit != vertices );
+		const Vec3f *src = mesh->getVertices();
+		for (uint32 i = 0; i < testPoints; ++i) {
+			Vec3f expected = src[10 * testPoints + i].lerp(0.5f, src[11 * testPoints + i]);
+			CPPUNIT_ASSERT( vertices[i] == expected );
+		}
+		CPPUNIT_ASSERT_EQUAL( 4, data->getCachedFrameCount() );
+	}
+
+	void test_unused_frames_dropped() {
+		InterpolationTestModel model(path);
+		Mesh *mesh = model.getMeshPtr(0);
+		const InterpolationData *data = mesh->getInterpolationData();
+
+		mesh->updateInterpolationData(0.1f, true);
+		mesh->updateInterpolationData(0.2f, true);
+		CPPUNIT_ASSERT_EQUAL( 4, data->getCachedFrameCount() );
+
+		// Still used last frame, kept
+		InterpolationData::advanceFrame();
+		mesh->updateInterpolationData(0.3f, true);
+		CPPUNIT_ASSERT_EQUAL( 6, data->getCachedFrameCount() );
+
+		InterpolationData::advanceFrame();
+		InterpolationData::advanceFrame();
+		mesh->updateInterpolationData(0.3f, true);
+		CPPUNIT_ASSERT_EQUAL( 2, data->getCachedFrameCount() );
+
+		// A full cache recycles its least recently used frame
+		InterpolationData::setCacheSize(2);
+		InterpolationData::setFrameSlots(0);
+		for (int i = 0; i < 5; ++i) {
+			mesh->updateInterpolationData(0.05f * i, true);
+		}
+		CPPUNIT_ASSERT_EQUAL( 4, data->getCachedFrameCount() );
+	}
+
+	void test_frame_slots_kept_for_later_passes() {
+		InterpolationTestModel model(path);
+		Mesh *mesh = model.getMeshPtr(0);
+		const InterpolationData *data = mesh->getInterpolationData();
+		InterpolationData::setCacheSize(2);
+		InterpolationData::setFrameSlots(4);
+
+		// Main pass, more units in different poses than the cache holds
+		for (int unit = 0; unit < 4; ++unit) {
+			mesh->updateInterpolationData(0.1f * unit, true);
+		}
+		CPPUNIT_ASSERT_EQUAL( 8, data->getCachedFrameCount() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)8, InterpolationData::getCacheMisses() );
+
+		// Shadow pass over the same units interpolates nothing
+		for (int unit = 0; unit < 4; ++unit) {
+			mesh->updateInterpolationData(0.1f * unit, true);
+		}
+		CPPUNIT_ASSERT_EQUAL( (uint32)8, InterpolationData::getCacheHits() );
+
+		// Past the slots the least recently used frame is recycled
+		mesh->updateInterpolationData(0.9f, true);
+		CPPUNIT_ASSERT_EQUAL( 8, data->getCachedFrameCount() );
+
+		// Frames unused since the last frame go back to the cache size
+		InterpolationData::advanceFrame();
+		InterpolationData::advanceFrame();
+		mesh->updateInterpolationData(0.95f, true);
+		CPPUNIT_ASSERT_EQUAL( 2, data->getCachedFrameCount() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( InterpolationTest );
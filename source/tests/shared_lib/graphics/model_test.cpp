@@ -12,8 +12,16 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <memory>
 #include "model.h"
+#include "model_manager.h"
+#include "graphics_interface.h"
+#include "graphics_factory.h"
+#include "texture_manager.h"
+#include "opengl.h"
+#include "platform_common.h"
 #include <vector>
 #include <algorithm>
+#include <stdio.h>
+#include <string.h>
 
 #ifdef WIN32
 #include <io.h>
@@ -22,6 +30,7 @@
 #endif
 
 using namespace Shared::Graphics;
+using namespace Shared::PlatformCommon;
 
 class TestBaseColorPickEntity : public BaseColorPickEntity {
 public:
@@ -29,6 +38,43 @@ public:
 		return getColorDescription();
 	}
 };
+
+class TestTexture2D : public Texture2D {
+public:
+	virtual void init(Filter filter, int maxAnisotropy) {
+	}
+	virtual void end(bool deletePixelBuffer) {
+	}
+};
+
+class TestModel : public Model {
+public:
+	TestModel(const string &path, std::map<string, vector<pair<string, string> > > *loadedFileList = NULL, string *sourceLoader = NULL,
+		TextureManager *textureManager = NULL) : Model() {
+		setTextureManager(textureManager);
+		load(path, false, loadedFileList, sourceLoader);
+	}
+	virtual void init() {
+	}
+	virtual void end() {
+	}
+};
+
+class TestModelFactory : public GraphicsFactory {
+public:
+	int loadCount;
+
+	TestModelFactory() : loadCount(0) {
+	}
+	virtual Model *newModel(const string &path, TextureManager* textureManager, bool deletePixMapAfterLoad, std::map<string, std::vector<std::pair<string, string> > > *loadedFileList, string *sourceLoader) {
+		loadCount++;
+		return new TestModel(path, loadedFileList, sourceLoader, textureManager);
+	}
+	virtual Texture2D *newTexture2D() {
+		return new TestTexture2D();
+	}
+};
+
 //
 // Tests for font class
 //
@@ -38,12 +84,118 @@ class ModelTest : public CppUnit::TestFixture {
 
 	CPPUNIT_TEST( test_ColorPicking_loop );
 	CPPUNIT_TEST( test_ColorPicking_prime );
+	CPPUNIT_TEST( test_load_v3_mapped );
+	CPPUNIT_TEST( test_load_v4_unaligned );
+	CPPUNIT_TEST( test_manager_shares_models );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
 
+private:
+
+	static const uint32 testFrames = 2;
+	static const uint32 testPoints = 3;
+
+	static Vec3f testVertex(uint32 index) {
+		return Vec3f((float)index, (float)index * 2.0f, (float)index * 0.5f);
+	}
+
+	// One untextured mesh with two frames of a single triangle
+	static void writeFrameData(FILE *f) {
+		for (uint32 i = 0; i < testFrames * testPoints * 2; ++i) {
+			Vec3f value = testVertex(i);
+			fwrite(value.ptr(), sizeof(float), 3, f);
+		}
+	}
+
+	static void writeV3(const string &path) {
+		FILE *f = fopen(path.c_str(), "wb");
+		CPPUNIT_ASSERT( f != NULL );
+		FileHeader fileHeader = { { 'G', '3', 'D' }, 3 };
+		fwrite(&fileHeader, sizeof(fileHeader), 1, f);
+		uint32 meshCount = 1;
+		fwrite(&meshCount, sizeof(meshCount), 1, f);
+
+		MeshHeaderV3 meshHeader;
+		memset(&meshHeader, 0, sizeof(meshHeader));
+		meshHeader.vertexFrameCount = testFrames;
+		meshHeader.normalFrameCount = testFrames;
+		meshHeader.colorFrameCount = 1;
+		meshHeader.pointCount = testPoints;
+		meshHeader.indexCount = 3;
+		meshHeader.properties = mp3NoTexture;
+		fwrite(&meshHeader, sizeof(meshHeader), 1, f);
+
+		writeFrameData(f);
+		float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		fwrite(color, sizeof(float), 4, f);
+		uint32 indices[3] = { 0, 1, 2 };
+		fwrite(indices, sizeof(uint32), 3, f);
+		fclose(f);
+	}
+
+	// With a diffuse texture when texture is not empty
+	static void writeV4(const string &path, const string &texture = "") {
+		FILE *f = fopen(path.c_str(), "wb");
+		CPPUNIT_ASSERT( f != NULL );
+		FileHeader fileHeader = { { 'G', '3', 'D' }, 4 };
+		fwrite(&fileHeader, sizeof(fileHeader), 1, f);
+		ModelHeader modelHeader;
+		modelHeader.meshCount = 1;
+		modelHeader.type = mtMorphMesh;
+		fwrite(&modelHeader, sizeof(modelHeader), 1, f);
+
+		MeshHeader meshHeader;
+		memset(&meshHeader, 0, sizeof(meshHeader));
+		meshHeader.frameCount = testFrames;
+		meshHeader.vertexCount = testPoints;
+		meshHeader.indexCount = 3;
+		meshHeader.opacity = 1.0f;
+		meshHeader.textures = (texture != "" ? mtDiffuse : mtNone);
+		fwrite(&meshHeader, sizeof(meshHeader), 1, f);
+		if (texture != "") {
+			char mapPath[mapPathSize];
+			memset(mapPath, 0, mapPathSize);
+			strncpy(mapPath, texture.c_str(), mapPathSize - 1);
+			fwrite(mapPath, mapPathSize, 1, f);
+		}
+
+		writeFrameData(f);
+		if (texture != "") {
+			float texCoords[testPoints * 2] = { 0 };
+			fwrite(texCoords, sizeof(float), testPoints * 2, f);
+		}
+		uint32 indices[3] = { 0, 1, 2 };
+		fwrite(indices, sizeof(uint32), 3, f);
+		fclose(f);
+	}
+
+	static void checkFrameData(const Model &model) {
+		CPPUNIT_ASSERT_EQUAL( (uint32)1, model.getMeshCount() );
+		const Mesh *mesh = model.getMesh(0);
+		CPPUNIT_ASSERT_EQUAL( testFrames, mesh->getFrameCount() );
+		CPPUNIT_ASSERT_EQUAL( testPoints, mesh->getVertexCount() );
+		for (uint32 i = 0; i < testFrames * testPoints; ++i) {
+			CPPUNIT_ASSERT( mesh->getVertices()[i] == testVertex(i) );
+			CPPUNIT_ASSERT( mesh->getNormals()[i] == testVertex(testFrames * testPoints + i) );
+		}
+		CPPUNIT_ASSERT_EQUAL( (uint32)2, mesh->getIndices()[2] );
+
+		// Bounds cover every frame
+		Vec3f boundsMin;
+		Vec3f boundsMax;
+		model.getBounds(boundsMin, boundsMax);
+		CPPUNIT_ASSERT( boundsMin == testVertex(0) );
+		CPPUNIT_ASSERT( boundsMax == testVertex(testFrames * testPoints - 1) );
+	}
+
 public:
 
+	void setUp() {
+		// There is no GL context, keep meshes away from VBOs
+		Shared::Graphics::Gl::setVBOSupported(false);
+	}
+
 	void test_ColorPicking_loop() {
 
 		BaseColorPickEntity::setTrackColorUse(true);
@@ -100,6 +252,101 @@ public:
 		BaseColorPickEntity::setTrackColorUse(false);
 	}
 
+	void test_load_v3_mapped() {
+		string path = getUserHome() + "/.zetaglest_model_test_v3.g3d";
+		writeV3(path);
+		{
+			TestModel model(path);
+			checkFrameData(model);
+			// v3 headers keep the frame data 4 byte aligned
+			CPPUNIT_ASSERT_EQUAL( true, model.getMesh(0)->hasMappedFrameData() );
+		}
+		removeFile(path);
+	}
+
+	void test_load_v4_unaligned() {
+		string path = getUserHome() + "/.zetaglest_model_test_v4.g3d";
+		writeV4(path);
+		{
+			TestModel model(path);
+			checkFrameData(model);
+			// The 7 byte v4 file and model headers leave it misaligned
+			CPPUNIT_ASSERT_EQUAL( false, model.getMesh(0)->hasMappedFrameData() );
+		}
+		removeFile(path);
+	}
+
+	void test_manager_shares_models() {
+		string path = getUserHome() + "/.zetaglest_model_test_v4.g3d";
+		writeV4(path);
+
+		TestModelFactory factory;
+		GraphicsInterface::getInstance().setFactory(&factory);
+		{
+			ModelManager modelManager;
+			std::map<string, vector<pair<string, string> > > loadedFileList;
+			string loaderA = "unitA";
+			string loaderB = "unitB";
+			Model *modelA = modelManager.newModel(path, false, &loadedFileList, &loaderA);
+			Model *modelB = modelManager.newModel(path, false, &loadedFileList, &loaderB);
+
+			CPPUNIT_ASSERT( modelA == modelB );
+			CPPUNIT_ASSERT_EQUAL( 1, factory.loadCount );
+			CPPUNIT_ASSERT_EQUAL( 2, modelManager.getRefCount(modelA) );
+			CPPUNIT_ASSERT_EQUAL( (size_t)2, loadedFileList[path].size() );
+
+			modelManager.endModel(modelA);
+			CPPUNIT_ASSERT_EQUAL( 1, modelManager.getRefCount(modelB) );
+			checkFrameData(*modelB);
+
+			modelManager.endModel(modelB);
+			CPPUNIT_ASSERT_EQUAL( 0, modelManager.getRefCount(modelB) );
+
+			// Loads again once all users are gone
+			modelManager.newModel(path, false, NULL, NULL);
+			CPPUNIT_ASSERT_EQUAL( 2, factory.loadCount );
+
+			// The last model handed out is the shared one, not the last one loaded
+			string otherPath = getUserHome() + "/.zetaglest_model_test_v4_other.g3d";
+			writeV4(otherPath);
+			Model *other = modelManager.newModel(otherPath, false, NULL, NULL);
+			Model *shared = modelManager.newModel(path, false, NULL, NULL);
+			CPPUNIT_ASSERT_EQUAL( 2, modelManager.getRefCount(shared) );
+			modelManager.endLastModel(true);
+			CPPUNIT_ASSERT_EQUAL( 1, modelManager.getRefCount(shared) );
+			CPPUNIT_ASSERT_EQUAL( 1, modelManager.getRefCount(other) );
+			checkFrameData(*other);
+			removeFile(otherPath);
+		}
+		{
+			// Every user of a shared model is recorded for its textures too
+			string texturePath = getUserHome() + "/.zetaglest_model_test_texture.tga";
+			Pixmap2D pixmap(2, 2, 4);
+			pixmap.saveTga(texturePath);
+			string texturedPath = getUserHome() + "/.zetaglest_model_test_v4_textured.g3d";
+			writeV4(texturedPath, ".zetaglest_model_test_texture.tga");
+
+			TextureManager textureManager;
+			ModelManager modelManager;
+			modelManager.setTextureManager(&textureManager);
+			std::map<string, vector<pair<string, string> > > loadedFileList;
+			string loaderA = "unitA";
+			string loaderB = "unitB";
+			Model *modelA = modelManager.newModel(texturedPath, false, &loadedFileList, &loaderA);
+			Model *modelB = modelManager.newModel(texturedPath, false, &loadedFileList, &loaderB);
+			CPPUNIT_ASSERT( modelA == modelB );
+			CPPUNIT_ASSERT( modelA->getMesh(0)->getTexture(0) != NULL );
+			CPPUNIT_ASSERT_EQUAL( (size_t)2, loadedFileList[texturePath].size() );
+			CPPUNIT_ASSERT( loadedFileList[texturePath][1].first == loaderB );
+
+			modelManager.end();
+			removeFile(texturedPath);
+			removeFile(texturePath);
+		}
+		GraphicsInterface::getInstance().setFactory(NULL);
+		removeFile(path);
+	}
+
 };
 
 
@@ -0,0 +1,323 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "particle.h"
+#include "math_util.h"
+#include "util.h"
+#include "platform_common.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+class TestSplashParticleSystem : public SplashParticleSystem {
+public:
+	TestSplashParticleSystem(int particleCount) : SplashParticleSystem(particleCount) {
+		setColor(Vec4f(1.0f, 0.5f, 0.25f, 1.0f));
+		setColorNoEnergy(Vec4f(0.0f, 0.0f, 0.0f, 0.0f));
+		setSizeNoEnergy(0.1f);
+		setGravity(0.002f);
+		setSpeedUpRelative(0.01f);
+		setSpeedUpConstant(0.001f);
+		setMaxParticleEnergy(100);
+	}
+
+	// Fills the store the same way emission would
+	void fill(int count) {
+		for (int i = 0; i < count; ++i) {
+			emitParticle(i);
+		}
+	}
+	void runKernel() {
+		updateParticles(0, aliveParticleCount);
+	}
+
+	// What SplashParticleSystem::updateParticle did for one particle
+	void referenceUpdate(Particle *p) const {
+		float energyRatio = clamp(static_cast<float> (p->energy) / maxParticleEnergy, 0.f, 1.f);
+
+		p->lastPos = p->pos;
+		p->pos = p->pos + p->speed;
+		p->pos.x = truncateDecimal<float>(p->pos.x, 6);
+		p->pos.y = truncateDecimal<float>(p->pos.y, 6);
+		p->pos.z = truncateDecimal<float>(p->pos.z, 6);
+
+		p->speed += p->speedUpConstant;
+		p->speed = p->speed*(1 + p->speedUpRelative);
+		p->speed = p->speed + p->accel;
+		p->speed.x = truncateDecimal<float>(p->speed.x, 6);
+		p->speed.y = truncateDecimal<float>(p->speed.y, 6);
+		p->speed.z = truncateDecimal<float>(p->speed.z, 6);
+
+		p->energy--;
+		p->color = color * energyRatio + colorNoEnergy * (1.0f - energyRatio);
+		p->size = particleSize * energyRatio + sizeNoEnergy * (1.0f - energyRatio);
+		p->size = truncateDecimal<float>(p->size, 6);
+	}
+};
+
+//
+// Tests for the particle store and its update kernels
+//
+class ParticleTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ParticleTest );
+
+	CPPUNIT_TEST( test_store_set_get_move );
+	CPPUNIT_TEST( test_kernel_matches_particle_update );
+	CPPUNIT_TEST( test_dead_particles_removed );
+	CPPUNIT_TEST( test_type_tags );
+	CPPUNIT_TEST( test_manager_tracks_systems );
+	CPPUNIT_TEST( test_particle_stores_pooled );
+	CPPUNIT_TEST( test_workers_match_serial_update );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	// Unit systems of different sizes and rates plus a splash, the same
+	// on every call
+	static void addSystems(ParticleManager &manager, vector<ParticleSystem *> &systems, int count) {
+		for (int i = 0; i < count; ++i) {
+			UnitParticleSystem *ups = new UnitParticleSystem(100 + 40 * (i % 5));
+			ups->setEmissionRate(2.0f + (float) (i % 7));
+			ups->setMaxParticleEnergy(30 + i % 11);
+			ups->setVarParticleEnergy(5);
+			ups->setDirection(Vec3f(0.0f, 1.0f, 0.0f));
+			ups->setPos(Vec3f((float) i, 0.0f, (float) -i));
+			manager.manage(ups);
+			systems.push_back(ups);
+		}
+		TestSplashParticleSystem *splash = new TestSplashParticleSystem(500);
+		splash->setEmissionRate(20.0f);
+		splash->setEmissionRateFade(0.5f);
+		splash->setMaxParticleEnergy(25);
+		splash->initParticleSystem();
+		manager.manage(splash);
+		systems.push_back(splash);
+	}
+
+	static void updateSystems(ParticleManager &manager, vector<ParticleSystem *> &systems, int frames) {
+		for (int frame = 0; frame < frames; ++frame) {
+			// Fades halfway through a frame like a unit dying would
+			if (frame == frames / 2) {
+				for (unsigned int i = 0; i < systems.size(); i += 3) {
+					systems[i]->fade();
+				}
+			}
+			manager.update();
+		}
+	}
+
+public:
+
+	void setUp() {
+		ParticleSystem::setParticleStorePoolSize(32);
+		ParticleSystem::clearParticleStorePools();
+	}
+
+	void tearDown() {
+		ParticleManager::stopWorkers();
+		ParticleSystem::clearParticleStorePools();
+	}
+
+	void test_store_set_get_move() {
+		ParticleStore store;
+		store.resize(3);
+		CPPUNIT_ASSERT_EQUAL( 3, store.getCount() );
+
+		Particle p;
+		p.pos = Vec3f(1.0f, 2.0f, 3.0f);
+		p.lastPos = Vec3f(4.0f, 5.0f, 6.0f);
+		p.speed = Vec3f(0.1f, 0.2f, 0.3f);
+		p.speedUpRelative = 0.5f;
+		p.speedUpConstant = Vec3f(0.01f, 0.02f, 0.03f);
+		p.accel = Vec3f(0.0f, -1.0f, 0.0f);
+		p.color = Vec4f(0.1f, 0.2f, 0.3f, 0.4f);
+		p.size = 2.5f;
+		p.energy = 42;
+		store.set(2, p);
+		store.move(2, 0);
+
+		Particle copy = store.get(0);
+		CPPUNIT_ASSERT( copy.pos == p.pos );
+		CPPUNIT_ASSERT( copy.lastPos == p.lastPos );
+		CPPUNIT_ASSERT( copy.speed == p.speed );
+		CPPUNIT_ASSERT_EQUAL( p.speedUpRelative, copy.speedUpRelative );
+		CPPUNIT_ASSERT( copy.speedUpConstant == p.speedUpConstant );
+		CPPUNIT_ASSERT( copy.accel == p.accel );
+		CPPUNIT_ASSERT( copy.color == p.color );
+		CPPUNIT_ASSERT_EQUAL( p.size, copy.size );
+		CPPUNIT_ASSERT_EQUAL( p.energy, copy.energy );
+	}
+
+	void test_kernel_matches_particle_update() {
+		TestSplashParticleSystem ps(257);
+		ps.fill(257);
+		CPPUNIT_ASSERT_EQUAL( 257, ps.getAliveParticleCount() );
+
+		vector<Particle> expected;
+		for (int i = 0; i < ps.getAliveParticleCount(); ++i) {
+			expected.push_back(ps.getParticle(i));
+		}
+		for (int step = 0; step < 20; ++step) {
+			ps.runKernel();
+			for (unsigned int i = 0; i < expected.size(); ++i) {
+				ps.referenceUpdate(&expected[i]);
+			}
+		}
+		for (unsigned int i = 0; i < expected.size(); ++i) {
+			Particle actual = ps.getParticle(i);
+			CPPUNIT_ASSERT( expected[i].pos == actual.pos );
+			CPPUNIT_ASSERT( expected[i].lastPos == actual.lastPos );
+			CPPUNIT_ASSERT( expected[i].speed == actual.speed );
+			CPPUNIT_ASSERT( expected[i].color == actual.color );
+			CPPUNIT_ASSERT_EQUAL( expected[i].size, actual.size );
+			CPPUNIT_ASSERT_EQUAL( expected[i].energy, actual.energy );
+		}
+	}
+
+	void test_dead_particles_removed() {
+		TestSplashParticleSystem ps(500);
+		ps.setEmissionRate(20.0f);
+		ps.setEmissionRateFade(0.0f);
+		ps.setMaxParticleEnergy(30);
+		for (int i = 0; i < 40; ++i) {
+			ps.update();
+			const ParticleStore &particles = ps.getParticles();
+			for (int j = 0; j < ps.getAliveParticleCount(); ++j) {
+				CPPUNIT_ASSERT( particles.getEnergy(j) > 0 );
+			}
+		}
+		CPPUNIT_ASSERT( ps.getAliveParticleCount() > 0 );
+
+		ps.fade();
+		for (int i = 0; i < 100; ++i) {
+			ps.update();
+		}
+		CPPUNIT_ASSERT_EQUAL( 0, ps.getAliveParticleCount() );
+	}
+
+	void test_type_tags() {
+		FireParticleSystem fire(10);
+		UnitParticleSystem unit(10);
+		RainParticleSystem rain(10);
+		SnowParticleSystem snow(10);
+		ProjectileParticleSystem projectile(10);
+		SplashParticleSystem splash(10);
+		CPPUNIT_ASSERT_EQUAL( ParticleSystem::pst_FireParticleSystem, fire.getParticleSystemType() );
+		CPPUNIT_ASSERT_EQUAL( ParticleSystem::pst_UnitParticleSystem, unit.getParticleSystemType() );
+		CPPUNIT_ASSERT_EQUAL( ParticleSystem::pst_RainParticleSystem, rain.getParticleSystemType() );
+		CPPUNIT_ASSERT_EQUAL( ParticleSystem::pst_SnowParticleSystem, snow.getParticleSystemType() );
+		CPPUNIT_ASSERT_EQUAL( ParticleSystem::pst_ProjectileParticleSystem, projectile.getParticleSystemType() );
+		CPPUNIT_ASSERT_EQUAL( ParticleSystem::pst_SplashParticleSystem, splash.getParticleSystemType() );
+	}
+
+	void test_manager_tracks_systems() {
+		ParticleManager manager;
+		vector<ParticleSystem *> systems;
+		addSystems(manager, systems, 5);
+		for (unsigned int i = 0; i < systems.size(); ++i) {
+			CPPUNIT_ASSERT_EQUAL( true, manager.validateParticleSystemStillExists(systems[i]) );
+		}
+		CPPUNIT_ASSERT_EQUAL( true, manager.hasActiveParticleSystem(ParticleSystem::pst_SplashParticleSystem) );
+		CPPUNIT_ASSERT_EQUAL( false, manager.hasActiveParticleSystem(ParticleSystem::pst_ProjectileParticleSystem) );
+
+		ParticleSystem *removed = systems[1];
+		manager.cleanupParticleSystems(removed);
+		CPPUNIT_ASSERT_EQUAL( false, manager.validateParticleSystemStillExists(removed) );
+		manager.update();
+		for (unsigned int i = 0; i < systems.size(); ++i) {
+			if (systems[i] != removed) {
+				CPPUNIT_ASSERT_EQUAL( true, manager.validateParticleSystemStillExists(systems[i]) );
+			}
+		}
+
+		// Faded systems go once their last particle is gone
+		ParticleSystem *faded = systems[3];
+		faded->fade();
+		for (int i = 0; i < 100; ++i) {
+			manager.update();
+		}
+		CPPUNIT_ASSERT_EQUAL( false, manager.validateParticleSystemStillExists(faded) );
+		CPPUNIT_ASSERT_EQUAL( true, manager.validateParticleSystemStillExists(systems[4]) );
+	}
+
+	void test_particle_stores_pooled() {
+		UnitParticleSystem *ups = new UnitParticleSystem(300);
+		delete ups;
+		CPPUNIT_ASSERT_EQUAL( 1, ParticleSystem::getPooledParticleStoreCount(ParticleSystem::pst_UnitParticleSystem) );
+
+		ups = new UnitParticleSystem(200);
+		CPPUNIT_ASSERT_EQUAL( 0, ParticleSystem::getPooledParticleStoreCount(ParticleSystem::pst_UnitParticleSystem) );
+		CPPUNIT_ASSERT_EQUAL( 200, ups->getParticles().getCount() );
+		CPPUNIT_ASSERT( ups->getParticles().getCapacity() >= 300 );
+		delete ups;
+
+		// Long lived systems are not pooled
+		delete new RainParticleSystem(100);
+		CPPUNIT_ASSERT_EQUAL( 0, ParticleSystem::getPooledParticleStoreCount(ParticleSystem::pst_RainParticleSystem) );
+
+		ParticleSystem::setParticleStorePoolSize(2);
+		for (int i = 0; i < 4; ++i) {
+			delete new SplashParticleSystem(100);
+		}
+		CPPUNIT_ASSERT_EQUAL( 1, ParticleSystem::getPooledParticleStoreCount(ParticleSystem::pst_SplashParticleSystem) );
+		vector<SplashParticleSystem *> splashes;
+		for (int i = 0; i < 4; ++i) {
+			splashes.push_back(new SplashParticleSystem(100));
+		}
+		for (int i = 0; i < 4; ++i) {
+			delete splashes[i];
+		}
+		CPPUNIT_ASSERT_EQUAL( 2, ParticleSystem::getPooledParticleStoreCount(ParticleSystem::pst_SplashParticleSystem) );
+	}
+
+	void test_workers_match_serial_update() {
+		const int frames = 60;
+		ParticleManager serialManager;
+		vector<ParticleSystem *> serialSystems;
+		addSystems(serialManager, serialSystems, 12);
+		updateSystems(serialManager, serialSystems, frames);
+
+		ParticleManager::startWorkers(3);
+		CPPUNIT_ASSERT_EQUAL( 3, ParticleManager::getWorkerCount() );
+		ParticleManager threadedManager;
+		vector<ParticleSystem *> threadedSystems;
+		addSystems(threadedManager, threadedSystems, 12);
+		updateSystems(threadedManager, threadedSystems, frames);
+
+		for (unsigned int i = 0; i < serialSystems.size(); ++i) {
+			bool exists = serialManager.validateParticleSystemStillExists(serialSystems[i]);
+			CPPUNIT_ASSERT_EQUAL( exists, threadedManager.validateParticleSystemStillExists(threadedSystems[i]) );
+			if (exists == false) {
+				continue;
+			}
+			ParticleSystem *serial = serialSystems[i];
+			ParticleSystem *threaded = threadedSystems[i];
+			CPPUNIT_ASSERT_EQUAL( serial->getAliveParticleCount(), threaded->getAliveParticleCount() );
+			CPPUNIT_ASSERT_EQUAL( serial->getCRC().getSum(), threaded->getCRC().getSum() );
+			for (int j = 0; j < serial->getAliveParticleCount(); ++j) {
+				Particle expected = serial->getParticle(j);
+				Particle actual = threaded->getParticle(j);
+				CPPUNIT_ASSERT( expected.pos == actual.pos );
+				CPPUNIT_ASSERT( expected.speed == actual.speed );
+				CPPUNIT_ASSERT( expected.color == actual.color );
+				CPPUNIT_ASSERT_EQUAL( expected.energy, actual.energy );
+			}
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ParticleTest );
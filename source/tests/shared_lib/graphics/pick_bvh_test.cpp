@@ -0,0 +1,100 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <algorithm>
+#include "pick_bvh.h"
+
+using namespace Shared::Graphics;
+
+//
+// Tests for picking without drawing
+//
+class PickBvhTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( PickBvhTest );
+
+	CPPUNIT_TEST( test_ray_finds_nearest_box );
+	CPPUNIT_TEST( test_frustum_finds_boxes_inside );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	// A row of unit sized boxes along x, ids are the x positions
+	static void buildRow(PickBvh &bvh, int boxCount) {
+		vector<PickBox> boxes;
+		for (int i = 0; i < boxCount; ++i) {
+			boxes.push_back(PickBox(Vec3f((float) i, 0.f, 0.f), Vec3f(i + 0.5f, 2.f, 0.5f), i));
+		}
+		bvh.build(boxes);
+	}
+
+public:
+
+	void test_ray_finds_nearest_box() {
+		PickBvh bvh;
+		CPPUNIT_ASSERT_EQUAL( -1, bvh.findNearest(Vec3f(0.f), Vec3f(0.f, -1.f, 0.f)) );
+
+		buildRow(bvh, 100);
+		CPPUNIT_ASSERT_EQUAL( 100, bvh.getBoxCount() );
+		CPPUNIT_ASSERT( bvh.getNodeCount() > 1 );
+
+		// Looking down on box 42
+		float distance = 0;
+		CPPUNIT_ASSERT_EQUAL( 42, bvh.findNearest(Vec3f(42.25f, 10.f, 0.25f), Vec3f(0.f, -1.f, 0.f), &distance) );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 8.0, distance, 0.0001 );
+
+		// Between two boxes nothing is hit
+		CPPUNIT_ASSERT_EQUAL( -1, bvh.findNearest(Vec3f(42.75f, 10.f, 0.25f), Vec3f(0.f, -1.f, 0.f)) );
+
+		// Along the row the first box in front of the origin wins,
+		// whichever way the ray goes
+		CPPUNIT_ASSERT_EQUAL( 0, bvh.findNearest(Vec3f(-5.f, 1.f, 0.25f), Vec3f(1.f, 0.f, 0.f)) );
+		CPPUNIT_ASSERT_EQUAL( 99, bvh.findNearest(Vec3f(200.f, 1.f, 0.25f), Vec3f(-1.f, 0.f, 0.f)) );
+		CPPUNIT_ASSERT_EQUAL( 51, bvh.findNearest(Vec3f(50.75f, 1.f, 0.25f), Vec3f(1.f, 0.f, 0.f)) );
+
+		// Boxes behind the origin do not count
+		CPPUNIT_ASSERT_EQUAL( -1, bvh.findNearest(Vec3f(200.f, 1.f, 0.25f), Vec3f(1.f, 0.f, 0.f)) );
+	}
+
+	void test_frustum_finds_boxes_inside() {
+		PickBvh bvh;
+		buildRow(bvh, 100);
+
+		// Slab 10 <= x <= 20.2, boxes touching it count
+		Vec4f planes[] = {
+			Vec4f(1.f, 0.f, 0.f, -10.f),
+			Vec4f(-1.f, 0.f, 0.f, 20.2f)
+		};
+		vector<int> ids;
+		bvh.findInside(planes, 2, ids);
+		std::sort(ids.begin(), ids.end());
+		CPPUNIT_ASSERT_EQUAL( 11, (int) ids.size() );
+		for (int i = 0; i < (int) ids.size(); ++i) {
+			CPPUNIT_ASSERT_EQUAL( 10 + i, ids[i] );
+		}
+
+		// Above all boxes
+		Vec4f above(0.f, 1.f, 0.f, -3.f);
+		ids.clear();
+		bvh.findInside(&above, 1, ids);
+		CPPUNIT_ASSERT( ids.empty() );
+
+		bvh.clear();
+		bvh.findInside(planes, 2, ids);
+		CPPUNIT_ASSERT( ids.empty() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( PickBvhTest );
@@ -0,0 +1,115 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "render_queue.h"
+
+using namespace Shared::Graphics;
+
+//
+// Tests for the state sorted render queue
+//
+class RenderQueueTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( RenderQueueTest );
+
+	CPPUNIT_TEST( test_opaque_grouped_by_state );
+	CPPUNIT_TEST( test_blended_back_to_front );
+	CPPUNIT_TEST( test_state_change_counts );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	// Only compared, never used
+	char models[3];
+	char teamTextures[2];
+
+	Model *model(int i) {
+		return reinterpret_cast<Model *>(&models[i]);
+	}
+	const Texture *teamTexture(int i) const {
+		return reinterpret_cast<const Texture *>(&teamTextures[i]);
+	}
+
+	void add(RenderQueue &queue, int modelIndex, int teamIndex, int index, bool blended = false, float depth = 0) {
+		RenderQueueItem item;
+		item.model = model(modelIndex);
+		item.teamTexture = teamTexture(teamIndex);
+		item.blended = blended;
+		item.depth = depth;
+		item.index = index;
+		queue.add(item);
+	}
+
+public:
+
+	void test_opaque_grouped_by_state() {
+		RenderQueue queue;
+		add(queue, 0, 0, 0);
+		add(queue, 1, 1, 1);
+		add(queue, 1, 0, 2);
+		add(queue, 0, 1, 3);
+		add(queue, 0, 0, 4);
+		add(queue, 2, 0, 5);
+		queue.sort();
+
+		// Team textures and models in the order first seen, equal
+		// state in the order added
+		const int expected[] = { 0, 4, 2, 5, 3, 1 };
+		CPPUNIT_ASSERT_EQUAL( 6, queue.getItemCount() );
+		for (int i = 0; i < queue.getItemCount(); ++i) {
+			CPPUNIT_ASSERT_EQUAL( expected[i], queue.getItem(i).index );
+		}
+	}
+
+	void test_blended_back_to_front() {
+		RenderQueue queue;
+		add(queue, 0, 0, 0, true, 10.0f);
+		add(queue, 1, 1, 1);
+		add(queue, 0, 0, 2, true, 250.5f);
+		add(queue, 0, 1, 3, true, 0.25f);
+		add(queue, 1, 0, 4);
+		queue.sort();
+
+		const int expected[] = { 4, 1, 2, 0, 3 };
+		for (int i = 0; i < queue.getItemCount(); ++i) {
+			CPPUNIT_ASSERT_EQUAL( expected[i], queue.getItem(i).index );
+		}
+	}
+
+	void test_state_change_counts() {
+		RenderQueue queue;
+		for (int i = 0; i < 300; ++i) {
+			add(queue, i % 3, i % 2, i);
+		}
+		queue.sort();
+		// Two team textures times three models
+		CPPUNIT_ASSERT_EQUAL( 6, queue.getBatchCount() );
+		// Model changes within a team, then both change once
+		CPPUNIT_ASSERT_EQUAL( 6, queue.getStateChangeCount() );
+		for (int i = 1; i < queue.getItemCount(); ++i) {
+			if (queue.getItem(i).model == queue.getItem(i - 1).model &&
+				queue.getItem(i).teamTexture == queue.getItem(i - 1).teamTexture) {
+				CPPUNIT_ASSERT( queue.getItem(i).index > queue.getItem(i - 1).index );
+			}
+		}
+
+		queue.clear();
+		CPPUNIT_ASSERT_EQUAL( 0, queue.getItemCount() );
+		queue.sort();
+		CPPUNIT_ASSERT_EQUAL( 0, queue.getBatchCount() );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( RenderQueueTest );
@@ -0,0 +1,129 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "text_layout_cache.h"
+
+using namespace Shared::Graphics;
+
+//
+// Text handler that counts how often it measures
+//
+class CountingText : public Text {
+public:
+	int faceSize;
+	int advanceCount;
+	int lineHeightCount;
+
+	CountingText() : Text(ftht_2D) {
+		faceSize = 10;
+		advanceCount = 0;
+		lineHeightCount = 0;
+	}
+
+	virtual int GetFaceSize() {
+		return faceSize;
+	}
+	virtual float Advance(const char *str, const int len) {
+		advanceCount++;
+		return (float) (string(str).size() * faceSize);
+	}
+	virtual float LineHeight(const char *str, const int len) {
+		lineHeightCount++;
+		return (float) faceSize * 2;
+	}
+};
+
+static void reverseText(string &text, bool hasTextHandler) {
+	text = string(text.rbegin(), text.rend());
+}
+
+//
+// Tests for the text layout cache
+//
+class TextLayoutCacheTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( TextLayoutCacheTest );
+
+	CPPUNIT_TEST( test_layout_measured_once );
+	CPPUNIT_TEST( test_glyph_runs );
+	CPPUNIT_TEST( test_face_size_and_limit );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_layout_measured_once() {
+		CountingText text;
+		TextLayoutCache cache(&text, &reverseText);
+
+		for (int i = 0; i < 10; ++i) {
+			const TextLayout &layout = cache.getLayout("abc", true);
+			CPPUNIT_ASSERT_EQUAL( string("cba"), layout.shapedText );
+			CPPUNIT_ASSERT_EQUAL( 30.f, layout.advance );
+			CPPUNIT_ASSERT_EQUAL( 20.f, cache.getLineHeight() );
+		}
+		CPPUNIT_ASSERT_EQUAL( 1, text.advanceCount );
+		CPPUNIT_ASSERT_EQUAL( 1, text.lineHeightCount );
+		CPPUNIT_ASSERT_EQUAL( 9, cache.getHitCount() );
+
+		// Width is of the longest unshaped line
+		CPPUNIT_ASSERT_EQUAL( 40.f, cache.getTextWidth("ab\nabcd\nabc") );
+		CPPUNIT_ASSERT_EQUAL( 40.f, cache.getTextWidth("ab\nabcd\nabc") );
+		CPPUNIT_ASSERT_EQUAL( 2, text.advanceCount );
+
+		// Language changes shape text differently
+		TextLayoutCache::shapingGeneration++;
+		cache.getLayout("abc", true);
+		CPPUNIT_ASSERT_EQUAL( 3, text.advanceCount );
+	}
+
+	void test_glyph_runs() {
+		CountingText text;
+		TextLayoutCache cache(&text);
+
+		CPPUNIT_ASSERT( cache.getLayout("HP: 10").runs.empty() );
+
+		const TextLayout &layout = cache.getLayout("HP:\t10\n\nArmor: 3");
+		const char *expected[] = { "HP:", "\t", "10", "\n", "\n", "Armor: 3" };
+		CPPUNIT_ASSERT_EQUAL( 6, (int) layout.runs.size() );
+		for (int i = 0; i < (int) layout.runs.size(); ++i) {
+			CPPUNIT_ASSERT_EQUAL( string(expected[i]), layout.runs[i] );
+		}
+		// Nothing measured unless asked for
+		CPPUNIT_ASSERT_EQUAL( 0, text.advanceCount );
+	}
+
+	void test_face_size_and_limit() {
+		CountingText text;
+		TextLayoutCache cache(&text, NULL, 4);
+
+		CPPUNIT_ASSERT_EQUAL( 30.f, cache.getLayout("abc", true).advance );
+		text.faceSize = 20;
+		CPPUNIT_ASSERT_EQUAL( 60.f, cache.getLayout("abc", true).advance );
+		CPPUNIT_ASSERT_EQUAL( 40.f, cache.getLineHeight() );
+		CPPUNIT_ASSERT_EQUAL( 2, cache.getLayoutCount() );
+
+		cache.getLayout("1");
+		cache.getLayout("2");
+		CPPUNIT_ASSERT_EQUAL( 4, cache.getLayoutCount() );
+		cache.getLayout("3");
+		CPPUNIT_ASSERT_EQUAL( 1, cache.getLayoutCount() );
+
+		cache.setTextHandler(NULL);
+		CPPUNIT_ASSERT_EQUAL( 0, cache.getLayoutCount() );
+		CPPUNIT_ASSERT_EQUAL( 0.f, cache.getLayout("abc", true).advance );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( TextLayoutCacheTest );
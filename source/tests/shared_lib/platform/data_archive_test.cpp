@@ -0,0 +1,220 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include "data_archive.h"
+#include "checksum.h"
+#include "conversion.h"
+#include "platform_common.h"
+#include "cache_manager.h"
+#include "platform_util.h"
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for packed data archives
+//
+class DataArchiveTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( DataArchiveTest );
+
+	CPPUNIT_TEST( test_create_and_read );
+	CPPUNIT_TEST( test_mounted_reads_and_checksum );
+	CPPUNIT_TEST( test_invalid_archive );
+	CPPUNIT_TEST( test_stale_archive_is_ignored );
+	CPPUNIT_TEST( test_changed_folder_is_unmounted );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	string folder;
+	string archiveFile;
+	string oldCRCCacheFilePath;
+	std::map<string, string> contents;
+
+	void writeFile(const string &relativePath, const string &data) {
+		string path = folder + relativePath;
+		createDirectoryPaths(extractDirectoryPathFromFile(path));
+		std::ofstream file(path.c_str(), std::ios::binary);
+		file.write(data.data(), data.size());
+		file.close();
+		contents[relativePath] = data;
+	}
+
+	static string toString(const vector<char> &data) {
+		return (data.empty() == true ? string() : string(&data[0], data.size()));
+	}
+
+public:
+
+	void setUp() {
+		folder = getUserHome() + "/.zetaglest_data_archive_test/tech/";
+		archiveFile = getUserHome() + "/.zetaglest_data_archive_test/tech" + DataArchive::fileExtension;
+		contents.clear();
+		// Keeps the folder sums cached on disk from leaking between tests
+		oldCRCCacheFilePath = getCRCCacheFilePath();
+		setCRCCacheFilePath(getUserHome() + "/.zetaglest_data_archive_test/");
+
+		writeFile("tech.xml", "<?xml version=\"1.0\"?>\n<tech-tree>\n\t<description value=\"test\"/>\n</tech-tree>\n");
+		string repeated;
+		for (int i = 0; i < 500; ++i) {
+			repeated += "<unit name=\"worker\" hp=\"" + intToStr(i % 7) + "\"/>\n";
+		}
+		writeFile("factions/a/units/worker/worker.xml", repeated);
+		string noise;
+		unsigned int value = 12345;
+		for (int i = 0; i < 5000; ++i) {
+			value = value * 1103515245 + 12345;
+			noise += (char) (value >> 16);
+		}
+		writeFile("factions/a/units/worker/models/worker.g3d", noise);
+		writeFile("factions/a/empty.txt", "");
+	}
+
+	void tearDown() {
+		VirtualFileSystem::unmountAll();
+		setCRCCacheFilePath(oldCRCCacheFilePath);
+		CacheManager::getCachedItem< std::map<string, uint32> >(CacheManager::getFolderTreeContentsCheckSumRecursivelyCacheLookupKey1).clear();
+		CacheManager::getCachedItem< std::map<string, uint32> >(CacheManager::getFolderTreeContentsCheckSumRecursivelyCacheLookupKey2).clear();
+		removeFolder(getUserHome() + "/.zetaglest_data_archive_test");
+	}
+
+	void test_create_and_read() {
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, true) );
+
+		DataArchive archive;
+		CPPUNIT_ASSERT_EQUAL( true, archive.open(archiveFile) );
+		CPPUNIT_ASSERT_EQUAL( contents.size(), archive.getEntries().size() );
+
+		for (std::map<string, string>::const_iterator iterMap = contents.begin();
+			iterMap != contents.end(); ++iterMap) {
+			const DataArchiveEntry *entry = archive.findEntry(iterMap->first);
+			CPPUNIT_ASSERT( entry != NULL );
+			CPPUNIT_ASSERT_EQUAL( (uint64)0, entry->offset % DataArchive::blobAlignment );
+			CPPUNIT_ASSERT_EQUAL( Checksum::getFileSum(folder + iterMap->first), entry->crc );
+
+			vector<char> data;
+			CPPUNIT_ASSERT_EQUAL( true, archive.readFile(*entry, data) );
+			CPPUNIT_ASSERT( iterMap->second == toString(data) );
+		}
+		CPPUNIT_ASSERT( archive.findEntry("missing.xml") == NULL );
+
+		// Repetitive xml shrinks, random bytes are kept as they are
+		CPPUNIT_ASSERT_EQUAL( true, archive.findEntry("factions/a/units/worker/worker.xml")->isCompressed() );
+		const DataArchiveEntry *model = archive.findEntry("factions/a/units/worker/models/worker.g3d");
+		CPPUNIT_ASSERT_EQUAL( false, model->isCompressed() );
+		CPPUNIT_ASSERT( archive.getMappedData(*model) != NULL );
+
+		CPPUNIT_ASSERT_EQUAL( getFolderTreeContentsCheckSumRecursively(folder + "*", ".xml", NULL, true),
+			archive.getContentCheckSum(".xml") );
+		CPPUNIT_ASSERT_EQUAL( getFolderTreeContentsCheckSumRecursively(folder + "*", "", NULL, true),
+			archive.getContentCheckSum("") );
+	}
+
+	void test_mounted_reads_and_checksum() {
+		uint32 folderSum = getFolderTreeContentsCheckSumRecursively(folder + "*", ".xml", NULL, true);
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, true) );
+		CPPUNIT_ASSERT_EQUAL( true, VirtualFileSystem::mountFolderArchive(folder) );
+		CPPUNIT_ASSERT_EQUAL( true, VirtualFileSystem::isMounted(folder) );
+
+		string workerXml = folder + "factions/a/units//worker/worker.xml";
+		CPPUNIT_ASSERT_EQUAL( true, VirtualFileSystem::isArchived(workerXml) );
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::isArchived(folder + "other.xml") );
+
+		// Served from the archive even once the loose file is gone
+		removeFile(folder + "factions/a/units/worker/worker.xml");
+		vector<char> data;
+		CPPUNIT_ASSERT_EQUAL( true, VirtualFileSystem::readFile(workerXml, data) );
+		CPPUNIT_ASSERT( contents["factions/a/units/worker/worker.xml"] == toString(data) );
+
+		string modelPath = folder + "factions/a/units/worker/models/worker.g3d";
+		FILE *fp = VirtualFileSystem::openFile(modelPath);
+		CPPUNIT_ASSERT( fp != NULL );
+		vector<char> modelData(contents["factions/a/units/worker/models/worker.g3d"].size() + 1);
+		CPPUNIT_ASSERT_EQUAL( modelData.size() - 1, fread(&modelData[0], 1, modelData.size(), fp) );
+		fclose(fp);
+		modelData.pop_back();
+		CPPUNIT_ASSERT( contents["factions/a/units/worker/models/worker.g3d"] == toString(modelData) );
+
+		fp = VirtualFileSystem::openFile(workerXml);
+		CPPUNIT_ASSERT( fp != NULL );
+		fclose(fp);
+
+		// Folder sums come from the archive index, alone or as part of a
+		// walk over several data paths
+		CacheManager::getCachedItem< std::map<string, uint32> >(CacheManager::getFolderTreeContentsCheckSumRecursivelyCacheLookupKey2).clear();
+		vector<string> paths;
+		paths.push_back(getUserHome() + "/.zetaglest_data_archive_test");
+		CPPUNIT_ASSERT_EQUAL( folderSum, getFolderTreeContentsCheckSumRecursively(paths, "/tech/*", ".xml", NULL, false) );
+		CPPUNIT_ASSERT_EQUAL( folderSum, getFolderTreeContentsCheckSumRecursively(folder + "*", ".xml", NULL, false) );
+		// Asked for explicitly, the sum is what is on disk now
+		CPPUNIT_ASSERT( folderSum != getFolderTreeContentsCheckSumRecursively(folder + "*", ".xml", NULL, true) );
+	}
+
+	void test_invalid_archive() {
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, false) );
+		{
+			std::fstream file(archiveFile.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(4);
+			file.put('\x7f');
+		}
+		DataArchive archive;
+		CPPUNIT_ASSERT_EQUAL( false, archive.open(archiveFile) );
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::mountFolderArchive(folder) );
+	}
+
+	void test_stale_archive_is_ignored() {
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, true) );
+		writeFile("factions/a/units/worker/worker.xml", "<unit name=\"worker\" hp=\"9\"/>\n");
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::mountFolderArchive(folder) );
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::isMounted(folder) );
+
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, true) );
+		writeFile("factions/b/b.xml", "<faction/>\n");
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::mountFolderArchive(folder) );
+
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, true) );
+		removeFile(folder + "factions/a/empty.txt");
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::mountFolderArchive(folder) );
+
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, true) );
+		CPPUNIT_ASSERT_EQUAL( true, VirtualFileSystem::mountFolderArchive(folder) );
+	}
+	void test_changed_folder_is_unmounted() {
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, true) );
+		CPPUNIT_ASSERT_EQUAL( true, VirtualFileSystem::mountFolderArchive(folder) );
+		uint32 archivedSum = VirtualFileSystem::findMountedFolder(folder + "*")->getContentCheckSum(".xml");
+
+		// Like a techtree download replacing files while the archive is mounted
+		writeFile("factions/a/units/worker/worker.xml", "<unit name=\"worker\" hp=\"9\"/>\n");
+		Checksum::clearFileCache();
+		uint32 folderSum = getFolderTreeContentsCheckSumRecursively(folder + "*", ".xml", NULL, true);
+		CPPUNIT_ASSERT( folderSum != archivedSum );
+
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::mountFolderArchive(folder) );
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::isMounted(folder) );
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::isArchived(folder + "tech.xml") );
+
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(folder, archiveFile, true) );
+		CPPUNIT_ASSERT_EQUAL( true, VirtualFileSystem::mountFolderArchive(folder) );
+		CPPUNIT_ASSERT_EQUAL( folderSum, getFolderTreeContentsCheckSumRecursively(folder + "*", ".xml", NULL, false) );
+
+		clearFolderTreeContentsCheckSum(folder + "*", ".xml");
+		CPPUNIT_ASSERT_EQUAL( false, VirtualFileSystem::isMounted(folder) );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( DataArchiveTest );
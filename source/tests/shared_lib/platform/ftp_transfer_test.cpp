@@ -0,0 +1,219 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "miniftpserver.h"
+#include "miniftpclient.h"
+#include "platform_common.h"
+#include "conversion.h"
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <vector>
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+//
+// Loopback transfers between the built-in FTP server and client
+//
+class FtpTransferTest : public CppUnit::TestFixture, public FTPClientCallbackInterface,
+	public FTPClientValidationInterface {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( FtpTransferTest );
+
+	CPPUNIT_TEST( test_resume_partial_transfer );
+	CPPUNIT_TEST( test_partial_transfer_of_changed_file_starts_over );
+	CPPUNIT_TEST( test_partial_transfer_longer_than_file_starts_over );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static const int FTP_TEST_PORT = 61358;
+
+	string serverFolder;
+	string clientFolder;
+	Mutex mutexResults;
+	std::vector<string> finishedFiles;
+	std::vector<FTP_Client_ResultType> finishedResults;
+
+	static std::vector<char> makeData(size_t size) {
+		std::vector<char> data(size);
+		for(size_t idx = 0; idx < size; ++idx) {
+			data[idx] = (char)((idx * 7 + idx / 4096) & 0xFF);
+		}
+		return data;
+	}
+
+	static void writeData(const string &fileName, const std::vector<char> &data, size_t size) {
+		FILE *fp = fopen(fileName.c_str(), "wb");
+		CPPUNIT_ASSERT( fp != NULL );
+		if(size > 0) {
+			CPPUNIT_ASSERT_EQUAL( size, fwrite(&data[0], 1, size, fp) );
+		}
+		fclose(fp);
+	}
+
+	static std::vector<char> readData(const string &fileName) {
+		std::vector<char> result;
+		FILE *fp = fopen(fileName.c_str(), "rb");
+		if(fp != NULL) {
+			char buf[65536];
+			size_t bytes = 0;
+			while((bytes = fread(buf, 1, sizeof(buf), fp)) > 0) {
+				result.insert(result.end(), buf, buf + bytes);
+			}
+			fclose(fp);
+		}
+		return result;
+	}
+
+	// Serves serverFolder as the temp files account, downloads fileName into
+	// clientFolder
+	void transfer(const string &fileName, FTP_Client_ResultType &result) {
+		FTPServerThread *server = new FTPServerThread(
+			make_pair(string(""), string("")), make_pair(string(""), string("")),
+			make_pair(string(""), string("")), false, false, false,
+			FTP_TEST_PORT, 1, this, serverFolder);
+		server->start();
+		sleep(250);
+
+		FTPClientThread *client = new FTPClientThread(FTP_TEST_PORT, "127.0.0.1",
+			make_pair(string(""), string("")), make_pair(string(""), string("")),
+			make_pair(string(""), string("")), make_pair(string(""), string("")),
+			this, ".7z", "", "", 0, clientFolder);
+		client->setMaxConcurrentTransfers(2);
+
+		Chrono chrono(true);
+		client->start();
+		client->addTempFileToRequests(fileName, fileName);
+
+		bool finished = false;
+		while(finished == false && chrono.getMillis() < 60000) {
+			sleep(10);
+			MutexSafeWrapper safeMutex(&mutexResults);
+			finished = (finishedFiles.empty() == false);
+		}
+
+		if(client->shutdownAndWait() == true) {
+			delete client;
+		}
+		if(server->shutdownAndWait() == true) {
+			delete server;
+		}
+
+		CPPUNIT_ASSERT_EQUAL( true, finished );
+		CPPUNIT_ASSERT_EQUAL( fileName, finishedFiles[0] );
+		result = finishedResults[0];
+	}
+
+	// What the client notes down next to a .part file: the size and the
+	// modification time the server reports (MDTM is sent in server local time)
+	static void writeStamp(const string &partFileName, const string &serverFileName, time_t offset) {
+		struct stat st;
+		CPPUNIT_ASSERT_EQUAL( 0, stat(serverFileName.c_str(), &st) );
+		time_t modified = st.st_mtime;
+		struct tm *localModified = localtime(&modified);
+		FILE *fp = fopen((partFileName + ".stamp").c_str(), "wt");
+		CPPUNIT_ASSERT( fp != NULL );
+		fprintf(fp, "%lld %ld\n", (long long)st.st_size, (long)(timegm(localModified) + offset));
+		fclose(fp);
+	}
+
+public:
+
+	// The loopback client is the only one connecting, let it in
+	virtual int isValidClientType(uint32 clientIp) {
+		return 1;
+	}
+	virtual int isClientAllowedToGetFile(uint32 clientIp, const char *username, const char *filename) {
+		return 1;
+	}
+
+	virtual void FTPClient_CallbackEvent(string itemName,
+		FTP_Client_CallbackType type,
+		pair<FTP_Client_ResultType, string> result,
+		void *userdata) {
+		if(type == ftp_cct_TempFile) {
+			MutexSafeWrapper safeMutex(&mutexResults);
+			finishedFiles.push_back(itemName);
+			finishedResults.push_back(result.first);
+		}
+	}
+
+	void setUp() {
+		serverFolder = getUserHome() + "/.zetaglest_ftp_test/server/";
+		clientFolder = getUserHome() + "/.zetaglest_ftp_test/client/";
+		createDirectoryPaths(serverFolder);
+		createDirectoryPaths(clientFolder);
+		finishedFiles.clear();
+		finishedResults.clear();
+	}
+
+	void tearDown() {
+		removeFolder(getUserHome() + "/.zetaglest_ftp_test/");
+	}
+
+	void test_resume_partial_transfer() {
+		const size_t size = 8 * 1024 * 1024;
+		std::vector<char> data = makeData(size);
+		writeData(serverFolder + "techtree.bin", data, size);
+		// What an earlier, broken off transfer would have left behind. The kept
+		// bytes differ from the file so the result shows they were not fetched again
+		std::vector<char> kept(size / 2 + 123, 0);
+		writeData(clientFolder + "techtree.bin.part", kept, kept.size());
+		writeStamp(clientFolder + "techtree.bin.part", serverFolder + "techtree.bin", 0);
+
+		FTP_Client_ResultType result = ftp_crt_FAIL;
+		transfer("techtree.bin", result);
+		CPPUNIT_ASSERT_EQUAL( ftp_crt_SUCCESS, result );
+
+		std::vector<char> expected = data;
+		std::fill(expected.begin(), expected.begin() + kept.size(), 0);
+		CPPUNIT_ASSERT( readData(clientFolder + "techtree.bin") == expected );
+		CPPUNIT_ASSERT_EQUAL( false, fileExists(clientFolder + "techtree.bin.part.stamp") );
+	}
+
+	void test_partial_transfer_of_changed_file_starts_over() {
+		const size_t size = 1024 * 1024;
+		std::vector<char> data = makeData(size);
+		writeData(serverFolder + "techtree.bin", data, size);
+		std::vector<char> kept(size / 2, 0);
+		writeData(clientFolder + "techtree.bin.part", kept, kept.size());
+		// Kept while the server had an older version of the file
+		writeStamp(clientFolder + "techtree.bin.part", serverFolder + "techtree.bin", -3600);
+
+		FTP_Client_ResultType result = ftp_crt_FAIL;
+		transfer("techtree.bin", result);
+		CPPUNIT_ASSERT_EQUAL( ftp_crt_SUCCESS, result );
+		CPPUNIT_ASSERT( readData(clientFolder + "techtree.bin") == data );
+	}
+
+	void test_partial_transfer_longer_than_file_starts_over() {
+		const size_t size = 1024 * 1024;
+		std::vector<char> data = makeData(size);
+		writeData(serverFolder + "techtree.bin", data, size);
+		// No stamp, and more bytes than the file has
+		std::vector<char> kept(size + 4096, 0);
+		writeData(clientFolder + "techtree.bin.part", kept, kept.size());
+
+		FTP_Client_ResultType result = ftp_crt_FAIL;
+		transfer("techtree.bin", result);
+		CPPUNIT_ASSERT_EQUAL( ftp_crt_SUCCESS, result );
+		CPPUNIT_ASSERT( readData(clientFolder + "techtree.bin") == data );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( FtpTransferTest );
@@ -0,0 +1,389 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "network_link_simulator.h"
+#include "platform_common.h"
+#include "checksum.h"
+#include "randomgen.h"
+#include <vector>
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+//
+// Plays a lockstep game between one server and several clients in one
+// process, every client connected through the network link simulator.
+// It follows the game's network loop: clients send their commands for
+// a frame, the server merges and broadcasts them, every peer applies
+// them to its own world and the clients report their faction CRCs for
+// the frame, which the server checks against its own.
+//
+class LockstepHarnessTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( LockstepHarnessTest );
+
+	CPPUNIT_TEST( test_crcs_match_unimpaired );
+	CPPUNIT_TEST( test_crcs_match_impaired );
+	CPPUNIT_TEST( test_desync_is_detected );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static const int unitsPerFaction = 8;
+	static const int mapSize = 64;
+	static const int commandInts = 4;
+
+	// Owned by the fixture so a failed assert in playGame still gets
+	// them closed in tearDown
+	ServerSocket *server;
+	NetworkLinkSimulator *simulator;
+	std::vector<ClientSocket *> clients;
+	std::vector<Socket *> slots;
+	bool disableNagle;
+
+	// A deterministic stand in for the game world, units move by the
+	// commands they are given and lose hp when they share a cell
+	class LockstepWorld {
+	public:
+		class Unit {
+		public:
+			int32 x;
+			int32 y;
+			int32 dx;
+			int32 dy;
+			int32 hp;
+		};
+
+		std::vector<std::vector<Unit> > factions;
+
+		void init(int factionCount) {
+			factions.assign(factionCount, std::vector<Unit>(unitsPerFaction));
+			for(int faction = 0; faction < factionCount; ++faction) {
+				for(int index = 0; index < unitsPerFaction; ++index) {
+					Unit &unit = factions[faction][index];
+					unit.x = (faction * 13 + index * 7) % mapSize;
+					unit.y = (faction * 5 + index * 11) % mapSize;
+					unit.dx = 0;
+					unit.dy = 0;
+					unit.hp = 100;
+				}
+			}
+		}
+
+		// command is faction, unit, dx, dy
+		void apply(const int32 *command) {
+			Unit &unit = factions[command[0]][command[1]];
+			unit.dx = command[2];
+			unit.dy = command[3];
+		}
+
+		void update() {
+			for(size_t faction = 0; faction < factions.size(); ++faction) {
+				for(size_t index = 0; index < factions[faction].size(); ++index) {
+					Unit &unit = factions[faction][index];
+					unit.x = (unit.x + unit.dx + mapSize) % mapSize;
+					unit.y = (unit.y + unit.dy + mapSize) % mapSize;
+				}
+			}
+			for(size_t faction = 0; faction < factions.size(); ++faction) {
+				for(size_t index = 0; index < factions[faction].size(); ++index) {
+					Unit &unit = factions[faction][index];
+					for(size_t other = 0; other < factions.size(); ++other) {
+						if(other == faction) {
+							continue;
+						}
+						for(size_t otherIndex = 0; otherIndex < factions[other].size(); ++otherIndex) {
+							const Unit &otherUnit = factions[other][otherIndex];
+							if(otherUnit.x == unit.x && otherUnit.y == unit.y && unit.hp > 0) {
+								unit.hp--;
+							}
+						}
+					}
+				}
+			}
+		}
+
+		uint32 getFactionCRC(int faction) const {
+			Checksum checksum;
+			for(size_t index = 0; index < factions[faction].size(); ++index) {
+				const Unit &unit = factions[faction][index];
+				checksum.addInt(unit.x);
+				checksum.addInt(unit.y);
+				checksum.addInt(unit.dx);
+				checksum.addInt(unit.dy);
+				checksum.addInt(unit.hp);
+			}
+			return checksum.getSum();
+		}
+	};
+
+	class LockstepResult {
+	public:
+		int framesPlayed;
+		int firstMismatchFrame;
+		int mismatchClient;
+		int mismatchFaction;
+		std::vector<uint32> serverFactionCRCs;
+
+		LockstepResult() {
+			framesPlayed = 0;
+			firstMismatchFrame = -1;
+			mismatchClient = -1;
+			mismatchFaction = -1;
+		}
+	};
+
+	static bool sendInts(Socket *socket, const std::vector<int32> &values) {
+		const char *data = (const char *)&values[0];
+		size_t size = values.size() * sizeof(int32);
+		size_t sent = 0;
+		Chrono chrono(true);
+		while(sent < size && chrono.getMillis() < 10000) {
+			int result = socket->send(&data[sent], (int)(size - sent));
+			if(result > 0) {
+				sent += result;
+			}
+			else {
+				sleep(1);
+			}
+		}
+		return (sent == size);
+	}
+
+	static bool receiveInts(Socket *socket, std::vector<int32> &values, size_t count) {
+		values.resize(count);
+		char *data = (char *)&values[0];
+		size_t size = count * sizeof(int32);
+		size_t received = 0;
+		Chrono chrono(true);
+		while(received < size && chrono.getMillis() < 10000) {
+			if(socket->hasDataToReadWithWait(10000) == false) {
+				continue;
+			}
+			int result = socket->receive(&data[received], (int)(size - received), false);
+			if(result <= 0) {
+				break;
+			}
+			received += result;
+		}
+		return (received == size);
+	}
+
+	static void makeCommand(RandomGen &random, int faction, std::vector<int32> &command) {
+		command.resize(commandInts);
+		command[0] = faction;
+		command[1] = random.randRange(0, unitsPerFaction - 1);
+		command[2] = random.randRange(-2, 2);
+		command[3] = random.randRange(-2, 2);
+	}
+
+	// The server plays faction 0, client i plays faction i + 1. A client
+	// listed in desyncClient changes its world on its own at desyncFrame
+	LockstepResult playGame(const NetworkLinkConditions &conditions, int clientCount, int frameCount,
+		int desyncClient = -1, int desyncFrame = -1) {
+		LockstepResult result;
+		int factionCount = clientCount + 1;
+
+		// Small frame messages must not wait for Nagle and delayed acks
+		Socket::disableNagle = true;
+
+		server = new ServerSocket(true);
+		server->setBindSpecificAddress("127.0.0.1");
+		server->bind(0);
+		server->listen();
+		CPPUNIT_ASSERT( server->getBindPort() > 0 );
+
+		simulator = new NetworkLinkSimulator(conditions, "127.0.0.1", server->getBindPort());
+		simulator->start();
+
+		for(int clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+			ClientSocket *client = new ClientSocket();
+			client->connect(Ip("127.0.0.1"), simulator->getListenPort());
+			CPPUNIT_ASSERT_EQUAL( true,client->isConnected() );
+			clients.push_back(client);
+
+			// Connect one at a time so slot i belongs to client i
+			Socket *slot = NULL;
+			for(Chrono chrono(true); slot == NULL && chrono.getMillis() < 5000;) {
+				if(server->hasDataToRead() == true) {
+					slot = server->accept(false);
+				}
+				else {
+					sleep(1);
+				}
+			}
+			CPPUNIT_ASSERT( slot != NULL );
+			slots.push_back(slot);
+		}
+
+		LockstepWorld serverWorld;
+		serverWorld.init(factionCount);
+		std::vector<LockstepWorld> clientWorlds(clientCount);
+		std::vector<RandomGen> clientRandoms(clientCount);
+		for(int clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+			clientWorlds[clientIndex].init(factionCount);
+			clientRandoms[clientIndex].init(clientIndex + 1);
+		}
+		RandomGen serverRandom;
+		serverRandom.init(0);
+
+		std::vector<int32> message;
+		for(int frame = 0; frame < frameCount && result.firstMismatchFrame < 0; ++frame) {
+			// Clients send the commands they issued for this frame
+			for(int clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+				std::vector<int32> command;
+				makeCommand(clientRandoms[clientIndex], clientIndex + 1, command);
+				message.assign(1, frame);
+				message.insert(message.end(), command.begin(), command.end());
+				CPPUNIT_ASSERT_EQUAL( true,sendInts(clients[clientIndex],message) );
+			}
+
+			// The server merges them in slot order and broadcasts the frame
+			std::vector<int32> commands;
+			makeCommand(serverRandom, 0, commands);
+			for(int clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+				CPPUNIT_ASSERT_EQUAL( true,receiveInts(slots[clientIndex],message,1 + commandInts) );
+				CPPUNIT_ASSERT_EQUAL( frame,message[0] );
+				commands.insert(commands.end(), message.begin() + 1, message.end());
+			}
+			message.assign(1, frame);
+			message.push_back(factionCount);
+			message.insert(message.end(), commands.begin(), commands.end());
+			for(int clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+				CPPUNIT_ASSERT_EQUAL( true,sendInts(slots[clientIndex],message) );
+			}
+			for(int commandIndex = 0; commandIndex < factionCount; ++commandIndex) {
+				serverWorld.apply(&commands[commandIndex * commandInts]);
+			}
+			serverWorld.update();
+
+			// Every client plays the frame and reports its faction CRCs
+			for(int clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+				LockstepWorld &world = clientWorlds[clientIndex];
+				CPPUNIT_ASSERT_EQUAL( true,receiveInts(clients[clientIndex],message,2) );
+				CPPUNIT_ASSERT_EQUAL( frame,message[0] );
+				int commandCount = message[1];
+				CPPUNIT_ASSERT_EQUAL( true,receiveInts(clients[clientIndex],message,commandCount * commandInts) );
+				for(int commandIndex = 0; commandIndex < commandCount; ++commandIndex) {
+					world.apply(&message[commandIndex * commandInts]);
+				}
+				world.update();
+				if(clientIndex == desyncClient && frame == desyncFrame) {
+					world.factions[0][0].hp--;
+				}
+
+				message.assign(1, frame);
+				for(int faction = 0; faction < factionCount; ++faction) {
+					message.push_back((int32)world.getFactionCRC(faction));
+				}
+				CPPUNIT_ASSERT_EQUAL( true,sendInts(clients[clientIndex],message) );
+			}
+
+			for(int clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+				CPPUNIT_ASSERT_EQUAL( true,receiveInts(slots[clientIndex],message,1 + factionCount) );
+				CPPUNIT_ASSERT_EQUAL( frame,message[0] );
+				for(int faction = 0; faction < factionCount && result.firstMismatchFrame < 0; ++faction) {
+					if((uint32)message[1 + faction] != serverWorld.getFactionCRC(faction)) {
+						result.firstMismatchFrame = frame;
+						result.mismatchClient = clientIndex;
+						result.mismatchFaction = faction;
+					}
+				}
+			}
+			result.framesPlayed++;
+		}
+
+		for(int faction = 0; faction < factionCount; ++faction) {
+			result.serverFactionCRCs.push_back(serverWorld.getFactionCRC(faction));
+		}
+
+		closeGame();
+		return result;
+	}
+
+	void closeGame() {
+		for(size_t clientIndex = 0; clientIndex < clients.size(); ++clientIndex) {
+			delete clients[clientIndex];
+		}
+		clients.clear();
+		for(size_t slotIndex = 0; slotIndex < slots.size(); ++slotIndex) {
+			delete slots[slotIndex];
+		}
+		slots.clear();
+		if(simulator != NULL) {
+			simulator->signalQuit();
+			simulator->shutdownAndJoin();
+			delete simulator;
+			simulator = NULL;
+		}
+		delete server;
+		server = NULL;
+		Socket::disableNagle = disableNagle;
+	}
+
+public:
+
+	void setUp() {
+		server = NULL;
+		simulator = NULL;
+		disableNagle = Socket::disableNagle;
+	}
+
+	void tearDown() {
+		closeGame();
+	}
+
+	void test_crcs_match_unimpaired() {
+		NetworkLinkConditions conditions;
+		LockstepResult result = playGame(conditions, 4, 200);
+
+		CPPUNIT_ASSERT_EQUAL( 200,result.framesPlayed );
+		CPPUNIT_ASSERT_EQUAL( -1,result.firstMismatchFrame );
+		CPPUNIT_ASSERT_EQUAL( 5,(int)result.serverFactionCRCs.size() );
+	}
+
+	void test_crcs_match_impaired() {
+		NetworkLinkConditions conditions;
+		conditions.latencyMilliseconds = 2;
+		conditions.jitterMilliseconds = 1;
+		conditions.dropPercent = 5;
+		conditions.retransmitMilliseconds = 5;
+		conditions.reorderPercent = 5;
+		conditions.reorderMilliseconds = 3;
+		conditions.randomSeed = 7;
+		LockstepResult result = playGame(conditions, 3, 40);
+
+		CPPUNIT_ASSERT_EQUAL( 40,result.framesPlayed );
+		CPPUNIT_ASSERT_EQUAL( -1,result.firstMismatchFrame );
+
+		// The link only changes timing, never the outcome
+		LockstepResult unimpaired = playGame(NetworkLinkConditions(), 3, 40);
+		CPPUNIT_ASSERT( unimpaired.serverFactionCRCs == result.serverFactionCRCs );
+	}
+
+	void test_desync_is_detected() {
+		NetworkLinkConditions conditions;
+		LockstepResult result = playGame(conditions, 3, 100, 1, 37);
+
+		CPPUNIT_ASSERT_EQUAL( 37,result.firstMismatchFrame );
+		CPPUNIT_ASSERT_EQUAL( 1,result.mismatchClient );
+		CPPUNIT_ASSERT_EQUAL( 0,result.mismatchFaction );
+		CPPUNIT_ASSERT_EQUAL( 38,result.framesPlayed );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( LockstepHarnessTest );
+//
@@ -0,0 +1,159 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "network_link_simulator.h"
+#include "platform_common.h"
+#include <vector>
+#include <algorithm>
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for the network link simulator
+//
+class NetworkLinkSimulatorTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( NetworkLinkSimulatorTest );
+
+	CPPUNIT_TEST( test_relay_unimpaired );
+	CPPUNIT_TEST( test_relay_impaired_keeps_stream_intact );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static bool sendAll(Socket *socket, const std::vector<char> &data) {
+		size_t sent = 0;
+		Chrono chrono(true);
+		while(sent < data.size() && chrono.getMillis() < 10000) {
+			int result = socket->send(&data[sent], (int)(data.size() - sent));
+			if(result > 0) {
+				sent += result;
+			}
+			else {
+				sleep(1);
+			}
+		}
+		return (sent == data.size());
+	}
+
+	static std::vector<char> receiveAll(Socket *socket, size_t size) {
+		std::vector<char> result;
+		Chrono chrono(true);
+		while(result.size() < size && chrono.getMillis() < 10000) {
+			if(socket->hasDataToReadWithWait(10000) == false) {
+				continue;
+			}
+			int available = socket->getDataToRead(true);
+			if(available <= 0) {
+				continue;
+			}
+			std::vector<char> buf(std::min<size_t>(available, size - result.size()));
+			int received = socket->receive(&buf[0], (int)buf.size(), false);
+			if(received <= 0) {
+				break;
+			}
+			result.insert(result.end(), buf.begin(), buf.begin() + received);
+		}
+		return result;
+	}
+
+	static std::vector<char> makePattern(size_t size) {
+		std::vector<char> data(size);
+		for(size_t index = 0; index < size; ++index) {
+			data[index] = (char)((index * 31 + 7) & 0xFF);
+		}
+		return data;
+	}
+
+	void runRelay(const NetworkLinkConditions &conditions, size_t payloadSize, int64 *elapsedMillis) {
+		ServerSocket server(true);
+		server.setBindSpecificAddress("127.0.0.1");
+		server.bind(0);
+		server.listen();
+		CPPUNIT_ASSERT( server.getBindPort() > 0 );
+
+		NetworkLinkSimulator *simulator = new NetworkLinkSimulator(conditions, "127.0.0.1", server.getBindPort());
+		simulator->start();
+		CPPUNIT_ASSERT( simulator->getListenPort() > 0 );
+
+		ClientSocket client;
+		client.connect(Ip("127.0.0.1"), simulator->getListenPort());
+		CPPUNIT_ASSERT_EQUAL( true,client.isConnected() );
+
+		Socket *serverSide = NULL;
+		for(Chrono chrono(true); serverSide == NULL && chrono.getMillis() < 5000;) {
+			if(server.hasDataToRead() == true) {
+				serverSide = server.accept(false);
+			}
+			else {
+				sleep(1);
+			}
+		}
+		CPPUNIT_ASSERT( serverSide != NULL );
+
+		std::vector<char> payload = makePattern(payloadSize);
+		Chrono chrono(true);
+		CPPUNIT_ASSERT_EQUAL( true,sendAll(&client,payload) );
+		std::vector<char> atServer = receiveAll(serverSide, payloadSize);
+		CPPUNIT_ASSERT( atServer == payload );
+
+		// Echo it back through the other direction
+		CPPUNIT_ASSERT_EQUAL( true,sendAll(serverSide,atServer) );
+		std::vector<char> atClient = receiveAll(&client, payloadSize);
+		CPPUNIT_ASSERT( atClient == payload );
+		*elapsedMillis = chrono.getMillis();
+
+		NetworkLinkStats stats = simulator->getStats();
+		CPPUNIT_ASSERT_EQUAL( 1,stats.acceptedLinks );
+		CPPUNIT_ASSERT_EQUAL( (int64)payloadSize,stats.bytesToServer );
+		CPPUNIT_ASSERT_EQUAL( (int64)payloadSize,stats.bytesToClient );
+
+		if(simulator->shutdownAndWait() == true) {
+			delete simulator;
+		}
+		delete serverSide;
+	}
+
+public:
+
+	void test_relay_unimpaired() {
+		NetworkLinkConditions conditions;
+		CPPUNIT_ASSERT_EQUAL( false,conditions.hasImpairment() );
+
+		int64 elapsedMillis = 0;
+		runRelay(conditions, 4096, &elapsedMillis);
+	}
+
+	void test_relay_impaired_keeps_stream_intact() {
+		NetworkLinkConditions conditions;
+		conditions.latencyMilliseconds = 40;
+		conditions.jitterMilliseconds = 10;
+		conditions.bandwidthBytesPerSecond = 512 * 1024;
+		conditions.dropPercent = 10;
+		conditions.reorderPercent = 10;
+		conditions.randomSeed = 42;
+		CPPUNIT_ASSERT_EQUAL( true,conditions.hasImpairment() );
+
+		int64 elapsedMillis = 0;
+		runRelay(conditions, 64 * 1024, &elapsedMillis);
+
+		// Each direction pays at least latency minus jitter
+		CPPUNIT_ASSERT( elapsedMillis >= 2 * (conditions.latencyMilliseconds - conditions.jitterMilliseconds) );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( NetworkLinkSimulatorTest );
+//
@@ -0,0 +1,187 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests <https://github.com/ZetaGlest>
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include "sound.h"
+#include "sound_buffer_cache.h"
+#include "data_archive.h"
+#include "platform_common.h"
+#include "platform_util.h"
+
+using namespace Shared::Sound;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for shared sound buffers and prefetched streams
+//
+class SoundBufferCacheTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SoundBufferCacheTest );
+
+	CPPUNIT_TEST( test_shared_buffers );
+	CPPUNIT_TEST( test_shared_buffers_threaded );
+	CPPUNIT_TEST( test_prefetched_stream );
+	CPPUNIT_TEST( test_archived_sound );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static const uint32 sampleCount = 100000;
+	string folder;
+	string wavFile;
+
+	static void writeValue(std::ofstream &file, uint32 value, int size) {
+		for (int i = 0; i < size; ++i) {
+			file.put((char) ((value >> (i * 8)) & 0xFF));
+		}
+	}
+
+	static int8 sampleAt(uint32 index) {
+		return (int8) (index * 7);
+	}
+
+	// 8 bit mono PCM
+	void writeWav(const string &path) {
+		std::ofstream file(path.c_str(), std::ios::binary);
+		file.write("RIFF", 4);
+		writeValue(file, 36 + sampleCount, 4);
+		file.write("WAVE", 4);
+		file.write("fmt ", 4);
+		writeValue(file, 16, 4);
+		writeValue(file, 1, 2);
+		writeValue(file, 1, 2);
+		writeValue(file, 22050, 4);
+		writeValue(file, 22050, 4);
+		writeValue(file, 1, 2);
+		writeValue(file, 8, 2);
+		file.write("data", 4);
+		writeValue(file, sampleCount, 4);
+		for (uint32 i = 0; i < sampleCount; ++i) {
+			file.put(sampleAt(i));
+		}
+	}
+
+	void checkSharedBuffers() {
+		StaticSound *first = new StaticSound();
+		StaticSound *second = new StaticSound();
+		first->load(wavFile);
+		second->load(folder + "./" + "sound.wav");
+		CPPUNIT_ASSERT_EQUAL( 1, SoundBufferCache::getBufferCount() );
+		CPPUNIT_ASSERT( first->getSamples() != NULL );
+		CPPUNIT_ASSERT( first->getSamples() == second->getSamples() );
+		CPPUNIT_ASSERT_EQUAL( sampleCount, second->getInfo()->getSize() );
+		CPPUNIT_ASSERT_EQUAL( sampleAt(99), first->getSamples()[99] );
+
+		delete first;
+		CPPUNIT_ASSERT_EQUAL( 1, SoundBufferCache::getBufferCount() );
+		delete second;
+		CPPUNIT_ASSERT_EQUAL( 0, SoundBufferCache::getBufferCount() );
+	}
+
+public:
+
+	void setUp() {
+		folder = getUserHome() + "/.zetaglest_sound_buffer_test/";
+		wavFile = folder + "sound.wav";
+		createDirectoryPaths(folder);
+		writeWav(wavFile);
+	}
+
+	void tearDown() {
+		SoundBufferCache::stop();
+		VirtualFileSystem::unmountAll();
+		StrSound::setPrefetchSize(256 * 1024);
+		removeFolder(getUserHome() + "/.zetaglest_sound_buffer_test");
+	}
+
+	void test_shared_buffers() {
+		checkSharedBuffers();
+		CPPUNIT_ASSERT_THROW( StaticSound().load(folder + "missing.wav"), megaglest_runtime_error );
+
+		// A file that fails to decode is not kept, so it can be fixed and reloaded
+		string brokenFile = folder + "broken.wav";
+		{
+			std::ofstream file(brokenFile.c_str(), std::ios::binary);
+			file.write("not a wav file", 14);
+		}
+		StaticSound broken;
+		broken.load(brokenFile);
+		CPPUNIT_ASSERT( broken.getSamples() == NULL );
+		CPPUNIT_ASSERT_EQUAL( 0, SoundBufferCache::getBufferCount() );
+
+		writeWav(brokenFile);
+		StaticSound fixed;
+		fixed.load(brokenFile);
+		CPPUNIT_ASSERT( fixed.getSamples() != NULL );
+		CPPUNIT_ASSERT_EQUAL( 1, SoundBufferCache::getBufferCount() );
+		broken.close();
+		CPPUNIT_ASSERT_EQUAL( 1, SoundBufferCache::getBufferCount() );
+	}
+
+	void test_shared_buffers_threaded() {
+		SoundBufferCache::start(2);
+		checkSharedBuffers();
+
+		// Released before any worker decoded them
+		for (int i = 0; i < 50; ++i) {
+			StaticSound sound;
+			sound.load(wavFile);
+		}
+		for (int i = 0; i < 200 && SoundBufferCache::getBufferCount() > 0; ++i) {
+			sleep(5);
+		}
+		CPPUNIT_ASSERT_EQUAL( 0, SoundBufferCache::getBufferCount() );
+	}
+
+	void test_prefetched_stream() {
+		StrSound::setPrefetchSize(64 * 1024);
+		StrSound sound;
+		sound.open(wavFile);
+
+		vector<int8> samples;
+		int8 chunk[3000];
+		for (uint32 readCount = sound.read(chunk, sizeof(chunk)); readCount > 0;
+			readCount = sound.read(chunk, sizeof(chunk))) {
+			samples.insert(samples.end(), chunk, chunk + readCount);
+		}
+		CPPUNIT_ASSERT_EQUAL( (size_t) sampleCount, samples.size() );
+		for (uint32 i = 0; i < sampleCount; ++i) {
+			CPPUNIT_ASSERT_EQUAL( sampleAt(i), samples[i] );
+		}
+
+		sound.restart();
+		CPPUNIT_ASSERT_EQUAL( (uint32) sizeof(chunk), sound.read(chunk, sizeof(chunk)) );
+		CPPUNIT_ASSERT_EQUAL( sampleAt(5), chunk[5] );
+		sound.close();
+	}
+
+	void test_archived_sound() {
+		string archiveFile = getUserHome() + "/.zetaglest_sound_buffer_test/sounds" + DataArchive::fileExtension;
+		string soundFolder = folder + "sounds/";
+		createDirectoryPaths(soundFolder);
+		writeWav(soundFolder + "sound.wav");
+		CPPUNIT_ASSERT_EQUAL( true, DataArchive::create(soundFolder, archiveFile, true) );
+		CPPUNIT_ASSERT_EQUAL( true, VirtualFileSystem::mountFolderArchive(soundFolder) );
+		removeFile(soundFolder + "sound.wav");
+
+		StaticSound sound;
+		sound.load(soundFolder + "sound.wav");
+		CPPUNIT_ASSERT( sound.getSamples() != NULL );
+		CPPUNIT_ASSERT_EQUAL( sampleCount, sound.getInfo()->getSize() );
+		CPPUNIT_ASSERT_EQUAL( sampleAt(99), sound.getSamples()[99] );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SoundBufferCacheTest );
@@ -0,0 +1,165 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <fstream>
+#include "checksum.h"
+#include "conversion.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for Checksum
+//
+class ChecksumTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ChecksumTest );
+
+	CPPUNIT_TEST( test_known_crc );
+	CPPUNIT_TEST( test_bytes_match_single_bytes );
+	CPPUNIT_TEST( test_threaded_file_sum_unchanged );
+	CPPUNIT_TEST( test_persistent_file_cache );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	vector<string> testFiles;
+
+	void createTestFiles(int count) {
+		for (int i = 0; i < count; ++i) {
+			bool isXMLFile = (i % 3 == 0);
+			string path = "./checksum_test_" + intToStr(i) + (isXMLFile ? ".xml" : ".bin");
+			std::ofstream file(path.c_str(), std::ios::binary);
+			if (isXMLFile == true) {
+				file << "<?xml version=\"1.0\"?>\n<!-- comment " << i << " -->\n<unit size=\"" << i << "\">\n\t<text> value </text>\n</unit>\n";
+			} else {
+				for (int j = 0; j < 1000 + i * 37; ++j) {
+					file.put((char) ((i * 31 + j * 7) & 0xff));
+				}
+			}
+			file.close();
+			testFiles.push_back(path);
+		}
+	}
+
+	uint32 getTestFilesSum() {
+		Checksum::clearFileCache();
+		Checksum checksum;
+		for (unsigned int i = 0; i < testFiles.size(); ++i) {
+			checksum.addFile(testFiles[i]);
+		}
+		return checksum.getFinalFileListSum();
+	}
+
+public:
+
+	void tearDown() {
+		for (unsigned int i = 0; i < testFiles.size(); ++i) {
+			removeFile(testFiles[i]);
+		}
+		testFiles.clear();
+		Checksum::clearFileCache();
+		Checksum::setFileCRCCacheFile("");
+	}
+
+	void test_known_crc() {
+		Checksum checksum;
+		checksum.addString("123456789");
+		CPPUNIT_ASSERT_EQUAL( (uint32)0xCBF43926, checksum.getSum() );
+	}
+
+	void test_bytes_match_single_bytes() {
+		char data[300];
+		for (unsigned int i = 0; i < sizeof(data); ++i) {
+			data[i] = (char) (i * 131 + 17);
+		}
+		// Every length and start offset around the 8 byte steps
+		for (unsigned int offset = 0; offset < 9; ++offset) {
+			for (unsigned int length = 0; offset + length <= sizeof(data); length += 7) {
+				Checksum bytes;
+				bytes.addBytes(&data[offset], length);
+				Checksum singleBytes;
+				for (unsigned int i = 0; i < length; ++i) {
+					singleBytes.addByte(data[offset + i]);
+				}
+				CPPUNIT_ASSERT_EQUAL( singleBytes.getSum(), bytes.getSum() );
+			}
+		}
+	}
+
+	void test_threaded_file_sum_unchanged() {
+		createTestFiles(64);
+
+		int threadCount = Checksum::getFileThreadCount();
+		Checksum::setFileThreadCount(1);
+		uint32 singleThreadSum = getTestFilesSum();
+		Checksum::setFileThreadCount(4);
+		uint32 multiThreadSum = getTestFilesSum();
+		Checksum::setFileThreadCount(threadCount);
+
+		CPPUNIT_ASSERT( singleThreadSum != 0 );
+		CPPUNIT_ASSERT_EQUAL( singleThreadSum, multiThreadSum );
+
+		// Comments and spaces in xml files are not part of the sum
+		Checksum xmlSum;
+		xmlSum.addString(lastFile(testFiles[3]));
+		xmlSum.addString("<?xmlversion=\"1.0\"?><unitsize=\"3\"><text>value</text></unit>");
+		CPPUNIT_ASSERT_EQUAL( xmlSum.getSum(), Checksum::getFileSum(testFiles[3]) );
+	}
+
+	void test_persistent_file_cache() {
+		createTestFiles(4);
+		string cacheFile = "./checksum_test_crc_cache";
+		removeFile(cacheFile);
+
+		Checksum::setFileCRCCacheFile(cacheFile);
+		uint32 sum = getTestFilesSum();
+		CPPUNIT_ASSERT_EQUAL( true, fileExists(cacheFile) );
+
+		// An unchanged file takes its sum from the cache file, which is
+		// told apart here by giving the record a different crc
+		Checksum::setFileCRCCacheFile("");
+		{
+			std::fstream file(cacheFile.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+			file.seekp(-4, std::ios::end);
+			file.put('\x5a');
+		}
+		Checksum::setFileCRCCacheFile(cacheFile);
+		CPPUNIT_ASSERT( getTestFilesSum() != sum );
+
+		// A changed file is hashed again
+		Checksum::setFileCRCCacheFile("");
+		removeFile(cacheFile);
+		Checksum::setFileCRCCacheFile(cacheFile);
+		CPPUNIT_ASSERT_EQUAL( sum, getTestFilesSum() );
+		{
+			std::ofstream file(testFiles[1].c_str(), std::ios::binary | std::ios::app);
+			file << "more";
+		}
+		uint32 changedSum = getTestFilesSum();
+		CPPUNIT_ASSERT( changedSum != sum );
+		Checksum::setFileCRCCacheFile("");
+		Checksum::setFileCRCCacheFile(cacheFile);
+		CPPUNIT_ASSERT_EQUAL( changedSum, getTestFilesSum() );
+
+		Checksum::setFileCRCCacheFile("");
+		removeFile(cacheFile);
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ChecksumTest );
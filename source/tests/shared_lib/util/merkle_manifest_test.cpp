@@ -0,0 +1,142 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "merkle_manifest.h"
+#include "conversion.h"
+#include <vector>
+#include <algorithm>
+
+using namespace Shared::Util;
+
+//
+// Tests for MerkleManifest
+//
+class MerkleManifestTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( MerkleManifestTest );
+
+	CPPUNIT_TEST( test_same_data_in_different_folders );
+	CPPUNIT_TEST( test_diff_reports_changed_and_missing_files );
+	CPPUNIT_TEST( test_diff_skips_identical_folders );
+	CPPUNIT_TEST( test_root_is_matched_as_leading_folder );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	vector<std::pair<string, uint32> > makeTechtree(const string &installFolder) {
+		vector<std::pair<string, uint32> > fileList;
+		fileList.push_back(make_pair(installFolder + "/techs/megapack/megapack.xml", 11));
+		fileList.push_back(make_pair(installFolder + "/techs/megapack/factions/magic/magic.xml", 21));
+		fileList.push_back(make_pair(installFolder + "/techs/megapack/factions/magic/units/archmage/archmage.xml", 22));
+		fileList.push_back(make_pair(installFolder + "/techs/megapack/factions/tech/tech.xml", 31));
+		fileList.push_back(make_pair(installFolder + "/techs/megapack/factions/tech/units/worker/worker.xml", 32));
+		fileList.push_back(make_pair(installFolder + "/techs/megapack/resources/gold/gold.xml", 41));
+		return fileList;
+	}
+
+	vector<string> makeRoots(const string &installFolder) {
+		vector<string> rootFolders;
+		rootFolders.push_back(installFolder + "/techs/megapack");
+		return rootFolders;
+	}
+
+public:
+
+	void test_same_data_in_different_folders() {
+		MerkleManifest local;
+		local.build(makeTechtree("/usr/share/zetaglest"), makeRoots("/usr/share/zetaglest"));
+		MerkleManifest remote;
+		remote.build(makeTechtree("C:\\Program Files\\ZetaGlest"), makeRoots("C:\\Program Files\\ZetaGlest"));
+
+		CPPUNIT_ASSERT_EQUAL( 6, local.getFileCount() );
+		CPPUNIT_ASSERT_EQUAL( local.getRootHash(), remote.getRootHash() );
+
+		uint32 hash = 0;
+		CPPUNIT_ASSERT_EQUAL( true, local.getHash("factions/tech/tech.xml", hash) );
+		CPPUNIT_ASSERT_EQUAL( (uint32)31, hash );
+		CPPUNIT_ASSERT_EQUAL( false, local.getHash("factions/norsemen", hash) );
+
+		MerkleManifestDiff diff;
+		local.diff(remote, diff);
+		CPPUNIT_ASSERT_EQUAL( true, diff.empty() );
+		CPPUNIT_ASSERT_EQUAL( 1, diff.nodesCompared );
+	}
+
+	void test_diff_reports_changed_and_missing_files() {
+		vector<std::pair<string, uint32> > localFiles = makeTechtree("/home/a");
+		vector<std::pair<string, uint32> > remoteFiles = makeTechtree("/home/b");
+		remoteFiles[2].second = 99;
+		remoteFiles.push_back(make_pair(string("/home/b/techs/megapack/factions/egypt/egypt.xml"), 51));
+		localFiles.erase(localFiles.begin() + 5);
+
+		MerkleManifest local;
+		local.build(localFiles, makeRoots("/home/a"));
+		MerkleManifest remote;
+		remote.build(remoteFiles, makeRoots("/home/b"));
+		CPPUNIT_ASSERT( local.getRootHash() != remote.getRootHash() );
+
+		MerkleManifestDiff diff;
+		local.diff(remote, diff);
+
+		CPPUNIT_ASSERT_EQUAL( (size_t)1, diff.changed.size() );
+		CPPUNIT_ASSERT_EQUAL( string("factions/magic/units/archmage/archmage.xml"), diff.changed[0] );
+		CPPUNIT_ASSERT_EQUAL( (size_t)2, diff.missingLocally.size() );
+		CPPUNIT_ASSERT( std::find(diff.missingLocally.begin(), diff.missingLocally.end(), "factions/egypt/egypt.xml") != diff.missingLocally.end() );
+		CPPUNIT_ASSERT( std::find(diff.missingLocally.begin(), diff.missingLocally.end(), "resources/gold/gold.xml") != diff.missingLocally.end() );
+		CPPUNIT_ASSERT_EQUAL( (size_t)0, diff.missingRemotely.size() );
+	}
+
+	void test_diff_skips_identical_folders() {
+		vector<std::pair<string, uint32> > localFiles = makeTechtree("/a");
+		vector<std::pair<string, uint32> > remoteFiles = makeTechtree("/b");
+		for (int idx = 0; idx < 500; ++idx) {
+			string name = "/factions/tech/units/unit" + intToStr(idx) + "/unit.xml";
+			localFiles.push_back(make_pair("/a/techs/megapack" + name, idx));
+			remoteFiles.push_back(make_pair("/b/techs/megapack" + name, idx));
+		}
+		remoteFiles[0].second = 12;
+
+		MerkleManifest local;
+		local.build(localFiles, makeRoots("/a"));
+		MerkleManifest remote;
+		remote.build(remoteFiles, makeRoots("/b"));
+
+		MerkleManifestDiff diff;
+		local.diff(remote, diff);
+
+		CPPUNIT_ASSERT_EQUAL( (size_t)1, diff.changed.size() );
+		CPPUNIT_ASSERT_EQUAL( string("megapack.xml"), diff.changed[0] );
+		// root, its 3 children and nothing below the unchanged folders
+		CPPUNIT_ASSERT_EQUAL( 4, diff.nodesCompared );
+	}
+
+	void test_root_is_matched_as_leading_folder() {
+		// The techtree name also shows up further up and further down the path
+		vector<string> rootFolders;
+		rootFolders.push_back("/data/techs/megapack/");
+		rootFolders.push_back("/home/megapack/.zetaglest/techs/megapack");
+
+		CPPUNIT_ASSERT_EQUAL( string("megapack.xml"), MerkleManifest::getRelativePath("/home/megapack/.zetaglest/techs/megapack/megapack.xml", rootFolders) );
+		CPPUNIT_ASSERT_EQUAL( string("factions/megapack/megapack.xml"), MerkleManifest::getRelativePath("/data/techs/megapack/factions/megapack/megapack.xml", rootFolders) );
+		// Already relative, as sent over the network
+		CPPUNIT_ASSERT_EQUAL( string("factions/tech/tech.xml"), MerkleManifest::getRelativePath("factions/tech/tech.xml", rootFolders) );
+		// A sibling techtree whose name starts the same is not inside the root
+		CPPUNIT_ASSERT_EQUAL( string("/data/techs/megapack2/megapack2.xml"), MerkleManifest::getRelativePath("/data/techs/megapack2/megapack2.xml", rootFolders) );
+
+		vector<std::pair<string, uint32> > fileList = makeTechtree("/data");
+		MerkleManifest::getRelativeFileList(fileList, rootFolders);
+		CPPUNIT_ASSERT_EQUAL( string("factions/magic/magic.xml"), fileList[1].first );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( MerkleManifestTest );
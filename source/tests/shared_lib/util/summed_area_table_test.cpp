@@ -0,0 +1,88 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests
+//
+//	Copyright (C) 2018  The ZetaGlest team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "summed_area_table.h"
+
+using namespace Shared::Util;
+
+//
+// Tests for SummedAreaTable
+//
+class SummedAreaTableTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SummedAreaTableTest );
+
+	CPPUNIT_TEST( test_counts_match_brute_force );
+	CPPUNIT_TEST( test_outside_counts_as_marked );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_counts_match_brute_force() {
+		const int w = 23;
+		const int h = 17;
+		bool marked[h][w];
+		SummedAreaTable table;
+		table.init(-5, 10, w, h);
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				marked[y][x] = ((x * 7 + y * 13) % 5 == 0);
+				if (marked[y][x] == true) {
+					table.mark(x - 5, y + 10);
+				}
+			}
+		}
+		table.build();
+
+		for (int size = 1; size <= 6; ++size) {
+			for (int y = 0; y + size <= h; ++y) {
+				for (int x = 0; x + size <= w; ++x) {
+					int expected = 0;
+					for (int j = y; j < y + size; ++j) {
+						for (int i = x; i < x + size; ++i) {
+							expected += (marked[j][i] ? 1 : 0);
+						}
+					}
+					CPPUNIT_ASSERT_EQUAL( expected, table.getCount(x - 5, y + 10, size) );
+				}
+			}
+		}
+	}
+
+	void test_outside_counts_as_marked() {
+		SummedAreaTable table;
+		table.init(0, 0, 4, 4);
+		table.mark(3, 3);
+		// Marks outside the window are dropped
+		table.mark(10, 10);
+		table.build();
+
+		CPPUNIT_ASSERT( table.isClear(0, 0, 3) );
+		CPPUNIT_ASSERT_EQUAL( 1, table.getCount(0, 0, 4) );
+		// Half a 2x2 square sticks out to the left
+		CPPUNIT_ASSERT_EQUAL( 2, table.getCount(-1, 0, 2) );
+		CPPUNIT_ASSERT_EQUAL( 9, table.getCount(10, 10, 3) );
+		CPPUNIT_ASSERT_EQUAL( 0, table.getCount(0, 0, 0) );
+
+		// Reused for another window
+		table.init(100, 100, 2, 2);
+		table.build();
+		CPPUNIT_ASSERT( table.isClear(100, 100, 2) );
+		CPPUNIT_ASSERT_EQUAL( 0, table.getCount(101, 101, 1) );
+		CPPUNIT_ASSERT_EQUAL( 1, table.getCount(102, 101, 1) );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SummedAreaTableTest );
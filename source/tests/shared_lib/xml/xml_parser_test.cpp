@@ -14,6 +14,7 @@
 #include <fstream>
 #include "xml_parser.h"
 #include "platform_util.h"
+#include "conversion.h"
 
 #if defined(WANT_XERCES)
 
@@ -32,6 +33,7 @@
 
 using namespace Shared::Xml;
 using namespace Shared::Platform;
+using namespace Shared::Util;
 
 //
 // Utility methods for tests
@@ -317,6 +319,190 @@ public:
 };
 
 
+//
+// Tests for XmlTreePreloader
+//
+class XmlTreePreloaderTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( XmlTreePreloaderTest );
+
+	CPPUNIT_TEST( test_load_uses_preloaded_files );
+	CPPUNIT_TEST( test_different_tag_values_not_used );
+	CPPUNIT_TEST_EXCEPTION( test_malformed_file_still_reported,  megaglest_runtime_error );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void tearDown() {
+		XmlTreePreloader::stop();
+	}
+
+	void test_load_uses_preloaded_files() {
+		vector<string> fileList;
+		for(int i = 0; i < 16; ++i) {
+			fileList.push_back("xml_test_preload" + intToStr(i) + ".xml");
+			createValidXMLTestFile(fileList.back());
+		}
+		std::map<string,string> mapTagReplacementValues;
+		mapTagReplacementValues["$COMMONDATAPATH"] = "techs/test/commondata/";
+
+		XmlTreePreloader::start(fileList, mapTagReplacementValues, 4);
+		CPPUNIT_ASSERT_EQUAL( true, XmlTreePreloader::isRunning() );
+
+		for(unsigned int i = 0; i < fileList.size(); ++i) {
+			SafeRemoveTestFile deleteFile(fileList[i]);
+			XmlTree xmlInstance;
+			xmlInstance.load(fileList[i], mapTagReplacementValues);
+			CPPUNIT_ASSERT_EQUAL( string("menu"), xmlInstance.getRootNode()->getName() );
+			CPPUNIT_ASSERT_EQUAL( true, xmlInstance.getRootNode()->getAttribute("mytest-attribute")->getBoolValue() );
+			// Handed out once, after that the file is parsed as usual
+			CPPUNIT_ASSERT_EQUAL( (XmlNode *)NULL, XmlTreePreloader::takePreloaded(fileList[i], mapTagReplacementValues) );
+		}
+
+		XmlTreePreloader::stop();
+		CPPUNIT_ASSERT_EQUAL( false, XmlTreePreloader::isRunning() );
+	}
+	void test_different_tag_values_not_used() {
+		const string test_filename = "xml_test_preload_tags.xml";
+		createValidXMLTestFile(test_filename);
+		SafeRemoveTestFile deleteFile(test_filename);
+
+		std::map<string,string> mapTagReplacementValues;
+		mapTagReplacementValues["$COMMONDATAPATH"] = "techs/test/commondata/";
+		XmlTreePreloader::start(vector<string>(1, test_filename), mapTagReplacementValues, 1);
+		// Give the worker time to get to it, a file still waiting in the queue is not handed out
+		sleep(250);
+
+		CPPUNIT_ASSERT_EQUAL( (XmlNode *)NULL, XmlTreePreloader::takePreloaded(test_filename, std::map<string,string>()) );
+		XmlNode *rootNode = XmlTreePreloader::takePreloaded(test_filename, mapTagReplacementValues);
+		CPPUNIT_ASSERT( rootNode != NULL );
+		CPPUNIT_ASSERT_EQUAL( string("menu"), rootNode->getName() );
+		delete rootNode;
+	}
+	void test_malformed_file_still_reported() {
+		const string test_filename = "xml_test_preload_malformed.xml";
+		createMalformedXMLTestFile(test_filename);
+		SafeRemoveTestFile deleteFile(test_filename);
+
+		XmlTreePreloader::start(vector<string>(1, test_filename), std::map<string,string>(), 1);
+
+		XmlTree xmlInstance;
+		xmlInstance.load(test_filename, std::map<string,string>());
+	}
+};
+
+
+//
+// Tests for XmlTreeCache
+//
+class XmlTreeCacheTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( XmlTreeCacheTest );
+
+	CPPUNIT_TEST( test_cached_tree_matches_parsed );
+	CPPUNIT_TEST( test_crc_change_rebuilds );
+	CPPUNIT_TEST( test_files_outside_prefix_not_cached );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+
+	static const string cacheFile;
+	static const string xmlFile;
+
+	static std::map<string,string> getTagValues() {
+		std::map<string,string> mapTagReplacementValues;
+		mapTagReplacementValues["$COMMONDATAPATH"] = "techs/test/commondata/";
+		return mapTagReplacementValues;
+	}
+
+	static void createCommondataXMLTestFile(const string& test_filename) {
+		std::ofstream xmlFile(test_filename.c_str());
+		xmlFile << "<?xml version=\"1.0\"?>" << std::endl
+				<< "<unit>" << std::endl
+				<< "<image path=\"$COMMONDATAPATH/unit.bmp\"/>" << std::endl
+				<< "<sound path=\"sounds/hit.wav\" volume=\"0.5\"/>" << std::endl
+				<< "<text>$COMMONDATAPATH</text>" << std::endl
+				<< "</unit>" << std::endl;
+		xmlFile.close();
+	}
+
+	// Loads xmlFile with the cache open and saves the cache afterwards
+	static void buildCache(uint32 crc) {
+		XmlTreeCache::open(cacheFile, crc, "xml_test_cache", getTagValues());
+		XmlTree xmlInstance;
+		xmlInstance.load(xmlFile, getTagValues());
+		XmlTreeCache::close(true);
+	}
+
+public:
+
+	void setUp() {
+		createCommondataXMLTestFile(xmlFile);
+	}
+
+	void tearDown() {
+		XmlTreeCache::close(false);
+		removeTestFile(xmlFile);
+		removeTestFile(cacheFile);
+	}
+
+	void test_cached_tree_matches_parsed() {
+		buildCache(1234);
+
+		string parsedText;
+		string parsedImagePath;
+		{
+			XmlTree parsed;
+			parsed.load(xmlFile, getTagValues());
+			parsedText = parsed.getRootNode()->getChild("text")->getText();
+			parsedImagePath = parsed.getRootNode()->getChild("image")->getAttribute("path")->getValue("prefix/");
+		}
+
+		// Nothing needs the xml file once it is in the cache
+		removeTestFile(xmlFile);
+		XmlTreeCache::open(cacheFile, 1234, "xml_test_cache", getTagValues());
+		CPPUNIT_ASSERT_EQUAL( true, XmlTreeCache::hasFile(xmlFile) );
+
+		XmlTree cached;
+		cached.load(xmlFile, getTagValues());
+		const XmlNode *rootNode = cached.getRootNode();
+		CPPUNIT_ASSERT_EQUAL( string("unit"), rootNode->getName() );
+		CPPUNIT_ASSERT_EQUAL( (size_t)3, rootNode->getChildCount() );
+		CPPUNIT_ASSERT_EQUAL( parsedText, rootNode->getChild("text")->getText() );
+
+		const XmlNode *image = rootNode->getChild("image");
+		CPPUNIT_ASSERT_EQUAL( parsedImagePath, image->getAttribute("path")->getValue("prefix/") );
+		const XmlNode *sound = rootNode->getChild("sound");
+		CPPUNIT_ASSERT_EQUAL( string("prefix/sounds/hit.wav"), sound->getAttribute("path")->getValue("prefix/") );
+		CPPUNIT_ASSERT_EQUAL( 0.5f, sound->getAttribute("volume")->getFloatValue() );
+	}
+	void test_crc_change_rebuilds() {
+		buildCache(1234);
+
+		XmlTreeCache::open(cacheFile, 4321, "xml_test_cache", getTagValues());
+		CPPUNIT_ASSERT_EQUAL( 0, XmlTreeCache::getFileCount() );
+		XmlTreeCache::close(false);
+
+		std::map<string,string> otherTagValues = getTagValues();
+		otherTagValues["$COMMONDATAPATH"] = "techs/other/commondata/";
+		XmlTreeCache::open(cacheFile, 1234, "xml_test_cache", otherTagValues);
+		CPPUNIT_ASSERT_EQUAL( 0, XmlTreeCache::getFileCount() );
+	}
+	void test_files_outside_prefix_not_cached() {
+		XmlTreeCache::open(cacheFile, 1234, "some/other/folder/", getTagValues());
+		XmlTree xmlInstance;
+		xmlInstance.load(xmlFile, getTagValues());
+		CPPUNIT_ASSERT_EQUAL( false, XmlTreeCache::hasFile(xmlFile) );
+	}
+};
+
+const string XmlTreeCacheTest::cacheFile = "xml_test_cache.bin";
+const string XmlTreeCacheTest::xmlFile = "xml_test_cache.xml";
+
 //
 // Tests for XmlNode
 //
@@ -335,6 +521,7 @@ class XmlNodeTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST( test_valid_named_node );
 	CPPUNIT_TEST( test_child_nodes );
 	CPPUNIT_TEST( test_node_attributes );
+	CPPUNIT_TEST( test_interned_names );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
@@ -455,6 +642,20 @@ public:
 		CPPUNIT_ASSERT_EQUAL( (size_t)2,node.getChildCount() );
 	}
 
+	void test_interned_names() {
+		XmlNode node("testNode");
+		XmlNode *childNode1 = node.addChild("child");
+		XmlNode *childNode2 = node.addChild("child");
+		childNode1->addAttribute("value", "1", std::map<string,string>());
+		childNode2->addAttribute("value", "2", std::map<string,string>());
+
+		// Equal names share one string
+		CPPUNIT_ASSERT( &childNode1->getName() == &childNode2->getName() );
+		CPPUNIT_ASSERT( &childNode1->getAttribute("value")->getName() == &childNode2->getAttribute("value")->getName() );
+		CPPUNIT_ASSERT( &node.getName() != &childNode1->getName() );
+		CPPUNIT_ASSERT_EQUAL( 2, childNode2->getAttribute("value")->getIntValue() );
+	}
+
 	void test_node_attributes() {
 		XmlNode node("testNode");
 
@@ -624,6 +825,8 @@ public:
 
 CPPUNIT_TEST_SUITE_REGISTRATION( XmlIoRapidTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( XmlTreeTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( XmlTreePreloaderTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( XmlTreeCacheTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( XmlNodeTest );
 
 #if defined(WANT_XERCES)